@@ -0,0 +1,363 @@
+/******************************************************************************
+ *  File Name:
+ *    config_solver.hpp
+ *
+ *  Description:
+ *    Branch and bound search over several register option lists at once.
+ *    Everything is constexpr so fixed configurations resolve at compile time.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_ALGORITHM_CONFIG_SOLVER_HPP
+#define CHIMERA_ALGORITHM_CONFIG_SOLVER_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace Chimera::Algorithm::Solver
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Outcome of a search over D option lists
+   */
+  template<size_t D>
+  struct Result
+  {
+    bool   valid;         /**< False if no combination met the constraints */
+    double cost;          /**< Cost of the selected combination */
+    size_t index[ D ];    /**< Position of the selected option in each list */
+    size_t value[ D ];    /**< Selected option from each list */
+    size_t evaluations;   /**< Complete combinations that were scored */
+    size_t combinations;  /**< Size of the full search space, for comparison */
+  };
+
+  namespace Internal
+  {
+    /*-------------------------------------------------------------------------
+    Optional Problem members, detected so simple problems stay simple
+    -------------------------------------------------------------------------*/
+    template<typename P, size_t D, typename = void>
+    struct HasFeasible : std::false_type
+    {
+    };
+
+    template<typename P, size_t D>
+    struct HasFeasible<P, D,
+                       std::void_t<decltype( std::declval<const P &>().feasible(
+                           std::declval<const size_t ( & )[ D ]>(), size_t{} ) )>> : std::true_type
+    {
+    };
+
+    template<typename P, size_t D, typename = void>
+    struct HasBound : std::false_type
+    {
+    };
+
+    template<typename P, size_t D>
+    struct HasBound<P, D,
+                    std::void_t<decltype( std::declval<const P &>().bound( std::declval<const size_t ( & )[ D ]>(),
+                                                                           size_t{} ) )>> : std::true_type
+    {
+    };
+
+    /**
+     *  Depth first walk of the option lists. A branch is abandoned as soon as
+     *  a constraint fails or its lower bound can't beat the best so far.
+     */
+    template<typename Problem, size_t D>
+    class Search
+    {
+    public:
+      constexpr Search( const Problem &problem, const size_t *const ( &lists )[ D ], const size_t ( &sizes )[ D ] ) :
+          mProblem( problem ), mLists{}, mSizes{}, mValues{}, mIndex{}, mResult{}
+      {
+        mResult.valid        = false;
+        mResult.cost         = std::numeric_limits<double>::max();
+        mResult.combinations = 1;
+
+        for ( size_t x = 0; x < D; x++ )
+        {
+          mLists[ x ] = lists[ x ];
+          mSizes[ x ] = sizes[ x ];
+          mResult.combinations *= sizes[ x ];
+        }
+      }
+
+      constexpr Result<D> run()
+      {
+        descend( 0 );
+        return mResult;
+      }
+
+    private:
+      const Problem &mProblem;
+      const size_t  *mLists[ D ];
+      size_t         mSizes[ D ];
+      size_t         mValues[ D ];
+      size_t         mIndex[ D ];
+      Result<D>      mResult;
+
+      constexpr void descend( const size_t depth )
+      {
+        for ( size_t x = 0; x < mSizes[ depth ]; x++ )
+        {
+          mValues[ depth ] = mLists[ depth ][ x ];
+          mIndex[ depth ]  = x;
+
+          if constexpr ( HasFeasible<Problem, D>::value )
+          {
+            if ( !mProblem.feasible( mValues, depth + 1 ) )
+            {
+              continue;
+            }
+          }
+
+          if ( ( depth + 1 ) < D )
+          {
+            if constexpr ( HasBound<Problem, D>::value )
+            {
+              if ( mResult.valid && ( mProblem.bound( mValues, depth + 1 ) >= mResult.cost ) )
+              {
+                continue;
+              }
+            }
+
+            descend( depth + 1 );
+          }
+          else
+          {
+            score();
+          }
+
+          /*-------------------------------------------------------------------
+          Nothing beats an exact match
+          -------------------------------------------------------------------*/
+          if ( mResult.valid && ( mResult.cost <= 0.0 ) )
+          {
+            return;
+          }
+        }
+      }
+
+      constexpr void score()
+      {
+        const double cost = mProblem.cost( mValues );
+        mResult.evaluations++;
+
+        if ( cost < mResult.cost )
+        {
+          mResult.valid = true;
+          mResult.cost  = cost;
+
+          for ( size_t x = 0; x < D; x++ )
+          {
+            mResult.index[ x ] = mIndex[ x ];
+            mResult.value[ x ] = mValues[ x ];
+          }
+        }
+      }
+    };
+  }  // namespace Internal
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Finds the combination of one option from each list that minimizes the
+   *  problem's cost. The problem is any type providing:
+   *
+   *    constexpr double cost( const size_t ( &values )[ D ] ) const;
+   *      Required. Scores a complete combination, lower is better.
+   *
+   *    constexpr bool feasible( const size_t ( &values )[ D ], size_t depth ) const;
+   *      Optional. Checks the constraints that involve values[ 0, depth ).
+   *
+   *    constexpr double bound( const size_t ( &values )[ D ], size_t depth ) const;
+   *      Optional. Lower bound on the cost of any combination starting with
+   *      values[ 0, depth ). The tighter it is, the more gets pruned.
+   *
+   *  Ties go to the combination found first, so order each list by preference.
+   *
+   *  @param[in]  problem     Cost, constraints and bound
+   *  @param[in]  lists       Option values, one list per dimension
+   *  @return Result
+   */
+  template<typename Problem, size_t... N>
+  constexpr Result<sizeof...( N )> solve( const Problem &problem, const std::array<size_t, N> &...lists )
+  {
+    static_assert( sizeof...( N ) > 0, "Need at least one option list" );
+    constexpr size_t D = sizeof...( N );
+
+    const size_t *const data[ D ]  = { lists.data()... };
+    const size_t        sizes[ D ] = { N... };
+
+    Internal::Search<Problem, D> search( problem, data, sizes );
+    return search.run();
+  }
+
+  /*---------------------------------------------------------------------------
+  Ratio Chains
+  ---------------------------------------------------------------------------*/
+  enum class Op : uint8_t
+  {
+    MULTIPLY,
+    DIVIDE
+  };
+
+  /**
+   *  One step of a clock tree or baud generator. Each option from the stage's
+   *  list multiplies or divides the running value, which must then fall
+   *  within [min, max]. Think PLL M/N/P dividers, timer prescalers, etc.
+   */
+  struct Stage
+  {
+    Op     op;
+    double min = 0.0;
+    double max = std::numeric_limits<double>::max();
+  };
+
+  /**
+   *  Problem for solveRatio(). The bound uses the smallest and largest factor
+   *  left in the remaining lists to get the output range of a partial chain.
+   */
+  template<size_t D>
+  class RatioProblem
+  {
+  public:
+    constexpr RatioProblem( const double input, const double target, const std::array<Stage, D> &stages,
+                            const size_t ( &lo )[ D ], const size_t ( &hi )[ D ] ) :
+        mInput( input ), mTarget( target ), mStages( stages ), mRestLo{}, mRestHi{}
+    {
+      mRestLo[ D ] = 1.0;
+      mRestHi[ D ] = 1.0;
+
+      for ( size_t x = D; x > 0; x-- )
+      {
+        const Stage &stage = mStages[ x - 1 ];
+        const double small = static_cast<double>( lo[ x - 1 ] );
+        const double large = static_cast<double>( hi[ x - 1 ] );
+
+        if ( stage.op == Op::MULTIPLY )
+        {
+          mRestLo[ x - 1 ] = mRestLo[ x ] * small;
+          mRestHi[ x - 1 ] = mRestHi[ x ] * large;
+        }
+        else
+        {
+          mRestLo[ x - 1 ] = mRestLo[ x ] / ( large ? large : 1.0 );
+          mRestHi[ x - 1 ] = mRestHi[ x ] / ( small ? small : 1.0 );
+        }
+      }
+    }
+
+    constexpr double output( const size_t ( &values )[ D ], const size_t depth ) const
+    {
+      double value = mInput;
+      for ( size_t x = 0; x < depth; x++ )
+      {
+        value = ( mStages[ x ].op == Op::MULTIPLY ) ? ( value * values[ x ] ) : ( value / values[ x ] );
+      }
+
+      return value;
+    }
+
+    constexpr bool feasible( const size_t ( &values )[ D ], const size_t depth ) const
+    {
+      const Stage &stage = mStages[ depth - 1 ];
+      if ( ( stage.op == Op::DIVIDE ) && ( values[ depth - 1 ] == 0 ) )
+      {
+        return false;
+      }
+
+      const double value = output( values, depth );
+      return ( value >= stage.min ) && ( value <= stage.max );
+    }
+
+    constexpr double bound( const size_t ( &values )[ D ], const size_t depth ) const
+    {
+      const double value = output( values, depth );
+      const double lo    = value * mRestLo[ depth ];
+      const double hi    = value * mRestHi[ depth ];
+
+      if ( mTarget < lo )
+      {
+        return lo - mTarget;
+      }
+
+      return ( mTarget > hi ) ? ( mTarget - hi ) : 0.0;
+    }
+
+    constexpr double cost( const size_t ( &values )[ D ] ) const
+    {
+      const double value = output( values, D );
+      return ( value > mTarget ) ? ( value - mTarget ) : ( mTarget - value );
+    }
+
+  private:
+    double               mInput;
+    double               mTarget;
+    std::array<Stage, D> mStages;
+    double               mRestLo[ D + 1 ]; /**< Smallest factor stages [x, D) can apply */
+    double               mRestHi[ D + 1 ]; /**< Largest factor stages [x, D) can apply */
+  };
+
+  /**
+   *  Finds the options that bring input closest to target through a chain of
+   *  multiply/divide stages, honoring each stage's limits. For example, an
+   *  STM32F4 main PLL from an 8MHz HSE:
+   *
+   *    constexpr auto pll = Solver::solveRatio( 8e6, 168e6,
+   *                                             { { { Op::DIVIDE, 1e6, 2e6 },        // M: VCO input
+   *                                                 { Op::MULTIPLY, 100e6, 432e6 },  // N: VCO output
+   *                                                 { Op::DIVIDE, 0.0, 168e6 } } },  // P: SYSCLK
+   *                                             PLLM_OPTIONS, PLLN_OPTIONS, PLLP_OPTIONS );
+   *    static_assert( pll.valid && ( pll.cost == 0.0 ) );
+   *
+   *  The result's index[] picks the matching register encodings.
+   *
+   *  @param[in]  input       Value entering the first stage
+   *  @param[in]  target      Desired output of the last stage
+   *  @param[in]  stages      Operation and limits of each stage
+   *  @param[in]  lists       Option values, one list per stage
+   *  @return Result          cost is the absolute error from target
+   */
+  template<size_t... N>
+  constexpr Result<sizeof...( N )> solveRatio( const double input, const double target,
+                                               const std::array<Stage, sizeof...( N )> &stages,
+                                               const std::array<size_t, N> &...lists )
+  {
+    constexpr size_t D = sizeof...( N );
+
+    size_t lo[ D ] = {};
+    size_t hi[ D ] = {};
+    size_t dim     = 0;
+    auto   minmax  = [ & ]( const auto &list ) {
+      lo[ dim ] = std::numeric_limits<size_t>::max();
+      hi[ dim ] = 0;
+
+      for ( const size_t value : list )
+      {
+        lo[ dim ] = ( value < lo[ dim ] ) ? value : lo[ dim ];
+        hi[ dim ] = ( value > hi[ dim ] ) ? value : hi[ dim ];
+      }
+
+      dim++;
+    };
+    ( minmax( lists ), ... );
+
+    const RatioProblem<D> problem( input, target, stages, lo, hi );
+    return solve( problem, lists... );
+  }
+
+}  // namespace Chimera::Algorithm::Solver
+
+#endif /* !CHIMERA_ALGORITHM_CONFIG_SOLVER_HPP */
@@ -0,0 +1,361 @@
+/******************************************************************************
+ *  File Name:
+ *    allocator_arena.hpp
+ *
+ *  Description:
+ *    Monotonic (bump pointer) allocator for short lived scratch memory
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_ALLOCATOR_ARENA_HPP
+#define CHIMERA_ALLOCATOR_ARENA_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if __has_include( <memory_resource> )
+#include <memory_resource>
+#endif
+
+#if __has_include( <etl/imemory_block_allocator.h> )
+#include <etl/imemory_block_allocator.h>
+#endif
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Minimum size of a heap chunk requested when an arena that permits
+overflow runs out of room in its primary buffer.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ARENA_OVERFLOW_CHUNK_SIZE
+#define CHIMERA_ARENA_OVERFLOW_CHUNK_SIZE ( 512 )
+#endif
+
+namespace Chimera::Memory
+{
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Bump pointer allocator over a caller supplied buffer. Allocations are
+   *  never individually freed. Instead the whole arena is reset at once, or
+   *  rolled back to a previously taken marker, both in O(1) when no overflow
+   *  chunks were needed.
+   *
+   *  When overflow is enabled and the primary buffer is exhausted, additional
+   *  chunks are pulled from Chimera::malloc() and chained together. They are
+   *  returned to the heap when the arena is reset or rewound past them.
+   *
+   *  @warning Not thread safe. Intended to be owned by a single task, usually
+   *           for the lifetime of a single transaction or frame.
+   */
+  class Arena
+  {
+  public:
+    /**
+     *  Position in the arena that can later be restored with rewind()
+     */
+    struct Marker
+    {
+      void  *chunk;  /**< Chunk that was active (nullptr for the primary buffer) */
+      size_t offset; /**< Bump offset inside that chunk */
+    };
+
+    /**
+     *  RAII helper that rewinds the arena to where it was when the scope was
+     *  entered. Scopes may be nested arbitrarily as long as they are destroyed
+     *  in reverse order of construction.
+     */
+    class Scope
+    {
+    public:
+      explicit Scope( Arena &arena ) : mArena( arena ), mMarker( arena.mark() )
+      {
+      }
+
+      ~Scope()
+      {
+        mArena.rewind( mMarker );
+      }
+
+      Scope( const Scope & )            = delete;
+      Scope &operator=( const Scope & ) = delete;
+
+    private:
+      Arena &mArena;
+      Marker mMarker;
+    };
+
+    Arena();
+    Arena( void *const buffer, const size_t size, const bool allowOverflow = false );
+    ~Arena();
+
+    Arena( const Arena & )            = delete;
+    Arena &operator=( const Arena & ) = delete;
+
+    /**
+     *  Assigns the backing memory for the arena, dropping any previous state
+     *
+     *  @param[in]  buffer          Memory to allocate from
+     *  @param[in]  size            Size of the buffer in bytes
+     *  @param[in]  allowOverflow   Chain heap chunks when the buffer runs out
+     *  @return void
+     */
+    void assign( void *const buffer, const size_t size, const bool allowOverflow = false );
+
+    /**
+     *  Allocates a block of memory
+     *
+     *  @param[in]  size        Number of bytes to allocate
+     *  @param[in]  alignment   Required alignment, must be a power of two
+     *  @return void*           Allocated memory, or nullptr if exhausted
+     */
+    void *allocate( const size_t size, const size_t alignment = alignof( std::max_align_t ) );
+
+    /**
+     *  Allocates and default constructs an array of objects
+     *
+     *  @note Destructors are never run by the arena
+     *
+     *  @param[in]  count       Number of objects to construct
+     *  @return T*              nullptr if exhausted or the size overflows
+     */
+    template<typename T>
+    T *create( const size_t count = 1 )
+    {
+      if ( count > ( SIZE_MAX / sizeof( T ) ) )
+      {
+        return nullptr;
+      }
+
+      void *mem = allocate( sizeof( T ) * count, alignof( T ) );
+      if ( !mem )
+      {
+        return nullptr;
+      }
+
+      T *obj = static_cast<T *>( mem );
+      for ( size_t x = 0; x < count; x++ )
+      {
+        new ( &obj[ x ] ) T();
+      }
+
+      return obj;
+    }
+
+    /**
+     *  Releases every allocation made from the arena
+     *
+     *  @return void
+     */
+    void reset();
+
+    /**
+     *  Captures the current allocation position
+     *
+     *  @return Marker
+     */
+    Marker mark() const;
+
+    /**
+     *  Releases every allocation made since the marker was taken
+     *
+     *  @param[in]  marker      Position returned from mark()
+     *  @return void
+     */
+    void rewind( const Marker &marker );
+
+    /**
+     *  Checks if the pointer came from this arena
+     *
+     *  @param[in]  ptr         Pointer to check
+     *  @return bool
+     */
+    bool owns( const void *const ptr ) const;
+
+    /**
+     *  Size of the primary buffer
+     *  @return size_t
+     */
+    size_t capacity() const;
+
+    /**
+     *  Bytes consumed in the primary buffer, including alignment padding
+     *  @return size_t
+     */
+    size_t used() const;
+
+    /**
+     *  Bytes currently held in overflow chunks pulled from the heap
+     *  @return size_t
+     */
+    size_t overflowBytes() const;
+
+    /**
+     *  Largest value used() + overflowBytes() has reached since the last assign()
+     *  @return size_t
+     */
+    size_t highWaterMark() const;
+
+  private:
+    struct Chunk
+    {
+      Chunk *next; /**< Previously active chunk */
+      size_t size; /**< Usable bytes following the header */
+    };
+
+    uint8_t *mBuffer;        /**< Primary buffer */
+    size_t   mSize;          /**< Size of the primary buffer */
+    size_t   mPrimaryUsed;   /**< Bump offset into the primary buffer */
+    Chunk   *mChunk;         /**< Active overflow chunk, nullptr if using the primary buffer */
+    size_t   mChunkUsed;     /**< Bump offset into the active chunk */
+    size_t   mOverflowBytes; /**< Total bytes held by overflow chunks */
+    size_t   mHighWater;     /**< Peak usage */
+    bool     mAllowOverflow; /**< May chunks be pulled from the heap? */
+
+    void *allocateFromChunk( const size_t size, const size_t alignment );
+    void  releaseChunksUntil( const Chunk *const stop );
+    void  updateHighWater();
+  };
+
+
+  /**
+   *  Standard library compatible allocator that draws from an Arena. Useful
+   *  for giving STL containers scratch storage for the life of a transaction.
+   *
+   *  @code
+   *  Arena arena( buffer, sizeof( buffer ) );
+   *  std::vector<int, ArenaAllocator<int>> vec( ArenaAllocator<int>( arena ) );
+   *  @endcode
+   */
+  template<typename T>
+  class ArenaAllocator
+  {
+  public:
+    using value_type = T;
+
+    explicit ArenaAllocator( Arena &arena ) noexcept : mArena( &arena )
+    {
+    }
+
+    template<typename U>
+    ArenaAllocator( const ArenaAllocator<U> &other ) noexcept : mArena( other.arena() )
+    {
+    }
+
+    T *allocate( const size_t n )
+    {
+      if ( n > ( SIZE_MAX / sizeof( T ) ) )
+      {
+        return nullptr;
+      }
+
+      return static_cast<T *>( mArena->allocate( n * sizeof( T ), alignof( T ) ) );
+    }
+
+    void deallocate( T *const, const size_t ) noexcept
+    {
+      /* Memory is reclaimed when the arena is reset */
+    }
+
+    Arena *arena() const noexcept
+    {
+      return mArena;
+    }
+
+    template<typename U>
+    bool operator==( const ArenaAllocator<U> &rhs ) const noexcept
+    {
+      return mArena == rhs.arena();
+    }
+
+    template<typename U>
+    bool operator!=( const ArenaAllocator<U> &rhs ) const noexcept
+    {
+      return mArena != rhs.arena();
+    }
+
+  private:
+    Arena *mArena;
+  };
+
+
+#if __has_include( <memory_resource> )
+  /**
+   *  Polymorphic memory resource adapter so std::pmr containers can use an Arena
+   *
+   *  @note Returns nullptr on exhaustion rather than throwing, as exceptions are
+   *        usually disabled on target.
+   */
+  class ArenaResource : public std::pmr::memory_resource
+  {
+  public:
+    explicit ArenaResource( Arena &arena ) : mArena( arena )
+    {
+    }
+
+  protected:
+    void *do_allocate( size_t bytes, size_t alignment ) override
+    {
+      return mArena.allocate( bytes, alignment );
+    }
+
+    void do_deallocate( void *, size_t, size_t ) override
+    {
+      /* Memory is reclaimed when the arena is reset */
+    }
+
+    bool do_is_equal( const std::pmr::memory_resource &other ) const noexcept override
+    {
+      return this == &other;
+    }
+
+  private:
+    Arena &mArena;
+  };
+#endif /* __has_include( <memory_resource> ) */
+
+
+#if __has_include( <etl/imemory_block_allocator.h> )
+  /**
+   *  ETL memory block allocator adapter, allowing an Arena to back ETL types
+   *  that draw from an etl::imemory_block_allocator (message pools, etc).
+   */
+  class ArenaBlockAllocator : public etl::imemory_block_allocator
+  {
+  public:
+    explicit ArenaBlockAllocator( Arena &arena ) : mArena( arena )
+    {
+    }
+
+  protected:
+    void *allocate_block( size_t required_size, size_t required_alignment ) override
+    {
+      return mArena.allocate( required_size, required_alignment );
+    }
+
+    bool release_block( const void *const ptr ) override
+    {
+      return mArena.owns( ptr );
+    }
+
+    bool is_owner_of_block( const void *const ptr ) const override
+    {
+      return mArena.owns( ptr );
+    }
+
+  private:
+    Arena &mArena;
+  };
+#endif /* __has_include( <etl/imemory_block_allocator.h> ) */
+
+}  // namespace Chimera::Memory
+
+#endif /* !CHIMERA_ALLOCATOR_ARENA_HPP */
@@ -0,0 +1,104 @@
+/******************************************************************************
+ *  File Name:
+ *    allocator_cache.hpp
+ *
+ *  Description:
+ *    Thread caching front end for the Chimera allocator
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_ALLOCATOR_CACHE_HPP
+#define CHIMERA_ALLOCATOR_CACHE_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Chimera/source/drivers/allocator/allocator_types.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace Chimera::Memory
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Thread cache statistics. Hit and miss counts are for the calling thread,
+   *  while the shared figures cover blocks parked in the central free lists.
+   */
+  struct ThreadCacheStats
+  {
+    size_t hits;         /**< Allocations served from the calling thread's cache */
+    size_t misses;       /**< Allocations that had to go to the shared lists or heap */
+    size_t cachedBytes;  /**< Bytes held in the calling thread's cache */
+    size_t centralBytes; /**< Bytes held in the shared free lists */
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Gets cache statistics for the calling thread
+   *
+   *  @note If CHIMERA_ALLOCATOR_THREAD_CACHE is disabled, all fields are zero
+   *
+   *  @param[out] stats     Output for the statistics
+   *  @return void
+   */
+  void getThreadCacheStats( ThreadCacheStats &stats );
+
+  /**
+   *  Moves every block held by the calling thread's cache to the shared free
+   *  lists. Happens automatically when a thread exits.
+   *
+   *  @return void
+   */
+  void flushThreadCache();
+
+  /**
+   *  Returns every block in the shared free lists to the backend heap. Blocks
+   *  still cached by other threads are unaffected.
+   *
+   *  @return void
+   */
+  void releaseCachedMemory();
+
+  namespace Internal
+  {
+    /**
+     *  Allocates through the calling thread's cache
+     *
+     *  @param[in]  size      Number of bytes requested
+     *  @return void*
+     */
+    void *cacheAllocate( const size_t size );
+
+    /**
+     *  Releases a block from cacheAllocate() into the calling thread's cache
+     *
+     *  @param[in]  ptr       Block to release
+     *  @return void
+     */
+    void cacheFree( void *const ptr );
+
+    /**
+     *  Raw access to the backend heap, used by the cache to fill misses
+     *
+     *  @param[in]  size      Number of bytes requested
+     *  @return void*
+     */
+    void *backendMalloc( const size_t size );
+
+    /**
+     *  Raw access to the backend heap, used by the cache to release blocks
+     *
+     *  @param[in]  ptr       Block to release
+     *  @return void
+     */
+    void backendFree( void *const ptr );
+  }  // namespace Internal
+}  // namespace Chimera::Memory
+
+#endif /* !CHIMERA_ALLOCATOR_CACHE_HPP */
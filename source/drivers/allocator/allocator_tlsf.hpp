@@ -0,0 +1,187 @@
+/******************************************************************************
+ *  File Name:
+ *    allocator_tlsf.hpp
+ *
+ *  Description:
+ *    Two-Level Segregated Fit allocator. Provides O(1) allocation and release
+ *    with bounded worst case timing, suitable for use inside control loops.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_ALLOCATOR_TLSF_HPP
+#define CHIMERA_ALLOCATOR_TLSF_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Log2 of the largest block a TLSF instance can manage. Controls the
+size of the first level index and thus the control structure size.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_TLSF_FL_INDEX_MAX
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define CHIMERA_TLSF_FL_INDEX_MAX ( 32 )
+#else
+#define CHIMERA_TLSF_FL_INDEX_MAX ( 24 )
+#endif
+#endif
+
+namespace Chimera::Memory
+{
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  TLSF heap over one or more caller supplied memory regions. Free blocks
+   *  are binned into a two level table of segregated lists indexed by bitmaps,
+   *  so finding a suitable block is a pair of bit scans regardless of how
+   *  fragmented the heap has become. Adjacent free blocks are coalesced
+   *  immediately on release.
+   *
+   *  @warning Not thread safe. Callers sharing an instance must lock around it.
+   */
+  class TLSF
+  {
+  public:
+    /*-------------------------------------------------------------------------
+    Constants
+    -------------------------------------------------------------------------*/
+    static constexpr size_t ALIGN_SIZE     = alignof( std::max_align_t );
+    static constexpr size_t SL_INDEX_LOG2  = 5;
+    static constexpr size_t SL_INDEX_COUNT = 1u << SL_INDEX_LOG2;
+    static constexpr size_t FL_INDEX_MAX   = CHIMERA_TLSF_FL_INDEX_MAX;
+    static constexpr size_t FL_INDEX_SHIFT = SL_INDEX_LOG2 + ( ALIGN_SIZE == 16 ? 4 : 3 );
+    static constexpr size_t FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+    static constexpr size_t SMALL_BLOCK    = 1u << FL_INDEX_SHIFT;
+
+    static_assert( ( ALIGN_SIZE == 8 ) || ( ALIGN_SIZE == 16 ), "Unsupported platform alignment" );
+    static_assert( FL_INDEX_COUNT <= 32, "First level bitmap must fit in 32 bits" );
+
+    /**
+     *  Heap usage and fragmentation figures
+     */
+    struct Stats
+    {
+      size_t totalBytes;    /**< Usable bytes across all pools */
+      size_t usedBytes;     /**< Bytes in allocated blocks, including headers */
+      size_t freeBytes;     /**< Bytes in free blocks */
+      size_t peakUsedBytes; /**< High water mark of usedBytes */
+      size_t usedBlocks;    /**< Number of allocated blocks */
+      size_t freeBlocks;    /**< Number of free blocks */
+      size_t largestFree;   /**< Size of the largest free block */
+      float  fragmentation; /**< 1 - largestFree / freeBytes. Zero means no fragmentation. */
+    };
+
+    TLSF();
+    ~TLSF() = default;
+
+    TLSF( const TLSF & )            = delete;
+    TLSF &operator=( const TLSF & ) = delete;
+
+    /**
+     *  Resets the allocator and hands it its first memory region
+     *
+     *  @param[in]  region      Start of the memory region
+     *  @param[in]  size        Size of the region in bytes
+     *  @return bool            True if the region was large enough to use
+     */
+    bool init( void *const region, const size_t size );
+
+    /**
+     *  Adds another, non-contiguous, memory region to the heap
+     *
+     *  @param[in]  region      Start of the memory region
+     *  @param[in]  size        Size of the region in bytes
+     *  @return bool            True if the region was large enough to use
+     */
+    bool addPool( void *const region, const size_t size );
+
+    /**
+     *  Allocates a block of at least the given size, aligned to ALIGN_SIZE
+     *
+     *  @param[in]  size        Number of bytes requested
+     *  @return void*           nullptr if no block could satisfy the request
+     */
+    void *malloc( const size_t size );
+
+    /**
+     *  Releases a block previously returned from malloc()
+     *
+     *  @param[in]  ptr         Block to release (nullptr is ignored)
+     *  @return void
+     */
+    void free( void *const ptr );
+
+    /**
+     *  Number of bytes that can actually be used in an allocated block
+     *
+     *  @param[in]  ptr         Block returned from malloc()
+     *  @return size_t
+     */
+    size_t usableSize( const void *const ptr ) const;
+
+    /**
+     *  Gets heap usage and fragmentation statistics. Only the largest
+     *  free list is walked, so this is cheap enough to poll.
+     *
+     *  @param[out] stats       Output for the statistics
+     *  @return void
+     */
+    void getStats( Stats &stats ) const;
+
+    /**
+     *  Walks every pool and verifies the block chain and free list
+     *  bookkeeping. Intended for test and debug builds; runs in O(n).
+     *
+     *  @return bool            True if the heap is consistent
+     */
+    bool check() const;
+
+  private:
+    static constexpr size_t MAX_POOLS = 4;
+
+    struct Pool
+    {
+      uint8_t *first; /**< First block in the pool */
+      size_t   size;  /**< Bytes managed in the pool */
+    };
+
+    uint32_t mFLBitmap;                                    /**< Non-empty first level lists */
+    uint32_t mSLBitmap[ FL_INDEX_COUNT ];                  /**< Non-empty second level lists */
+    uint8_t *mBlocks[ FL_INDEX_COUNT ][ SL_INDEX_COUNT ];  /**< Free list heads */
+    Pool     mPools[ MAX_POOLS ];                          /**< Registered regions */
+    size_t   mNumPools;                                    /**< Number of registered regions */
+    size_t   mTotalBytes;                                  /**< Usable bytes across all pools */
+    size_t   mUsedBytes;                                   /**< Bytes in allocated blocks */
+    size_t   mPeakUsedBytes;                               /**< High water mark of mUsedBytes */
+    size_t   mUsedBlocks;                                  /**< Number of allocated blocks */
+    size_t   mFreeBlocks;                                  /**< Number of free blocks */
+
+    void     insertFree( uint8_t *const block );
+    void     removeFree( uint8_t *const block );
+    uint8_t *findSuitable( size_t &fl, size_t &sl ) const;
+  };
+
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Gets statistics for the TLSF heap backing the allocator overrides
+   *
+   *  @param[out] stats       Output for the statistics
+   *  @return bool            False if the build isn't using the TLSF backend
+   */
+  bool getSystemHeapStats( TLSF::Stats &stats );
+
+}  // namespace Chimera::Memory
+
+#endif /* !CHIMERA_ALLOCATOR_TLSF_HPP */
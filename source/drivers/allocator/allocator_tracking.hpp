@@ -0,0 +1,103 @@
+/******************************************************************************
+ *  File Name:
+ *    allocator_tracking.hpp
+ *
+ *  Description:
+ *    Heap instrumentation for the Chimera allocator overrides
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_ALLOCATOR_TRACKING_HPP
+#define CHIMERA_ALLOCATOR_TRACKING_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Chimera/source/drivers/allocator/allocator_types.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace Chimera::Memory
+{
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Gets a snapshot of the heap statistics. The counters are updated without
+   *  locks, so the individual fields may be very slightly out of sync with each
+   *  other if allocations are in flight while this is called.
+   *
+   *  @note If CHIMERA_ALLOCATOR_TRACKING is disabled, all fields are zero
+   *
+   *  @param[out] stats     Output for the statistics
+   *  @return void
+   */
+  void getHeapStats( HeapStats &stats );
+
+  /**
+   *  Resets the peak usage watermark back to the current usage
+   *
+   *  @return void
+   */
+  void resetHeapPeak();
+
+  /**
+   *  Copies out the per call site statistics
+   *
+   *  @note Requires CHIMERA_ALLOCATOR_TRACKING_SITES > 0
+   *
+   *  @param[out] buffer    Where to place the site records
+   *  @param[in]  count     Max number of records the buffer can hold
+   *  @return size_t        Number of records written
+   */
+  size_t getSiteStats( SiteStats *const buffer, const size_t count );
+
+  /**
+   *  Walks all blocks that are currently allocated and recorded in the
+   *  live block table, invoking the visitor on each of them.
+   *
+   *  @note Requires CHIMERA_ALLOCATOR_TRACKING_BLOCKS > 0
+   *
+   *  @param[in]  visitor   Function to invoke per outstanding block
+   *  @return size_t        Number of blocks visited
+   */
+  size_t visitLiveBlocks( LeakVisitor visitor );
+
+  /**
+   *  Logs the heap statistics and all outstanding blocks
+   *
+   *  @return void
+   */
+  void logLeakReport();
+
+  namespace Internal
+  {
+    /**
+     *  Number of bytes the tracking layer prepends to every allocation. The
+     *  backend must be asked for this many bytes more than the user requested.
+     */
+    size_t trackingOverhead();
+
+    /**
+     *  Records a new allocation from the backend heap
+     *
+     *  @param[in]  raw       Pointer returned by the backend (may be nullptr)
+     *  @param[in]  size      Size the user requested
+     *  @param[in]  site      Return address of the caller
+     *  @return void*         Pointer to hand back to the user
+     */
+    void *onAllocate( void *const raw, const size_t size, const uintptr_t site );
+
+    /**
+     *  Records that a user pointer is being released
+     *
+     *  @param[in]  ptr       Pointer previously returned from onAllocate()
+     *  @return void*         Pointer to hand back to the backend heap
+     */
+    void *onFree( void *const ptr );
+  }  // namespace Internal
+}  // namespace Chimera::Memory
+
+#endif /* !CHIMERA_ALLOCATOR_TRACKING_HPP */
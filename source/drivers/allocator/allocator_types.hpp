@@ -0,0 +1,164 @@
+/******************************************************************************
+ *  File Name:
+ *    allocator_types.hpp
+ *
+ *  Description:
+ *    Types and configuration for the Chimera allocator
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_ALLOCATOR_TYPES_HPP
+#define CHIMERA_ALLOCATOR_TYPES_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include <etl/delegate.h>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Enables the heap tracking layer that sits between the allocation entry
+points (malloc, new, Chimera::malloc) and the backend heap. Costs one
+header per block and a handful of relaxed atomic operations per call.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_TRACKING
+#define CHIMERA_ALLOCATOR_TRACKING ( 0 )
+#endif
+
+/*-------------------------------------------------------------------
+Number of unique caller addresses that can be attributed. Set to zero
+to disable per-site statistics.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_TRACKING_SITES
+#define CHIMERA_ALLOCATOR_TRACKING_SITES ( 0 )
+#endif
+
+/*-------------------------------------------------------------------
+Number of outstanding blocks that can be recorded for leak reporting.
+Each entry costs four words. Set to zero to disable the live block
+table.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_TRACKING_BLOCKS
+#define CHIMERA_ALLOCATOR_TRACKING_BLOCKS ( 0 )
+#endif
+
+/*-------------------------------------------------------------------
+Replaces the default backend heap (pvPortMalloc or the C runtime)
+with a TLSF heap over a statically allocated region. Normally set
+through the CHIMERA_ALLOCATOR_BACKEND CMake cache variable.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_TLSF
+#define CHIMERA_ALLOCATOR_TLSF ( 0 )
+#endif
+
+/*-------------------------------------------------------------------
+Size in bytes of the static region handed to the TLSF backend
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_TLSF_HEAP_SIZE
+#define CHIMERA_ALLOCATOR_TLSF_HEAP_SIZE ( 64 * 1024 )
+#endif
+
+/*-------------------------------------------------------------------
+Enables per-thread caches of small blocks in front of the backend heap
+so that allocation heavy threads don't contend on the heap lock. Only
+meaningful on native builds, where simulation threads are real OS
+threads and operator new/delete are routed through the allocator.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_THREAD_CACHE
+#if defined( USING_NATIVE_THREADS )
+#define CHIMERA_ALLOCATOR_THREAD_CACHE ( 1 )
+#else
+#define CHIMERA_ALLOCATOR_THREAD_CACHE ( 0 )
+#endif
+#endif
+
+/*-------------------------------------------------------------------
+Maximum number of bytes a single thread may hold in its cache before
+blocks are handed back to the shared free lists.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_THREAD_CACHE_BYTES
+#define CHIMERA_ALLOCATOR_THREAD_CACHE_BYTES ( 256 * 1024 )
+#endif
+
+/*-------------------------------------------------------------------
+Number of blocks moved between a thread cache and the shared free
+lists in a single locked transfer.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_THREAD_CACHE_BATCH
+#define CHIMERA_ALLOCATOR_THREAD_CACHE_BATCH ( 32 )
+#endif
+
+/*-------------------------------------------------------------------
+Maximum number of blocks each size class may park in the shared free
+lists. Anything handed back beyond this goes to the backend heap, so
+memory freed by one burst is not stranded in a single size class.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_ALLOCATOR_THREAD_CACHE_CENTRAL_BLOCKS
+#define CHIMERA_ALLOCATOR_THREAD_CACHE_CENTRAL_BLOCKS ( 8 * CHIMERA_ALLOCATOR_THREAD_CACHE_BATCH )
+#endif
+
+namespace Chimera::Memory
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Allocation sizes are binned into power of two classes, starting at 8
+   *  bytes. The last class collects everything that didn't fit elsewhere.
+   */
+  static constexpr size_t NUM_SIZE_CLASSES     = 11;
+  static constexpr size_t SIZE_CLASS_MIN_SHIFT = 3;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Snapshot of the heap usage as seen through the tracking layer
+   */
+  struct HeapStats
+  {
+    bool   enabled;                       /**< True if tracking was compiled in */
+    size_t currentBytes;                  /**< Bytes currently allocated by users */
+    size_t peakBytes;                     /**< Largest value currentBytes has ever reached */
+    size_t currentBlocks;                 /**< Number of outstanding allocations */
+    size_t totalAllocs;                   /**< Lifetime count of successful allocations */
+    size_t totalFrees;                    /**< Lifetime count of frees */
+    size_t failedAllocs;                  /**< Allocations the backend heap rejected */
+    size_t untrackedBlocks;               /**< Live blocks that didn't fit in the leak table */
+    size_t sizeClass[ NUM_SIZE_CLASSES ]; /**< Lifetime allocation count per size class */
+  };
+
+  /**
+   *  Allocation statistics attributed to a single call site
+   */
+  struct SiteStats
+  {
+    uintptr_t site;         /**< Return address of the allocating call */
+    size_t    totalAllocs;  /**< Lifetime allocation count from this site */
+    size_t    currentBytes; /**< Bytes still outstanding from this site */
+  };
+
+  /**
+   *  Description of a block that has not yet been freed
+   */
+  struct LeakRecord
+  {
+    const void *ptr;  /**< User pointer returned by the allocator */
+    size_t      size; /**< Requested size in bytes */
+    uintptr_t   site; /**< Return address of the allocating call, if recorded */
+  };
+
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  using LeakVisitor = etl::delegate<void( const LeakRecord & )>;
+
+}  // namespace Chimera::Memory
+
+#endif /* !CHIMERA_ALLOCATOR_TYPES_HPP */
@@ -0,0 +1,184 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_cache.cpp
+ *
+ *  Description:
+ *    Thread cache scaling run. Every thread churns small blocks through its
+ *    own slot table while the thread count doubles, through Chimera::malloc(),
+ *    through operator new and through the C runtime heap. Aggregate throughput
+ *    should grow with the thread count rather than flatten on a lock.
+ *
+ *    Usage: chimera_allocator_cache_bench [operations per thread] [max threads]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+/* Chimera Includes */
+#include <Chimera/allocator>
+#include <Chimera/source/drivers/allocator/allocator_cache.hpp>
+
+namespace
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t SLOTS    = 256;
+  static constexpr size_t MAX_SIZE = 512;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct Heap
+  {
+    const char *name;
+    void *( *alloc )( size_t );
+    void ( *release )( void * );
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static void *chimeraAlloc( size_t size )
+  {
+    return Chimera::malloc( size );
+  }
+
+
+  static void chimeraFree( void *ptr )
+  {
+    Chimera::free( ptr );
+  }
+
+
+  static void *newAlloc( size_t size )
+  {
+    return ::operator new( size );
+  }
+
+
+  static void newFree( void *ptr )
+  {
+    ::operator delete( ptr );
+  }
+
+
+  static void *crtAlloc( size_t size )
+  {
+    return std::malloc( size );
+  }
+
+
+  static void crtFree( void *ptr )
+  {
+    std::free( ptr );
+  }
+
+
+  /**
+   *  Randomly fills and empties a private slot table. Each slot is touched
+   *  so the allocator can't get away with handing out the same block.
+   */
+  static void churn( const Heap &heap, const size_t operations, const uint32_t seed )
+  {
+    std::mt19937 rng( seed );
+    void        *slots[ SLOTS ] = {};
+
+    for ( size_t x = 0; x < operations; x++ )
+    {
+      const size_t idx = rng() % SLOTS;
+      if ( slots[ idx ] )
+      {
+        heap.release( slots[ idx ] );
+        slots[ idx ] = nullptr;
+      }
+      else
+      {
+        const size_t size = ( rng() % MAX_SIZE ) + 1;
+        slots[ idx ]      = heap.alloc( size );
+        memset( slots[ idx ], 0xA5, size );
+      }
+    }
+
+    for ( void *ptr : slots )
+    {
+      if ( ptr )
+      {
+        heap.release( ptr );
+      }
+    }
+  }
+
+
+  /**
+   *  Runs one heap at each power of two thread count, reporting scaling
+   *  against the single thread rate
+   */
+  static void run( const Heap &heap, const size_t operations, const size_t maxThreads )
+  {
+    double single = 0.0;
+
+    for ( size_t threads = 1; threads <= maxThreads; threads *= 2 )
+    {
+      std::vector<std::thread> pool;
+      pool.reserve( threads );
+
+      const auto start = std::chrono::steady_clock::now();
+      for ( size_t t = 0; t < threads; t++ )
+      {
+        pool.emplace_back( churn, std::cref( heap ), operations, static_cast<uint32_t>( t + 1 ) );
+      }
+
+      for ( std::thread &thread : pool )
+      {
+        thread.join();
+      }
+
+      const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      const double rate    = static_cast<double>( operations * threads ) / seconds;
+      if ( threads == 1 )
+      {
+        single = rate;
+      }
+
+      printf( "%-8s threads %2zu  %8.2f Mops/s  %6.1f ns/op/thread  scaling %5.2fx\n", heap.name, threads, rate / 1e6,
+              ( seconds * 1e9 ) / static_cast<double>( operations ), rate / single );
+    }
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t hw         = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+  const size_t operations = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 1000000;
+  const size_t maxThreads = ( argc > 2 ) ? strtoul( argv[ 2 ], nullptr, 0 ) : hw;
+
+  printf( "%zu operations per thread, up to %zu threads, sizes 1-%zu bytes\n", operations, maxThreads, MAX_SIZE );
+
+  const Heap chimera = { "chimera", chimeraAlloc, chimeraFree };
+  const Heap global  = { "new", newAlloc, newFree };
+  const Heap crt     = { "crt", crtAlloc, crtFree };
+
+  run( chimera, operations, maxThreads );
+  run( global, operations, maxThreads );
+  run( crt, operations, maxThreads );
+
+  Chimera::Memory::ThreadCacheStats stats;
+  Chimera::Memory::getThreadCacheStats( stats );
+  printf( "shared free lists hold %zu bytes before release\n", stats.centralBytes );
+
+  Chimera::Memory::releaseCachedMemory();
+  Chimera::Memory::getThreadCacheStats( stats );
+  printf( "shared free lists hold %zu bytes after release\n", stats.centralBytes );
+  return 0;
+}
@@ -0,0 +1,226 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_tlsf.cpp
+ *
+ *  Description:
+ *    Randomized TLSF stress run. Times every malloc() and free() against the
+ *    C runtime heap doing the same work, and checks heap consistency along
+ *    the way. The tail of the timing distribution is the figure of merit.
+ *
+ *    Usage: chimera_allocator_tlsf_bench [operations] [seed]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/* Chimera Includes */
+#include <Chimera/allocator>
+
+namespace
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t HEAP_SIZE    = 4 * 1024 * 1024;
+  static constexpr size_t MAX_LIVE     = 2048;
+  static constexpr size_t CHECK_PERIOD = 10000;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct Block
+  {
+    uint8_t *ptr;
+    size_t   size;
+  };
+
+  struct Heap
+  {
+    const char *name;
+    void *( *alloc )( size_t );
+    void ( *release )( void * );
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  alignas( 16 ) static uint8_t s_region[ HEAP_SIZE ];
+  static Chimera::Memory::TLSF s_tlsf;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static void *tlsfAlloc( size_t size )
+  {
+    return s_tlsf.malloc( size );
+  }
+
+
+  static void tlsfFree( void *ptr )
+  {
+    s_tlsf.free( ptr );
+  }
+
+
+  static void *crtAlloc( size_t size )
+  {
+    return std::malloc( size );
+  }
+
+
+  static void crtFree( void *ptr )
+  {
+    std::free( ptr );
+  }
+
+
+  static uint64_t nanos()
+  {
+    return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now().time_since_epoch() )
+                                      .count() );
+  }
+
+
+  /**
+   *  Mostly small requests with a long tail of large ones, which is what
+   *  fragments a heap
+   */
+  static size_t requestSize( std::mt19937 &rng )
+  {
+    return ( ( rng() % 8 ) == 0 ) ? ( ( rng() % 8192 ) + 1 ) : ( ( rng() % 256 ) + 1 );
+  }
+
+
+  static void report( const char *name, const char *op, std::vector<uint32_t> &samples )
+  {
+    if ( samples.empty() )
+    {
+      return;
+    }
+
+    std::sort( samples.begin(), samples.end() );
+    const size_t last = samples.size() - 1;
+
+    uint64_t sum = 0;
+    for ( const uint32_t sample : samples )
+    {
+      sum += sample;
+    }
+
+    printf( "%-6s %-6s n %8zu  mean %6.1f  p50 %6u  p99 %6u  p99.9 %6u  max %8u ns\n", name, op, samples.size(),
+            static_cast<double>( sum ) / static_cast<double>( samples.size() ), samples[ last / 2 ],
+            samples[ ( last * 99 ) / 100 ], samples[ ( last * 999 ) / 1000 ], samples[ last ] );
+  }
+
+
+  /**
+   *  Runs the same operation sequence against one heap
+   *
+   *  @return bool            False if the heap returned corrupt memory or failed check()
+   */
+  static bool run( const Heap &heap, const size_t operations, const uint32_t seed, const bool isTLSF )
+  {
+    std::mt19937          rng( seed );
+    std::vector<Block>    live;
+    std::vector<uint32_t> allocTimes;
+    std::vector<uint32_t> freeTimes;
+    size_t                failed = 0;
+
+    live.reserve( MAX_LIVE );
+    allocTimes.reserve( operations );
+    freeTimes.reserve( operations );
+
+    for ( size_t x = 0; x < operations; x++ )
+    {
+      if ( live.empty() || ( ( live.size() < MAX_LIVE ) && ( rng() % 3 ) ) )
+      {
+        const size_t size  = requestSize( rng );
+        const uint64_t start = nanos();
+        uint8_t *const ptr   = static_cast<uint8_t *>( heap.alloc( size ) );
+        allocTimes.push_back( static_cast<uint32_t>( nanos() - start ) );
+
+        if ( !ptr )
+        {
+          failed++;
+          continue;
+        }
+
+        memset( ptr, static_cast<int>( x & 0xFF ), size );
+        live.push_back( { ptr, size } );
+      }
+      else
+      {
+        const size_t idx   = rng() % live.size();
+        const Block  block = live[ idx ];
+
+        if ( ( block.ptr[ 0 ] != block.ptr[ block.size - 1 ] ) )
+        {
+          printf( "%s: block %p was overwritten\n", heap.name, static_cast<void *>( block.ptr ) );
+          return false;
+        }
+
+        const uint64_t start = nanos();
+        heap.release( block.ptr );
+        freeTimes.push_back( static_cast<uint32_t>( nanos() - start ) );
+
+        live[ idx ] = live.back();
+        live.pop_back();
+      }
+
+      if ( isTLSF && ( ( x % CHECK_PERIOD ) == 0 ) && !s_tlsf.check() )
+      {
+        printf( "%s: check() failed after %zu operations\n", heap.name, x );
+        return false;
+      }
+    }
+
+    if ( isTLSF )
+    {
+      Chimera::Memory::TLSF::Stats stats;
+      s_tlsf.getStats( stats );
+      printf( "%-6s peak %zu of %zu bytes, %zu failed allocations, fragmentation %.3f\n", heap.name,
+              stats.peakUsedBytes, stats.totalBytes, failed, static_cast<double>( stats.fragmentation ) );
+    }
+
+    for ( const Block &block : live )
+    {
+      heap.release( block.ptr );
+    }
+
+    report( heap.name, "malloc", allocTimes );
+    report( heap.name, "free", freeTimes );
+    return !isTLSF || s_tlsf.check();
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t   operations = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 2000000;
+  const uint32_t seed       = ( argc > 2 ) ? static_cast<uint32_t>( strtoul( argv[ 2 ], nullptr, 0 ) ) : 1;
+
+  if ( !s_tlsf.init( s_region, sizeof( s_region ) ) )
+  {
+    printf( "TLSF init failed\n" );
+    return 1;
+  }
+
+  printf( "%zu operations, seed %u, %zu byte TLSF pool\n", operations, seed, HEAP_SIZE );
+
+  const Heap tlsf = { "tlsf", tlsfAlloc, tlsfFree };
+  const Heap crt  = { "crt", crtAlloc, crtFree };
+
+  const bool ok = run( tlsf, operations, seed, true );
+  run( crt, operations, seed, false );
+
+  return ok ? 0 : 1;
+}
@@ -5,76 +5,309 @@
  *  Description:
  *	  Provides overloads for common memory allocators and deleters
  *
- *  2019-2020 | Brandon Braun | brandonbraun653@gmail.com
+ *  2019-2023 | Brandon Braun | brandonbraun653@gmail.com
  *****************************************************************************/
 
 /* STL Includes */
+#include <cstdint>
 #include <cstdlib>
+#include <new>
 
 /* Chimera Includes */
 #include <Chimera/source/drivers/allocator/allocator.hpp>
+#include <Chimera/source/drivers/allocator/allocator_cache.hpp>
+#include <Chimera/source/drivers/allocator/allocator_tlsf.hpp>
+#include <Chimera/source/drivers/allocator/allocator_tracking.hpp>
 #include <Chimera/thread>
 
 #if defined( USING_FREERTOS_THREADS )
 /* FreeRTOS Includes */
 #include <FreeRTOS/FreeRTOS.h>
 #include <FreeRTOS/portable.h>
+#include <FreeRTOS/task.h>
+#elif ( CHIMERA_ALLOCATOR_TLSF == 1 )
+#include <mutex>
+#endif /* USING_FREERTOS_THREADS */
+
+/*-----------------------------------------------------------------------------
+Macros
+-----------------------------------------------------------------------------*/
+#define CALLER_SITE() ( reinterpret_cast<uintptr_t>( __builtin_return_address( 0 ) ) )
+
+#if ( CHIMERA_ALLOCATOR_TLSF == 1 )
+/*-----------------------------------------------------------------------------
+Static Data
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+The heap object lives in raw storage and is constructed on first use.
+Allocations can happen during static initialization of other
+translation units, before a normal global would be constructed.
+-------------------------------------------------------------------*/
+alignas( std::max_align_t ) static uint8_t s_tlsf_region[ CHIMERA_ALLOCATOR_TLSF_HEAP_SIZE ];
+alignas( Chimera::Memory::TLSF ) static uint8_t s_tlsf_storage[ sizeof( Chimera::Memory::TLSF ) ];
+static Chimera::Memory::TLSF *s_tlsf;
+
+#if !defined( USING_FREERTOS_THREADS )
+static std::mutex s_tlsf_lock;
+#endif /* !USING_FREERTOS_THREADS */
+#endif /* CHIMERA_ALLOCATOR_TLSF */
+
+/*-----------------------------------------------------------------------------
+Static Functions
+-----------------------------------------------------------------------------*/
+#if ( CHIMERA_ALLOCATOR_TLSF == 1 )
+/**
+ *  Serializes access to the TLSF heap. The scheduler is suspended rather
+ *  than taking a mutex so the heap stays usable before it starts.
+ */
+static inline void tlsf_lock()
+{
+#if defined( USING_FREERTOS_THREADS )
+  vTaskSuspendAll();
+#else
+  s_tlsf_lock.lock();
+#endif /* USING_FREERTOS_THREADS */
+
+  if ( !s_tlsf )
+  {
+    s_tlsf = new ( s_tlsf_storage ) Chimera::Memory::TLSF();
+    s_tlsf->init( s_tlsf_region, sizeof( s_tlsf_region ) );
+  }
+}
+
+static inline void tlsf_unlock()
+{
+#if defined( USING_FREERTOS_THREADS )
+  ( void )xTaskResumeAll();
+#else
+  s_tlsf_lock.unlock();
+#endif /* USING_FREERTOS_THREADS */
+}
+#endif /* CHIMERA_ALLOCATOR_TLSF */
+
+/**
+ *  Allocates from whichever heap backs this build
+ */
+static inline void *backend_malloc( size_t size )
+{
+#if ( CHIMERA_ALLOCATOR_TLSF == 1 )
+  tlsf_lock();
+  void *ptr = s_tlsf->malloc( size );
+  tlsf_unlock();
+  return ptr;
+#elif defined( USING_FREERTOS_THREADS )
+  return pvPortMalloc( size );
+#else
+  return std::malloc( size );
+#endif /* CHIMERA_ALLOCATOR_TLSF */
+}
+
+/**
+ *  Releases memory back to whichever heap backs this build
+ */
+static inline void backend_free( void *ptr )
+{
+#if ( CHIMERA_ALLOCATOR_TLSF == 1 )
+  tlsf_lock();
+  s_tlsf->free( ptr );
+  tlsf_unlock();
+#elif defined( USING_FREERTOS_THREADS )
+  vPortFree( ptr );
+#else
+  std::free( ptr );
+#endif /* CHIMERA_ALLOCATOR_TLSF */
+}
+
+/**
+ *  Allocates through the thread cache when enabled, else the backend heap
+ */
+static inline void *heap_malloc( size_t size )
+{
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+  return Chimera::Memory::Internal::cacheAllocate( size );
+#else
+  return backend_malloc( size );
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+}
+
+/**
+ *  Releases through the thread cache when enabled, else the backend heap
+ */
+static inline void heap_free( void *ptr )
+{
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+  Chimera::Memory::Internal::cacheFree( ptr );
+#else
+  backend_free( ptr );
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+}
+
+/**
+ *  Allocation entry point shared by all overloads. Routes through the
+ *  heap tracking layer, which compiles down to nothing when disabled.
+ */
+static inline void *tracked_malloc( size_t size, uintptr_t site )
+{
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+  const size_t overhead = Chimera::Memory::Internal::trackingOverhead();
+  void        *raw      = ( size <= ( SIZE_MAX - overhead ) ) ? heap_malloc( size + overhead ) : nullptr;
+  return Chimera::Memory::Internal::onAllocate( raw, size, site );
+#else
+  ( void )site;
+  return heap_malloc( size );
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+}
+
+/**
+ *  Release entry point shared by all overloads
+ */
+static inline void tracked_free( void *ptr )
+{
+  if ( !ptr )
+  {
+    return;
+  }
+
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+  heap_free( Chimera::Memory::Internal::onFree( ptr ) );
+#else
+  heap_free( ptr );
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+}
+
 
+#if defined( USING_FREERTOS_THREADS )
 #if !defined( SIM )
 void *malloc( size_t size )
 {
-  return pvPortMalloc( size );
+  return tracked_malloc( size, CALLER_SITE() );
 }
 
 void free( void *ptr )
 {
-  vPortFree( ptr );
+  tracked_free( ptr );
 }
 #endif /* !SIM */
+#endif /* USING_FREERTOS_THREADS */
 
 /*------------------------------------------------
 Only overload these operators if we aren't using the MSVC runtime.
 I was unsuccessful in figuring out a thread safe way to mix and match
 FreeRTOS threads and std::threads without corrupting memory.
+
+Native builds take the same overloads so that new/delete go through
+the thread cache and tracking layer rather than straight to the C
+runtime. The nothrow forms fall back to these by default.
 ------------------------------------------------*/
-#if !defined( WIN32 ) && !defined( WIN64 )
+#if ( defined( USING_FREERTOS_THREADS ) || defined( USING_NATIVE_THREADS ) ) && !defined( WIN32 ) && !defined( WIN64 )
+/**
+ *  Allocation path of the throwing operator new. Failure calls the installed
+ *  new_handler until it gives up, then throws std::bad_alloc. Builds without
+ *  exceptions get nullptr instead, as before.
+ */
+static inline void *new_malloc( size_t size, uintptr_t site )
+{
+  while ( true )
+  {
+    /*-------------------------------------------------------------------------
+    A zero byte request must still return a unique pointer
+    -------------------------------------------------------------------------*/
+    void *ptr = tracked_malloc( size ? size : 1, site );
+    if ( ptr )
+    {
+      return ptr;
+    }
+
+    std::new_handler handler = std::get_new_handler();
+    if ( !handler )
+    {
+#if defined( __cpp_exceptions )
+      throw std::bad_alloc();
+#else
+      return nullptr;
+#endif
+    }
+
+    handler();
+  }
+}
+
 void *operator new( size_t size )
 {
-  return pvPortMalloc( size );
+  return new_malloc( size, CALLER_SITE() );
 }
 
 void *operator new[]( size_t size )
 {
-  return pvPortMalloc( size );
+  return new_malloc( size, CALLER_SITE() );
 }
 
 void operator delete( void *p ) noexcept
 {
-  vPortFree( p );
+  tracked_free( p );
 }
-#endif /* !WIN32 && !WIN64 */
 
-#endif /* CHIMERA_CFG_FREERTOS */
+void operator delete[]( void *p ) noexcept
+{
+  tracked_free( p );
+}
+
+void operator delete( void *p, size_t size ) noexcept
+{
+  ( void )size;
+  tracked_free( p );
+}
+
+void operator delete[]( void *p, size_t size ) noexcept
+{
+  ( void )size;
+  tracked_free( p );
+}
+#endif /* ( USING_FREERTOS_THREADS || USING_NATIVE_THREADS ) && !WIN32 && !WIN64 */
 
 
 namespace Chimera
 {
   void *malloc( size_t size )
   {
-#if defined( USING_FREERTOS_THREADS )
-    return pvPortMalloc( size );
-#else
-    return malloc( size );
-#endif /* USING_FREERTOS_THREADS */
+    return tracked_malloc( size, CALLER_SITE() );
   }
 
 
   void free( void *ptr )
   {
-#if defined( USING_FREERTOS_THREADS )
-    vPortFree( ptr );
-#else
-    free( ptr );
-#endif /* USING_FREERTOS_THREADS */
+    tracked_free( ptr );
   }
-}  // namespace Chimera
\ No newline at end of file
+
+
+  namespace Memory
+  {
+    namespace Internal
+    {
+      void *backendMalloc( const size_t size )
+      {
+        return backend_malloc( size );
+      }
+
+
+      void backendFree( void *const ptr )
+      {
+        backend_free( ptr );
+      }
+    }  // namespace Internal
+
+
+    bool getSystemHeapStats( TLSF::Stats &stats )
+    {
+#if ( CHIMERA_ALLOCATOR_TLSF == 1 )
+      tlsf_lock();
+      s_tlsf->getStats( stats );
+      tlsf_unlock();
+      return true;
+#else
+      ( void )stats;
+      return false;
+#endif /* CHIMERA_ALLOCATOR_TLSF */
+    }
+  }  // namespace Memory
+}  // namespace Chimera
@@ -0,0 +1,265 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_allocator_arena.cpp
+ *
+ *  Description:
+ *    Monotonic arena allocator implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Chimera/source/drivers/allocator/allocator.hpp>
+#include <Chimera/source/drivers/allocator/allocator_arena.hpp>
+#include <algorithm>
+#include <cstdint>
+
+namespace Chimera::Memory
+{
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Computes the padding needed to align an address
+   */
+  static inline size_t alignPadding( const uintptr_t address, const size_t alignment )
+  {
+    return ( alignment - ( address & ( alignment - 1 ) ) ) & ( alignment - 1 );
+  }
+
+
+  /**
+   *  Checks that size bytes after padding fit in what's left, without letting
+   *  the sum wrap for huge requests
+   */
+  static inline bool fits( const size_t remaining, const size_t padding, const size_t size )
+  {
+    return ( size <= remaining ) && ( padding <= ( remaining - size ) );
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Arena Implementation
+  ---------------------------------------------------------------------------*/
+  Arena::Arena() :
+      mBuffer( nullptr ), mSize( 0 ), mPrimaryUsed( 0 ), mChunk( nullptr ), mChunkUsed( 0 ), mOverflowBytes( 0 ),
+      mHighWater( 0 ), mAllowOverflow( false )
+  {
+  }
+
+
+  Arena::Arena( void *const buffer, const size_t size, const bool allowOverflow ) : Arena()
+  {
+    assign( buffer, size, allowOverflow );
+  }
+
+
+  Arena::~Arena()
+  {
+    releaseChunksUntil( nullptr );
+  }
+
+
+  void Arena::assign( void *const buffer, const size_t size, const bool allowOverflow )
+  {
+    releaseChunksUntil( nullptr );
+
+    mBuffer        = static_cast<uint8_t *>( buffer );
+    mSize          = buffer ? size : 0;
+    mPrimaryUsed   = 0;
+    mChunkUsed     = 0;
+    mHighWater     = 0;
+    mAllowOverflow = allowOverflow;
+  }
+
+
+  void *Arena::allocate( const size_t size, const size_t alignment )
+  {
+    /*-------------------------------------------------------------------------
+    Input protection. Alignment must be a power of two.
+    -------------------------------------------------------------------------*/
+    if ( !size || !alignment || ( alignment & ( alignment - 1 ) ) )
+    {
+      return nullptr;
+    }
+
+    /*-------------------------------------------------------------------------
+    Once overflow has begun, all further allocations come from the chunks
+    -------------------------------------------------------------------------*/
+    if ( mChunk )
+    {
+      return allocateFromChunk( size, alignment );
+    }
+
+    /*-------------------------------------------------------------------------
+    Bump allocate from the primary buffer
+    -------------------------------------------------------------------------*/
+    const uintptr_t cursor  = reinterpret_cast<uintptr_t>( mBuffer ) + mPrimaryUsed;
+    const size_t    padding = alignPadding( cursor, alignment );
+
+    if ( mBuffer && fits( mSize - mPrimaryUsed, padding, size ) )
+    {
+      mPrimaryUsed += padding + size;
+      updateHighWater();
+      return reinterpret_cast<void *>( cursor + padding );
+    }
+
+    return allocateFromChunk( size, alignment );
+  }
+
+
+  void Arena::reset()
+  {
+    rewind( Marker{ nullptr, 0 } );
+  }
+
+
+  Arena::Marker Arena::mark() const
+  {
+    if ( mChunk )
+    {
+      return Marker{ mChunk, mChunkUsed };
+    }
+    else
+    {
+      return Marker{ nullptr, mPrimaryUsed };
+    }
+  }
+
+
+  void Arena::rewind( const Marker &marker )
+  {
+    Chunk *const target = static_cast<Chunk *>( marker.chunk );
+    releaseChunksUntil( target );
+
+    if ( target )
+    {
+      mChunkUsed = std::min( marker.offset, target->size );
+    }
+    else
+    {
+      mChunkUsed   = 0;
+      mPrimaryUsed = std::min( marker.offset, mSize );
+    }
+  }
+
+
+  bool Arena::owns( const void *const ptr ) const
+  {
+    const uint8_t *p = static_cast<const uint8_t *>( ptr );
+
+    if ( mBuffer && ( p >= mBuffer ) && ( p < ( mBuffer + mSize ) ) )
+    {
+      return true;
+    }
+
+    for ( const Chunk *chunk = mChunk; chunk; chunk = chunk->next )
+    {
+      const uint8_t *data = reinterpret_cast<const uint8_t *>( chunk + 1 );
+      if ( ( p >= data ) && ( p < ( data + chunk->size ) ) )
+      {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+
+  size_t Arena::capacity() const
+  {
+    return mSize;
+  }
+
+
+  size_t Arena::used() const
+  {
+    return mPrimaryUsed;
+  }
+
+
+  size_t Arena::overflowBytes() const
+  {
+    return mOverflowBytes;
+  }
+
+
+  size_t Arena::highWaterMark() const
+  {
+    return mHighWater;
+  }
+
+
+  void *Arena::allocateFromChunk( const size_t size, const size_t alignment )
+  {
+    /*-------------------------------------------------------------------------
+    Try the active chunk first
+    -------------------------------------------------------------------------*/
+    if ( mChunk )
+    {
+      const uintptr_t cursor  = reinterpret_cast<uintptr_t>( mChunk + 1 ) + mChunkUsed;
+      const size_t    padding = alignPadding( cursor, alignment );
+
+      if ( fits( mChunk->size - mChunkUsed, padding, size ) )
+      {
+        mChunkUsed += padding + size;
+        return reinterpret_cast<void *>( cursor + padding );
+      }
+    }
+
+    if ( !mAllowOverflow )
+    {
+      return nullptr;
+    }
+
+    /*-------------------------------------------------------------------------
+    Chain a new chunk large enough for the request in the worst alignment case
+    -------------------------------------------------------------------------*/
+    if ( size > ( SIZE_MAX - alignment - sizeof( Chunk ) ) )
+    {
+      return nullptr;
+    }
+
+    const size_t dataSize = std::max<size_t>( CHIMERA_ARENA_OVERFLOW_CHUNK_SIZE, size + alignment );
+    Chunk       *chunk    = static_cast<Chunk *>( Chimera::malloc( sizeof( Chunk ) + dataSize ) );
+    if ( !chunk )
+    {
+      return nullptr;
+    }
+
+    chunk->next = mChunk;
+    chunk->size = dataSize;
+    mChunk      = chunk;
+    mChunkUsed  = 0;
+    mOverflowBytes += dataSize;
+    updateHighWater();
+
+    const uintptr_t cursor  = reinterpret_cast<uintptr_t>( mChunk + 1 );
+    const size_t    padding = alignPadding( cursor, alignment );
+
+    mChunkUsed = padding + size;
+    return reinterpret_cast<void *>( cursor + padding );
+  }
+
+
+  void Arena::releaseChunksUntil( const Chunk *const stop )
+  {
+    while ( mChunk && ( mChunk != stop ) )
+    {
+      Chunk *next = mChunk->next;
+      mOverflowBytes -= mChunk->size;
+
+      Chimera::free( mChunk );
+      mChunk = next;
+    }
+  }
+
+
+  void Arena::updateHighWater()
+  {
+    mHighWater = std::max( mHighWater, mPrimaryUsed + mOverflowBytes );
+  }
+
+}  // namespace Chimera::Memory
@@ -0,0 +1,457 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_allocator_cache.cpp
+ *
+ *  Description:
+ *    Thread caching front end for the allocator. Small blocks are binned into
+ *    power of two size classes and recycled through a per-thread free list,
+ *    only touching the shared lists (and their locks) in batches.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Chimera/source/drivers/allocator/allocator_cache.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+#include <atomic>
+#include <mutex>
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+
+namespace Chimera::Memory
+{
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t HEADER_SIZE     = alignof( std::max_align_t );
+  static constexpr size_t MIN_CLASS_SHIFT = 4;
+  static constexpr size_t NUM_CLASSES     = 8; /* 16B to 2kB */
+  static constexpr size_t LARGE_CLASS     = NUM_CLASSES;
+  static constexpr size_t BATCH           = CHIMERA_ALLOCATOR_THREAD_CACHE_BATCH;
+  static constexpr size_t MAX_CACHED      = 2 * BATCH;
+  static constexpr size_t CENTRAL_MAX     = CHIMERA_ALLOCATOR_THREAD_CACHE_CENTRAL_BLOCKS;
+
+  static_assert( BATCH > 0, "Thread cache batch size must be non-zero" );
+  static_assert( CENTRAL_MAX >= BATCH, "Shared free lists must hold at least one batch" );
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Cached blocks are chained through the first word of their payload
+   */
+  struct FreeNode
+  {
+    FreeNode *next;
+  };
+
+  struct ThreadBin
+  {
+    FreeNode *head;
+    size_t    count;
+  };
+
+  /**
+   *  Per-thread state. Kept trivial so that it is zero initialized and stays
+   *  valid for the whole life of the thread, even while other thread_local
+   *  objects are being destroyed and may still free memory.
+   */
+  struct ThreadCache
+  {
+    ThreadBin bins[ NUM_CLASSES ];
+    size_t    bytes;
+    size_t    hits;
+    size_t    misses;
+    bool      registered;
+    bool      retired;
+  };
+
+  struct CentralBin
+  {
+    std::mutex lock;
+    FreeNode  *head;
+    size_t     count;
+  };
+
+  /**
+   *  Flushes the owning thread's cache when the thread exits
+   */
+  struct ThreadCacheReaper
+  {
+    ~ThreadCacheReaper();
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static CentralBin                     s_central[ NUM_CLASSES ];
+  static std::atomic<size_t>            s_central_bytes;
+  static thread_local ThreadCache       t_cache;
+  static thread_local ThreadCacheReaper t_reaper;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static inline size_t classSize( const size_t cls )
+  {
+    return static_cast<size_t>( 1 ) << ( cls + MIN_CLASS_SHIFT );
+  }
+
+  /**
+   *  Maps a request onto the smallest class that can hold it
+   */
+  static inline size_t sizeToClass( const size_t size )
+  {
+    if ( size <= classSize( 0 ) )
+    {
+      return 0;
+    }
+
+    const size_t bits = ( sizeof( unsigned long long ) * 8u ) - __builtin_clzll( size - 1 );
+    const size_t cls  = bits - MIN_CLASS_SHIFT;
+    return ( cls < NUM_CLASSES ) ? cls : LARGE_CLASS;
+  }
+
+  static inline size_t &classOf( void *const payload )
+  {
+    return *reinterpret_cast<size_t *>( static_cast<uint8_t *>( payload ) - HEADER_SIZE );
+  }
+
+  static inline void *toRaw( void *const payload )
+  {
+    return static_cast<uint8_t *>( payload ) - HEADER_SIZE;
+  }
+
+  /**
+   *  Gets a fresh block for a class straight from the backend heap
+   */
+  static void *allocateNew( const size_t cls, const size_t size )
+  {
+    const size_t bytes = ( cls == LARGE_CLASS ) ? size : classSize( cls );
+    if ( bytes > ( SIZE_MAX - HEADER_SIZE ) )
+    {
+      return nullptr;
+    }
+
+    uint8_t *raw = static_cast<uint8_t *>( Internal::backendMalloc( bytes + HEADER_SIZE ) );
+    if ( !raw )
+    {
+      return nullptr;
+    }
+
+    void *payload      = raw + HEADER_SIZE;
+    classOf( payload ) = cls;
+    return payload;
+  }
+
+  /**
+   *  Detaches whatever a shared list holds beyond CENTRAL_MAX. The surplus is
+   *  taken from the head, where the newest blocks were just spliced in. The
+   *  caller holds the list lock and frees the chain after dropping it.
+   *
+   *  @param[in]  central     Shared list to trim
+   *  @param[out] trimmed     Number of blocks detached
+   *  @return FreeNode*       Detached chain, or nullptr
+   */
+  static FreeNode *trimCentral( CentralBin &central, size_t &trimmed )
+  {
+    trimmed = 0;
+    if ( central.count <= CENTRAL_MAX )
+    {
+      return nullptr;
+    }
+
+    trimmed         = central.count - CENTRAL_MAX;
+    FreeNode *first = central.head;
+    FreeNode *last  = first;
+    for ( size_t i = 1; i < trimmed; i++ )
+    {
+      last = last->next;
+    }
+
+    central.head  = last->next;
+    central.count = CENTRAL_MAX;
+    last->next    = nullptr;
+    return first;
+  }
+
+  /**
+   *  Returns a detached chain of blocks to the backend heap
+   */
+  static void releaseToBackend( FreeNode *node )
+  {
+    while ( node )
+    {
+      FreeNode *next = node->next;
+      Internal::backendFree( toRaw( node ) );
+      node = next;
+    }
+  }
+
+  /**
+   *  Moves up to a batch of blocks from the shared list into a thread bin
+   */
+  static void fillFromCentral( ThreadCache &cache, const size_t cls )
+  {
+    CentralBin &central = s_central[ cls ];
+    ThreadBin  &bin     = cache.bins[ cls ];
+
+    std::lock_guard<std::mutex> guard( central.lock );
+
+    size_t moved = 0;
+    while ( central.head && ( moved < BATCH ) )
+    {
+      FreeNode *node = central.head;
+      central.head   = node->next;
+      node->next     = bin.head;
+      bin.head       = node;
+      moved++;
+    }
+
+    central.count -= moved;
+    bin.count += moved;
+    cache.bytes += moved * classSize( cls );
+    s_central_bytes.fetch_sub( moved * classSize( cls ), std::memory_order_relaxed );
+  }
+
+  /**
+   *  Moves up to count blocks from a thread bin to the shared list. The chain
+   *  is detached before taking the lock so the critical section is a splice.
+   */
+  static void releaseToCentral( ThreadCache &cache, const size_t cls, const size_t count )
+  {
+    ThreadBin &bin = cache.bins[ cls ];
+    if ( !bin.head || !count )
+    {
+      return;
+    }
+
+    FreeNode *first = bin.head;
+    FreeNode *last  = first;
+    size_t    moved = 1;
+    while ( last->next && ( moved < count ) )
+    {
+      last = last->next;
+      moved++;
+    }
+
+    bin.head = last->next;
+    bin.count -= moved;
+    cache.bytes -= moved * classSize( cls );
+
+    CentralBin &central = s_central[ cls ];
+    FreeNode   *surplus = nullptr;
+    size_t      trimmed = 0;
+    {
+      std::lock_guard<std::mutex> guard( central.lock );
+      last->next   = central.head;
+      central.head = first;
+      central.count += moved;
+      surplus = trimCentral( central, trimmed );
+    }
+
+    s_central_bytes.fetch_add( ( moved - trimmed ) * classSize( cls ), std::memory_order_relaxed );
+    releaseToBackend( surplus );
+  }
+
+  /**
+   *  Gets the calling thread's cache, or nullptr if the thread is exiting
+   */
+  static inline ThreadCache *getCache()
+  {
+    ThreadCache &cache = t_cache;
+    if ( cache.retired )
+    {
+      return nullptr;
+    }
+
+    if ( !cache.registered )
+    {
+      /*-----------------------------------------------------------------------
+      Odr-using the reaper constructs it, which registers its destructor to
+      run at thread exit.
+      -----------------------------------------------------------------------*/
+      cache.registered = true;
+      ( void )&t_reaper;
+    }
+
+    return &cache;
+  }
+
+  static void flushCache( ThreadCache &cache )
+  {
+    for ( size_t cls = 0; cls < NUM_CLASSES; cls++ )
+    {
+      releaseToCentral( cache, cls, cache.bins[ cls ].count );
+    }
+  }
+
+  ThreadCacheReaper::~ThreadCacheReaper()
+  {
+    flushCache( t_cache );
+    t_cache.retired = true;
+  }
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  void getThreadCacheStats( ThreadCacheStats &stats )
+  {
+    memset( &stats, 0, sizeof( stats ) );
+
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+    stats.hits         = t_cache.hits;
+    stats.misses       = t_cache.misses;
+    stats.cachedBytes  = t_cache.bytes;
+    stats.centralBytes = s_central_bytes.load( std::memory_order_relaxed );
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+  }
+
+
+  void flushThreadCache()
+  {
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+    flushCache( t_cache );
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+  }
+
+
+  void releaseCachedMemory()
+  {
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+    for ( size_t cls = 0; cls < NUM_CLASSES; cls++ )
+    {
+      CentralBin &central = s_central[ cls ];
+
+      /*-----------------------------------------------------------------------
+      Detach the whole list, then free it outside the lock
+      -----------------------------------------------------------------------*/
+      FreeNode *node = nullptr;
+      {
+        std::lock_guard<std::mutex> guard( central.lock );
+        node          = central.head;
+        central.head  = nullptr;
+        s_central_bytes.fetch_sub( central.count * classSize( cls ), std::memory_order_relaxed );
+        central.count = 0;
+      }
+
+      releaseToBackend( node );
+    }
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+  }
+
+
+  namespace Internal
+  {
+    void *cacheAllocate( const size_t size )
+    {
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+      const size_t cls = sizeToClass( size );
+      if ( cls == LARGE_CLASS )
+      {
+        return allocateNew( cls, size );
+      }
+
+      ThreadCache *cache = getCache();
+      if ( !cache )
+      {
+        return allocateNew( cls, size );
+      }
+
+      /*-----------------------------------------------------------------------
+      Refill the bin from the shared list on a miss. Only if that is also
+      empty does the request reach the backend heap.
+      -----------------------------------------------------------------------*/
+      ThreadBin &bin = cache->bins[ cls ];
+      if ( !bin.head )
+      {
+        cache->misses++;
+        fillFromCentral( *cache, cls );
+
+        if ( !bin.head )
+        {
+          return allocateNew( cls, size );
+        }
+      }
+      else
+      {
+        cache->hits++;
+      }
+
+      FreeNode *node = bin.head;
+      bin.head       = node->next;
+      bin.count--;
+      cache->bytes -= classSize( cls );
+
+      classOf( node ) = cls;
+      return node;
+#else
+      return backendMalloc( size );
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+    }
+
+
+    void cacheFree( void *const ptr )
+    {
+      if ( !ptr )
+      {
+        return;
+      }
+
+#if ( CHIMERA_ALLOCATOR_THREAD_CACHE == 1 )
+      const size_t cls = classOf( ptr );
+      if ( cls >= LARGE_CLASS )
+      {
+        backendFree( toRaw( ptr ) );
+        return;
+      }
+
+      FreeNode    *node  = static_cast<FreeNode *>( ptr );
+      ThreadCache *cache = getCache();
+      if ( !cache )
+      {
+        /*---------------------------------------------------------------------
+        Thread is exiting; park the block in the shared list directly
+        ---------------------------------------------------------------------*/
+        CentralBin &central = s_central[ cls ];
+        FreeNode   *surplus = nullptr;
+        size_t      trimmed = 0;
+        {
+          std::lock_guard<std::mutex> guard( central.lock );
+          node->next   = central.head;
+          central.head = node;
+          central.count++;
+          surplus = trimCentral( central, trimmed );
+        }
+
+        s_central_bytes.fetch_add( ( 1 - trimmed ) * classSize( cls ), std::memory_order_relaxed );
+        releaseToBackend( surplus );
+        return;
+      }
+
+      ThreadBin &bin = cache->bins[ cls ];
+      node->next     = bin.head;
+      bin.head       = node;
+      bin.count++;
+      cache->bytes += classSize( cls );
+
+      /*-----------------------------------------------------------------------
+      Hand a batch back when this bin or the cache as a whole is too large
+      -----------------------------------------------------------------------*/
+      if ( ( bin.count > MAX_CACHED ) || ( cache->bytes > CHIMERA_ALLOCATOR_THREAD_CACHE_BYTES ) )
+      {
+        releaseToCentral( *cache, cls, BATCH );
+      }
+#else
+      backendFree( ptr );
+#endif /* CHIMERA_ALLOCATOR_THREAD_CACHE */
+    }
+  }  // namespace Internal
+}  // namespace Chimera::Memory
@@ -0,0 +1,588 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_allocator_tlsf.cpp
+ *
+ *  Description:
+ *    Two-Level Segregated Fit allocator implementation. Based on the design
+ *    from "TLSF: a New Dynamic Memory Allocator for Real-Time Systems" by
+ *    Masmano, Ripoll, Crespo and Real.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Chimera/source/drivers/allocator/allocator_tlsf.hpp>
+#include <cstring>
+
+namespace Chimera::Memory
+{
+  /*---------------------------------------------------------------------------
+  Block Layout
+  ---------------------------------------------------------------------------*/
+  /*-------------------------------------------------------------------
+  Every block is laid out as:
+
+    [ prevPhys ][ size + flags (padded to ALIGN) ][ payload ... ]
+
+  The prevPhys pointer overlaps the tail of the previous block's payload
+  and is only valid while that block is free. Free blocks store their
+  free list links at the start of their payload. This leaves ALIGN_SIZE
+  bytes of overhead on every allocated block.
+  -------------------------------------------------------------------*/
+  static constexpr size_t PTR_SIZE       = sizeof( uint8_t * );
+  static constexpr size_t HDR_SIZE       = TLSF::ALIGN_SIZE;
+  static constexpr size_t PAYLOAD_OFFSET = PTR_SIZE + HDR_SIZE;
+  static constexpr size_t BLOCK_MIN      = ( ( 3 * PTR_SIZE ) + TLSF::ALIGN_SIZE - 1 ) & ~( TLSF::ALIGN_SIZE - 1 );
+  static constexpr size_t BLOCK_MAX      = ( static_cast<size_t>( 1 ) << TLSF::FL_INDEX_MAX ) - TLSF::ALIGN_SIZE;
+
+  static constexpr size_t FLAG_FREE      = ( 1u << 0 );
+  static constexpr size_t FLAG_PREV_FREE = ( 1u << 1 );
+  static constexpr size_t FLAG_MASK      = FLAG_FREE | FLAG_PREV_FREE;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static inline size_t alignUp( const size_t x )
+  {
+    return ( x + TLSF::ALIGN_SIZE - 1 ) & ~( TLSF::ALIGN_SIZE - 1 );
+  }
+
+  static inline size_t alignDown( const size_t x )
+  {
+    return x & ~( TLSF::ALIGN_SIZE - 1 );
+  }
+
+  /**
+   *  Index of the most significant set bit
+   */
+  static inline size_t fls( const size_t x )
+  {
+    return ( ( sizeof( unsigned long long ) * 8u ) - 1u ) - __builtin_clzll( static_cast<unsigned long long>( x ) );
+  }
+
+  /**
+   *  Index of the least significant set bit
+   */
+  static inline size_t ffs( const uint32_t x )
+  {
+    return static_cast<size_t>( __builtin_ctz( x ) );
+  }
+
+  static inline uint8_t *&prevPhys( uint8_t *const block )
+  {
+    return *reinterpret_cast<uint8_t **>( block );
+  }
+
+  static inline size_t &sizeField( uint8_t *const block )
+  {
+    return *reinterpret_cast<size_t *>( block + PTR_SIZE );
+  }
+
+  static inline size_t sizeField( const uint8_t *const block )
+  {
+    return *reinterpret_cast<const size_t *>( block + PTR_SIZE );
+  }
+
+  static inline size_t blockSize( const uint8_t *const block )
+  {
+    return sizeField( block ) & ~FLAG_MASK;
+  }
+
+  static inline void setBlockSize( uint8_t *const block, const size_t size )
+  {
+    sizeField( block ) = size | ( sizeField( block ) & FLAG_MASK );
+  }
+
+  static inline bool isFree( const uint8_t *const block )
+  {
+    return sizeField( block ) & FLAG_FREE;
+  }
+
+  static inline bool isPrevFree( const uint8_t *const block )
+  {
+    return sizeField( block ) & FLAG_PREV_FREE;
+  }
+
+  static inline uint8_t *toPayload( uint8_t *const block )
+  {
+    return block + PAYLOAD_OFFSET;
+  }
+
+  static inline uint8_t *fromPayload( void *const ptr )
+  {
+    return static_cast<uint8_t *>( ptr ) - PAYLOAD_OFFSET;
+  }
+
+  static inline uint8_t *nextPhys( uint8_t *const block )
+  {
+    return toPayload( block ) + blockSize( block ) - PTR_SIZE;
+  }
+
+  static inline uint8_t *&nextFree( uint8_t *const block )
+  {
+    return *reinterpret_cast<uint8_t **>( toPayload( block ) );
+  }
+
+  static inline uint8_t *&prevFree( uint8_t *const block )
+  {
+    return *reinterpret_cast<uint8_t **>( toPayload( block ) + PTR_SIZE );
+  }
+
+  /**
+   *  Computes the list a block of this size belongs in
+   */
+  static inline void mappingInsert( const size_t size, size_t &fl, size_t &sl )
+  {
+    if ( size < TLSF::SMALL_BLOCK )
+    {
+      fl = 0;
+      sl = size / ( TLSF::SMALL_BLOCK / TLSF::SL_INDEX_COUNT );
+    }
+    else
+    {
+      const size_t msb = fls( size );
+      sl               = ( size >> ( msb - TLSF::SL_INDEX_LOG2 ) ) ^ TLSF::SL_INDEX_COUNT;
+      fl               = msb - ( TLSF::FL_INDEX_SHIFT - 1 );
+    }
+  }
+
+  /**
+   *  Computes the first list whose blocks are all guaranteed to be large
+   *  enough for the request. Rounding up here is what makes the search O(1).
+   */
+  static inline void mappingSearch( size_t size, size_t &fl, size_t &sl )
+  {
+    if ( size >= TLSF::SMALL_BLOCK )
+    {
+      size += ( static_cast<size_t>( 1 ) << ( fls( size ) - TLSF::SL_INDEX_LOG2 ) ) - 1;
+    }
+
+    mappingInsert( size, fl, sl );
+  }
+
+
+  /*---------------------------------------------------------------------------
+  TLSF Implementation
+  ---------------------------------------------------------------------------*/
+  TLSF::TLSF()
+  {
+    init( nullptr, 0 );
+  }
+
+
+  bool TLSF::init( void *const region, const size_t size )
+  {
+    mFLBitmap      = 0;
+    mNumPools      = 0;
+    mTotalBytes    = 0;
+    mUsedBytes     = 0;
+    mPeakUsedBytes = 0;
+    mUsedBlocks    = 0;
+    mFreeBlocks    = 0;
+
+    memset( mSLBitmap, 0, sizeof( mSLBitmap ) );
+    memset( mBlocks, 0, sizeof( mBlocks ) );
+    memset( mPools, 0, sizeof( mPools ) );
+
+    if ( !region )
+    {
+      return false;
+    }
+
+    return addPool( region, size );
+  }
+
+
+  bool TLSF::addPool( void *const region, const size_t size )
+  {
+    if ( !region || ( mNumPools >= MAX_POOLS ) )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Place the first payload on an aligned boundary. The first block's
+    prevPhys field lands before the region, but is never touched since
+    the block is flagged as having no free predecessor.
+    -------------------------------------------------------------------------*/
+    const uintptr_t start   = reinterpret_cast<uintptr_t>( region );
+    const uintptr_t end     = start + size;
+    const uintptr_t payload = alignUp( start + HDR_SIZE );
+
+    if ( ( payload + HDR_SIZE ) >= end )
+    {
+      return false;
+    }
+
+    size_t poolSize = alignDown( end - payload - HDR_SIZE );
+    if ( poolSize > BLOCK_MAX )
+    {
+      poolSize = alignDown( BLOCK_MAX );
+    }
+
+    if ( poolSize < BLOCK_MIN )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    One big free block followed by a zero sized, allocated sentinel that
+    stops coalescing from running off the end of the pool.
+    -------------------------------------------------------------------------*/
+    uint8_t *block      = reinterpret_cast<uint8_t *>( payload - PAYLOAD_OFFSET );
+    sizeField( block )  = poolSize | FLAG_FREE;
+    insertFree( block );
+
+    uint8_t *sentinel     = nextPhys( block );
+    sizeField( sentinel ) = 0 | FLAG_PREV_FREE;
+    prevPhys( sentinel )  = block;
+
+    mPools[ mNumPools ].first = block;
+    mPools[ mNumPools ].size  = poolSize + HDR_SIZE;
+    mNumPools++;
+
+    mTotalBytes += poolSize + HDR_SIZE;
+    mFreeBlocks++;
+    return true;
+  }
+
+
+  void *TLSF::malloc( const size_t size )
+  {
+    if ( !size || ( size > BLOCK_MAX ) )
+    {
+      return nullptr;
+    }
+
+    const size_t adjusted = ( alignUp( size ) < BLOCK_MIN ) ? BLOCK_MIN : alignUp( size );
+
+    /*-------------------------------------------------------------------------
+    Locate a free block that is guaranteed to fit
+    -------------------------------------------------------------------------*/
+    size_t fl = 0;
+    size_t sl = 0;
+    mappingSearch( adjusted, fl, sl );
+
+    uint8_t *block = findSuitable( fl, sl );
+    if ( !block )
+    {
+      return nullptr;
+    }
+
+    removeFree( block );
+
+    /*-------------------------------------------------------------------------
+    Split off the tail if it's large enough to be useful on its own
+    -------------------------------------------------------------------------*/
+    const size_t available = blockSize( block );
+    if ( available >= ( adjusted + HDR_SIZE + BLOCK_MIN ) )
+    {
+      uint8_t *remain      = toPayload( block ) + adjusted - PTR_SIZE;
+      sizeField( remain )  = ( available - adjusted - HDR_SIZE ) | FLAG_FREE;
+      setBlockSize( block, adjusted );
+
+      uint8_t *next   = nextPhys( remain );
+      prevPhys( next ) = remain;
+      sizeField( next ) |= FLAG_PREV_FREE;
+
+      insertFree( remain );
+      mFreeBlocks++;
+    }
+
+    /*-------------------------------------------------------------------------
+    Mark the block as in use
+    -------------------------------------------------------------------------*/
+    sizeField( block ) &= ~FLAG_FREE;
+    sizeField( nextPhys( block ) ) &= ~FLAG_PREV_FREE;
+
+    mFreeBlocks--;
+    mUsedBlocks++;
+    mUsedBytes += blockSize( block ) + HDR_SIZE;
+    if ( mUsedBytes > mPeakUsedBytes )
+    {
+      mPeakUsedBytes = mUsedBytes;
+    }
+
+    return toPayload( block );
+  }
+
+
+  void TLSF::free( void *const ptr )
+  {
+    if ( !ptr )
+    {
+      return;
+    }
+
+    uint8_t *block = fromPayload( ptr );
+    if ( isFree( block ) )
+    {
+      return; /* Double free */
+    }
+
+    mUsedBytes -= blockSize( block ) + HDR_SIZE;
+    mUsedBlocks--;
+    mFreeBlocks++;
+    sizeField( block ) |= FLAG_FREE;
+
+    /*-------------------------------------------------------------------------
+    Coalesce with the physically previous block
+    -------------------------------------------------------------------------*/
+    if ( isPrevFree( block ) )
+    {
+      uint8_t *prev = prevPhys( block );
+      removeFree( prev );
+      setBlockSize( prev, blockSize( prev ) + blockSize( block ) + HDR_SIZE );
+
+      block = prev;
+      mFreeBlocks--;
+    }
+
+    /*-------------------------------------------------------------------------
+    Coalesce with the physically next block
+    -------------------------------------------------------------------------*/
+    uint8_t *next = nextPhys( block );
+    if ( isFree( next ) )
+    {
+      removeFree( next );
+      setBlockSize( block, blockSize( block ) + blockSize( next ) + HDR_SIZE );
+      mFreeBlocks--;
+    }
+
+    /*-------------------------------------------------------------------------
+    Let the new neighbor know it has a free predecessor
+    -------------------------------------------------------------------------*/
+    next             = nextPhys( block );
+    prevPhys( next ) = block;
+    sizeField( next ) |= FLAG_PREV_FREE;
+
+    insertFree( block );
+  }
+
+
+  size_t TLSF::usableSize( const void *const ptr ) const
+  {
+    if ( !ptr )
+    {
+      return 0;
+    }
+
+    return blockSize( fromPayload( const_cast<void *>( ptr ) ) );
+  }
+
+
+  void TLSF::getStats( Stats &stats ) const
+  {
+    stats.totalBytes    = mTotalBytes;
+    stats.usedBytes     = mUsedBytes;
+    stats.freeBytes     = mTotalBytes - mUsedBytes;
+    stats.peakUsedBytes = mPeakUsedBytes;
+    stats.usedBlocks    = mUsedBlocks;
+    stats.freeBlocks    = mFreeBlocks;
+    stats.largestFree   = 0;
+    stats.fragmentation = 0.0f;
+
+    if ( !mFLBitmap )
+    {
+      return;
+    }
+
+    /*-------------------------------------------------------------------------
+    The largest free block lives in the highest non-empty list
+    -------------------------------------------------------------------------*/
+    const size_t fl = 31u - __builtin_clz( mFLBitmap );
+    const size_t sl = 31u - __builtin_clz( mSLBitmap[ fl ] );
+
+    for ( uint8_t *block = mBlocks[ fl ][ sl ]; block; block = nextFree( block ) )
+    {
+      if ( blockSize( block ) > stats.largestFree )
+      {
+        stats.largestFree = blockSize( block );
+      }
+    }
+
+    const size_t freePayload = stats.freeBytes - ( mFreeBlocks * HDR_SIZE );
+    if ( freePayload )
+    {
+      stats.fragmentation = 1.0f - ( static_cast<float>( stats.largestFree ) / static_cast<float>( freePayload ) );
+    }
+  }
+
+
+  bool TLSF::check() const
+  {
+    size_t usedBytes  = 0;
+    size_t usedBlocks = 0;
+    size_t freeBlocks = 0;
+
+    /*-------------------------------------------------------------------------
+    Walk the physical block chain of each pool
+    -------------------------------------------------------------------------*/
+    for ( size_t p = 0; p < mNumPools; p++ )
+    {
+      uint8_t *block    = mPools[ p ].first;
+      bool     prevFree = false;
+
+      while ( blockSize( block ) )
+      {
+        if ( ( isPrevFree( block ) != prevFree ) || ( prevFree && isFree( block ) ) )
+        {
+          return false; /* Flag mismatch or uncoalesced neighbors */
+        }
+
+        if ( ( reinterpret_cast<uintptr_t>( toPayload( block ) ) & ( ALIGN_SIZE - 1 ) ) || ( blockSize( block ) < BLOCK_MIN ) )
+        {
+          return false;
+        }
+
+        if ( isFree( block ) )
+        {
+          freeBlocks++;
+        }
+        else
+        {
+          usedBlocks++;
+          usedBytes += blockSize( block ) + HDR_SIZE;
+        }
+
+        uint8_t *next = nextPhys( block );
+        if ( isFree( block ) && ( prevPhys( next ) != block ) )
+        {
+          return false;
+        }
+
+        prevFree = isFree( block );
+        block    = next;
+      }
+
+      if ( isPrevFree( block ) != prevFree )
+      {
+        return false;
+      }
+    }
+
+    if ( ( usedBytes != mUsedBytes ) || ( usedBlocks != mUsedBlocks ) || ( freeBlocks != mFreeBlocks ) )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Walk the segregated free lists
+    -------------------------------------------------------------------------*/
+    size_t listed = 0;
+    for ( size_t fl = 0; fl < FL_INDEX_COUNT; fl++ )
+    {
+      for ( size_t sl = 0; sl < SL_INDEX_COUNT; sl++ )
+      {
+        const bool flBit = mFLBitmap & ( 1u << fl );
+        const bool slBit = mSLBitmap[ fl ] & ( 1u << sl );
+
+        if ( ( slBit != ( mBlocks[ fl ][ sl ] != nullptr ) ) || ( slBit && !flBit ) )
+        {
+          return false;
+        }
+
+        for ( uint8_t *block = mBlocks[ fl ][ sl ]; block; block = nextFree( block ) )
+        {
+          size_t bfl = 0;
+          size_t bsl = 0;
+          mappingInsert( blockSize( block ), bfl, bsl );
+
+          if ( !isFree( block ) || ( bfl != fl ) || ( bsl != sl ) )
+          {
+            return false;
+          }
+
+          listed++;
+        }
+      }
+    }
+
+    return listed == mFreeBlocks;
+  }
+
+
+  void TLSF::insertFree( uint8_t *const block )
+  {
+    size_t fl = 0;
+    size_t sl = 0;
+    mappingInsert( blockSize( block ), fl, sl );
+
+    uint8_t *head     = mBlocks[ fl ][ sl ];
+    nextFree( block ) = head;
+    prevFree( block ) = nullptr;
+    if ( head )
+    {
+      prevFree( head ) = block;
+    }
+
+    mBlocks[ fl ][ sl ] = block;
+    mFLBitmap |= ( 1u << fl );
+    mSLBitmap[ fl ] |= ( 1u << sl );
+  }
+
+
+  void TLSF::removeFree( uint8_t *const block )
+  {
+    size_t fl = 0;
+    size_t sl = 0;
+    mappingInsert( blockSize( block ), fl, sl );
+
+    uint8_t *prev = prevFree( block );
+    uint8_t *next = nextFree( block );
+
+    if ( next )
+    {
+      prevFree( next ) = prev;
+    }
+
+    if ( prev )
+    {
+      nextFree( prev ) = next;
+    }
+    else
+    {
+      mBlocks[ fl ][ sl ] = next;
+      if ( !next )
+      {
+        mSLBitmap[ fl ] &= ~( 1u << sl );
+        if ( !mSLBitmap[ fl ] )
+        {
+          mFLBitmap &= ~( 1u << fl );
+        }
+      }
+    }
+  }
+
+
+  uint8_t *TLSF::findSuitable( size_t &fl, size_t &sl ) const
+  {
+    if ( fl >= FL_INDEX_COUNT )
+    {
+      return nullptr;
+    }
+
+    /*-------------------------------------------------------------------------
+    Search the current first level for a large enough list, then fall back
+    to the next non-empty first level.
+    -------------------------------------------------------------------------*/
+    uint32_t slMap = mSLBitmap[ fl ] & ( ~0u << sl );
+    if ( !slMap )
+    {
+      const uint32_t flMap = ( ( fl + 1 ) < 32 ) ? ( mFLBitmap & ( ~0u << ( fl + 1 ) ) ) : 0;
+      if ( !flMap )
+      {
+        return nullptr;
+      }
+
+      fl    = ffs( flMap );
+      slMap = mSLBitmap[ fl ];
+    }
+
+    sl = ffs( slMap );
+    return mBlocks[ fl ][ sl ];
+  }
+
+}  // namespace Chimera::Memory
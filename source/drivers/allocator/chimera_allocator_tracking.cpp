@@ -0,0 +1,486 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_allocator_tracking.cpp
+ *
+ *  Description:
+ *    Lock-free heap instrumentation. Every block gets a small header holding
+ *    the requested size and call site so that frees can be accounted for
+ *    without asking the backend heap how large the block was.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Chimera/assert>
+#include <Chimera/source/drivers/allocator/allocator_tracking.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace Chimera::Memory
+{
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct BlockHeader
+  {
+    size_t    size;  /**< Size the user requested */
+    uintptr_t site;  /**< Caller that requested the block */
+    uint32_t  magic; /**< Guards against freeing a foreign pointer */
+    uint32_t  flags; /**< Bookkeeping flags */
+  };
+
+  /**
+   *  Live block table entry. It holds its own copy of the size and site so a
+   *  report never has to touch a block another thread may be freeing. seq is
+   *  odd while the entry is being written, and every change advances it, so a
+   *  reader can tell a torn or recycled entry from a stable one.
+   */
+  struct BlockSlot
+  {
+    std::atomic<uint32_t>  seq;
+    std::atomic<uintptr_t> block;
+    std::atomic<size_t>    size;
+    std::atomic<uintptr_t> site;
+  };
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t    HEADER_ALIGN      = alignof( std::max_align_t );
+  static constexpr size_t    HEADER_SIZE       = ( sizeof( BlockHeader ) + HEADER_ALIGN - 1 ) & ~( HEADER_ALIGN - 1 );
+  static constexpr uint32_t  HEADER_MAGIC      = 0x48454150; /* "HEAP" */
+  static constexpr uint32_t  FLAG_IN_BLOCK_TBL = ( 1u << 0 );
+  static constexpr uintptr_t SLOT_EMPTY        = 0;
+  static constexpr size_t    NUM_SITE_SLOTS    = CHIMERA_ALLOCATOR_TRACKING_SITES;
+  static constexpr size_t    NUM_BLOCK_SLOTS   = CHIMERA_ALLOCATOR_TRACKING_BLOCKS;
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static std::atomic<size_t> s_current_bytes;
+  static std::atomic<size_t> s_peak_bytes;
+  static std::atomic<size_t> s_current_blocks;
+  static std::atomic<size_t> s_total_allocs;
+  static std::atomic<size_t> s_total_frees;
+  static std::atomic<size_t> s_failed_allocs;
+  static std::atomic<size_t> s_untracked_blocks;
+  static std::atomic<size_t> s_size_class[ NUM_SIZE_CLASSES ];
+
+#if ( CHIMERA_ALLOCATOR_TRACKING_SITES > 0 )
+  static std::atomic<uintptr_t> s_site_addr[ NUM_SITE_SLOTS ];
+  static std::atomic<size_t>    s_site_allocs[ NUM_SITE_SLOTS ];
+  static std::atomic<size_t>    s_site_bytes[ NUM_SITE_SLOTS ];
+#endif
+
+#if ( CHIMERA_ALLOCATOR_TRACKING_BLOCKS > 0 )
+  static BlockSlot s_block_tbl[ NUM_BLOCK_SLOTS ];
+#endif
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Maps an allocation size onto its power of two histogram bin
+   */
+  static inline size_t sizeClassOf( const size_t size )
+  {
+    size_t idx   = 0;
+    size_t limit = static_cast<size_t>( 1u ) << SIZE_CLASS_MIN_SHIFT;
+
+    while ( ( size > limit ) && ( idx < ( NUM_SIZE_CLASSES - 1 ) ) )
+    {
+      limit <<= 1;
+      idx++;
+    }
+
+    return idx;
+  }
+
+  /**
+   *  Cheap pointer mixing to spread table probes
+   */
+  static inline size_t hashOf( const uintptr_t value )
+  {
+    uintptr_t x = value >> 3;
+    x ^= x >> 16;
+    x *= 0x45d9f3bu;
+    x ^= x >> 16;
+    return static_cast<size_t>( x );
+  }
+
+  /**
+   *  Raise the peak watermark if the current usage exceeds it
+   */
+  static inline void updatePeak( const size_t current )
+  {
+    size_t peak = s_peak_bytes.load( std::memory_order_relaxed );
+    while ( ( current > peak ) &&
+            !s_peak_bytes.compare_exchange_weak( peak, current, std::memory_order_relaxed, std::memory_order_relaxed ) )
+    {
+      continue;
+    }
+  }
+
+#if ( CHIMERA_ALLOCATOR_TRACKING_SITES > 0 )
+  /**
+   *  Finds (or claims) the slot associated with a call site. Returns
+   *  NUM_SITE_SLOTS if the table is full.
+   */
+  static size_t findSiteSlot( const uintptr_t site )
+  {
+    const size_t start = hashOf( site ) % NUM_SITE_SLOTS;
+
+    for ( size_t probe = 0; probe < NUM_SITE_SLOTS; probe++ )
+    {
+      const size_t idx     = ( start + probe ) % NUM_SITE_SLOTS;
+      uintptr_t    current = s_site_addr[ idx ].load( std::memory_order_acquire );
+
+      if ( current == site )
+      {
+        return idx;
+      }
+
+      if ( current == SLOT_EMPTY )
+      {
+        if ( s_site_addr[ idx ].compare_exchange_strong( current, site, std::memory_order_acq_rel ) || ( current == site ) )
+        {
+          return idx;
+        }
+      }
+    }
+
+    return NUM_SITE_SLOTS;
+  }
+#endif /* CHIMERA_ALLOCATOR_TRACKING_SITES */
+
+#if ( CHIMERA_ALLOCATOR_TRACKING_BLOCKS > 0 )
+  /**
+   *  Inserts a block into the live block table. A slot is claimed by moving
+   *  its sequence from the even value it had while empty to odd, so a slot
+   *  filled or emptied in the meantime makes the claim fail.
+   */
+  static bool insertBlock( const uintptr_t block, const size_t size, const uintptr_t site )
+  {
+    const size_t start = hashOf( block ) % NUM_BLOCK_SLOTS;
+
+    for ( size_t probe = 0; probe < NUM_BLOCK_SLOTS; probe++ )
+    {
+      BlockSlot &slot = s_block_tbl[ ( start + probe ) % NUM_BLOCK_SLOTS ];
+      uint32_t   seq  = slot.seq.load( std::memory_order_acquire );
+
+      if ( ( seq & 1u ) || ( slot.block.load( std::memory_order_relaxed ) != SLOT_EMPTY ) )
+      {
+        continue;
+      }
+
+      if ( slot.seq.compare_exchange_strong( seq, seq + 1, std::memory_order_acq_rel, std::memory_order_relaxed ) )
+      {
+        std::atomic_thread_fence( std::memory_order_release );
+        slot.size.store( size, std::memory_order_relaxed );
+        slot.site.store( site, std::memory_order_relaxed );
+        slot.block.store( block, std::memory_order_relaxed );
+        slot.seq.store( seq + 2, std::memory_order_release );
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   *  Removes a block from the live block table. Only blocks flagged as
+   *  recorded are removed, so the block is known to be further along its
+   *  probe chain. That lets the slot go straight back to empty instead of
+   *  leaving a tombstone, and the walk carries on past empty slots rather
+   *  than stopping at them. Probe lengths then depend only on how full the
+   *  table is, not on how much churn it has seen.
+   */
+  static void removeBlock( const uintptr_t block )
+  {
+    const size_t start = hashOf( block ) % NUM_BLOCK_SLOTS;
+
+    for ( size_t probe = 0; probe < NUM_BLOCK_SLOTS; probe++ )
+    {
+      BlockSlot &slot = s_block_tbl[ ( start + probe ) % NUM_BLOCK_SLOTS ];
+
+      /*-----------------------------------------------------------------------
+      Only the thread freeing a block changes its slot, so no claim is needed
+      -----------------------------------------------------------------------*/
+      if ( slot.block.load( std::memory_order_relaxed ) == block )
+      {
+        slot.seq.fetch_add( 1, std::memory_order_acq_rel );
+        std::atomic_thread_fence( std::memory_order_release );
+        slot.block.store( SLOT_EMPTY, std::memory_order_relaxed );
+        slot.seq.fetch_add( 1, std::memory_order_release );
+        return;
+      }
+    }
+  }
+
+  /**
+   *  Leak report visitor that dumps a single record to the log
+   */
+  static void logLeakRecord( const LeakRecord &record )
+  {
+    LOG_INFO( "  Leak: %p, %u bytes, site %p\r\n", record.ptr, static_cast<unsigned>( record.size ),
+              reinterpret_cast<void *>( record.site ) );
+  }
+#endif /* CHIMERA_ALLOCATOR_TRACKING_BLOCKS */
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  void getHeapStats( HeapStats &stats )
+  {
+    memset( &stats, 0, sizeof( stats ) );
+
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+    stats.enabled         = true;
+    stats.currentBytes    = s_current_bytes.load( std::memory_order_relaxed );
+    stats.peakBytes       = s_peak_bytes.load( std::memory_order_relaxed );
+    stats.currentBlocks   = s_current_blocks.load( std::memory_order_relaxed );
+    stats.totalAllocs     = s_total_allocs.load( std::memory_order_relaxed );
+    stats.totalFrees      = s_total_frees.load( std::memory_order_relaxed );
+    stats.failedAllocs    = s_failed_allocs.load( std::memory_order_relaxed );
+    stats.untrackedBlocks = s_untracked_blocks.load( std::memory_order_relaxed );
+
+    for ( size_t x = 0; x < NUM_SIZE_CLASSES; x++ )
+    {
+      stats.sizeClass[ x ] = s_size_class[ x ].load( std::memory_order_relaxed );
+    }
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+  }
+
+
+  void resetHeapPeak()
+  {
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+    s_peak_bytes.store( s_current_bytes.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+  }
+
+
+  size_t getSiteStats( SiteStats *const buffer, const size_t count )
+  {
+    size_t written = 0;
+
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 ) && ( CHIMERA_ALLOCATOR_TRACKING_SITES > 0 )
+    if ( !buffer )
+    {
+      return 0;
+    }
+
+    for ( size_t x = 0; ( x < NUM_SITE_SLOTS ) && ( written < count ); x++ )
+    {
+      const uintptr_t site = s_site_addr[ x ].load( std::memory_order_acquire );
+      if ( site == SLOT_EMPTY )
+      {
+        continue;
+      }
+
+      buffer[ written ].site         = site;
+      buffer[ written ].totalAllocs  = s_site_allocs[ x ].load( std::memory_order_relaxed );
+      buffer[ written ].currentBytes = s_site_bytes[ x ].load( std::memory_order_relaxed );
+      written++;
+    }
+#else
+    ( void )buffer;
+    ( void )count;
+#endif
+
+    return written;
+  }
+
+
+  size_t visitLiveBlocks( LeakVisitor visitor )
+  {
+    size_t visited = 0;
+
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 ) && ( CHIMERA_ALLOCATOR_TRACKING_BLOCKS > 0 )
+    if ( !visitor.is_valid() )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Blocks may be freed while walking the table. Only the slot is read, never
+    the block, and an entry that changed while it was being copied is skipped.
+    -------------------------------------------------------------------------*/
+    for ( size_t x = 0; x < NUM_BLOCK_SLOTS; x++ )
+    {
+      const BlockSlot &slot = s_block_tbl[ x ];
+      const uint32_t   seq  = slot.seq.load( std::memory_order_acquire );
+      if ( seq & 1u )
+      {
+        continue;
+      }
+
+      const uintptr_t block = slot.block.load( std::memory_order_relaxed );
+      LeakRecord      record;
+      record.ptr  = reinterpret_cast<const uint8_t *>( block ) + HEADER_SIZE;
+      record.size = slot.size.load( std::memory_order_relaxed );
+      record.site = slot.site.load( std::memory_order_relaxed );
+
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( ( block != SLOT_EMPTY ) && ( slot.seq.load( std::memory_order_relaxed ) == seq ) )
+      {
+        visitor( record );
+        visited++;
+      }
+    }
+#else
+    ( void )visitor;
+#endif
+
+    return visited;
+  }
+
+
+  void logLeakReport()
+  {
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+    HeapStats stats;
+    getHeapStats( stats );
+
+    LOG_INFO( "Heap: %u bytes in %u blocks, peak %u, allocs %u, frees %u, failed %u\r\n",
+              static_cast<unsigned>( stats.currentBytes ), static_cast<unsigned>( stats.currentBlocks ),
+              static_cast<unsigned>( stats.peakBytes ), static_cast<unsigned>( stats.totalAllocs ),
+              static_cast<unsigned>( stats.totalFrees ), static_cast<unsigned>( stats.failedAllocs ) );
+
+#if ( CHIMERA_ALLOCATOR_TRACKING_BLOCKS > 0 )
+    visitLiveBlocks( LeakVisitor::create<logLeakRecord>() );
+
+    if ( stats.untrackedBlocks )
+    {
+      LOG_INFO( "  %u live blocks not recorded, table full\r\n", static_cast<unsigned>( stats.untrackedBlocks ) );
+    }
+#endif /* CHIMERA_ALLOCATOR_TRACKING_BLOCKS */
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+  }
+
+
+  namespace Internal
+  {
+    size_t trackingOverhead()
+    {
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+      return HEADER_SIZE;
+#else
+      return 0;
+#endif
+    }
+
+
+    void *onAllocate( void *const raw, const size_t size, const uintptr_t site )
+    {
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+      if ( !raw )
+      {
+        s_failed_allocs.fetch_add( 1, std::memory_order_relaxed );
+        return nullptr;
+      }
+
+      /*-----------------------------------------------------------------------
+      Fill in the header
+      -----------------------------------------------------------------------*/
+      BlockHeader *hdr = reinterpret_cast<BlockHeader *>( raw );
+      hdr->size        = size;
+      hdr->site        = site;
+      hdr->magic       = HEADER_MAGIC;
+      hdr->flags       = 0;
+
+      /*-----------------------------------------------------------------------
+      Global accounting
+      -----------------------------------------------------------------------*/
+      const size_t current = s_current_bytes.fetch_add( size, std::memory_order_relaxed ) + size;
+      updatePeak( current );
+
+      s_current_blocks.fetch_add( 1, std::memory_order_relaxed );
+      s_total_allocs.fetch_add( 1, std::memory_order_relaxed );
+      s_size_class[ sizeClassOf( size ) ].fetch_add( 1, std::memory_order_relaxed );
+
+      /*-----------------------------------------------------------------------
+      Optional attribution and leak tracking
+      -----------------------------------------------------------------------*/
+#if ( CHIMERA_ALLOCATOR_TRACKING_SITES > 0 )
+      const size_t slot = findSiteSlot( site );
+      if ( slot < NUM_SITE_SLOTS )
+      {
+        s_site_allocs[ slot ].fetch_add( 1, std::memory_order_relaxed );
+        s_site_bytes[ slot ].fetch_add( size, std::memory_order_relaxed );
+      }
+#endif
+
+#if ( CHIMERA_ALLOCATOR_TRACKING_BLOCKS > 0 )
+      if ( insertBlock( reinterpret_cast<uintptr_t>( raw ), size, site ) )
+      {
+        hdr->flags |= FLAG_IN_BLOCK_TBL;
+      }
+      else
+      {
+        s_untracked_blocks.fetch_add( 1, std::memory_order_relaxed );
+      }
+#endif
+
+      return reinterpret_cast<uint8_t *>( raw ) + HEADER_SIZE;
+#else
+      ( void )size;
+      ( void )site;
+      return raw;
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+    }
+
+
+    void *onFree( void *const ptr )
+    {
+#if ( CHIMERA_ALLOCATOR_TRACKING == 1 )
+      if ( !ptr )
+      {
+        return nullptr;
+      }
+
+      uint8_t     *raw = reinterpret_cast<uint8_t *>( ptr ) - HEADER_SIZE;
+      BlockHeader *hdr = reinterpret_cast<BlockHeader *>( raw );
+      RT_DBG_ASSERT( hdr->magic == HEADER_MAGIC );
+
+      /*-----------------------------------------------------------------------
+      Remove from the tables first so a report never sees a freed header
+      -----------------------------------------------------------------------*/
+#if ( CHIMERA_ALLOCATOR_TRACKING_BLOCKS > 0 )
+      if ( hdr->flags & FLAG_IN_BLOCK_TBL )
+      {
+        removeBlock( reinterpret_cast<uintptr_t>( raw ) );
+      }
+      else
+      {
+        s_untracked_blocks.fetch_sub( 1, std::memory_order_relaxed );
+      }
+#endif
+
+#if ( CHIMERA_ALLOCATOR_TRACKING_SITES > 0 )
+      const size_t slot = findSiteSlot( hdr->site );
+      if ( slot < NUM_SITE_SLOTS )
+      {
+        s_site_bytes[ slot ].fetch_sub( hdr->size, std::memory_order_relaxed );
+      }
+#endif
+
+      s_current_bytes.fetch_sub( hdr->size, std::memory_order_relaxed );
+      s_current_blocks.fetch_sub( 1, std::memory_order_relaxed );
+      s_total_frees.fetch_add( 1, std::memory_order_relaxed );
+
+      hdr->magic = 0;
+      return raw;
+#else
+      return ptr;
+#endif /* CHIMERA_ALLOCATOR_TRACKING */
+    }
+  }  // namespace Internal
+}  // namespace Chimera::Memory
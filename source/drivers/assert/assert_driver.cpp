@@ -8,12 +8,11 @@
  *  2021 | Brandon Braun | brandonbraun653@gmail.com
  *****************************************************************************/
 
-/* Aurora Includes */
-#include <Aurora/logging>
-
 /* Chimera Includes */
 #include <Chimera/common>
 #include <Chimera/assert>
+#include <Chimera/crash>
+#include <Chimera/log>
 #include <Chimera/system>
 
 namespace Chimera::Assert
@@ -25,7 +24,20 @@ namespace Chimera::Assert
   {
     if( !assertion )
     {
-      LOG_ERROR( "Failed assertion -- %s, Line: %d\r\n", file, line );
+      /*-----------------------------------------------------------------------
+      Snapshot the system first, while it still looks like it did when the
+      assertion failed. It's preserved across the reset for the next boot.
+      -----------------------------------------------------------------------*/
+      Chimera::Crash::capture( file, line, __builtin_return_address( 0 ) );
+
+      /*-----------------------------------------------------------------------
+      Anything still queued would be lost across the reset. Flush before to
+      guarantee room for this record, then again to emit it. flush() skips
+      consumers, which could block on a driver this context already holds.
+      -----------------------------------------------------------------------*/
+      Chimera::Log::flush();
+      CHIMERA_LOG_ERROR( "Failed assertion -- %s, Line: %d\r\n", file, line );
+      Chimera::Log::flush();
       Chimera::System::softwareReset();
     }
   }
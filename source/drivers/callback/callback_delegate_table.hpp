@@ -0,0 +1,337 @@
+/******************************************************************************
+ *  File Name:
+ *    callback_delegate_table.hpp
+ *
+ *  Description:
+ *    Double buffered delegate table that can be updated while ISRs dispatch
+ *    from it
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_CALLBACK_DELEGATE_TABLE_HPP
+#define CHIMERA_CALLBACK_DELEGATE_TABLE_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Chimera/source/drivers/threading/threading_mutex.hpp>
+#include <Chimera/source/drivers/threading/threading_thread.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <etl/delegate.h>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Default number of delegates that may be attached to one callback id.
+Every DelegateTable holds two copies of N * FANOUT delegates, so this
+multiplies the RAM of every driver's callback table. Memory tight
+targets can set it to 1, which leaves addCallback() room for only
+the delegate registerCallback() sets.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CALLBACK_MAX_FANOUT
+#define CHIMERA_CALLBACK_MAX_FANOUT ( 4 )
+#endif
+
+namespace Chimera::Callback
+{
+  /*---------------------------------------------------------------------------
+  Class Definitions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Drop-in replacement for etl::delegate_service whose delegates can be
+   *  changed at any time, including while an ISR is dispatching from it.
+   *
+   *  Two copies of the table exist. Dispatch reads whichever copy is active
+   *  and never blocks. Updates copy the active table into the spare one,
+   *  modify the copy, then publish it with a single atomic store, so a
+   *  dispatch always sees either the old table or the new one and never a
+   *  half written entry. Before reusing the spare copy, an update waits for
+   *  any dispatch still running on it from the previous swap to finish.
+   *
+   *  Each id can hold up to FANOUT delegates, invoked in the order they were
+   *  added. Ids with no delegates fall through to the unhandled delegate.
+   *
+   *  Updates are serialized by a mutex and wait for readers by sleeping, so
+   *  a lower priority task that was preempted mid dispatch gets to finish.
+   *  The table costs 2 * ( N * FANOUT + 1 ) delegates of RAM.
+   *
+   *  @warning Updates must not be made from an ISR. They block on the update
+   *           lock and may have to wait for an interrupted dispatch to finish.
+   *
+   *  @tparam N       Number of callback ids
+   *  @tparam FANOUT  Maximum delegates per id
+   */
+  template<const size_t N, const size_t FANOUT = CHIMERA_CALLBACK_MAX_FANOUT>
+  class DelegateTable
+  {
+  public:
+    static_assert( FANOUT > 0, "DelegateTable needs room for at least one delegate per id" );
+
+    using Delegate = etl::delegate<void( size_t )>;
+
+    DelegateTable() : mActive( 0 ), mReaders{ 0, 0 }
+    {
+    }
+
+    DelegateTable( const DelegateTable & )            = delete;
+    DelegateTable &operator=( const DelegateTable & ) = delete;
+
+    /**
+     *  Replaces every delegate on an id with a single delegate
+     *
+     *  @param[in]  id          Callback id to assign
+     *  @param[in]  callback    Delegate to invoke, or an empty one to clear
+     *  @return bool            False if the id is out of range
+     */
+    bool register_delegate( const size_t id, Delegate callback )
+    {
+      if ( id >= N )
+      {
+        return false;
+      }
+
+      Table &next = beginUpdate();
+      for ( auto &slot : next.delegates[ id ] )
+      {
+        slot = Delegate();
+      }
+
+      next.delegates[ id ][ 0 ] = callback;
+      endUpdate();
+      return true;
+    }
+
+    /**
+     *  Assigns the delegate invoked for ids that have nothing registered
+     *
+     *  @param[in]  callback    Delegate to invoke
+     *  @return void
+     */
+    void register_unhandled_delegate( Delegate callback )
+    {
+      Table &next    = beginUpdate();
+      next.unhandled = callback;
+      endUpdate();
+    }
+
+    /**
+     *  Attaches another delegate to an id without disturbing existing ones
+     *
+     *  @param[in]  id          Callback id to add to
+     *  @param[in]  callback    Delegate to add
+     *  @return bool            False if the id is out of range or full
+     */
+    bool add_delegate( const size_t id, Delegate callback )
+    {
+      if ( ( id >= N ) || !callback.is_valid() )
+      {
+        return false;
+      }
+
+      bool   added = false;
+      Table &next  = beginUpdate();
+      for ( auto &slot : next.delegates[ id ] )
+      {
+        if ( !slot.is_valid() )
+        {
+          slot  = callback;
+          added = true;
+          break;
+        }
+      }
+
+      endUpdate( added );
+      return added;
+    }
+
+    /**
+     *  Detaches a delegate previously attached to an id
+     *
+     *  @param[in]  id          Callback id to remove from
+     *  @param[in]  callback    Delegate to remove
+     *  @return bool            False if the delegate wasn't attached
+     */
+    bool remove_delegate( const size_t id, Delegate callback )
+    {
+      if ( id >= N )
+      {
+        return false;
+      }
+
+      /*-----------------------------------------------------------------------
+      Close the gap so dispatch can stop at the first empty slot
+      -----------------------------------------------------------------------*/
+      bool   removed = false;
+      Table &next    = beginUpdate();
+      auto  &slots   = next.delegates[ id ];
+      for ( size_t x = 0; x < FANOUT; x++ )
+      {
+        if ( !removed && slots[ x ].is_valid() && ( slots[ x ] == callback ) )
+        {
+          removed = true;
+        }
+
+        if ( removed )
+        {
+          slots[ x ] = ( ( x + 1 ) < FANOUT ) ? slots[ x + 1 ] : Delegate();
+        }
+      }
+
+      endUpdate( removed );
+      return removed;
+    }
+
+    /**
+     *  Invokes every delegate attached to an id. Safe from any context.
+     *
+     *  @param[in]  id          Callback id to dispatch
+     *  @return size_t          Number of delegates invoked
+     */
+    size_t call( const size_t id ) const
+    {
+      if ( id >= N )
+      {
+        return 0;
+      }
+
+      /*-----------------------------------------------------------------------
+      Announce the read, then confirm the table is still the active one. If
+      an update published a new table in between, it may not have seen the
+      announcement, so back out and read the new table instead. Sequentially
+      consistent ordering here and in beginUpdate() is what makes this work.
+      -----------------------------------------------------------------------*/
+      size_t idx = mActive.load();
+      while ( true )
+      {
+        mReaders[ idx ].fetch_add( 1 );
+
+        const size_t now = mActive.load();
+        if ( now == idx )
+        {
+          break;
+        }
+
+        mReaders[ idx ].fetch_sub( 1, std::memory_order_release );
+        idx = now;
+      }
+
+      size_t       invoked = 0;
+      const Table &table   = mTables[ idx ];
+      for ( const auto &slot : table.delegates[ id ] )
+      {
+        if ( !slot.is_valid() )
+        {
+          break;
+        }
+
+        slot( id );
+        invoked++;
+      }
+
+      if ( !invoked && table.unhandled.is_valid() )
+      {
+        table.unhandled( id );
+      }
+
+      mReaders[ idx ].fetch_sub( 1, std::memory_order_release );
+      return invoked;
+    }
+
+    /**
+     *  Compile time checked version of call()
+     *
+     *  @tparam ID              Callback id to dispatch
+     *  @return size_t          Number of delegates invoked
+     */
+    template<const size_t ID>
+    size_t call() const
+    {
+      static_assert( ID < N, "Callback id out of range" );
+      return call( ID );
+    }
+
+    /**
+     *  Number of delegates attached to an id
+     *
+     *  @param[in]  id          Callback id to check
+     *  @return size_t
+     */
+    size_t count( const size_t id ) const
+    {
+      if ( id >= N )
+      {
+        return 0;
+      }
+
+      size_t       result = 0;
+      const Table &table  = mTables[ mActive.load( std::memory_order_acquire ) ];
+      while ( ( result < FANOUT ) && table.delegates[ id ][ result ].is_valid() )
+      {
+        result++;
+      }
+
+      return result;
+    }
+
+  private:
+    struct Table
+    {
+      Delegate delegates[ N ][ FANOUT ];
+      Delegate unhandled;
+    };
+
+    Table                       mTables[ 2 ];
+    std::atomic<size_t>         mActive;      /**< Index of the table dispatch reads */
+    mutable std::atomic<size_t> mReaders[ 2 ]; /**< Dispatches in flight per table */
+    Chimera::Thread::Mutex      mUpdateLock;  /**< Serializes updates */
+
+    /**
+     *  Takes the update lock and prepares the spare table as a copy of the
+     *  active one.
+     *
+     *  @return Table&          Spare table to modify
+     */
+    Table &beginUpdate()
+    {
+      mUpdateLock.lock();
+
+      /*-----------------------------------------------------------------------
+      Readers that loaded the spare index before the last swap may still be
+      using it. Nothing new can start on it, so this wait is bounded by the
+      dispatches already under way. Sleep rather than yield: a yield never
+      lets a preempted lower priority reader run.
+      -----------------------------------------------------------------------*/
+      const size_t spare = mActive.load( std::memory_order_relaxed ) ^ 1u;
+      while ( mReaders[ spare ].load() )
+      {
+        Chimera::Thread::this_thread::sleep_for( Chimera::Thread::TIMEOUT_1MS );
+      }
+
+      mTables[ spare ] = mTables[ spare ^ 1u ];
+      return mTables[ spare ];
+    }
+
+    /**
+     *  Publishes the spare table and releases the update lock
+     *
+     *  @param[in]  publish     False to discard the changes
+     *  @return void
+     */
+    void endUpdate( const bool publish = true )
+    {
+      if ( publish )
+      {
+        mActive.store( mActive.load( std::memory_order_relaxed ) ^ 1u );
+      }
+
+      mUpdateLock.unlock();
+    }
+  };
+}  // namespace Chimera::Callback
+
+#endif /* !CHIMERA_CALLBACK_DELEGATE_TABLE_HPP */
@@ -17,23 +17,29 @@
 Includes
 -----------------------------------------------------------------------------*/
 #include <Chimera/common>
+#include <Chimera/source/drivers/callback/callback_delegate_table.hpp>
 #include <cstddef>
 #include <cstdint>
+#include <etl/array.h>
 #include <etl/delegate.h>
-#include <etl/delegate_service.h>
 
 namespace Chimera::Callback
 {
   /*---------------------------------------------------------------------------
   Class Definitions
   ---------------------------------------------------------------------------*/
+  /**
+   *  Mixin giving a driver a table of event callbacks. Callbacks may be
+   *  registered or swapped at any time, even while the driver's ISRs are
+   *  dispatching them, without taking the driver lock. See DelegateTable.
+   */
   template<typename CRTPClass, typename CBType, typename EventDataType = void *>
   class DelegateService
   {
   public:
     /**
      *  Register a callback to be invoked upon some event that occurs during
-     *  the service processing.
+     *  the service processing. Replaces anything already registered on the id.
      *
      *  @param[in]  id          Which event to register against
      *  @param[in]  func        The function to register
@@ -52,7 +58,6 @@ namespace Chimera::Callback
       /*-------------------------------------------------
       Register the callback
       -------------------------------------------------*/
-      static_cast<CRTPClass *>( this )->lock();
       if ( id == CBType::CB_UNHANDLED )
       {
         mCBService_registry.register_unhandled_delegate( func );
@@ -62,10 +67,55 @@ namespace Chimera::Callback
         mCBService_registry.register_delegate( id, func );
       }
 
-      static_cast<CRTPClass *>( this )->unlock();
       return Chimera::Status::OK;
     }
 
+    /**
+     *  Attach an additional callback to an event, keeping existing ones
+     *
+     *  @param[in]  id          Which event to register against
+     *  @param[in]  func        The function to attach
+     *  @return Chimera::Status_t
+     *
+     *  |   Return Value   |                 Explanation                |
+     *  |:----------------:|:------------------------------------------:|
+     *  |               OK | The callback was attached                  |
+     *  |             FULL | CHIMERA_CALLBACK_MAX_FANOUT already in use |
+     *  | INVAL_FUNC_PARAM | Bad event id or empty function             |
+     */
+    Chimera::Status_t addCallback( const CBType id, etl::delegate<void( size_t )> func )
+    {
+      if ( !( id < CBType::CB_NUM_OPTIONS ) || !func.is_valid() )
+      {
+        return Chimera::Status::INVAL_FUNC_PARAM;
+      }
+
+      return mCBService_registry.add_delegate( id, func ) ? Chimera::Status::OK : Chimera::Status::FULL;
+    }
+
+    /**
+     *  Detach a callback previously attached to an event
+     *
+     *  @param[in]  id          Which event to remove from
+     *  @param[in]  func        The function to detach
+     *  @return Chimera::Status_t
+     *
+     *  |   Return Value   |                 Explanation                |
+     *  |:----------------:|:------------------------------------------:|
+     *  |               OK | The callback was detached                  |
+     *  |        NOT_FOUND | The callback wasn't attached to the event  |
+     *  | INVAL_FUNC_PARAM | Bad event id                               |
+     */
+    Chimera::Status_t removeCallback( const CBType id, etl::delegate<void( size_t )> func )
+    {
+      if ( !( id < CBType::CB_NUM_OPTIONS ) )
+      {
+        return Chimera::Status::INVAL_FUNC_PARAM;
+      }
+
+      return mCBService_registry.remove_delegate( id, func ) ? Chimera::Status::OK : Chimera::Status::NOT_FOUND;
+    }
+
     /**
      * Sets the data associated with a particular callback event
      *
@@ -100,7 +150,7 @@ namespace Chimera::Callback
 
   protected:
     etl::array<EventDataType, CBType::CB_NUM_OPTIONS> mCBService_data;
-    etl::delegate_service<CBType::CB_NUM_OPTIONS>     mCBService_registry;
+    DelegateTable<CBType::CB_NUM_OPTIONS>             mCBService_registry;
   };
 }  // namespace Chimera::Callback
 
@@ -0,0 +1,151 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_map.cpp
+ *
+ *  Description:
+ *    Lookup cost of the flat map variants at 8, 64 and 1024 entries. The
+ *    tables are built at compile time so FrozenMap can be measured the way
+ *    it is meant to be used, and the runtime maps are filled from the same
+ *    entries. Every lookup hits.
+ *
+ *    Usage: chimera_container_map_bench [lookups]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/* Chimera Includes */
+#include <Chimera/container>
+
+namespace
+{
+  using namespace Chimera::Container;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t KEY_POOL = 4096;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Compile time table of scattered keys, so that neither the sorted map nor
+   *  the hash gets handed a trivially ordered sequence
+   */
+  template<size_t N>
+  struct Table
+  {
+    std::pair<uint32_t, uint32_t> entries[ N ];
+
+    constexpr Table() : entries{}
+    {
+      for ( size_t x = 0; x < N; x++ )
+      {
+        entries[ x ].first  = static_cast<uint32_t>( x * 2654435761u ) ^ 0x40000000u;
+        entries[ x ].second = static_cast<uint32_t>( x );
+      }
+    }
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  template<size_t N>
+  static constexpr Table<N> s_table{};
+
+  template<size_t N>
+  static constexpr FrozenMap<uint32_t, uint32_t, N> s_frozen( s_table<N>.entries );
+
+  static volatile uint32_t s_sink;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Times a lookup function over the key pool
+   *
+   *  @return double          Nanoseconds per lookup
+   */
+  template<typename Lookup>
+  static double timeLookups( const std::vector<uint32_t> &keys, const size_t lookups, Lookup &&lookup )
+  {
+    const size_t passes = ( lookups + keys.size() - 1 ) / keys.size();
+    uint32_t     acc    = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for ( size_t pass = 0; pass < passes; pass++ )
+    {
+      for ( const uint32_t key : keys )
+      {
+        acc += lookup( key );
+      }
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    s_sink = acc;
+    return std::chrono::duration<double, std::nano>( stop - start ).count() /
+           static_cast<double>( passes * keys.size() );
+  }
+
+
+  /**
+   *  Runs every map type at one table size
+   *
+   *  @return bool            False if the maps disagree on any lookup
+   */
+  template<size_t N>
+  static bool run( const size_t lookups )
+  {
+    static_assert( s_frozen<N>.valid(), "FrozenMap failed to build" );
+
+    LightFlatMap<uint32_t, uint32_t>  light;
+    SortedFlatMap<uint32_t, uint32_t> sorted;
+    for ( const auto &entry : s_table<N>.entries )
+    {
+      light.append( entry.first, entry.second );
+      sorted.append( entry.first, entry.second );
+    }
+
+    std::mt19937          rng( 1 );
+    std::vector<uint32_t> keys;
+    keys.reserve( KEY_POOL );
+    for ( size_t x = 0; x < KEY_POOL; x++ )
+    {
+      keys.push_back( s_table<N>.entries[ rng() % N ].first );
+    }
+
+    for ( const uint32_t key : keys )
+    {
+      if ( ( light[ key ] != sorted[ key ] ) || ( light[ key ] != s_frozen<N>[ key ] ) )
+      {
+        printf( "N %4zu: maps disagree on key 0x%08x\n", N, key );
+        return false;
+      }
+    }
+
+    const double lightNs  = timeLookups( keys, lookups, [ & ]( uint32_t key ) { return light[ key ]; } );
+    const double sortedNs = timeLookups( keys, lookups, [ & ]( uint32_t key ) { return sorted[ key ]; } );
+    const double frozenNs = timeLookups( keys, lookups, [ & ]( uint32_t key ) { return s_frozen<N>[ key ]; } );
+
+    printf( "N %4zu  light %7.2f ns  sorted %6.2f ns  frozen %6.2f ns\n", N, lightNs, sortedNs, frozenNs );
+    return true;
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t lookups = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 1000000;
+
+  printf( "%zu lookups per map\n", lookups );
+
+  const bool ok = run<8>( lookups ) && run<64>( lookups ) && run<1024>( lookups );
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_mpmc.cpp
+ *
+ *  Description:
+ *    MPMCQueue throughput against a mutex guarded queue of the same depth.
+ *    Producers mix single and bulk pushes, consumers mix single and bulk pops,
+ *    and a checksum over every item proves nothing was lost or duplicated.
+ *
+ *    Usage: chimera_container_mpmc_bench [items per producer] [max pairs]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/* Chimera Includes */
+#include <Chimera/container>
+
+namespace
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t DEPTH = 1024;
+  static constexpr size_t BURST = 8;
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Bounded std::queue behind a single mutex, with the MPMCQueue interface
+   */
+  class LockedQueue
+  {
+  public:
+    bool tryPush( const uint64_t item )
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      if ( mQueue.size() >= DEPTH )
+      {
+        return false;
+      }
+
+      mQueue.push( item );
+      return true;
+    }
+
+    bool tryPop( uint64_t &item )
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      if ( mQueue.empty() )
+      {
+        return false;
+      }
+
+      item = mQueue.front();
+      mQueue.pop();
+      return true;
+    }
+
+    size_t pushBulk( const uint64_t *const items, const size_t count )
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      const size_t                written = std::min( count, DEPTH - mQueue.size() );
+      for ( size_t x = 0; x < written; x++ )
+      {
+        mQueue.push( items[ x ] );
+      }
+
+      return written;
+    }
+
+    size_t popBulk( uint64_t *const items, const size_t count )
+    {
+      std::lock_guard<std::mutex> guard( mLock );
+      const size_t                read = std::min( count, mQueue.size() );
+      for ( size_t x = 0; x < read; x++ )
+      {
+        items[ x ] = mQueue.front();
+        mQueue.pop();
+      }
+
+      return read;
+    }
+
+  private:
+    std::mutex           mLock;
+    std::queue<uint64_t> mQueue;
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Pushes the values [first, first + count), every third operation a burst
+   */
+  template<typename Queue>
+  static void produce( Queue &queue, const uint64_t first, const size_t count )
+  {
+    size_t sent = 0;
+    while ( sent < count )
+    {
+      size_t written = 0;
+      if ( ( sent % 3 ) == 0 )
+      {
+        uint64_t     burst[ BURST ];
+        const size_t length = std::min( BURST, count - sent );
+        for ( size_t x = 0; x < length; x++ )
+        {
+          burst[ x ] = first + sent + x;
+        }
+
+        written = queue.pushBulk( burst, length );
+      }
+      else
+      {
+        written = queue.tryPush( first + sent ) ? 1 : 0;
+      }
+
+      sent += written;
+      if ( !written )
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+
+  /**
+   *  Pops until every item has been accounted for. Odd consumers drain in
+   *  bursts, even ones one item at a time.
+   */
+  template<typename Queue>
+  static void consume( Queue &queue, const size_t id, const size_t total, std::atomic<size_t> &received,
+                       std::atomic<uint64_t> &checksum )
+  {
+    uint64_t sum = 0;
+    while ( received.load( std::memory_order_relaxed ) < total )
+    {
+      uint64_t burst[ BURST ];
+      size_t   read = 0;
+      if ( id & 1u )
+      {
+        read = queue.popBulk( burst, BURST );
+      }
+      else
+      {
+        read = queue.tryPop( burst[ 0 ] ) ? 1 : 0;
+      }
+
+      for ( size_t x = 0; x < read; x++ )
+      {
+        sum += burst[ x ];
+      }
+
+      if ( read )
+      {
+        received.fetch_add( read, std::memory_order_relaxed );
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    checksum.fetch_add( sum, std::memory_order_relaxed );
+  }
+
+
+  /**
+   *  Moves items through a queue with the given number of producers and
+   *  consumers
+   *
+   *  @return double          Elapsed seconds, or a negative value on a checksum mismatch
+   */
+  template<typename Queue>
+  static double run( Queue &queue, const size_t pairs, const size_t items )
+  {
+    const size_t          total = pairs * items;
+    std::atomic<size_t>   received( 0 );
+    std::atomic<uint64_t> checksum( 0 );
+
+    std::vector<std::thread> threads;
+    threads.reserve( 2 * pairs );
+
+    const auto start = std::chrono::steady_clock::now();
+    for ( size_t p = 0; p < pairs; p++ )
+    {
+      threads.emplace_back( produce<Queue>, std::ref( queue ), ( p * items ) + 1, items );
+    }
+
+    for ( size_t c = 0; c < pairs; c++ )
+    {
+      threads.emplace_back( consume<Queue>, std::ref( queue ), c, total, std::ref( received ), std::ref( checksum ) );
+    }
+
+    for ( std::thread &thread : threads )
+    {
+      thread.join();
+    }
+
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    const uint64_t expect = ( static_cast<uint64_t>( total ) * ( total + 1 ) ) / 2;
+    return ( checksum.load() == expect ) ? seconds : -1.0;
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t items    = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 1000000;
+  const size_t maxPairs = ( argc > 2 ) ? strtoul( argv[ 2 ], nullptr, 0 ) : 4;
+
+  printf( "%zu items per producer, queue depth %zu\n", items, DEPTH );
+
+  for ( size_t pairs = 1; pairs <= maxPairs; pairs *= 2 )
+  {
+    auto lockFree = std::make_unique<Chimera::Container::MPMCQueue<uint64_t, DEPTH>>();
+    auto locked   = std::make_unique<LockedQueue>();
+
+    const double lockFreeSec = run( *lockFree, pairs, items );
+    const double lockedSec   = run( *locked, pairs, items );
+    if ( ( lockFreeSec < 0.0 ) || ( lockedSec < 0.0 ) )
+    {
+      printf( "%zuP/%zuC: checksum mismatch\n", pairs, pairs );
+      return 1;
+    }
+
+    const double moved = static_cast<double>( pairs * items );
+    printf( "%zuP/%zuC  mpmc %7.2f Mitems/s  mutex %7.2f Mitems/s\n", pairs, pairs, moved / lockFreeSec / 1e6,
+            moved / lockedSec / 1e6 );
+  }
+
+  return 0;
+}
@@ -37,6 +37,10 @@ namespace Chimera::Container
    *  as this is intended for low item count (<20), I believe a linear lookup
    *  will likely be faster than hashing. This depends on the comparison function
    *  however.
+   *
+   *  @see FixedFlatMap for use without a heap
+   *  @see SortedFlatMap for larger tables built at runtime
+   *  @see FrozenMap for constant tables known at compile time
    */
   template<typename T1, typename T2>
   class LightFlatMap
@@ -67,7 +71,7 @@ namespace Chimera::Container
     {
       T2 tempVal = {};
 
-      if ( auto x = at( key ); &x != &emptyObj )
+      if ( auto &x = at( key ); &x != &emptyObj )
       {
         tempVal = x.second;
       }
@@ -145,12 +149,12 @@ namespace Chimera::Container
      */
     bool exists( const T1 &key, value_type **element = nullptr )
     {
-      auto tmp = at( key );
+      auto &tmp   = at( key );
       auto result = static_cast<bool>( &tmp != &emptyObj );
 
       if ( element )
       {
-        *element = tmp;
+        *element = result ? &tmp : nullptr;
       }
 
       return result;
@@ -177,7 +181,7 @@ namespace Chimera::Container
      */
     void assign( const T1 &key, const T2 &value )
     {
-      auto tmp = at( key );
+      auto &tmp = at( key );
 
       if ( &tmp != &emptyObj )
       {
@@ -0,0 +1,296 @@
+/******************************************************************************
+ *  File Name:
+ *    container_fixed_map.hpp
+ *
+ *  Description:
+ *    Fixed capacity flat map with inline storage
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_CONTAINER_FIXED_MAP_HPP
+#define CHIMERA_CONTAINER_FIXED_MAP_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+namespace Chimera::Container
+{
+  /**
+   *  LightFlatMap with a compile time capacity. Entries live inside the object
+   *  itself, so nothing here ever touches the heap. That makes it safe to
+   *  modify from an ISR or after the heap has been locked down, as long as the
+   *  caller provides whatever mutual exclusion the use case needs.
+   *
+   *  Entries are unordered. Appending writes to the end of the array and
+   *  erasing moves the last entry into the hole (swap-and-pop), so both are
+   *  constant time once the entry has been located. Erasing invalidates
+   *  pointers to the last entry.
+   */
+  template<typename T1, typename T2, size_t N>
+  class FixedFlatMap
+  {
+  public:
+    static_assert( N > 0, "FixedFlatMap must have a non-zero capacity" );
+
+    using value_type = std::pair<T1, T2>;
+
+    constexpr FixedFlatMap() : map{}, count( 0 ), emptyObj( {} )
+    {
+    }
+
+    /**
+     *  Initializes from a list. Entries beyond the capacity are dropped.
+     */
+    constexpr FixedFlatMap( std::initializer_list<value_type> list ) : FixedFlatMap()
+    {
+      for ( const auto &entry : list )
+      {
+        if ( !append( entry.first, entry.second ) )
+        {
+          break;
+        }
+      }
+    }
+
+    /**
+     *  Looks up the value associated with a key. If the key does not
+     *  exist in the map, an empty value (zero initialized) will be
+     *  returned instead.
+     *
+     *  @note No insertion operation is permitted by design
+     *
+     *  @param[in]  key   The key to search for
+     *  @return T2        The key's value if it exists
+     */
+    constexpr T2 operator[]( const T1 &key ) const
+    {
+      const value_type *entry = find( key );
+      return entry ? entry->second : T2{};
+    }
+
+    /**
+     *  Looks up the key-value pair associated with a given key
+     *
+     *  @param[in]  key   The key to search for
+     *  @return std::pair<T1,T2>
+     */
+    value_type &at( const T1 &key )
+    {
+      value_type *entry = const_cast<value_type *>( find( key ) );
+      return entry ? *entry : emptyObj;
+    }
+
+    constexpr const value_type &at( const T1 &key ) const
+    {
+      const value_type *entry = find( key );
+      return entry ? *entry : emptyObj;
+    }
+
+    /**
+     *  Looks up the key-value pair associated with a given value
+     *
+     *  @param[in]  value     The value to search for
+     *  @return std::pair<T1,T2>
+     */
+    value_type *findWithValue( const T2 &value )
+    {
+      for ( size_t x = 0; x < count; x++ )
+      {
+        if ( map[ x ].second == value )
+        {
+          return &map[ x ];
+        }
+      }
+
+      return nullptr;
+    }
+
+    /**
+     *  Checks to see if the given key exists in the map. If it does, will
+     *  return true. Optionally can request that the key/value pair be returned
+     *  to the caller via an argument.
+     *
+     *  @param[in]  key       The key to lookup
+     *  @param[in]  element   The key-value pair element associated with the key
+     *  @return bool
+     */
+    bool exists( const T1 &key, value_type **element = nullptr )
+    {
+      value_type *entry = const_cast<value_type *>( find( key ) );
+
+      if ( element )
+      {
+        *element = entry;
+      }
+
+      return entry != nullptr;
+    }
+
+    /**
+     *  Constructs a new key-value pair and adds it to the map
+     *
+     *  @param[in]  key     The key to lookup
+     *  @param[in]  value   The new value to assign
+     *  @return bool        False if the map is full
+     */
+    constexpr bool append( const T1 &key, const T2 &value )
+    {
+      if ( count >= N )
+      {
+        return false;
+      }
+
+      map[ count ].first  = key;
+      map[ count ].second = value;
+      count++;
+      return true;
+    }
+
+    /**
+     *  Assigns an existing entry in the map and updates its value
+     *
+     *  @param[in]  key     The key to lookup
+     *  @param[in]  value   The new value to assign
+     *  @return void
+     */
+    void assign( const T1 &key, const T2 &value )
+    {
+      if ( value_type *entry = const_cast<value_type *>( find( key ) ); entry )
+      {
+        entry->second = value;
+      }
+    }
+
+    /**
+     *  Removes the first entry matching the key
+     *
+     *  @param[in]  key     The key to remove
+     *  @return bool        True if an entry was removed
+     */
+    bool erase( const T1 &key )
+    {
+      value_type *entry = const_cast<value_type *>( find( key ) );
+      if ( !entry )
+      {
+        return false;
+      }
+
+      erase( entry );
+      return true;
+    }
+
+    /**
+     *  Removes an entry previously returned from at(), exists() or
+     *  findWithValue(). Runs in constant time.
+     *
+     *  @param[in]  entry   Entry to remove
+     *  @return void
+     */
+    void erase( value_type *const entry )
+    {
+      if ( !entry || ( entry < map.data() ) || ( entry >= ( map.data() + count ) ) )
+      {
+        return;
+      }
+
+      value_type &last = map[ count - 1 ];
+      if ( entry != &last )
+      {
+        *entry = std::move( last );
+      }
+
+      last = value_type{};
+      count--;
+    }
+
+    /**
+     *  Removes all entries
+     *
+     *  @return void
+     */
+    void clear()
+    {
+      for ( size_t x = 0; x < count; x++ )
+      {
+        map[ x ] = value_type{};
+      }
+
+      count = 0;
+    }
+
+    /**
+     *  The number of entries in the map
+     *
+     *  @return size_t
+     */
+    constexpr size_t size() const
+    {
+      return count;
+    }
+
+    /**
+     *  The maximum number of entries the map can hold
+     *
+     *  @return size_t
+     */
+    static constexpr size_t capacity()
+    {
+      return N;
+    }
+
+    /**
+     *  Checks if another entry can be appended
+     *
+     *  @return bool
+     */
+    constexpr bool full() const
+    {
+      return count >= N;
+    }
+
+    value_type *begin()
+    {
+      return map.data();
+    }
+
+    value_type *end()
+    {
+      return map.data() + count;
+    }
+
+    constexpr const value_type *begin() const
+    {
+      return map.data();
+    }
+
+    constexpr const value_type *end() const
+    {
+      return map.data() + count;
+    }
+
+  private:
+    std::array<value_type, N> map;
+    size_t                    count;
+    value_type                emptyObj;
+
+    constexpr const value_type *find( const T1 &key ) const
+    {
+      for ( size_t x = 0; x < count; x++ )
+      {
+        if ( map[ x ].first == key )
+        {
+          return &map[ x ];
+        }
+      }
+
+      return nullptr;
+    }
+  };
+}  // namespace Chimera::Container
+
+#endif /* !CHIMERA_CONTAINER_FIXED_MAP_HPP */
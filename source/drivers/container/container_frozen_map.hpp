@@ -0,0 +1,330 @@
+/******************************************************************************
+ *  File Name:
+ *    container_frozen_map.hpp
+ *
+ *  Description:
+ *    Immutable map built at compile time around a perfect hash function
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_CONTAINER_FROZEN_MAP_HPP
+#define CHIMERA_CONTAINER_FROZEN_MAP_HPP
+
+/* STL Includes */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace Chimera::Container
+{
+  namespace Internal
+  {
+    /**
+     *  Intentionally not constexpr. Reaching this while building a FrozenMap
+     *  in a constant expression turns the failure into a compile error that
+     *  names the problem: usually a duplicate key in the table.
+     */
+    inline void frozen_map_construction_failed()
+    {
+    }
+
+    static constexpr size_t nextPow2( const size_t x )
+    {
+      size_t result = 1;
+      while ( result < x )
+      {
+        result <<= 1;
+      }
+
+      return result;
+    }
+
+    /**
+     *  64-bit finalizer from SplitMix64, seeded so that each seed gives an
+     *  independent looking hash of the same key.
+     */
+    static constexpr uint64_t frozenHash( uint64_t x, const uint64_t seed )
+    {
+      x ^= seed * 0x9E3779B97F4A7C15ull;
+      x ^= x >> 30;
+      x *= 0xBF58476D1CE4E5B9ull;
+      x ^= x >> 27;
+      x *= 0x94D049BB133111EBull;
+      x ^= x >> 31;
+      return x;
+    }
+  }  // namespace Internal
+
+
+  /**
+   *  Read-only map for fixed tables such as register maps and option lists.
+   *  The table is laid out at compile time using hash-and-displace perfect
+   *  hashing: every key is first hashed into a bucket, and each bucket stores
+   *  a seed chosen so that its keys land in distinct slots. A lookup is then
+   *  two hashes and a single key comparison with no probing, and the whole
+   *  structure lives in flash when declared constexpr.
+   *
+   *  Keys must be integral or enumeration types.
+   *
+   *  @code
+   *  static constexpr auto RegMap = makeFrozenMap<Channel, uintptr_t>( {
+   *    { Channel::CH0, 0x40001000 },
+   *    { Channel::CH1, 0x40001400 },
+   *  } );
+   *  static_assert( RegMap.valid() );
+   *  @endcode
+   */
+  template<typename K, typename V, size_t N>
+  class FrozenMap
+  {
+  public:
+    static_assert( std::is_integral_v<K> || std::is_enum_v<K>, "FrozenMap keys must be integral or enum types" );
+    static_assert( std::is_default_constructible_v<V>, "FrozenMap values must be default constructible" );
+    static_assert( N > 0, "FrozenMap must hold at least one entry" );
+
+    using value_type = std::pair<K, V>;
+
+    /**
+     *  Number of slots in the table. Always a power of two so that reducing a
+     *  hash to a slot is a mask.
+     */
+    static constexpr size_t TABLE_SIZE = Internal::nextPow2( N );
+
+    /**
+     *  Upper bound on seeds tried per bucket before giving up
+     */
+    static constexpr uint32_t MAX_SEED = 1u << 16;
+
+    constexpr FrozenMap( const value_type ( &list )[ N ] ) :
+        mSeeds{}, mKeys{}, mValues{}, mUsed{}, mEmpty{}, mValid( false )
+    {
+      /*-----------------------------------------------------------------------
+      Counting sort the entries by their bucket
+      -----------------------------------------------------------------------*/
+      std::array<size_t, TABLE_SIZE + 1> offsets{};
+      for ( size_t x = 0; x < N; x++ )
+      {
+        offsets[ bucketOf( list[ x ].first ) + 1 ]++;
+      }
+
+      size_t largest = 0;
+      for ( size_t b = 0; b < TABLE_SIZE; b++ )
+      {
+        largest = ( offsets[ b + 1 ] > largest ) ? offsets[ b + 1 ] : largest;
+        offsets[ b + 1 ] += offsets[ b ];
+      }
+
+      std::array<size_t, N>          order{};
+      std::array<size_t, TABLE_SIZE> fill{};
+      for ( size_t x = 0; x < N; x++ )
+      {
+        const size_t b                    = bucketOf( list[ x ].first );
+        order[ offsets[ b ] + fill[ b ] ] = x;
+        fill[ b ]++;
+      }
+
+      /*-----------------------------------------------------------------------
+      Place the most crowded buckets first while the table is still sparse
+      -----------------------------------------------------------------------*/
+      std::array<size_t, N> slots{};
+      for ( size_t count = largest; count > 0; count-- )
+      {
+        for ( size_t b = 0; b < TABLE_SIZE; b++ )
+        {
+          const size_t first = offsets[ b ];
+          if ( ( offsets[ b + 1 ] - first ) != count )
+          {
+            continue;
+          }
+
+          /*-------------------------------------------------------------------
+          Search for a seed that sends every key in the bucket to a free,
+          distinct slot. Equal keys can never be separated.
+          -------------------------------------------------------------------*/
+          uint32_t seed = 1;
+          for ( ; seed < MAX_SEED; seed++ )
+          {
+            bool fits = true;
+            for ( size_t i = 0; fits && ( i < count ); i++ )
+            {
+              const K key = list[ order[ first + i ] ].first;
+              slots[ i ]  = slotOf( key, seed );
+              fits        = !mUsed[ slots[ i ] ];
+
+              for ( size_t j = 0; fits && ( j < i ); j++ )
+              {
+                if ( list[ order[ first + j ] ].first == key )
+                {
+                  Internal::frozen_map_construction_failed();
+                  return;
+                }
+
+                fits = ( slots[ j ] != slots[ i ] );
+              }
+            }
+
+            if ( fits )
+            {
+              break;
+            }
+          }
+
+          if ( seed >= MAX_SEED )
+          {
+            Internal::frozen_map_construction_failed();
+            return;
+          }
+
+          mSeeds[ b ] = seed;
+          for ( size_t i = 0; i < count; i++ )
+          {
+            const size_t entry    = order[ first + i ];
+            mKeys[ slots[ i ] ]   = list[ entry ].first;
+            mValues[ slots[ i ] ] = list[ entry ].second;
+            mUsed[ slots[ i ] ]   = true;
+          }
+        }
+      }
+
+      mValid = true;
+    }
+
+    /**
+     *  Looks up the value associated with a key. If the key does not
+     *  exist in the map, an empty value (zero initialized) will be
+     *  returned instead.
+     *
+     *  @param[in]  key   The key to search for
+     *  @return V         The key's value if it exists
+     */
+    constexpr V operator[]( const K &key ) const
+    {
+      const V *value = find( key );
+      return value ? *value : V{};
+    }
+
+    /**
+     *  Looks up the value associated with a key
+     *
+     *  @param[in]  key   The key to search for
+     *  @return const V&  The key's value, or an empty value if it doesn't exist
+     */
+    constexpr const V &at( const K &key ) const
+    {
+      const V *value = find( key );
+      return value ? *value : mEmpty;
+    }
+
+    /**
+     *  Looks up the value associated with a key
+     *
+     *  @param[in]  key   The key to search for
+     *  @return const V*  Pointer to the value, or nullptr if it doesn't exist
+     */
+    constexpr const V *find( const K &key ) const
+    {
+      const size_t slot = slotOf( key, mSeeds[ bucketOf( key ) ] );
+      return ( mUsed[ slot ] && ( mKeys[ slot ] == key ) ) ? &mValues[ slot ] : nullptr;
+    }
+
+    /**
+     *  Looks up the key associated with a given value. Linear search.
+     *
+     *  @param[in]  value     The value to search for
+     *  @return const K*      Pointer to the key, or nullptr if it doesn't exist
+     */
+    constexpr const K *findWithValue( const V &value ) const
+    {
+      for ( size_t x = 0; x < TABLE_SIZE; x++ )
+      {
+        if ( mUsed[ x ] && ( mValues[ x ] == value ) )
+        {
+          return &mKeys[ x ];
+        }
+      }
+
+      return nullptr;
+    }
+
+    /**
+     *  Checks to see if the given key exists in the map
+     *
+     *  @param[in]  key       The key to lookup
+     *  @return bool
+     */
+    constexpr bool exists( const K &key ) const
+    {
+      return find( key ) != nullptr;
+    }
+
+    /**
+     *  Number of entries in the map
+     *
+     *  @return size_t
+     */
+    constexpr size_t size() const
+    {
+      return N;
+    }
+
+    /**
+     *  Whether a perfect hash was found for the table. Only relevant if the
+     *  map was built at runtime; constant evaluation fails to compile instead.
+     *
+     *  @return bool
+     */
+    constexpr bool valid() const
+    {
+      return mValid;
+    }
+
+  private:
+    std::array<uint32_t, TABLE_SIZE> mSeeds;  /**< Per-bucket displacement seed */
+    std::array<K, TABLE_SIZE>        mKeys;   /**< Slot keys */
+    std::array<V, TABLE_SIZE>        mValues; /**< Slot values */
+    std::array<bool, TABLE_SIZE>     mUsed;   /**< Slot occupancy */
+    V                                mEmpty;  /**< Returned from at() on a miss */
+    bool                             mValid;  /**< Construction succeeded */
+
+    static constexpr uint64_t toBits( const K &key )
+    {
+      if constexpr ( std::is_enum_v<K> )
+      {
+        return static_cast<uint64_t>( static_cast<std::underlying_type_t<K>>( key ) );
+      }
+      else
+      {
+        return static_cast<uint64_t>( key );
+      }
+    }
+
+    static constexpr size_t bucketOf( const K &key )
+    {
+      return static_cast<size_t>( Internal::frozenHash( toBits( key ), 0 ) & ( TABLE_SIZE - 1 ) );
+    }
+
+    static constexpr size_t slotOf( const K &key, const uint32_t seed )
+    {
+      return static_cast<size_t>( Internal::frozenHash( toBits( key ), seed ) & ( TABLE_SIZE - 1 ) );
+    }
+  };
+
+
+  /**
+   *  Builds a FrozenMap from a braced list, deducing the entry count
+   *
+   *  @param[in]  list      Key-value pairs to store
+   *  @return FrozenMap<K, V, N>
+   */
+  template<typename K, typename V, size_t N>
+  constexpr FrozenMap<K, V, N> makeFrozenMap( const std::pair<K, V> ( &list )[ N ] )
+  {
+    return FrozenMap<K, V, N>( list );
+  }
+}  // namespace Chimera::Container
+
+#endif /* !CHIMERA_CONTAINER_FROZEN_MAP_HPP */
@@ -0,0 +1,338 @@
+/******************************************************************************
+ *  File Name:
+ *    container_mpmc_queue.hpp
+ *
+ *  Description:
+ *    Bounded lock-free multi-producer/multi-consumer queue
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_CONTAINER_MPMC_QUEUE_HPP
+#define CHIMERA_CONTAINER_MPMC_QUEUE_HPP
+
+/* STL Includes */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Alignment used to keep the producer and consumer indices of lock-free
+containers out of each other's cache lines. Cortex-M parts have no
+coherent data cache to protect, so only native builds pay for it.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CACHE_LINE_SIZE
+#if defined( USING_NATIVE_THREADS )
+#define CHIMERA_CACHE_LINE_SIZE ( 64 )
+#else
+#define CHIMERA_CACHE_LINE_SIZE ( alignof( size_t ) )
+#endif
+#endif
+
+namespace Chimera::Container
+{
+  /**
+   *  Bounded queue safe for any number of concurrent producers and consumers,
+   *  including ISRs, without locks or interrupt masking. Based on Dmitry
+   *  Vyukov's design: each cell carries a sequence number telling producers
+   *  and consumers whether it is ready for them, so the only contended
+   *  operation is a CAS on the head or tail index.
+   *
+   *  No operation blocks. A push into a full queue, or a pop from an empty
+   *  one, fails immediately and the caller decides what to do about it.
+   *
+   *  @note Requires lock-free std::atomic<size_t>, which on ARMv6-M (no
+   *        LDREX/STREX) is not available.
+   *
+   *  @tparam T   Element type
+   *  @tparam N   Capacity, must be a power of two
+   */
+  template<typename T, size_t N>
+  class MPMCQueue
+  {
+  public:
+    static_assert( ( N >= 2 ) && ( ( N & ( N - 1 ) ) == 0 ), "MPMCQueue capacity must be a power of two" );
+
+    MPMCQueue() : mEnqueuePos( 0 ), mDequeuePos( 0 )
+    {
+      for ( size_t x = 0; x < N; x++ )
+      {
+        mCells[ x ].sequence.store( x, std::memory_order_relaxed );
+      }
+    }
+
+    ~MPMCQueue()
+    {
+      size_t pos  = 0;
+      Cell  *cell = nullptr;
+      while ( claim( mDequeuePos, 1, pos, cell ) )
+      {
+        reinterpret_cast<T *>( cell->storage )->~T();
+      }
+    }
+
+    MPMCQueue( const MPMCQueue & )            = delete;
+    MPMCQueue &operator=( const MPMCQueue & ) = delete;
+
+    /**
+     *  Attempts to push a copy of an element
+     *
+     *  @param[in]  item      Element to push
+     *  @return bool          False if the queue was full
+     */
+    bool tryPush( const T &item )
+    {
+      return tryEmplace( item );
+    }
+
+    /**
+     *  Attempts to push an element by moving it in
+     *
+     *  @param[in]  item      Element to push
+     *  @return bool          False if the queue was full
+     */
+    bool tryPush( T &&item )
+    {
+      return tryEmplace( std::move( item ) );
+    }
+
+    /**
+     *  Attempts to construct an element in place at the tail of the queue
+     *
+     *  @param[in]  args      Constructor arguments
+     *  @return bool          False if the queue was full
+     */
+    template<typename... Args>
+    bool tryEmplace( Args &&...args )
+    {
+      size_t pos  = 0;
+      Cell  *cell = nullptr;
+      if ( !claim( mEnqueuePos, 0, pos, cell ) )
+      {
+        return false;
+      }
+
+      new ( cell->storage ) T( std::forward<Args>( args )... );
+      cell->sequence.store( pos + 1, std::memory_order_release );
+      return true;
+    }
+
+    /**
+     *  Attempts to pop the element at the head of the queue
+     *
+     *  @param[out] item      Receives the element
+     *  @return bool          False if the queue was empty
+     */
+    bool tryPop( T &item )
+    {
+      size_t pos  = 0;
+      Cell  *cell = nullptr;
+      if ( !claim( mDequeuePos, 1, pos, cell ) )
+      {
+        return false;
+      }
+
+      T *ptr = reinterpret_cast<T *>( cell->storage );
+      item   = std::move( *ptr );
+      ptr->~T();
+      cell->sequence.store( pos + N, std::memory_order_release );
+      return true;
+    }
+
+    /**
+     *  Pushes as many elements as will currently fit. The cells are claimed
+     *  with a single CAS, so the elements land contiguously in the queue and
+     *  won't be interleaved with those of other producers.
+     *
+     *  @param[in]  items     Elements to push
+     *  @param[in]  count     Number of elements
+     *  @return size_t        Number of elements actually pushed
+     */
+    size_t pushBulk( const T *const items, const size_t count )
+    {
+      size_t first   = 0;
+      size_t claimed = claimBulk( mEnqueuePos, 0, count, first );
+
+      for ( size_t x = 0; x < claimed; x++ )
+      {
+        Cell &cell = mCells[ ( first + x ) & MASK ];
+        new ( cell.storage ) T( items[ x ] );
+        cell.sequence.store( first + x + 1, std::memory_order_release );
+      }
+
+      return claimed;
+    }
+
+    /**
+     *  Pops up to count elements in a single claim
+     *
+     *  @param[out] items     Receives the elements
+     *  @param[in]  count     Maximum number of elements to pop
+     *  @return size_t        Number of elements actually popped
+     */
+    size_t popBulk( T *const items, const size_t count )
+    {
+      size_t first   = 0;
+      size_t claimed = claimBulk( mDequeuePos, 1, count, first );
+
+      for ( size_t x = 0; x < claimed; x++ )
+      {
+        Cell &cell = mCells[ ( first + x ) & MASK ];
+        T    *ptr  = reinterpret_cast<T *>( cell.storage );
+
+        items[ x ] = std::move( *ptr );
+        ptr->~T();
+        cell.sequence.store( first + x + N, std::memory_order_release );
+      }
+
+      return claimed;
+    }
+
+    /**
+     *  Approximate number of elements in the queue. Exact only when no other
+     *  thread is pushing or popping.
+     *
+     *  @return size_t
+     */
+    size_t sizeApprox() const
+    {
+      const size_t tail = mEnqueuePos.load( std::memory_order_relaxed );
+      const size_t head = mDequeuePos.load( std::memory_order_relaxed );
+      return ( tail > head ) ? ( tail - head ) : 0;
+    }
+
+    /**
+     *  Approximate check for an empty queue
+     *
+     *  @return bool
+     */
+    bool emptyApprox() const
+    {
+      return sizeApprox() == 0;
+    }
+
+    /**
+     *  Maximum number of elements the queue can hold
+     *
+     *  @return size_t
+     */
+    static constexpr size_t capacity()
+    {
+      return N;
+    }
+
+  private:
+    static constexpr size_t MASK = N - 1;
+
+    struct Cell
+    {
+      std::atomic<size_t> sequence;
+      alignas( T ) unsigned char storage[ sizeof( T ) ];
+    };
+
+    alignas( CHIMERA_CACHE_LINE_SIZE ) Cell mCells[ N ];
+    alignas( CHIMERA_CACHE_LINE_SIZE ) std::atomic<size_t> mEnqueuePos;
+    alignas( CHIMERA_CACHE_LINE_SIZE ) std::atomic<size_t> mDequeuePos;
+
+    /**
+     *  Claims a single cell. A cell at position pos is ready for producers
+     *  when its sequence equals pos and for consumers when it equals pos + 1.
+     *
+     *  @param[in]  index     Producer or consumer index to advance
+     *  @param[in]  offset    0 for producers, 1 for consumers
+     *  @param[out] pos       Claimed position
+     *  @param[out] cell      Claimed cell
+     *  @return bool          False if the queue was full (or empty)
+     */
+    bool claim( std::atomic<size_t> &index, const size_t offset, size_t &pos, Cell *&cell )
+    {
+      pos = index.load( std::memory_order_relaxed );
+
+      while ( true )
+      {
+        cell                = &mCells[ pos & MASK ];
+        const size_t   seq  = cell->sequence.load( std::memory_order_acquire );
+        const intptr_t diff = static_cast<intptr_t>( seq ) - static_cast<intptr_t>( pos + offset );
+
+        if ( diff == 0 )
+        {
+          if ( index.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+          {
+            return true;
+          }
+        }
+        else if ( diff < 0 )
+        {
+          return false;
+        }
+        else
+        {
+          pos = index.load( std::memory_order_relaxed );
+        }
+      }
+    }
+
+    /**
+     *  Claims up to count consecutive cells. A cell that is ready can only be
+     *  taken by whoever advances the index past it, so checking readiness and
+     *  then CAS'ing the index over the whole run is safe.
+     *
+     *  @param[in]  index     Producer or consumer index to advance
+     *  @param[in]  offset    0 for producers, 1 for consumers
+     *  @param[in]  count     Maximum cells to claim
+     *  @param[out] first     First claimed position
+     *  @return size_t        Number of cells claimed
+     */
+    size_t claimBulk( std::atomic<size_t> &index, const size_t offset, const size_t count, size_t &first )
+    {
+      first = index.load( std::memory_order_relaxed );
+
+      while ( true )
+      {
+        size_t ready = 0;
+        while ( ( ready < count ) && ( ready < N ) )
+        {
+          const size_t pos = first + ready;
+          const size_t seq = mCells[ pos & MASK ].sequence.load( std::memory_order_acquire );
+          if ( seq != ( pos + offset ) )
+          {
+            break;
+          }
+
+          ready++;
+        }
+
+        if ( !ready )
+        {
+          /*-------------------------------------------------------------------
+          Either the queue is full/empty, or another thread already moved the
+          index past the first cell. Only retry in the latter case.
+          -------------------------------------------------------------------*/
+          const size_t seq  = mCells[ first & MASK ].sequence.load( std::memory_order_acquire );
+          const auto   diff = static_cast<intptr_t>( seq ) - static_cast<intptr_t>( first + offset );
+          if ( diff < 0 )
+          {
+            return 0;
+          }
+
+          first = index.load( std::memory_order_relaxed );
+          continue;
+        }
+
+        if ( index.compare_exchange_weak( first, first + ready, std::memory_order_relaxed ) )
+        {
+          return ready;
+        }
+      }
+    }
+  };
+}  // namespace Chimera::Container
+
+#endif /* !CHIMERA_CONTAINER_MPMC_QUEUE_HPP */
@@ -0,0 +1,197 @@
+/******************************************************************************
+ *  File Name:
+ *    container_sorted_map.hpp
+ *
+ *  Description:
+ *    Flat map kept in key order for logarithmic lookups
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_CONTAINER_SORTED_MAP_HPP
+#define CHIMERA_CONTAINER_SORTED_MAP_HPP
+
+/* STL Includes */
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace Chimera::Container
+{
+  /**
+   *  Drop-in alternative to LightFlatMap for tables that are too large for a
+   *  linear scan. Entries are kept sorted by key in contiguous storage, so a
+   *  lookup is a binary search with good cache behavior and no per-node
+   *  allocation. Inserting is O(n) as later entries shift, which is fine for
+   *  the build-once, read-often tables this is meant for.
+   *
+   *  Duplicate keys are permitted. Lookups resolve to the entry that was
+   *  appended first, matching LightFlatMap.
+   */
+  template<typename T1, typename T2, typename Compare = std::less<T1>>
+  class SortedFlatMap
+  {
+  public:
+    using value_type = std::pair<T1, T2>;
+
+    SortedFlatMap() : emptyObj( {} )
+    {
+    }
+
+    SortedFlatMap( std::initializer_list<value_type> list ) : map( list ), emptyObj( {} )
+    {
+      std::stable_sort( map.begin(), map.end(),
+                        []( const value_type &lhs, const value_type &rhs ) { return Compare{}( lhs.first, rhs.first ); } );
+    }
+
+    /**
+     *  Looks up the value associated with a key. If the key does not
+     *  exist in the map, an empty value (zero initialized) will be
+     *  returned instead.
+     *
+     *  @note No insertion operation is permitted by design
+     *
+     *  @param[in]  key   The key to search for
+     *  @return T2        The key's value if it exists
+     */
+    T2 operator[]( const T1 &key ) const
+    {
+      const auto iter = find( key );
+      return ( iter != map.end() ) ? iter->second : T2{};
+    }
+
+    /**
+     *  Looks up the key-value pair associated with a given key
+     *
+     *  @param[in]  key   The key to search for
+     *  @return std::pair<T1,T2>
+     */
+    value_type &at( const T1 &key )
+    {
+      const auto iter = find( key );
+      return ( iter != map.end() ) ? *( map.begin() + ( iter - map.cbegin() ) ) : emptyObj;
+    }
+
+    const value_type &at( const T1 &key ) const
+    {
+      const auto iter = find( key );
+      return ( iter != map.end() ) ? *iter : emptyObj;
+    }
+
+    /**
+     *  Looks up the key-value pair associated with a given value. Values
+     *  aren't ordered, so this is a linear search.
+     *
+     *  @param[in]  value     The value to search for
+     *  @return std::pair<T1,T2>
+     */
+    value_type *findWithValue( const T2 &value )
+    {
+      for ( auto &entry : map )
+      {
+        if ( entry.second == value )
+        {
+          return &entry;
+        }
+      }
+
+      return nullptr;
+    }
+
+    /**
+     *  Checks to see if the given key exists in the map. If it does, will
+     *  return true. Optionally can request that the key/value pair be returned
+     *  to the caller via an argument.
+     *
+     *  @param[in]  key       The key to lookup
+     *  @param[in]  element   The key-value pair element associated with the key
+     *  @return bool
+     */
+    bool exists( const T1 &key, value_type **element = nullptr )
+    {
+      auto &tmp   = at( key );
+      auto result = static_cast<bool>( &tmp != &emptyObj );
+
+      if ( element )
+      {
+        *element = result ? &tmp : nullptr;
+      }
+
+      return result;
+    }
+
+    /**
+     *  Constructs a new key-value pair and inserts it in key order
+     *
+     *  @param[in]  key     The key to lookup
+     *  @param[in]  value   The new value to assign
+     *  @return void
+     */
+    void append( const T1 &key, const T2 &value )
+    {
+      const auto pos = std::upper_bound( map.begin(), map.end(), key,
+                                         []( const T1 &lhs, const value_type &rhs ) { return Compare{}( lhs, rhs.first ); } );
+      map.insert( pos, { key, value } );
+    }
+
+    /**
+     *  Assigns an existing entry in the map and updates its value
+     *
+     *  @param[in]  key     The key to lookup
+     *  @param[in]  value   The new value to assign
+     *  @return void
+     */
+    void assign( const T1 &key, const T2 &value )
+    {
+      auto &tmp = at( key );
+
+      if ( &tmp != &emptyObj )
+      {
+        tmp.second = value;
+      }
+    }
+
+    /**
+     *  Pre-allocates storage for a number of entries
+     *
+     *  @param[in]  count   Number of entries to make room for
+     *  @return void
+     */
+    void reserve( const size_t count )
+    {
+      map.reserve( count );
+    }
+
+    /**
+     *  The size of the underlying container
+     *
+     *  @return size_t
+     */
+    size_t size() const
+    {
+      return map.size();
+    }
+
+  private:
+    std::vector<value_type> map;
+    value_type              emptyObj;
+
+    typename std::vector<value_type>::const_iterator find( const T1 &key ) const
+    {
+      const auto iter = std::lower_bound( map.begin(), map.end(), key,
+                                          []( const value_type &lhs, const T1 &rhs ) { return Compare{}( lhs.first, rhs ); } );
+
+      if ( ( iter != map.end() ) && !Compare{}( key, iter->first ) )
+      {
+        return iter;
+      }
+
+      return map.end();
+    }
+  };
+}  // namespace Chimera::Container
+
+#endif /* !CHIMERA_CONTAINER_SORTED_MAP_HPP */
@@ -0,0 +1,427 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_crash.cpp
+ *
+ *  Description:
+ *    Post-mortem snapshot implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#if defined( USING_NATIVE_THREADS )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif /* USING_NATIVE_THREADS */
+
+/* STL Includes */
+#include <atomic>
+#include <cstring>
+
+/* Aurora Includes */
+#include <Aurora/logging>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/crash>
+#include <Chimera/thread>
+#include <Chimera/trace>
+#include <Chimera/source/drivers/threading/common/threading_internal.hpp>
+
+#if defined( USING_FREERTOS_THREADS )
+#include <FreeRTOS/FreeRTOS.h>
+#include <FreeRTOS/task.h>
+#endif /* USING_FREERTOS_THREADS */
+
+namespace Chimera::Crash
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct Store
+  {
+    Snapshot slots[ CHIMERA_CRASH_SLOTS ];
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+#if defined( USING_NATIVE_THREADS )
+  static Store  s_local;
+  static Store *s_store = &s_local;
+#else
+  static Store  s_noinit __attribute__( ( section( CHIMERA_CRASH_SECTION ) ) );
+  static Store *s_store = &s_noinit;
+#endif /* USING_NATIVE_THREADS */
+
+  static std::atomic<bool> s_capturing;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Cheap rotate-xor over every word ahead of the checksum field. It only has
+   *  to catch uninitialized RAM and torn writes, not adversaries.
+   */
+  static uint32_t checksum( const Snapshot &snapshot )
+  {
+    static_assert( ( offsetof( Snapshot, checksum ) % sizeof( uint32_t ) ) == 0 );
+
+    const auto *const raw   = reinterpret_cast<const uint8_t *>( &snapshot );
+    uint32_t          value = SNAPSHOT_MAGIC;
+
+    for ( size_t x = 0; x < offsetof( Snapshot, checksum ); x += sizeof( uint32_t ) )
+    {
+      uint32_t word;
+      memcpy( &word, raw + x, sizeof( word ) );
+      value = ( ( value << 5 ) | ( value >> 27 ) ) ^ word;
+    }
+
+    return value;
+  }
+
+
+  static bool isValid( const Snapshot &snapshot )
+  {
+    return ( snapshot.magic == SNAPSHOT_MAGIC ) && ( snapshot.version == SNAPSHOT_VERSION ) &&
+           ( snapshot.size == sizeof( Snapshot ) ) && ( snapshot.checksum == checksum( snapshot ) );
+  }
+
+
+  /**
+   *  Slot index holding the n'th most recent valid snapshot, or
+   *  CHIMERA_CRASH_SLOTS if there isn't one
+   */
+  static size_t slotByAge( const size_t age )
+  {
+    size_t order[ CHIMERA_CRASH_SLOTS ];
+    size_t valid = 0;
+
+    for ( size_t x = 0; x < CHIMERA_CRASH_SLOTS; x++ )
+    {
+      if ( !isValid( s_store->slots[ x ] ) )
+      {
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Insertion sort, newest first. There are only a handful of slots.
+      -----------------------------------------------------------------------*/
+      size_t pos = valid++;
+      while ( ( pos > 0 ) && ( s_store->slots[ order[ pos - 1 ] ].sequence < s_store->slots[ x ].sequence ) )
+      {
+        order[ pos ] = order[ pos - 1 ];
+        pos--;
+      }
+      order[ pos ] = x;
+    }
+
+    return ( age < valid ) ? order[ age ] : CHIMERA_CRASH_SLOTS;
+  }
+
+
+  static TaskState taskState( Chimera::Thread::Task &task )
+  {
+#if defined( USING_NATIVE_THREADS )
+    if ( task.native_id() == std::this_thread::get_id() )
+    {
+      return TaskState::RUNNING;
+    }
+
+    return task.joinable() ? TaskState::READY : TaskState::DELETED;
+
+#elif defined( USING_FREERTOS_THREADS )
+    TaskHandle_t handle = task.native_handle();
+    if ( !handle )
+    {
+      return TaskState::UNKNOWN;
+    }
+
+    if ( handle == xTaskGetCurrentTaskHandle() )
+    {
+      return TaskState::RUNNING;
+    }
+
+    switch ( eTaskGetState( handle ) )
+    {
+      case eRunning:
+        return TaskState::RUNNING;
+
+      case eReady:
+        return TaskState::READY;
+
+      case eBlocked:
+        return TaskState::BLOCKED;
+
+      case eSuspended:
+        return TaskState::SUSPENDED;
+
+      case eDeleted:
+        return TaskState::DELETED;
+
+      default:
+        return TaskState::UNKNOWN;
+    }
+
+#else
+    ( void )task;
+    return TaskState::UNKNOWN;
+#endif
+  }
+
+
+  static const char *stateName( const TaskState state )
+  {
+    switch ( state )
+    {
+      case TaskState::RUNNING:
+        return "running";
+
+      case TaskState::READY:
+        return "ready";
+
+      case TaskState::BLOCKED:
+        return "blocked";
+
+      case TaskState::SUSPENDED:
+        return "suspended";
+
+      case TaskState::DELETED:
+        return "deleted";
+
+      default:
+        return "unknown";
+    }
+  }
+
+  /*---------------------------------------------------------------------------
+  Backend Hooks
+  ---------------------------------------------------------------------------*/
+  namespace Backend
+  {
+    void __attribute__( ( weak ) ) captureRegisters( const void *const pc, uintptr_t ( &registers )[ NUM_REGISTERS ] )
+    {
+      registers[ REG_PC ] = reinterpret_cast<uintptr_t>( pc );
+      registers[ REG_SP ] = reinterpret_cast<uintptr_t>( __builtin_frame_address( 0 ) );
+    }
+  }  // namespace Backend
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  Chimera::Status_t initialize()
+  {
+#if defined( USING_NATIVE_THREADS )
+    if ( s_store != &s_local )
+    {
+      return Chimera::Status::OK;
+    }
+
+    const int fd = open( CHIMERA_CRASH_FILE, O_RDWR | O_CREAT, 0644 );
+    if ( fd < 0 )
+    {
+      return Chimera::Status::FAIL;
+    }
+
+    /*-------------------------------------------------------------------------
+    A shared mapping lands in the page cache as it's written, so the snapshot
+    is on disk even if the process dies right after capturing it.
+    -------------------------------------------------------------------------*/
+    void *mapping = MAP_FAILED;
+    if ( ftruncate( fd, sizeof( Store ) ) == 0 )
+    {
+      mapping = mmap( nullptr, sizeof( Store ), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    }
+    close( fd );
+
+    if ( mapping == MAP_FAILED )
+    {
+      return Chimera::Status::FAIL;
+    }
+
+    s_store = static_cast<Store *>( mapping );
+#endif /* USING_NATIVE_THREADS */
+
+    return Chimera::Status::OK;
+  }
+
+
+  void capture( const char *const file, const uint32_t line, const void *const pc )
+  {
+    using namespace Chimera::Thread;
+
+    /*-------------------------------------------------------------------------
+    Only the first failure gets recorded if several race to the reset
+    -------------------------------------------------------------------------*/
+    if ( s_capturing.exchange( true, std::memory_order_acquire ) )
+    {
+      return;
+    }
+
+    /*-------------------------------------------------------------------------
+    Slot 0 keeps the first failure since the last clear(). Later ones rotate
+    through the rest, filling an empty slot first, otherwise the oldest.
+    -------------------------------------------------------------------------*/
+    const bool pinned = isValid( s_store->slots[ 0 ] );
+    size_t     target = 0;
+    uint32_t   oldest = UINT32_MAX;
+    uint32_t   newest = pinned ? s_store->slots[ 0 ].sequence : 0;
+
+    for ( size_t x = 1; x < CHIMERA_CRASH_SLOTS; x++ )
+    {
+      const Snapshot &slot     = s_store->slots[ x ];
+      const uint32_t  sequence = isValid( slot ) ? slot.sequence : 0;
+
+      if ( pinned && ( sequence < oldest ) )
+      {
+        oldest = sequence;
+        target = x;
+      }
+
+      newest = ( sequence > newest ) ? sequence : newest;
+    }
+
+    /*-------------------------------------------------------------------------
+    With a single slot there is nowhere to rotate, so the first failure stays
+    -------------------------------------------------------------------------*/
+    if ( pinned && ( CHIMERA_CRASH_SLOTS == 1 ) )
+    {
+      s_capturing.store( false, std::memory_order_release );
+      return;
+    }
+
+    Snapshot &record = s_store->slots[ target ];
+
+    memset( &record, 0, sizeof( record ) );
+    record.sequence  = newest + 1;
+    record.timestamp = static_cast<uint32_t>( Chimera::micros() );
+    record.line      = line;
+    record.taskId    = static_cast<uint32_t>( THREAD_ID_INVALID );
+
+    if ( file )
+    {
+      strncpy( record.file, file, sizeof( record.file ) - 1 );
+    }
+
+    /*-------------------------------------------------------------------------
+    Registers
+    -------------------------------------------------------------------------*/
+    Backend::captureRegisters( pc, record.registers );
+
+    /*-------------------------------------------------------------------------
+    Tasks. The registry lock may be held by whoever failed, so walk it bare.
+    -------------------------------------------------------------------------*/
+    for ( size_t x = 0; x < CHIMERA_CRASH_MAX_TASKS; x++ )
+    {
+      Task *task = peekThread( x );
+      if ( !task )
+      {
+        break;
+      }
+
+      TaskRecord &info = record.tasks[ record.taskCount++ ];
+      info.id          = static_cast<uint32_t>( task->id() );
+      info.priority    = static_cast<uint16_t>( task->priority() );
+      info.state       = taskState( *task );
+
+      const std::string_view name = task->name();
+      memcpy( info.name, name.data(), ( name.size() < TASK_NAME_LEN ) ? name.size() : ( TASK_NAME_LEN - 1 ) );
+
+      if ( info.state == TaskState::RUNNING )
+      {
+        record.taskId = info.id;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    Trace history leading up to the failure
+    -------------------------------------------------------------------------*/
+    const size_t events = Trace::collect( CHIMERA_TRACE_CORE_ID(), record.trace, CHIMERA_CRASH_TRACE_EVENTS );
+    record.traceCount   = static_cast<uint32_t>( events );
+
+    /*-------------------------------------------------------------------------
+    Seal it. The magic goes last so a capture cut short stays invalid.
+    -------------------------------------------------------------------------*/
+    record.version  = SNAPSHOT_VERSION;
+    record.size     = sizeof( Snapshot );
+    record.magic    = SNAPSHOT_MAGIC;
+    record.checksum = checksum( record );
+
+    s_capturing.store( false, std::memory_order_release );
+  }
+
+
+  size_t count()
+  {
+    size_t valid = 0;
+    for ( size_t x = 0; x < CHIMERA_CRASH_SLOTS; x++ )
+    {
+      valid += isValid( s_store->slots[ x ] ) ? 1 : 0;
+    }
+
+    return valid;
+  }
+
+
+  bool retrieve( const size_t index, Snapshot &snapshot )
+  {
+    const size_t slot = slotByAge( index );
+    if ( slot >= CHIMERA_CRASH_SLOTS )
+    {
+      return false;
+    }
+
+    memcpy( &snapshot, &s_store->slots[ slot ], sizeof( snapshot ) );
+    return true;
+  }
+
+
+  void clear()
+  {
+    memset( s_store, 0, sizeof( Store ) );
+  }
+
+
+  size_t report()
+  {
+    const size_t total = count();
+
+    for ( size_t x = 0; x < total; x++ )
+    {
+      const Snapshot &snap = s_store->slots[ slotByAge( x ) ];
+
+      LOG_ERROR( "Crash #%u -- %s, Line: %u, Time: %u us, Task: %u\r\n", static_cast<unsigned>( snap.sequence ), snap.file,
+                 static_cast<unsigned>( snap.line ), static_cast<unsigned>( snap.timestamp ),
+                 static_cast<unsigned>( snap.taskId ) );
+
+      const auto reg = [ &snap ]( const size_t r ) { return static_cast<unsigned long>( snap.registers[ r ] ); };
+
+      for ( size_t r = REG_R0; r < REG_R12; r += 4 )
+      {
+        LOG_ERROR( "  R%u-R%u: 0x%08lx 0x%08lx 0x%08lx 0x%08lx\r\n", static_cast<unsigned>( r ), static_cast<unsigned>( r + 3 ),
+                   reg( r ), reg( r + 1 ), reg( r + 2 ), reg( r + 3 ) );
+      }
+
+      LOG_ERROR( "  R12: 0x%08lx, SP: 0x%08lx, LR: 0x%08lx, PC: 0x%08lx, PSR: 0x%08lx\r\n", reg( REG_R12 ), reg( REG_SP ),
+                 reg( REG_LR ), reg( REG_PC ), reg( REG_PSR ) );
+
+      for ( size_t t = 0; ( t < snap.taskCount ) && ( t < CHIMERA_CRASH_MAX_TASKS ); t++ )
+      {
+        const TaskRecord &task = snap.tasks[ t ];
+        LOG_ERROR( "  Task %u %.*s, Priority: %u, State: %s\r\n", static_cast<unsigned>( task.id ),
+                   static_cast<int>( TASK_NAME_LEN ), task.name, static_cast<unsigned>( task.priority ),
+                   stateName( task.state ) );
+      }
+
+      for ( size_t e = 0; ( e < snap.traceCount ) && ( e < CHIMERA_CRASH_TRACE_EVENTS ); e++ )
+      {
+        const Trace::Entry &entry = snap.trace[ e ];
+        LOG_ERROR( "  Trace %u us, Event: 0x%x, Arg: %u\r\n", static_cast<unsigned>( entry.timestamp ),
+                   static_cast<unsigned>( entry.event ), static_cast<unsigned>( entry.arg ) );
+      }
+    }
+
+    return total;
+  }
+
+}  // namespace Chimera::Crash
@@ -0,0 +1,104 @@
+/******************************************************************************
+ *  File Name:
+ *    crash.hpp
+ *
+ *  Description:
+ *    Post-mortem snapshots that survive a software reset
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_CRASH_HPP
+#define CHIMERA_CRASH_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/crash/crash_types.hpp>
+
+namespace Chimera::Crash
+{
+  /*---------------------------------------------------------------------------
+  Backend Hooks
+  ---------------------------------------------------------------------------*/
+  namespace Backend
+  {
+    /**
+     *  Fills in the register snapshot. The weak default only knows the stack
+     *  and the failing address; ports with access to the exception frame
+     *  should override it.
+     *
+     *  @param[in]  pc          Address of the failing call site
+     *  @param[out] registers   Register slots, already zeroed
+     *  @return void
+     */
+    void captureRegisters( const void *const pc, uintptr_t ( &registers )[ NUM_REGISTERS ] );
+  }  // namespace Backend
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Attaches the snapshot storage and validates what the previous boot left
+   *  behind. Call early, before anything can fail. On native builds this maps
+   *  CHIMERA_CRASH_FILE; until then captures go to a process local buffer.
+   *
+   *  @return Chimera::Status_t
+   *
+   *  |   Return Value   |              Explanation              |
+   *  |:----------------:|:-------------------------------------:|
+   *  |               OK | Storage is attached                   |
+   *  |             FAIL | The native backing file wasn't usable |
+   */
+  Chimera::Status_t initialize();
+
+  /**
+   *  Records the state of the system. The first snapshot since clear() is
+   *  kept, and later ones replace the oldest of the others. Takes no locks,
+   *  allocates nothing and formats nothing, so it is safe from fault handlers
+   *  and adds only a few microseconds before a reset.
+   *
+   *  @param[in]  file        Failing file
+   *  @param[in]  line        Failing line
+   *  @param[in]  pc          Address of the failing call site
+   *  @return void
+   */
+  void capture( const char *const file, const uint32_t line, const void *const pc );
+
+  /**
+   *  Number of valid snapshots in storage
+   *
+   *  @return size_t
+   */
+  size_t count();
+
+  /**
+   *  Copies a snapshot out of storage
+   *
+   *  @param[in]  index       0 for the most recent, count() - 1 for the oldest
+   *  @param[out] snapshot    Receives the snapshot
+   *  @return bool            False if no snapshot exists at that index
+   */
+  bool retrieve( const size_t index, Snapshot &snapshot );
+
+  /**
+   *  Invalidates every stored snapshot, usually once they've been reported
+   *
+   *  @return void
+   */
+  void clear();
+
+  /**
+   *  Logs a human readable decode of each stored snapshot, most recent first
+   *
+   *  @return size_t          Number of snapshots reported
+   */
+  size_t report();
+
+}  // namespace Chimera::Crash
+
+#endif /* !CHIMERA_CRASH_HPP */
@@ -0,0 +1,159 @@
+/******************************************************************************
+ *  File Name:
+ *    crash_types.hpp
+ *
+ *  Description:
+ *    Post-mortem snapshot layout
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_CRASH_TYPES_HPP
+#define CHIMERA_CRASH_TYPES_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* Chimera Includes */
+#include <Chimera/source/drivers/trace/trace_types.hpp>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Snapshots kept in the reserved region. Slot 0 holds the first failure
+until Chimera::Crash::clear(), and later ones overwrite the oldest of
+the rest. Two keeps the original and the latest failure through a
+crash loop. One keeps only the original.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CRASH_SLOTS
+#define CHIMERA_CRASH_SLOTS ( 2 )
+#endif
+
+/*-------------------------------------------------------------------
+Most recent trace events copied into a snapshot
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CRASH_TRACE_EVENTS
+#define CHIMERA_CRASH_TRACE_EVENTS ( 32 )
+#endif
+
+/*-------------------------------------------------------------------
+Registered tasks whose state is recorded
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CRASH_MAX_TASKS
+#define CHIMERA_CRASH_MAX_TASKS ( 8 )
+#endif
+
+/*-------------------------------------------------------------------
+Characters of the failing file name kept, including the null
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CRASH_FILE_NAME
+#define CHIMERA_CRASH_FILE_NAME ( 32 )
+#endif
+
+/*-------------------------------------------------------------------
+Linker section holding the snapshots on embedded targets. It must be
+NOLOAD and outside of .bss so the startup code leaves it alone:
+
+  .noinit (NOLOAD) : { *(.noinit*) } > RAM
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CRASH_SECTION
+#define CHIMERA_CRASH_SECTION ".noinit"
+#endif
+
+/*-------------------------------------------------------------------
+File backing the snapshots on native builds
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_CRASH_FILE
+#define CHIMERA_CRASH_FILE "chimera_crash.bin"
+#endif
+
+namespace Chimera::Crash
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint32_t SNAPSHOT_MAGIC   = 0x43525348; /**< "CRSH" */
+  static constexpr uint16_t SNAPSHOT_VERSION = 1;
+  static constexpr size_t   TASK_NAME_LEN    = 16;
+
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Register slots. Named after the Cortex-M exception frame; other ports
+   *  use the slots that make sense for them.
+   */
+  enum Register : uint8_t
+  {
+    REG_R0,
+    REG_R1,
+    REG_R2,
+    REG_R3,
+    REG_R4,
+    REG_R5,
+    REG_R6,
+    REG_R7,
+    REG_R8,
+    REG_R9,
+    REG_R10,
+    REG_R11,
+    REG_R12,
+    REG_SP,
+    REG_LR,
+    REG_PC,
+    REG_PSR,
+
+    NUM_REGISTERS
+  };
+
+  enum class TaskState : uint8_t
+  {
+    UNKNOWN,
+    RUNNING, /**< The task that failed */
+    READY,
+    BLOCKED,
+    SUSPENDED,
+    DELETED,
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct TaskRecord
+  {
+    uint32_t  id;                    /**< Chimera task id */
+    uint16_t  priority;              /**< Configured priority */
+    TaskState state;                 /**< State when the snapshot was taken */
+    uint8_t   reserved;              /**< Padding */
+    char      name[ TASK_NAME_LEN ]; /**< Null terminated task name */
+  };
+
+  /**
+   *  Everything captured at the point of failure. Plain data only, so it can
+   *  be copied out of reserved RAM or a file and decoded anywhere.
+   */
+  struct Snapshot
+  {
+    uint32_t     magic;                                   /**< SNAPSHOT_MAGIC when the slot is valid */
+    uint16_t     version;                                 /**< SNAPSHOT_VERSION */
+    uint16_t     size;                                    /**< sizeof( Snapshot ) */
+    uint32_t     sequence;                                /**< Increments with every capture, starting at 1 */
+    uint32_t     timestamp;                               /**< Chimera::micros() at capture */
+    uint32_t     line;                                    /**< Failing line */
+    uint32_t     taskId;                                  /**< Id of the failing task, THREAD_ID_INVALID if none */
+    uint32_t     taskCount;                               /**< Valid entries in tasks */
+    uint32_t     traceCount;                              /**< Valid entries in trace */
+    char         file[ CHIMERA_CRASH_FILE_NAME ];         /**< Failing file, null terminated */
+    uintptr_t    registers[ NUM_REGISTERS ];              /**< See Register */
+    TaskRecord   tasks[ CHIMERA_CRASH_MAX_TASKS ];        /**< Registered tasks */
+    Trace::Entry trace[ CHIMERA_CRASH_TRACE_EVENTS ];     /**< Most recent trace events, oldest first */
+    uint32_t     checksum;                                /**< Over everything above */
+  };
+  static_assert( sizeof( Snapshot ) <= UINT16_MAX, "Snapshot no longer fits its size field, shrink the CHIMERA_CRASH_* limits" );
+
+}  // namespace Chimera::Crash
+
+#endif /* !CHIMERA_CRASH_TYPES_HPP */
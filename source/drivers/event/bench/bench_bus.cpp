@@ -0,0 +1,155 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_bus.cpp
+ *
+ *  Description:
+ *    Event bus fan-out throughput at 1, 8 and 64 subscribers. One publisher
+ *    alternates between a topic every subscriber takes and one only half of
+ *    them take, while each subscriber drains on its own thread. Reports
+ *    published events and deliveries per second, and proves every delivered
+ *    message was dispatched.
+ *
+ *    Usage: chimera_event_bus_bench [events]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/* Chimera Includes */
+#include <Chimera/event>
+
+namespace
+{
+  using namespace Chimera::Event;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t MAX_SUBSCRIBERS = 64;
+
+  static constexpr TypedTopic<uint32_t> TOPIC_ALL{ 0x0101'0001 };
+  static constexpr TypedTopic<uint32_t> TOPIC_HALF{ 0x0102'0001 };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct Counter
+  {
+    std::atomic<uint64_t> count{ 0 };
+
+    void onMessage( const Message &msg )
+    {
+      ( void )msg;
+      count.fetch_add( 1, std::memory_order_relaxed );
+    }
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Publishes events to a set of subscribers each draining on its own thread
+   *
+   *  @return bool            False if a delivered message was never dispatched
+   */
+  static bool run( const size_t subscribers, const size_t events )
+  {
+    BasicBus<MAX_SUBSCRIBERS>                bus;
+    std::vector<std::unique_ptr<Subscriber>> subs;
+    std::vector<std::unique_ptr<Counter>>    counters;
+    std::vector<std::thread>                 threads;
+    std::atomic<bool>                        stop( false );
+
+    subs.reserve( subscribers );
+    counters.reserve( subscribers );
+    threads.reserve( subscribers );
+
+    for ( size_t x = 0; x < subscribers; x++ )
+    {
+      subs.emplace_back( std::make_unique<Subscriber>() );
+      counters.emplace_back( std::make_unique<Counter>() );
+
+      /*-----------------------------------------------------------------------
+      Odd subscribers take the whole 0x01xx'xxxx group, even ones only the
+      first topic
+      -----------------------------------------------------------------------*/
+      const TopicId filter = ( x & 1u ) ? 0x0100'0000 : TOPIC_ALL.id;
+      const TopicId mask   = ( x & 1u ) ? 0xFF00'0000 : 0xFFFF'FFFF;
+      subs[ x ]->configure( filter, mask, Subscriber::Callback::create<Counter, &Counter::onMessage>( *counters[ x ] ) );
+      bus.subscribe( *subs[ x ] );
+
+      Subscriber *const sub = subs[ x ].get();
+      threads.emplace_back( [ &stop, sub ]() {
+        while ( !stop.load( std::memory_order_relaxed ) )
+        {
+          sub->wait( Chimera::Thread::TIMEOUT_10MS );
+          sub->dispatch();
+        }
+
+        sub->dispatch();
+      } );
+    }
+
+    size_t     delivered = 0;
+    size_t     dropped   = 0;
+    const auto start     = std::chrono::steady_clock::now();
+    for ( size_t x = 0; x < events; x++ )
+    {
+      const TypedTopic<uint32_t> &topic = ( x & 1u ) ? TOPIC_HALF : TOPIC_ALL;
+      delivered += bus.publish( topic, static_cast<uint32_t>( x ) );
+
+      /*-----------------------------------------------------------------------
+      Give the subscribers a chance to catch up whenever a queue fills
+      -----------------------------------------------------------------------*/
+      if ( bus.dropped() != dropped )
+      {
+        dropped = bus.dropped();
+        std::this_thread::yield();
+      }
+    }
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    stop.store( true );
+    for ( std::thread &thread : threads )
+    {
+      thread.join();
+    }
+
+    uint64_t dispatched = 0;
+    for ( size_t x = 0; x < subscribers; x++ )
+    {
+      dispatched += counters[ x ]->count.load();
+      bus.unsubscribe( *subs[ x ] );
+    }
+
+    printf( "%2zu subscribers  %9.0f events/s  %10.0f deliveries/s  dropped %zu\n", subscribers,
+            static_cast<double>( events ) / seconds, static_cast<double>( delivered ) / seconds, bus.dropped() );
+
+    if ( dispatched != delivered )
+    {
+      printf( "%zu deliveries but %llu dispatched\n", delivered, static_cast<unsigned long long>( dispatched ) );
+      return false;
+    }
+
+    return true;
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t events = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 200000;
+
+  printf( "%zu events per run, queue depth %d\n", events, CHIMERA_EVENT_BUS_QUEUE_DEPTH );
+
+  const bool ok = run( 1, events ) && run( 8, events ) && run( 64, events );
+  return ok ? 0 : 1;
+}
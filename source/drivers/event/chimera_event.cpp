@@ -14,6 +14,7 @@
 /* Chimera Includes */
 #include <Chimera/event>
 #include <Chimera/thread>
+#include <Chimera/trace>
 
 namespace Chimera::Event
 {
@@ -25,6 +26,8 @@ namespace Chimera::Event
 
   bool notifyListener( const Trigger event, Actionable &listener, uint32_t value )
   {
+    CHIMERA_TRACE( EVENT_NOTIFY, event );
+
     switch ( listener.type )
     {
       case ListenerType::LISTENER_ATOMIC:
@@ -50,18 +53,194 @@ namespace Chimera::Event
     }
   }
 
-  bool notifyListenerList( const Trigger event, ActionableList &list, uint32_t value )
+  bool notifyListenerList( const Trigger event, ActionableList &list, uint32_t value, size_t *const fired )
+  {
+    size_t visited = 0;
+    size_t success = 0;
+
+    uint16_t slot = list.first( event );
+    while ( slot != ActionableList::NO_SLOT )
+    {
+      /*-----------------------------------------------------------------------
+      Step past the slot before invoking it. A callback that removes its own
+      listener puts the slot back on the free list, which rewrites its link.
+      -----------------------------------------------------------------------*/
+      const uint16_t next = list.next( slot );
+
+      visited++;
+      if ( notifyListener( event, list[ slot ], value ) )
+      {
+        success++;
+      }
+
+      slot = next;
+    }
+
+    if ( fired )
+    {
+      *fired = success;
+    }
+
+    return visited && ( visited == success );
+  }
+
+
+  /*---------------------------------------------------------------------------
+  ActionableList Implementation
+  ---------------------------------------------------------------------------*/
+  ActionableList::ActionableList()
+  {
+    clear();
+  }
+
+
+  bool ActionableList::add( const Actionable &listener )
+  {
+    const size_t idx = static_cast<size_t>( listener.trigger );
+    if ( ( idx >= NUM_TRIGGERS ) || ( mFree == NO_SLOT ) )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Pop a slot off the free list and append it to the trigger's bucket
+    -------------------------------------------------------------------------*/
+    const uint16_t slot = mFree;
+    mFree               = mNodes[ slot ].next;
+
+    mNodes[ slot ].item = listener;
+    mNodes[ slot ].next = NO_SLOT;
+
+    if ( mTail[ idx ] == NO_SLOT )
+    {
+      mHead[ idx ] = slot;
+    }
+    else
+    {
+      mNodes[ mTail[ idx ] ].next = slot;
+    }
+
+    mTail[ idx ] = slot;
+    mActive |= ( 1u << idx );
+    mSize++;
+    return true;
+  }
+
+
+  size_t ActionableList::remove( const size_t id )
+  {
+    size_t removed = 0;
+
+    for ( size_t idx = 0; idx < NUM_TRIGGERS; idx++ )
+    {
+      uint16_t prev = NO_SLOT;
+      uint16_t slot = mHead[ idx ];
+
+      while ( slot != NO_SLOT )
+      {
+        const uint16_t next = mNodes[ slot ].next;
+
+        if ( mNodes[ slot ].item.id != id )
+        {
+          prev = slot;
+          slot = next;
+          continue;
+        }
+
+        /*---------------------------------------------------------------------
+        Unlink from the bucket and return the slot to the free list
+        ---------------------------------------------------------------------*/
+        if ( prev == NO_SLOT )
+        {
+          mHead[ idx ] = next;
+        }
+        else
+        {
+          mNodes[ prev ].next = next;
+        }
+
+        if ( mTail[ idx ] == slot )
+        {
+          mTail[ idx ] = prev;
+        }
+
+        mNodes[ slot ].next = mFree;
+        mFree               = slot;
+        mSize--;
+        removed++;
+
+        slot = next;
+      }
+
+      if ( mHead[ idx ] == NO_SLOT )
+      {
+        mActive &= ~( 1u << idx );
+      }
+    }
+
+    return removed;
+  }
+
+
+  void ActionableList::clear()
   {
-    bool accumulatedResult = true;
+    for ( size_t idx = 0; idx < NUM_TRIGGERS; idx++ )
+    {
+      mHead[ idx ] = NO_SLOT;
+      mTail[ idx ] = NO_SLOT;
+    }
 
-    for ( Actionable &item : list )
+    for ( size_t slot = 0; slot < CAPACITY; slot++ )
     {
-      accumulatedResult |= notifyListener( event, item, value );
+      mNodes[ slot ].next = ( ( slot + 1 ) < CAPACITY ) ? static_cast<uint16_t>( slot + 1 ) : NO_SLOT;
     }
 
-    return accumulatedResult;
+    mFree   = 0;
+    mActive = 0;
+    mSize   = 0;
+  }
+
+
+  size_t ActionableList::size() const
+  {
+    return mSize;
   }
 
+
+  bool ActionableList::hasListeners( const Trigger trigger ) const
+  {
+    const size_t idx = static_cast<size_t>( trigger );
+    return ( idx < NUM_TRIGGERS ) && ( mActive & ( 1u << idx ) );
+  }
+
+
+  uint32_t ActionableList::activeTriggers() const
+  {
+    return mActive;
+  }
+
+
+  uint16_t ActionableList::first( const Trigger trigger ) const
+  {
+    return hasListeners( trigger ) ? mHead[ static_cast<size_t>( trigger ) ] : NO_SLOT;
+  }
+
+
+  uint16_t ActionableList::next( const uint16_t slot ) const
+  {
+    return ( slot < CAPACITY ) ? mNodes[ slot ].next : NO_SLOT;
+  }
+
+
+  Actionable &ActionableList::operator[]( const uint16_t slot )
+  {
+    return mNodes[ slot ].item;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
   bool processListener_Atomic( const Trigger event, Actionable &listener, uint32_t value )
   {
     /*-------------------------------------------------------------------------
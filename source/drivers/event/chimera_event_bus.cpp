@@ -0,0 +1,288 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_event_bus.cpp
+ *
+ *  Description:
+ *    Publish/subscribe event bus implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* Chimera Includes */
+#include <Chimera/source/drivers/event/event_bus.hpp>
+#include <Chimera/thread>
+
+namespace Chimera::Event
+{
+  /*---------------------------------------------------------------------------
+  Subscriber Implementation
+  ---------------------------------------------------------------------------*/
+  Subscriber::Subscriber() :
+      mCallback(), mFilter( 0 ), mMask( 0 ), mSignaled( false ), mDropped( 0 ), mReceived( 0 )
+  {
+    /*-------------------------------------------------------------------------
+    Binary semaphores start out released. Take it so the first wait() only
+    returns once a publisher actually posts something.
+    -------------------------------------------------------------------------*/
+    mWakeup.try_acquire();
+  }
+
+
+  void Subscriber::configure( const TopicId filter, const TopicId mask, Callback callback )
+  {
+    mFilter   = filter & mask;
+    mMask     = mask;
+    mCallback = callback;
+  }
+
+
+  bool Subscriber::wait( const size_t timeout )
+  {
+    if ( !mWakeup.try_acquire_for( timeout ) )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Re-arm before draining so anything published from here on posts a new
+    wakeup. The semaphore count is zero at this point, so it can never be
+    released twice. The exchange pairs with the one in deliver() so every
+    message pushed before the flag was observed set is visible to dispatch().
+    -------------------------------------------------------------------------*/
+    mSignaled.exchange( false, std::memory_order_acq_rel );
+    return true;
+  }
+
+
+  size_t Subscriber::dispatch( const size_t limit )
+  {
+    Message batch[ CHIMERA_EVENT_BUS_BATCH_SIZE ];
+    size_t  total = 0;
+
+    while ( total < limit )
+    {
+      const size_t want  = ( ( limit - total ) < CHIMERA_EVENT_BUS_BATCH_SIZE ) ? ( limit - total ) : CHIMERA_EVENT_BUS_BATCH_SIZE;
+      const size_t count = mQueue.popBulk( batch, want );
+      if ( !count )
+      {
+        break;
+      }
+
+      for ( size_t x = 0; x < count; x++ )
+      {
+        if ( mCallback )
+        {
+          mCallback( batch[ x ] );
+        }
+      }
+
+      total += count;
+    }
+
+    mReceived += total;
+    return total;
+  }
+
+
+  bool Subscriber::matches( const TopicId topic ) const
+  {
+    return ( topic & mMask ) == mFilter;
+  }
+
+
+  size_t Subscriber::pending() const
+  {
+    return mQueue.sizeApprox();
+  }
+
+
+  size_t Subscriber::dropped() const
+  {
+    return mDropped.load( std::memory_order_relaxed );
+  }
+
+
+  size_t Subscriber::received() const
+  {
+    return mReceived;
+  }
+
+
+  bool Subscriber::deliver( const Message &msg, const bool fromISR )
+  {
+    if ( !mQueue.tryPush( msg ) )
+    {
+      mDropped.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Only the first delivery since the last wakeup touches the semaphore
+    -------------------------------------------------------------------------*/
+    if ( !mSignaled.exchange( true, std::memory_order_acq_rel ) )
+    {
+      if ( fromISR )
+      {
+        mWakeup.releaseFromISR();
+      }
+      else
+      {
+        mWakeup.release();
+      }
+    }
+
+    return true;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Bus Implementation
+  ---------------------------------------------------------------------------*/
+  BusBase::BusBase( Slot *const slots, const size_t capacity ) :
+      mSlots( slots ), mCapacity( capacity ), mHighWater( 0 ), mPublished( 0 ), mDropped( 0 )
+  {
+    /*-------------------------------------------------------------------------
+    The slots belong to the derived class and are zeroed by its constructor,
+    which runs after this one. Don't touch them here.
+    -------------------------------------------------------------------------*/
+  }
+
+
+  Chimera::Status_t BusBase::subscribe( Subscriber &subscriber )
+  {
+    for ( size_t x = 0; x < mCapacity; x++ )
+    {
+      Subscriber *expected = nullptr;
+      if ( mSlots[ x ].subscriber.compare_exchange_strong( expected, &subscriber ) )
+      {
+        /*---------------------------------------------------------------------
+        Publishers only scan up to the high water mark, so small subscriber
+        counts on a large bus stay cheap
+        ---------------------------------------------------------------------*/
+        size_t highWater = mHighWater.load();
+        while ( ( highWater < ( x + 1 ) ) && !mHighWater.compare_exchange_weak( highWater, x + 1 ) )
+        {
+          continue;
+        }
+
+        return Chimera::Status::OK;
+      }
+    }
+
+    return Chimera::Status::FULL;
+  }
+
+
+  Chimera::Status_t BusBase::unsubscribe( Subscriber &subscriber )
+  {
+    bool found = false;
+
+    for ( size_t x = 0; x < mCapacity; x++ )
+    {
+      Slot       &slot     = mSlots[ x ];
+      Subscriber *expected = &subscriber;
+      if ( !slot.subscriber.compare_exchange_strong( expected, nullptr ) )
+      {
+        continue;
+      }
+
+      found = true;
+
+      /*-----------------------------------------------------------------------
+      A publisher may have loaded the pointer just before it was cleared. It
+      bumps the slot's in-flight count before loading, and sequentially
+      consistent ordering on both sides means it either sees the cleared slot
+      or is counted here. Publishers arriving from now on see nullptr and
+      back out without touching the subscriber, so this can't starve.
+
+      Sleep rather than yield: a yield never lets a lower priority publisher
+      run, so spinning here would deadlock under a priority scheduler.
+      -----------------------------------------------------------------------*/
+      while ( slot.inFlight.load() )
+      {
+        Chimera::Thread::this_thread::sleep_for( Chimera::Thread::TIMEOUT_1MS );
+      }
+    }
+
+    return found ? Chimera::Status::OK : Chimera::Status::NOT_FOUND;
+  }
+
+
+  size_t BusBase::publish( const Message &msg )
+  {
+    return fanOut( msg, false );
+  }
+
+
+  size_t BusBase::publishFromISR( const Message &msg )
+  {
+    return fanOut( msg, true );
+  }
+
+
+  size_t BusBase::published() const
+  {
+    return mPublished.load( std::memory_order_relaxed );
+  }
+
+
+  size_t BusBase::dropped() const
+  {
+    return mDropped.load( std::memory_order_relaxed );
+  }
+
+
+  size_t BusBase::capacity() const
+  {
+    return mCapacity;
+  }
+
+
+  size_t BusBase::fanOut( const Message &msg, const bool fromISR )
+  {
+    size_t       delivered = 0;
+    size_t       dropped   = 0;
+    const size_t highWater = mHighWater.load( std::memory_order_acquire );
+
+    for ( size_t x = 0; x < highWater; x++ )
+    {
+      Slot &slot = mSlots[ x ];
+
+      /*-----------------------------------------------------------------------
+      Skip empty slots without touching the in-flight count. Otherwise pin
+      the slot and load it again: the subscriber is only safe to use if it
+      is still attached once the pin is visible to unsubscribe().
+      -----------------------------------------------------------------------*/
+      if ( !slot.subscriber.load( std::memory_order_relaxed ) )
+      {
+        continue;
+      }
+
+      slot.inFlight.fetch_add( 1 );
+      Subscriber *sub = slot.subscriber.load();
+
+      if ( sub && sub->matches( msg.topic ) )
+      {
+        if ( sub->deliver( msg, fromISR ) )
+        {
+          delivered++;
+        }
+        else
+        {
+          dropped++;
+        }
+      }
+
+      slot.inFlight.fetch_sub( 1, std::memory_order_release );
+    }
+
+    mPublished.fetch_add( 1, std::memory_order_relaxed );
+    if ( dropped )
+    {
+      mDropped.fetch_add( dropped, std::memory_order_relaxed );
+    }
+
+    return delivered;
+  }
+
+}  // namespace Chimera::Event
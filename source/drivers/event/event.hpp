@@ -32,14 +32,17 @@ namespace Chimera::Event
   bool notifyListener( const Trigger event, Actionable &listener, uint32_t value );
 
   /**
-   *  Provides the same functionality as notifyListener(), but iterates over a list.
+   *  Provides the same functionality as notifyListener(), but for every listener
+   *  in a list registered against the event. Listeners for other triggers are
+   *  never visited.
    *
    *  @param[in]  event       The event that occurred
    *  @param[in]  list        The list of listeners to be notified of the event
    *  @param[in]  value       Optional value to pass in to the listener object
-   *  @return bool            True if all listeners were successfully notified, else false
+   *  @param[out] fired       Optional count of listeners successfully notified
+   *  @return bool            True if at least one listener was registered and all were notified, else false
    */
-  bool notifyListenerList( const Trigger event, ActionableList &list, uint32_t value );
+  bool notifyListenerList( const Trigger event, ActionableList &list, uint32_t value, size_t *const fired = nullptr );
 
 }  // namespace Chimera::Event
 
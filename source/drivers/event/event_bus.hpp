@@ -0,0 +1,393 @@
+/******************************************************************************
+ *  File Name:
+ *    event_bus.hpp
+ *
+ *  Description:
+ *    Publish/subscribe event bus for application defined events
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_EVENT_BUS_HPP
+#define CHIMERA_EVENT_BUS_HPP
+
+/* STL Includes */
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/* ETL Includes */
+#include <etl/delegate.h>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/container/container_mpmc_queue.hpp>
+#include <Chimera/source/drivers/threading/threading_semaphore.hpp>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Number of subscribers a default sized Bus can hold. Use BasicBus<N>
+for a bus that needs more or fewer.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_EVENT_BUS_MAX_SUBSCRIBERS
+#define CHIMERA_EVENT_BUS_MAX_SUBSCRIBERS ( 16 )
+#endif
+
+/*-------------------------------------------------------------------
+Number of undelivered messages each subscriber can buffer. Must be a
+power of two.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_EVENT_BUS_QUEUE_DEPTH
+#define CHIMERA_EVENT_BUS_QUEUE_DEPTH ( 16 )
+#endif
+
+/*-------------------------------------------------------------------
+Largest payload that can be carried by a single message
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_EVENT_BUS_PAYLOAD_SIZE
+#define CHIMERA_EVENT_BUS_PAYLOAD_SIZE ( 16 )
+#endif
+
+/*-------------------------------------------------------------------
+Messages pulled off a subscriber queue per internal batch
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_EVENT_BUS_BATCH_SIZE
+#define CHIMERA_EVENT_BUS_BATCH_SIZE ( 8 )
+#endif
+
+namespace Chimera::Event
+{
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Topics are 32-bit identifiers. Subscribers filter on them with a mask, so
+   *  giving the upper bits a meaning (module, then event) allows subscribing
+   *  to whole groups of topics at once.
+   */
+  using TopicId = uint32_t;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Binds a topic id to the payload type published on it, so that publishers
+   *  and subscribers can't disagree about what the bytes mean.
+   *
+   *  @code
+   *  static constexpr TypedTopic<float> TOPIC_BATTERY_VOLTAGE{ 0x0101'0001 };
+   *  @endcode
+   */
+  template<typename T>
+  struct TypedTopic
+  {
+    static_assert( std::is_trivially_copyable_v<T>, "Bus payloads are copied as raw bytes" );
+    static_assert( sizeof( T ) <= CHIMERA_EVENT_BUS_PAYLOAD_SIZE, "Payload too large for CHIMERA_EVENT_BUS_PAYLOAD_SIZE" );
+
+    using PayloadType = T;
+
+    TopicId id;
+  };
+
+  /**
+   *  Unit of data carried by the bus
+   */
+  struct Message
+  {
+    TopicId  topic;                                     /**< What the message is about */
+    uint16_t size;                                      /**< Number of valid bytes in the payload */
+    uint8_t  payload[ CHIMERA_EVENT_BUS_PAYLOAD_SIZE ]; /**< Raw payload bytes */
+
+    /**
+     *  Copies the payload out as the type published on a topic
+     *
+     *  @param[in]  topic       Topic the payload is expected to belong to
+     *  @param[out] data        Receives the payload
+     *  @return bool            False if the message is for a different topic
+     */
+    template<typename T>
+    bool read( const TypedTopic<T> &topic, T &data ) const
+    {
+      if ( ( topic.id != this->topic ) || ( size != sizeof( T ) ) )
+      {
+        return false;
+      }
+
+      memcpy( &data, payload, sizeof( T ) );
+      return true;
+    }
+  };
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  class BusBase;
+
+  /**
+   *  Receiving end of the bus. Messages that match the subscriber's filter are
+   *  copied into its private queue by the publisher, then handed to the
+   *  callback later on the subscriber's own task when it calls dispatch().
+   *  A full queue drops the new message instead of stalling the publisher.
+   *
+   *  Typical use from the owning task:
+   *  @code
+   *  while ( true )
+   *  {
+   *    sub.wait( Chimera::Thread::TIMEOUT_BLOCK );
+   *    sub.dispatch();
+   *  }
+   *  @endcode
+   */
+  class Subscriber
+  {
+  public:
+    using Callback = etl::delegate<void( const Message & )>;
+
+    Subscriber();
+    ~Subscriber() = default;
+
+    Subscriber( const Subscriber & )            = delete;
+    Subscriber &operator=( const Subscriber & ) = delete;
+
+    /**
+     *  Sets which topics are accepted and what handles them. A topic matches
+     *  when ( topic & mask ) == ( filter & mask ), so a mask of zero accepts
+     *  everything and a mask of all ones accepts exactly one topic.
+     *
+     *  @note Must not be called while attached to a bus
+     *
+     *  @param[in]  filter      Topic bits to match against
+     *  @param[in]  mask        Which topic bits are significant
+     *  @param[in]  callback    Handler invoked for each dispatched message
+     *  @return void
+     */
+    void configure( const TopicId filter, const TopicId mask, Callback callback );
+
+    /**
+     *  Blocks until at least one message is queued or the timeout expires
+     *
+     *  @param[in]  timeout     How long to wait (mS)
+     *  @return bool            True if woken by a publisher
+     */
+    bool wait( const size_t timeout );
+
+    /**
+     *  Invokes the callback for queued messages, in the order they arrived
+     *
+     *  @param[in]  limit       Most messages to process this call
+     *  @return size_t          Number of messages processed
+     */
+    size_t dispatch( const size_t limit = SIZE_MAX );
+
+    /**
+     *  Checks if a topic passes the subscriber's filter
+     *
+     *  @param[in]  topic       Topic to check
+     *  @return bool
+     */
+    bool matches( const TopicId topic ) const;
+
+    /**
+     *  Approximate number of messages waiting to be dispatched
+     *  @return size_t
+     */
+    size_t pending() const;
+
+    /**
+     *  Number of messages dropped because the queue was full
+     *  @return size_t
+     */
+    size_t dropped() const;
+
+    /**
+     *  Number of messages handed to the callback
+     *  @return size_t
+     */
+    size_t received() const;
+
+  protected:
+    friend class BusBase;
+
+    /**
+     *  Called by the bus on the publisher's context
+     */
+    bool deliver( const Message &msg, const bool fromISR );
+
+  private:
+    using Queue = Chimera::Container::MPMCQueue<Message, CHIMERA_EVENT_BUS_QUEUE_DEPTH>;
+
+    Queue                            mQueue;    /**< Messages waiting for dispatch */
+    Callback                         mCallback; /**< Message handler */
+    TopicId                          mFilter;   /**< Topic bits to match */
+    TopicId                          mMask;     /**< Significant topic bits */
+    Chimera::Thread::BinarySemaphore mWakeup;   /**< Signals the owning task */
+    std::atomic<bool>                mSignaled; /**< Wakeup already posted */
+    std::atomic<size_t>              mDropped;  /**< Messages lost to a full queue */
+    size_t                           mReceived; /**< Messages dispatched */
+  };
+
+
+  /**
+   *  Many-to-many message bus. Any task or ISR may publish; publishing copies
+   *  the message into every matching subscriber's queue and never blocks or
+   *  takes a lock, so a slow subscriber only ever hurts itself.
+   *
+   *  The subscriber table lives in the derived BasicBus, so the capacity is
+   *  chosen per bus. Use Bus for the default capacity.
+   */
+  class BusBase
+  {
+  public:
+    BusBase( const BusBase & )            = delete;
+    BusBase &operator=( const BusBase & ) = delete;
+
+    /**
+     *  Attaches a subscriber to the bus
+     *
+     *  @param[in]  subscriber  Subscriber to attach
+     *  @return Chimera::Status_t
+     *
+     *  |   Return Value   |                Explanation               |
+     *  |:----------------:|:----------------------------------------:|
+     *  |               OK | The subscriber was attached              |
+     *  |             FULL | Every subscriber slot is in use          |
+     */
+    Chimera::Status_t subscribe( Subscriber &subscriber );
+
+    /**
+     *  Detaches a subscriber, then waits for any publish still touching it
+     *  to finish, after which it is safe to destroy. Only publishes that
+     *  loaded this subscriber's slot are waited on, and the wait sleeps
+     *  rather than spins so a preempted lower priority publisher can run.
+     *
+     *  @warning Blocks, so must not be called from an ISR or a subscriber
+     *           callback.
+     *
+     *  @param[in]  subscriber  Subscriber to detach
+     *  @return Chimera::Status_t
+     *
+     *  |   Return Value   |                Explanation               |
+     *  |:----------------:|:----------------------------------------:|
+     *  |               OK | The subscriber was detached              |
+     *  |        NOT_FOUND | The subscriber wasn't attached           |
+     */
+    Chimera::Status_t unsubscribe( Subscriber &subscriber );
+
+    /**
+     *  Publishes a message to every matching subscriber
+     *
+     *  @param[in]  msg         Message to publish
+     *  @return size_t          Number of subscribers the message was queued for
+     */
+    size_t publish( const Message &msg );
+
+    /**
+     *  Same as publish(), but safe to call from an ISR
+     *
+     *  @param[in]  msg         Message to publish
+     *  @return size_t          Number of subscribers the message was queued for
+     */
+    size_t publishFromISR( const Message &msg );
+
+    /**
+     *  Publishes a typed payload on its topic
+     *
+     *  @param[in]  topic       Topic to publish on
+     *  @param[in]  data        Payload to copy into the message
+     *  @return size_t          Number of subscribers the message was queued for
+     */
+    template<typename T>
+    size_t publish( const TypedTopic<T> &topic, const T &data )
+    {
+      return publish( makeMessage( topic, data ) );
+    }
+
+    template<typename T>
+    size_t publishFromISR( const TypedTopic<T> &topic, const T &data )
+    {
+      return publishFromISR( makeMessage( topic, data ) );
+    }
+
+    /**
+     *  Number of messages published on the bus
+     *  @return size_t
+     */
+    size_t published() const;
+
+    /**
+     *  Number of deliveries dropped across all subscribers because their
+     *  queues were full
+     *  @return size_t
+     */
+    size_t dropped() const;
+
+    /**
+     *  Number of subscriber slots on the bus
+     *  @return size_t
+     */
+    size_t capacity() const;
+
+  protected:
+    /**
+     *  Per-slot state. The in-flight count covers publishes that have loaded
+     *  the slot's pointer, which is all unsubscribe() needs to wait for.
+     */
+    struct Slot
+    {
+      std::atomic<Subscriber *> subscriber; /**< Attached subscriber, if any */
+      std::atomic<uint32_t>     inFlight;   /**< Publishes using the subscriber */
+    };
+
+    BusBase( Slot *const slots, const size_t capacity );
+    ~BusBase() = default;
+
+  private:
+    Slot *const         mSlots;     /**< Subscriber table, owned by the derived bus */
+    const size_t        mCapacity;  /**< Number of entries in mSlots */
+    std::atomic<size_t> mHighWater; /**< One past the highest slot ever used */
+    std::atomic<size_t> mPublished; /**< Total messages published */
+    std::atomic<size_t> mDropped;   /**< Total deliveries dropped */
+
+    size_t fanOut( const Message &msg, const bool fromISR );
+
+    template<typename T>
+    static Message makeMessage( const TypedTopic<T> &topic, const T &data )
+    {
+      Message msg;
+      msg.topic = topic.id;
+      msg.size  = sizeof( T );
+      memcpy( msg.payload, &data, sizeof( T ) );
+      return msg;
+    }
+  };
+
+
+  /**
+   *  Bus with room for up to N subscribers
+   */
+  template<size_t N>
+  class BasicBus : public BusBase
+  {
+  public:
+    static_assert( N > 0, "A bus needs at least one subscriber slot" );
+
+    BasicBus() : BusBase( mStorage, N ), mStorage{}
+    {
+    }
+
+  private:
+    Slot mStorage[ N ];
+  };
+
+  /**
+   *  Bus sized by CHIMERA_EVENT_BUS_MAX_SUBSCRIBERS
+   */
+  using Bus = BasicBus<CHIMERA_EVENT_BUS_MAX_SUBSCRIBERS>;
+
+}  // namespace Chimera::Event
+
+#endif /* !CHIMERA_EVENT_BUS_HPP */
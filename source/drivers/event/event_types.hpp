@@ -25,6 +25,16 @@
 #include <Chimera/callback>
 #include <Chimera/source/drivers/threading/threading_semaphore.hpp>
 
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Maximum number of listeners a single ActionableList can hold
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_EVENT_MAX_LISTENERS
+#define CHIMERA_EVENT_MAX_LISTENERS ( 16 )
+#endif
+
 namespace Chimera::Event
 {
   enum class Trigger : size_t
@@ -71,7 +81,124 @@ namespace Chimera::Event
     ListenerObject object; /**< The listener object to be invoked */
   };
 
-  using ActionableList = std::vector<Actionable>;
+  /**
+   *  Fixed capacity listener registry, bucketed by trigger. Each trigger owns
+   *  an intrusive singly linked list threaded through a shared slot pool, and
+   *  a bitmask records which triggers have any listeners at all. Notifying a
+   *  trigger only visits the listeners registered for it, in the order they
+   *  were added, and a trigger nobody cares about costs a single bit test.
+   *
+   *  A listener may remove itself from inside its own callback. Other
+   *  listeners on the list must not be removed during a notification.
+   *
+   *  @note Migrating from the old std::vector<Actionable> alias:
+   *        - push_back() is now add(), which returns false once
+   *          CHIMERA_EVENT_MAX_LISTENERS slots are used instead of growing.
+   *        - Erasing by iterator is now remove( id ), which returns how many
+   *          listeners were removed.
+   *        - Index loops become first()/next() walks over one trigger's
+   *          slots. Slot numbers are not positions and are reused.
+   *        - notifyListenerList() returns false when nothing is registered
+   *          for the event, where it used to return true.
+   *
+   *  @warning Not thread safe. Adding or removing listeners must not race
+   *           with a notification on the same list.
+   */
+  class ActionableList
+  {
+  public:
+    static constexpr size_t   CAPACITY = CHIMERA_EVENT_MAX_LISTENERS;
+    static constexpr uint16_t NO_SLOT  = std::numeric_limits<uint16_t>::max();
+
+    static_assert( CAPACITY < NO_SLOT, "Too many listeners for the slot index type" );
+
+    ActionableList();
+
+    /**
+     *  Registers a listener under its trigger
+     *
+     *  @param[in]  listener    Listener to add
+     *  @return bool            False if the list is full or the trigger is invalid
+     */
+    bool add( const Actionable &listener );
+
+    /**
+     *  Removes every listener with the given id
+     *
+     *  @param[in]  id          Actionable::id to remove
+     *  @return size_t          Number of listeners removed
+     */
+    size_t remove( const size_t id );
+
+    /**
+     *  Removes all listeners
+     *
+     *  @return void
+     */
+    void clear();
+
+    /**
+     *  Number of registered listeners
+     *
+     *  @return size_t
+     */
+    size_t size() const;
+
+    /**
+     *  Checks if any listener is registered for a trigger
+     *
+     *  @param[in]  trigger     Trigger to check
+     *  @return bool
+     */
+    bool hasListeners( const Trigger trigger ) const;
+
+    /**
+     *  Bitmask of triggers with at least one listener, indexed by Trigger
+     *
+     *  @return uint32_t
+     */
+    uint32_t activeTriggers() const;
+
+    /**
+     *  First listener slot registered for a trigger
+     *
+     *  @param[in]  trigger     Trigger to look up
+     *  @return uint16_t        Slot index, or NO_SLOT if there are none
+     */
+    uint16_t first( const Trigger trigger ) const;
+
+    /**
+     *  Next listener slot registered for the same trigger
+     *
+     *  @param[in]  slot        Slot returned from first() or next()
+     *  @return uint16_t        Slot index, or NO_SLOT at the end of the list
+     */
+    uint16_t next( const uint16_t slot ) const;
+
+    /**
+     *  Accesses the listener stored in a slot
+     *
+     *  @param[in]  slot        Slot returned from first() or next()
+     *  @return Actionable&
+     */
+    Actionable &operator[]( const uint16_t slot );
+
+  private:
+    static constexpr size_t NUM_TRIGGERS = static_cast<size_t>( Trigger::NUM_OPTIONS );
+
+    struct Node
+    {
+      Actionable item; /**< Registered listener */
+      uint16_t   next; /**< Next slot in the same bucket, or the free list */
+    };
+
+    Node     mNodes[ CAPACITY ];    /**< Slot pool */
+    uint16_t mHead[ NUM_TRIGGERS ]; /**< First slot per trigger */
+    uint16_t mTail[ NUM_TRIGGERS ]; /**< Last slot per trigger */
+    uint16_t mFree;                 /**< Head of the free slot list */
+    uint32_t mActive;               /**< Triggers with at least one listener */
+    size_t   mSize;                 /**< Number of registered listeners */
+  };
 
 }  // namespace Chimera::Event
 
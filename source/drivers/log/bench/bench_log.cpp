@@ -0,0 +1,115 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_log.cpp
+ *
+ *  Description:
+ *    Call site cost of a tokenized CHIMERA_LOG_* statement against formatting
+ *    the same message in place, which is the least a formatted LOG_* macro
+ *    pays before its output is even written anywhere. Also reports what the
+ *    deferred formatting costs the drain task per record.
+ *
+ *    Usage: chimera_log_bench [statements]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/* Chimera Includes */
+#include <Chimera/log>
+
+namespace
+{
+  using namespace Chimera::Log;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  /*-------------------------------------------------------------------
+  Statements per timed burst. Kept under the queue depth so the
+  tokenized path never hits a full queue and drops.
+  -------------------------------------------------------------------*/
+  static constexpr size_t BURST = ( CHIMERA_LOG_QUEUE_DEPTH / 2 ) ? ( CHIMERA_LOG_QUEUE_DEPTH / 2 ) : 1;
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static volatile size_t s_sunk;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static void nullSink( const Record &record, const char *const message, const size_t length )
+  {
+    ( void )record;
+    ( void )message;
+    s_sunk = s_sunk + length;
+  }
+
+
+  static double elapsedNs( const std::chrono::steady_clock::time_point start )
+  {
+    return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t statements = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 1000000;
+  const size_t bursts     = ( statements + BURST - 1 ) / BURST;
+  const size_t total      = bursts * BURST;
+
+  setSink( Sink::create<nullSink>() );
+
+  const uint32_t    channel = 3;
+  const int32_t     error   = -110;
+  const double      voltage = 3.271;
+  const char *const name    = "USART2";
+
+  /*-------------------------------------------------------------------------
+  Tokenized: pack the arguments and push. Drain between bursts, off the clock.
+  -------------------------------------------------------------------------*/
+  double tokenizedNs = 0.0;
+  double drainNs     = 0.0;
+  for ( size_t b = 0; b < bursts; b++ )
+  {
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t x = 0; x < BURST; x++ )
+    {
+      CHIMERA_LOG_INFO( "%s ch %u err %d at %.3f V, try %u", name, channel, error, voltage, static_cast<uint32_t>( x ) );
+    }
+    tokenizedNs += elapsedNs( start );
+
+    start = std::chrono::steady_clock::now();
+    drain();
+    drainNs += elapsedNs( start );
+  }
+
+  /*-------------------------------------------------------------------------
+  Formatted: render the same text at the call site
+  -------------------------------------------------------------------------*/
+  char   line[ CHIMERA_LOG_LINE_SIZE ];
+  double formattedNs = 0.0;
+  for ( size_t b = 0; b < bursts; b++ )
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for ( size_t x = 0; x < BURST; x++ )
+    {
+      const int length = snprintf( line, sizeof( line ), "%s ch %u err %d at %.3f V, try %u", name, channel, error, voltage,
+                                   static_cast<unsigned>( x ) );
+      s_sunk           = s_sunk + static_cast<size_t>( length );
+    }
+    formattedNs += elapsedNs( start );
+  }
+
+  printf( "%zu statements, %zu dropped\n", total, dropped() );
+  printf( "tokenized call site  %7.1f ns\n", tokenizedNs / static_cast<double>( total ) );
+  printf( "formatted call site  %7.1f ns\n", formattedNs / static_cast<double>( total ) );
+  printf( "deferred drain       %7.1f ns per record\n", drainNs / static_cast<double>( total ) );
+
+  return dropped() ? 1 : 0;
+}
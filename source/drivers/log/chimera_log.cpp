@@ -0,0 +1,432 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_log.cpp
+ *
+ *  Description:
+ *    Tokenized deferred logger implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+/* Aurora Includes */
+#include <Aurora/logging>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/log>
+#include <Chimera/source/drivers/container/container_mpmc_queue.hpp>
+#include <Chimera/thread>
+
+namespace Chimera::Log
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  A single argument pulled back out of a record
+   */
+  struct Value
+  {
+    ArgType type;
+    union
+    {
+      int32_t     i32;
+      uint32_t    u32;
+      int64_t     i64;
+      uint64_t    u64;
+      double      f64;
+      const void *ptr;
+      const char *str;
+    };
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static void defaultSink( const Record &record, const char *const message, const size_t length );
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static size_t                                                          s_driver_initialized;
+  static Chimera::Container::MPMCQueue<Record, CHIMERA_LOG_QUEUE_DEPTH> s_queue;
+  static std::atomic<size_t>                                             s_dropped;
+  static Sink                                                            s_sink = Sink::create<defaultSink>();
+  static Chimera::Thread::Task                                           s_drain_task;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Forwards to the Aurora logger at the matching level
+   */
+  static void defaultSink( const Record &record, const char *const message, const size_t length )
+  {
+    ( void )length;
+
+    switch ( record.desc->level )
+    {
+      case Level::LVL_DEBUG:
+        LOG_DEBUG( "%s", message );
+        break;
+
+      case Level::LVL_INFO:
+        LOG_INFO( "%s", message );
+        break;
+
+      case Level::LVL_WARN:
+        LOG_WARN( "%s", message );
+        break;
+
+      case Level::LVL_ERROR:
+      default:
+        LOG_ERROR( "%s", message );
+        break;
+    }
+  }
+
+
+  /**
+   *  Unpacks the next argument, advancing the word index
+   */
+  static Value unpack( const Record &record, const size_t arg, size_t &idx )
+  {
+    Value value;
+    value.type = static_cast<ArgType>( ( record.types >> ( arg * 4u ) ) & 0xFu );
+    value.u64  = 0;
+
+    if ( ( arg >= MAX_ARGS ) || ( value.type == ARG_NONE ) )
+    {
+      value.type = ARG_NONE;
+      return value;
+    }
+
+    size_t words = 1;
+    switch ( value.type )
+    {
+      case ARG_I32:
+        value.i32 = static_cast<int32_t>( record.words[ idx ] );
+        break;
+
+      case ARG_U32:
+        value.u32 = record.words[ idx ];
+        break;
+
+      case ARG_I64:
+      case ARG_U64:
+        memcpy( &value.u64, &record.words[ idx ], sizeof( value.u64 ) );
+        words = 2;
+        break;
+
+      case ARG_F64:
+        memcpy( &value.f64, &record.words[ idx ], sizeof( value.f64 ) );
+        words = 2;
+        break;
+
+      case ARG_PTR:
+      case ARG_STR:
+      default: {
+        uintptr_t raw = 0;
+        memcpy( &raw, &record.words[ idx ], sizeof( raw ) );
+        value.ptr = reinterpret_cast<const void *>( raw );
+        words     = Internal::Traits<const void *>::words;
+      }
+      break;
+    }
+
+    idx += words;
+    return value;
+  }
+
+
+  /**
+   *  Formats one conversion. The length modifiers from the call site are
+   *  dropped from spec and replaced with whatever matches the stored type.
+   *
+   *  @param[in]  spec        Conversion without length modifiers, e.g. "%-8"
+   *  @param[in]  conv        Conversion character
+   *  @param[in]  value       Argument to format
+   *  @param[out] buffer      Output
+   *  @param[in]  size        Room left in the output
+   *  @return int             snprintf() result
+   */
+  static int formatOne( char *const spec, const char conv, const Value &value, char *const buffer, const size_t size )
+  {
+    const size_t len = strlen( spec );
+
+    switch ( conv )
+    {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+      case 'c':
+        if ( ( value.type == ARG_I32 ) || ( value.type == ARG_U32 ) )
+        {
+          spec[ len ]     = conv;
+          spec[ len + 1 ] = '\0';
+          return std::snprintf( buffer, size, spec, value.u32 );
+        }
+        else
+        {
+          const long long raw = ( value.type == ARG_F64 ) ? static_cast<long long>( value.f64 ) : value.i64;
+
+          spec[ len ]     = 'l';
+          spec[ len + 1 ] = 'l';
+          spec[ len + 2 ] = ( conv == 'c' ) ? 'd' : conv;
+          spec[ len + 3 ] = '\0';
+          return std::snprintf( buffer, size, spec, raw );
+        }
+
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        double raw = value.f64;
+        if ( value.type == ARG_I32 )
+        {
+          raw = value.i32;
+        }
+        else if ( value.type == ARG_U32 )
+        {
+          raw = value.u32;
+        }
+        else if ( value.type == ARG_I64 )
+        {
+          raw = static_cast<double>( value.i64 );
+        }
+        else if ( value.type == ARG_U64 )
+        {
+          raw = static_cast<double>( value.u64 );
+        }
+
+        spec[ len ]     = conv;
+        spec[ len + 1 ] = '\0';
+        return std::snprintf( buffer, size, spec, raw );
+      }
+
+      case 's':
+        spec[ len ]     = 's';
+        spec[ len + 1 ] = '\0';
+        return std::snprintf( buffer, size, spec, ( value.type == ARG_STR && value.str ) ? value.str : "(null)" );
+
+      case 'p':
+      default:
+        spec[ len ]     = 'p';
+        spec[ len + 1 ] = '\0';
+        return std::snprintf( buffer, size, spec, value.ptr );
+    }
+  }
+
+
+  static void DrainThread( void *arg )
+  {
+    ( void )arg;
+
+    while ( true )
+    {
+      Chimera::Thread::this_thread::sleep_for( CHIMERA_LOG_DRAIN_PERIOD );
+      drain();
+    }
+  }
+
+  /*---------------------------------------------------------------------------
+  Internal Functions
+  ---------------------------------------------------------------------------*/
+  namespace Internal
+  {
+    bool enqueue( const Record &record )
+    {
+      if ( s_queue.tryPush( record ) )
+      {
+        return true;
+      }
+
+      s_dropped.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+  }  // namespace Internal
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  Chimera::Status_t initialize()
+  {
+    using namespace Chimera::Thread;
+
+    /*-------------------------------------------------------------------------
+    Start the drain task once
+    -------------------------------------------------------------------------*/
+    if ( s_driver_initialized == Chimera::DRIVER_INITIALIZED_KEY )
+    {
+      return Chimera::Status::OK;
+    }
+
+    TaskConfig cfg;
+
+    cfg.arg        = nullptr;
+    cfg.function   = DrainThread;
+    cfg.priority   = CHIMERA_LOG_DRAIN_PRIORITY;
+    cfg.stackWords = STACK_BYTES( CHIMERA_LOG_DRAIN_STACK );
+    cfg.type       = TaskInitType::DYNAMIC;
+    cfg.name       = "LogDrain";
+
+    s_drain_task.create( cfg );
+    s_drain_task.start();
+
+    s_driver_initialized = Chimera::DRIVER_INITIALIZED_KEY;
+    return Chimera::Status::OK;
+  }
+
+
+  void setSink( Sink sink )
+  {
+    s_sink = sink.is_valid() ? sink : Sink::create<defaultSink>();
+  }
+
+
+  size_t drain( const size_t limit )
+  {
+    char   line[ CHIMERA_LOG_LINE_SIZE ];
+    size_t count = 0;
+
+    Record record;
+    while ( ( count < limit ) && s_queue.tryPop( record ) )
+    {
+      if ( record.desc && record.desc->consumer )
+      {
+        record.desc->consumer( record );
+      }
+      else
+      {
+        const size_t length = format( record, line, sizeof( line ) );
+        s_sink( record, line, length );
+      }
+
+      count++;
+    }
+
+    return count;
+  }
+
+
+  size_t flush( const size_t limit )
+  {
+    char   line[ CHIMERA_LOG_LINE_SIZE ];
+    size_t count = 0;
+
+    Record record;
+    while ( ( count < limit ) && s_queue.tryPop( record ) )
+    {
+      if ( !record.desc || !record.desc->consumer )
+      {
+        const size_t length = format( record, line, sizeof( line ) );
+        s_sink( record, line, length );
+      }
+
+      count++;
+    }
+
+    return count;
+  }
+
+
+  size_t format( const Record &record, char *const buffer, const size_t size )
+  {
+    if ( !buffer || !size )
+    {
+      return 0;
+    }
+
+    buffer[ 0 ] = '\0';
+    /*-------------------------------------------------------------------------
+    A consumer's record doesn't hold arguments in the layout read below
+    -------------------------------------------------------------------------*/
+    if ( !record.desc || !record.desc->format || record.desc->consumer )
+    {
+      return 0;
+    }
+
+    const char *fmt  = record.desc->format;
+    size_t      out  = 0;
+    size_t      arg  = 0;
+    size_t      word = 0;
+
+    while ( *fmt && ( out < ( size - 1 ) ) )
+    {
+      /*-----------------------------------------------------------------------
+      Plain text and escaped percents
+      -----------------------------------------------------------------------*/
+      if ( *fmt != '%' )
+      {
+        buffer[ out++ ] = *fmt++;
+        continue;
+      }
+
+      if ( fmt[ 1 ] == '%' )
+      {
+        buffer[ out++ ] = '%';
+        fmt += 2;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Copy flags, width and precision. Length modifiers are skipped since the
+      stored type decides them.
+      -----------------------------------------------------------------------*/
+      char   spec[ 16 ];
+      size_t spec_len = 0;
+
+      spec[ spec_len++ ] = *fmt++;
+      while ( *fmt && strchr( "-+ #0123456789.", *fmt ) && ( spec_len < ( sizeof( spec ) - 4 ) ) )
+      {
+        spec[ spec_len++ ] = *fmt++;
+      }
+      spec[ spec_len ] = '\0';
+
+      while ( *fmt && strchr( "hljztL", *fmt ) )
+      {
+        fmt++;
+      }
+
+      if ( !*fmt )
+      {
+        break;
+      }
+
+      const char  conv  = *fmt++;
+      const Value value = unpack( record, arg++, word );
+      const int   wrote = formatOne( spec, conv, value, buffer + out, size - out );
+
+      if ( wrote > 0 )
+      {
+        out += static_cast<size_t>( wrote );
+        if ( out >= size )
+        {
+          out = size - 1;
+        }
+      }
+    }
+
+    buffer[ out ] = '\0';
+    return out;
+  }
+
+
+  size_t dropped()
+  {
+    return s_dropped.load( std::memory_order_relaxed );
+  }
+
+}  // namespace Chimera::Log
@@ -0,0 +1,276 @@
+/******************************************************************************
+ *  File Name:
+ *    log.hpp
+ *
+ *  Description:
+ *    Tokenized deferred logger. Call sites record a token and their raw
+ *    arguments; formatting happens later on a low priority task.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_LOG_HPP
+#define CHIMERA_LOG_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/assert/assert_driver.hpp>
+#include <Chimera/source/drivers/log/log_types.hpp>
+
+/*-----------------------------------------------------------------------------
+Macros
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Drop-in replacements for the formatted LOG_* macros on hot paths. A
+call costs a queue push of the raw arguments; nothing is formatted.
+
+  CHIMERA_LOG_ERROR( "DMA stream %d timed out after %u ticks", stream, ticks );
+
+%s arguments are recorded as pointers, so they must outlive the
+record. String literals and __SHORTFILE__ are fine, stack buffers
+are not. '*' widths and precisions aren't supported.
+-------------------------------------------------------------------*/
+#define CHIMERA_LOG( level, fmt, ... )                                                                                         \
+  do                                                                                                                           \
+  {                                                                                                                            \
+    static_assert( ::Chimera::Log::Internal::countSpecifiers( fmt ) ==                                                         \
+                       decltype( ::Chimera::Log::Internal::countArgs( __VA_ARGS__ ) )::value,                                 \
+                   "Log format specifiers don't match the argument count" );                                                   \
+    static constexpr ::Chimera::Log::Descriptor chimera_log_desc__{ fmt, __SHORTFILE__, __LINE__, level, nullptr };            \
+    ::Chimera::Log::write( &chimera_log_desc__, ##__VA_ARGS__ );                                                               \
+  } while ( 0 )
+
+#define CHIMERA_LOG_DEBUG( fmt, ... ) CHIMERA_LOG( ::Chimera::Log::Level::LVL_DEBUG, fmt, ##__VA_ARGS__ )
+#define CHIMERA_LOG_INFO( fmt, ... ) CHIMERA_LOG( ::Chimera::Log::Level::LVL_INFO, fmt, ##__VA_ARGS__ )
+#define CHIMERA_LOG_WARN( fmt, ... ) CHIMERA_LOG( ::Chimera::Log::Level::LVL_WARN, fmt, ##__VA_ARGS__ )
+#define CHIMERA_LOG_ERROR( fmt, ... ) CHIMERA_LOG( ::Chimera::Log::Level::LVL_ERROR, fmt, ##__VA_ARGS__ )
+
+namespace Chimera::Log
+{
+  /*---------------------------------------------------------------------------
+  Internal Helpers
+  ---------------------------------------------------------------------------*/
+  namespace Internal
+  {
+    /**
+     *  Number of conversions in a format string. "%%" is not a conversion.
+     */
+    constexpr size_t countSpecifiers( const char *fmt )
+    {
+      size_t count = 0;
+      while ( *fmt )
+      {
+        if ( *fmt == '%' )
+        {
+          fmt++;
+          if ( *fmt != '%' )
+          {
+            count++;
+          }
+
+          if ( !*fmt )
+          {
+            break;
+          }
+        }
+
+        fmt++;
+      }
+
+      return count;
+    }
+
+    /**
+     *  Only ever used inside decltype() to count macro arguments
+     */
+    template<typename... Args>
+    std::integral_constant<size_t, sizeof...( Args )> countArgs( const Args &... );
+
+    /**
+     *  How each argument type is stored
+     */
+    template<typename T, typename = void>
+    struct ArgTraits
+    {
+      static_assert( sizeof( T ) == 0, "Unsupported log argument type" );
+    };
+
+    template<typename T>
+    struct ArgTraits<T, std::enable_if_t<std::is_integral_v<T> && ( sizeof( T ) <= sizeof( uint32_t ) )>>
+    {
+      static constexpr ArgType type  = std::is_signed_v<T> ? ARG_I32 : ARG_U32;
+      static constexpr size_t  words = 1;
+    };
+
+    template<typename T>
+    struct ArgTraits<T, std::enable_if_t<std::is_integral_v<T> && ( sizeof( T ) > sizeof( uint32_t ) )>>
+    {
+      static constexpr ArgType type  = std::is_signed_v<T> ? ARG_I64 : ARG_U64;
+      static constexpr size_t  words = 2;
+    };
+
+    template<typename T>
+    struct ArgTraits<T, std::enable_if_t<std::is_enum_v<T>>> : ArgTraits<std::underlying_type_t<T>>
+    {
+    };
+
+    template<typename T>
+    struct ArgTraits<T, std::enable_if_t<std::is_floating_point_v<T>>>
+    {
+      static constexpr ArgType type  = ARG_F64;
+      static constexpr size_t  words = 2;
+    };
+
+    template<typename T>
+    struct ArgTraits<T, std::enable_if_t<std::is_pointer_v<T>>>
+    {
+      static constexpr bool    is_str = std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>;
+      static constexpr ArgType type   = is_str ? ARG_STR : ARG_PTR;
+      static constexpr size_t  words  = ( sizeof( uintptr_t ) + sizeof( uint32_t ) - 1 ) / sizeof( uint32_t );
+    };
+
+    template<typename T>
+    using Traits = ArgTraits<std::decay_t<T>>;
+
+    /**
+     *  Copies one argument into the record's words
+     */
+    template<typename T>
+    inline void pack( uint32_t *const words, size_t &idx, const T &arg )
+    {
+      using D = std::decay_t<const T &>;
+
+      if constexpr ( std::is_floating_point_v<D> )
+      {
+        const double value = static_cast<double>( arg );
+        memcpy( &words[ idx ], &value, sizeof( value ) );
+      }
+      else if constexpr ( std::is_pointer_v<D> )
+      {
+        const uintptr_t value = reinterpret_cast<uintptr_t>( static_cast<D>( arg ) );
+        memcpy( &words[ idx ], &value, sizeof( value ) );
+      }
+      else if constexpr ( Traits<T>::words == 2 )
+      {
+        const uint64_t value = static_cast<uint64_t>( arg );
+        memcpy( &words[ idx ], &value, sizeof( value ) );
+      }
+      else
+      {
+        words[ idx ] = static_cast<uint32_t>( arg );
+      }
+
+      idx += Traits<T>::words;
+    }
+
+    template<typename... Args>
+    constexpr uint32_t typeCodes()
+    {
+      uint32_t codes = 0;
+      uint32_t shift = 0;
+      ( ( codes |= static_cast<uint32_t>( Traits<Args>::type ) << shift, shift += 4 ), ... );
+      return codes;
+    }
+
+    /**
+     *  Queues a finished record
+     */
+    bool enqueue( const Record &record );
+  }  // namespace Internal
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Records a log statement. Safe from any context, including ISRs. Use the
+   *  CHIMERA_LOG_* macros rather than calling this directly.
+   *
+   *  @param[in]  desc        Call site descriptor
+   *  @param[in]  args        Arguments matching the format string
+   *  @return bool            False if the queue was full and the record dropped
+   */
+  template<typename... Args>
+  inline bool write( const Descriptor *const desc, const Args &...args )
+  {
+    static_assert( sizeof...( Args ) <= MAX_ARGS, "Too many log arguments" );
+    static_assert( ( Internal::Traits<Args>::words + ... + 0 ) <= CHIMERA_LOG_MAX_WORDS,
+                   "Log arguments exceed CHIMERA_LOG_MAX_WORDS" );
+
+    Record record;
+    record.desc      = desc;
+    record.timestamp = static_cast<uint32_t>( Chimera::micros() );
+    record.types     = Internal::typeCodes<Args...>();
+
+    size_t idx = 0;
+    ( Internal::pack( record.words, idx, args ), ... );
+
+    return Internal::enqueue( record );
+  }
+
+  /**
+   *  Starts the low priority task that formats queued records and passes
+   *  them to the sink
+   *
+   *  @return Chimera::Status_t
+   */
+  Chimera::Status_t initialize();
+
+  /**
+   *  Replaces the sink. The default forwards to the Aurora LOG_* macros, and
+   *  passing an empty sink restores it.
+   *
+   *  @warning Call before initialize(). The drain task reads the sink
+   *           without synchronization once it is running.
+   *
+   *  @param[in]  sink        Where formatted messages go
+   *  @return void
+   */
+  void setSink( Sink sink );
+
+  /**
+   *  Formats queued records on the calling thread, or hands them to their
+   *  descriptor's consumer. Call before a reset to make sure nothing is lost.
+   *
+   *  @param[in]  limit       Most records to process
+   *  @return size_t          Number of records processed
+   */
+  size_t drain( const size_t limit = SIZE_MAX );
+
+  /**
+   *  Like drain(), but only formats. Records with a consumer are discarded
+   *  without running it, so nothing waits on a driver or its lock. Meant for
+   *  the assert path, which may run in an ISR or with a driver held.
+   *
+   *  @param[in]  limit       Most records to process
+   *  @return size_t          Number of records processed
+   */
+  size_t flush( const size_t limit = SIZE_MAX );
+
+  /**
+   *  Formats a single record. Usable on a host that has the firmware's
+   *  descriptors, e.g. from a native build or a decoded image.
+   *
+   *  @param[in]  record      Record to format
+   *  @param[out] buffer      Receives the null terminated text
+   *  @param[in]  size        Size of the buffer
+   *  @return size_t          Length of the text, 0 for a record with a consumer
+   */
+  size_t format( const Record &record, char *const buffer, const size_t size );
+
+  /**
+   *  Number of records lost because the queue was full
+   *
+   *  @return size_t
+   */
+  size_t dropped();
+
+}  // namespace Chimera::Log
+
+#endif /* !CHIMERA_LOG_HPP */
@@ -0,0 +1,163 @@
+/******************************************************************************
+ *  File Name:
+ *    log_types.hpp
+ *
+ *  Description:
+ *    Types for the tokenized deferred logger
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_LOG_TYPES_HPP
+#define CHIMERA_LOG_TYPES_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* ETL Includes */
+#include <etl/delegate.h>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Records that can wait to be formatted. Must be a power of two.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_LOG_QUEUE_DEPTH
+#define CHIMERA_LOG_QUEUE_DEPTH ( 64 )
+#endif
+
+/*-------------------------------------------------------------------
+32-bit words of argument data a single record can carry. 64-bit
+integers, doubles and (on 64-bit hosts) pointers take two.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_LOG_MAX_WORDS
+#define CHIMERA_LOG_MAX_WORDS ( 8 )
+#endif
+
+/*-------------------------------------------------------------------
+Longest formatted message handed to the sink, including the null
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_LOG_LINE_SIZE
+#define CHIMERA_LOG_LINE_SIZE ( 128 )
+#endif
+
+/*-------------------------------------------------------------------
+How often the drain task wakes to format pending records (mS)
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_LOG_DRAIN_PERIOD
+#define CHIMERA_LOG_DRAIN_PERIOD ( 10 )
+#endif
+
+/*-------------------------------------------------------------------
+Drain task stack size in bytes. Formatting needs room for the line
+buffer plus snprintf.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_LOG_DRAIN_STACK
+#define CHIMERA_LOG_DRAIN_STACK ( 2048 )
+#endif
+
+/*-------------------------------------------------------------------
+Drain task priority. Formatting is the work being moved off the hot
+paths, so it should run only when little else wants the CPU.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_LOG_DRAIN_PRIORITY
+#define CHIMERA_LOG_DRAIN_PRIORITY ( Chimera::Thread::Priority::MINIMUM + 1u )
+#endif
+
+namespace Chimera::Log
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t MAX_ARGS = 8; /**< Limited by the 4-bit type codes in Record::types */
+
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  enum class Level : uint8_t
+  {
+    LVL_DEBUG,
+    LVL_INFO,
+    LVL_WARN,
+    LVL_ERROR,
+
+    NUM_OPTIONS
+  };
+
+  /**
+   *  How an argument was stored, so the formatter can rebuild it
+   */
+  enum ArgType : uint8_t
+  {
+    ARG_NONE,
+    ARG_I32,
+    ARG_U32,
+    ARG_I64,
+    ARG_U64,
+    ARG_F64,
+    ARG_PTR,
+    ARG_STR,
+  };
+
+  /*---------------------------------------------------------------------------
+  Forward Declarations
+  ---------------------------------------------------------------------------*/
+  struct Record;
+
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Takes a record off the drain task in place of format() and the sink.
+   *  Lets other deferred output, e.g. CHIMERA_SERIAL_DEFER, share the queue
+   *  and the task. Such a record's words are laid out however its consumer
+   *  wants.
+   *
+   *  @param[in]  record      Record to finish
+   */
+  using Consumer = void ( * )( const Record & );
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Everything about a log statement that is known at compile time. One of
+   *  these is placed in read-only memory per call site and its address is the
+   *  token recorded at runtime. A host tool can recover the strings from the
+   *  firmware image with that address.
+   */
+  struct Descriptor
+  {
+    const char *format;   /**< printf style format string */
+    const char *file;     /**< File containing the call site */
+    uint32_t    line;     /**< Line of the call site */
+    Level       level;    /**< Severity */
+    Consumer    consumer; /**< nullptr for log statements */
+  };
+
+  /**
+   *  What a call site actually records
+   */
+  struct Record
+  {
+    const Descriptor *desc;                           /**< Token identifying the call site */
+    uint32_t          timestamp;                      /**< Chimera::micros() at the call */
+    uint32_t          types;                          /**< ArgType per argument, 4 bits each, first arg lowest */
+    uint32_t          words[ CHIMERA_LOG_MAX_WORDS ]; /**< Raw argument data */
+  };
+
+  /**
+   *  Receives each formatted message
+   *
+   *  @param[in]  record      Record the message was formatted from
+   *  @param[in]  message     Null terminated text
+   *  @param[in]  length      Length of the text
+   */
+  using Sink = etl::delegate<void( const Record &, const char *const, const size_t )>;
+
+}  // namespace Chimera::Log
+
+#endif /* !CHIMERA_LOG_TYPES_HPP */
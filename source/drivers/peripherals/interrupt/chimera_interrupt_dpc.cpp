@@ -0,0 +1,403 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_interrupt_dpc.cpp
+ *
+ *  Description:
+ *    Deferred procedure call queue implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <atomic>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/container/container_mpmc_queue.hpp>
+#include <Chimera/source/drivers/peripherals/interrupt/interrupt_dpc.hpp>
+#include <Chimera/thread>
+
+namespace Chimera::Interrupt::DPC
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  What travels through the queue for non-coalescing sources. Coalescing
+   *  sources never use the queue; they flag themselves in s_ready instead.
+   */
+  struct Item
+  {
+    SourceId source;
+    uint32_t data;
+    size_t   timestamp;
+  };
+
+  struct SourceState
+  {
+    Handler               handler;      /**< Work handler */
+    bool                  coalesce;     /**< Merge posts while work is queued */
+    std::atomic<size_t>   since;        /**< Time of the oldest unhandled post */
+    std::atomic<bool>     stamped;      /**< since holds a valid time */
+    std::atomic<uint32_t> data;         /**< Coalesced data word */
+    std::atomic<uint32_t> count;        /**< Coalesced post count */
+    std::atomic<size_t>   posted;       /**< Telemetry, see Stats */
+    std::atomic<size_t>   executed;     /**< Telemetry, see Stats */
+    std::atomic<size_t>   coalesced;    /**< Telemetry, see Stats */
+    std::atomic<size_t>   dropped;      /**< Telemetry, see Stats */
+    std::atomic<size_t>   minLatency;   /**< Telemetry, see Stats */
+    std::atomic<size_t>   maxLatency;   /**< Telemetry, see Stats */
+    std::atomic<size_t>   totalLatency; /**< Telemetry, see Stats */
+  };
+
+  static_assert( CHIMERA_DPC_MAX_SOURCES <= 32, "Coalescing sources are tracked in a 32-bit mask" );
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static size_t                                                      s_driver_initialized;
+  static Chimera::Container::MPMCQueue<Item, CHIMERA_DPC_QUEUE_DEPTH> s_queue;
+  static SourceState                                                 s_sources[ CHIMERA_DPC_MAX_SOURCES ];
+  static std::atomic<uint32_t>                                       s_ready;
+  static Chimera::Thread::BinarySemaphore                            s_wakeup;
+  static std::atomic<bool>                                           s_signaled;
+  static Chimera::Thread::Task                                       s_workers[ CHIMERA_DPC_WORKERS ];
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Wakes a worker. Only the first post since a worker last woke touches the
+   *  semaphore, which keeps the ISR path short under bursts.
+   */
+  static void wake( const bool fromISR )
+  {
+    if ( s_signaled.exchange( true, std::memory_order_acq_rel ) )
+    {
+      return;
+    }
+
+    if ( fromISR )
+    {
+      s_wakeup.releaseFromISR();
+    }
+    else
+    {
+      s_wakeup.release();
+    }
+  }
+
+
+  static bool enqueue( const SourceId source, const uint32_t data, const bool fromISR )
+  {
+    if ( source >= CHIMERA_DPC_MAX_SOURCES )
+    {
+      return false;
+    }
+
+    SourceState &src = s_sources[ source ];
+    src.posted.fetch_add( 1, std::memory_order_relaxed );
+
+    /*-------------------------------------------------------------------------
+    Coalescing sources accumulate into their own state and set a ready bit, so
+    they can't be starved out of a queue that other sources have filled. Only
+    the post that sets the bit needs to wake a worker.
+    -------------------------------------------------------------------------*/
+    if ( src.coalesce )
+    {
+      const uint32_t bit = 1u << source;
+
+      /*-----------------------------------------------------------------------
+      Stamp the first post since the last execution. The time is written
+      before the flag that publishes it, and both before the count, so any
+      counted post finds a valid stamp. Zero is a legal time, hence the flag.
+      -----------------------------------------------------------------------*/
+      if ( !src.stamped.load( std::memory_order_acquire ) )
+      {
+        src.since.store( Chimera::micros(), std::memory_order_relaxed );
+        src.stamped.store( true, std::memory_order_release );
+      }
+
+      src.data.fetch_or( data, std::memory_order_acq_rel );
+      src.count.fetch_add( 1, std::memory_order_acq_rel );
+
+      if ( s_ready.fetch_or( bit, std::memory_order_acq_rel ) & bit )
+      {
+        src.coalesced.fetch_add( 1, std::memory_order_relaxed );
+        return true;
+      }
+    }
+    else if ( !s_queue.tryPush( Item{ source, data, Chimera::micros() } ) )
+    {
+      src.dropped.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+
+    wake( fromISR );
+    return true;
+  }
+
+
+  static bool execute( const Item &item )
+  {
+    SourceState &src   = s_sources[ item.source ];
+    Work         work  = { item.source, item.data, 1, item.timestamp };
+    bool         timed = true;
+
+    if ( src.coalesce )
+    {
+      /*-----------------------------------------------------------------------
+      The ready bit was cleared before getting here, so a post racing with
+      this one sets it again rather than being folded into work that was
+      already taken. The count is read before the data because posters write
+      them in the opposite order, so any post that is counted has its data
+      included.
+      -----------------------------------------------------------------------*/
+      timed          = src.stamped.exchange( false, std::memory_order_acq_rel );
+      work.timestamp = src.since.load( std::memory_order_relaxed );
+      work.count     = src.count.exchange( 0, std::memory_order_acq_rel );
+      work.data      = src.data.exchange( 0, std::memory_order_acq_rel );
+
+      if ( !work.count )
+      {
+        return false;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    Latency telemetry, skipped if a racing post hadn't stamped its time yet
+    -------------------------------------------------------------------------*/
+    if ( timed )
+    {
+      const size_t latency = Chimera::micros() - work.timestamp;
+
+      size_t current = src.minLatency.load( std::memory_order_relaxed );
+      while ( ( latency < current ) && !src.minLatency.compare_exchange_weak( current, latency, std::memory_order_relaxed ) )
+      {
+      }
+
+      current = src.maxLatency.load( std::memory_order_relaxed );
+      while ( ( latency > current ) && !src.maxLatency.compare_exchange_weak( current, latency, std::memory_order_relaxed ) )
+      {
+      }
+
+      src.totalLatency.fetch_add( latency, std::memory_order_relaxed );
+    }
+
+    src.executed.fetch_add( 1, std::memory_order_relaxed );
+
+    /*-------------------------------------------------------------------------
+    Run the handler
+    -------------------------------------------------------------------------*/
+    Handler handler = src.handler;
+    if ( handler )
+    {
+      handler( work );
+    }
+
+    return true;
+  }
+
+
+  static void WorkerThread( void *arg )
+  {
+    using namespace Chimera::Thread;
+    ( void )arg;
+
+    while ( true )
+    {
+      s_wakeup.acquire();
+
+      /*-----------------------------------------------------------------------
+      Re-arm before draining, same as Event::Subscriber::wait()
+      -----------------------------------------------------------------------*/
+      s_signaled.exchange( false, std::memory_order_acq_rel );
+      process();
+    }
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  Chimera::Status_t initialize()
+  {
+    using namespace Chimera::Thread;
+
+    /*-------------------------------------------------------------------------
+    Reset the source table
+    -------------------------------------------------------------------------*/
+    for ( SourceId x = 0; x < CHIMERA_DPC_MAX_SOURCES; x++ )
+    {
+      registerSource( x, {}, false );
+      resetStats( x );
+    }
+
+    /*-------------------------------------------------------------------------
+    Start the workers once
+    -------------------------------------------------------------------------*/
+    if ( s_driver_initialized == Chimera::DRIVER_INITIALIZED_KEY )
+    {
+      return Chimera::Status::OK;
+    }
+
+    s_wakeup.try_acquire();
+    s_signaled.store( false );
+
+    for ( size_t x = 0; x < CHIMERA_DPC_WORKERS; x++ )
+    {
+      TaskConfig cfg;
+
+      cfg.arg        = nullptr;
+      cfg.function   = WorkerThread;
+      cfg.priority   = CHIMERA_DPC_WORKER_PRIORITY;
+      cfg.stackWords = STACK_BYTES( CHIMERA_DPC_WORKER_STACK );
+      cfg.type       = TaskInitType::DYNAMIC;
+      cfg.name       = "DPCWorker";
+      cfg.name.push_back( static_cast<char>( '0' + x ) );
+
+      s_workers[ x ].create( cfg );
+      s_workers[ x ].start();
+    }
+
+    s_driver_initialized = Chimera::DRIVER_INITIALIZED_KEY;
+    return Chimera::Status::OK;
+  }
+
+
+  Chimera::Status_t registerSource( const SourceId source, Handler handler, const bool coalesce )
+  {
+    if ( source >= CHIMERA_DPC_MAX_SOURCES )
+    {
+      return Chimera::Status::INVAL_FUNC_PARAM;
+    }
+
+    SourceState &src = s_sources[ source ];
+    src.handler      = handler;
+    src.coalesce     = coalesce;
+    src.stamped.store( false, std::memory_order_relaxed );
+    src.since.store( 0, std::memory_order_relaxed );
+    src.data.store( 0, std::memory_order_relaxed );
+    src.count.store( 0, std::memory_order_relaxed );
+    s_ready.fetch_and( ~( 1u << source ), std::memory_order_relaxed );
+
+    return Chimera::Status::OK;
+  }
+
+
+  bool post( const SourceId source, const uint32_t data )
+  {
+    return enqueue( source, data, false );
+  }
+
+
+  bool postFromISR( const SourceId source, const uint32_t data )
+  {
+    return enqueue( source, data, true );
+  }
+
+
+  size_t process( const size_t limit )
+  {
+    Item   batch[ CHIMERA_DPC_BATCH_SIZE ];
+    size_t total = 0;
+
+    while ( total < limit )
+    {
+      /*-----------------------------------------------------------------------
+      Coalesced sources first, they have been waiting since their first post
+      -----------------------------------------------------------------------*/
+      uint32_t ready = s_ready.exchange( 0, std::memory_order_acq_rel );
+      for ( SourceId source = 0; ready; source++, ready >>= 1 )
+      {
+        if ( total >= limit )
+        {
+          /*-------------------------------------------------------------------
+          Out of budget. Hand the sources not yet run back to s_ready, where
+          later posts keep folding into them, and make sure someone comes
+          back for them.
+          -------------------------------------------------------------------*/
+          s_ready.fetch_or( ready << source, std::memory_order_acq_rel );
+          wake( false );
+          break;
+        }
+
+        if ( ready & 1u )
+        {
+          total += execute( Item{ source, 0, 0 } ) ? 1 : 0;
+        }
+      }
+
+      /*-----------------------------------------------------------------------
+      Then a batch of queued work
+      -----------------------------------------------------------------------*/
+      const size_t want  = ( ( limit - total ) < CHIMERA_DPC_BATCH_SIZE ) ? ( limit - total ) : CHIMERA_DPC_BATCH_SIZE;
+      const size_t count = ( total < limit ) ? s_queue.popBulk( batch, want ) : 0;
+      if ( !count && !s_ready.load( std::memory_order_relaxed ) )
+      {
+        break;
+      }
+
+      /*-----------------------------------------------------------------------
+      More work behind this batch, so hand it to another worker if there is
+      one instead of leaving it to wait on this thread's handlers.
+      -----------------------------------------------------------------------*/
+      if ( ( CHIMERA_DPC_WORKERS > 1 ) && !s_queue.emptyApprox() )
+      {
+        wake( false );
+      }
+
+      for ( size_t x = 0; x < count; x++ )
+      {
+        total += execute( batch[ x ] ) ? 1 : 0;
+      }
+    }
+
+    return total;
+  }
+
+
+  size_t pending()
+  {
+    return s_queue.sizeApprox() + __builtin_popcount( s_ready.load( std::memory_order_relaxed ) );
+  }
+
+
+  bool getStats( const SourceId source, Stats &stats )
+  {
+    if ( source >= CHIMERA_DPC_MAX_SOURCES )
+    {
+      return false;
+    }
+
+    const SourceState &src = s_sources[ source ];
+    stats.posted           = src.posted.load( std::memory_order_relaxed );
+    stats.executed         = src.executed.load( std::memory_order_relaxed );
+    stats.coalesced        = src.coalesced.load( std::memory_order_relaxed );
+    stats.dropped          = src.dropped.load( std::memory_order_relaxed );
+    stats.minLatency       = stats.executed ? src.minLatency.load( std::memory_order_relaxed ) : 0;
+    stats.maxLatency       = src.maxLatency.load( std::memory_order_relaxed );
+    stats.totalLatency     = src.totalLatency.load( std::memory_order_relaxed );
+
+    return true;
+  }
+
+
+  void resetStats( const SourceId source )
+  {
+    if ( source >= CHIMERA_DPC_MAX_SOURCES )
+    {
+      return;
+    }
+
+    SourceState &src = s_sources[ source ];
+    src.posted.store( 0, std::memory_order_relaxed );
+    src.executed.store( 0, std::memory_order_relaxed );
+    src.coalesced.store( 0, std::memory_order_relaxed );
+    src.dropped.store( 0, std::memory_order_relaxed );
+    src.minLatency.store( SIZE_MAX, std::memory_order_relaxed );
+    src.maxLatency.store( 0, std::memory_order_relaxed );
+    src.totalLatency.store( 0, std::memory_order_relaxed );
+  }
+
+}  // namespace Chimera::Interrupt::DPC
@@ -0,0 +1,200 @@
+/******************************************************************************
+ *  File Name:
+ *    interrupt_dpc.hpp
+ *
+ *  Description:
+ *    Deferred procedure call (bottom-half) queue for moving ISR work onto
+ *    worker threads
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_INTERRUPT_DPC_HPP
+#define CHIMERA_INTERRUPT_DPC_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* ETL Includes */
+#include <etl/delegate.h>
+
+/* Chimera Includes */
+#include <Chimera/common>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Number of work items that can be waiting for a worker. Must be a
+power of two.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_DPC_QUEUE_DEPTH
+#define CHIMERA_DPC_QUEUE_DEPTH ( 32 )
+#endif
+
+/*-------------------------------------------------------------------
+Number of distinct sources that can post work
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_DPC_MAX_SOURCES
+#define CHIMERA_DPC_MAX_SOURCES ( 16 )
+#endif
+
+/*-------------------------------------------------------------------
+Number of worker threads draining the queue
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_DPC_WORKERS
+#define CHIMERA_DPC_WORKERS ( 1 )
+#endif
+
+/*-------------------------------------------------------------------
+Work items a worker pulls off the queue at once
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_DPC_BATCH_SIZE
+#define CHIMERA_DPC_BATCH_SIZE ( 8 )
+#endif
+
+/*-------------------------------------------------------------------
+Worker thread stack size in bytes
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_DPC_WORKER_STACK
+#define CHIMERA_DPC_WORKER_STACK ( 1024 )
+#endif
+
+/*-------------------------------------------------------------------
+Worker thread priority. Deferred work should preempt everything
+but the ISRs that generate it.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_DPC_WORKER_PRIORITY
+#define CHIMERA_DPC_WORKER_PRIORITY ( Chimera::Thread::Priority::MAXIMUM - 1u )
+#endif
+
+namespace Chimera::Interrupt::DPC
+{
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  using SourceId = uint8_t;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Work handed to a source's handler on a worker thread
+   */
+  struct Work
+  {
+    SourceId source;    /**< Who posted the work */
+    uint32_t data;      /**< Posted data word, OR'd together if coalesced */
+    uint32_t count;     /**< Number of posts this work represents */
+    size_t   timestamp; /**< Time the work was queued (uS) */
+  };
+
+  /**
+   *  Per-source telemetry. Latency is measured from the post that queued the
+   *  work to the moment its handler is invoked, so for coalesced sources it
+   *  reflects the oldest post in the batch.
+   */
+  struct Stats
+  {
+    size_t posted;       /**< Calls to post() or postFromISR() */
+    size_t executed;     /**< Handler invocations */
+    size_t coalesced;    /**< Posts merged into already queued work */
+    size_t dropped;      /**< Posts that found the queue full */
+    size_t minLatency;   /**< Shortest queue to handler delay (uS) */
+    size_t maxLatency;   /**< Longest queue to handler delay (uS) */
+    size_t totalLatency; /**< Sum of all delays, for averaging (uS) */
+  };
+
+  using Handler = etl::delegate<void( const Work & )>;
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Resets the source table and starts the worker threads. Calling this more
+   *  than once only resets the sources.
+   *
+   *  @return Chimera::Status_t
+   */
+  Chimera::Status_t initialize();
+
+  /**
+   *  Assigns the handler for a source. A coalescing source never has more
+   *  than one piece of work outstanding: posts made while it is waiting OR
+   *  their data into it and bump its count instead. That suits status and
+   *  event flag style interrupts, where the handler only cares about what
+   *  happened, not how many times. Coalescing sources bypass the shared queue
+   *  and so can never be dropped.
+   *
+   *  @note Must not be called while the source may be posting
+   *  @warning With more than one worker, a handler may run on several threads
+   *           at once and must be reentrant.
+   *
+   *  @param[in]  source      Source to configure
+   *  @param[in]  handler     Work handler, or an empty delegate to disable
+   *  @param[in]  coalesce    Merge posts while work is pending
+   *  @return Chimera::Status_t
+   *
+   *  |   Return Value   |              Explanation             |
+   *  |:----------------:|:------------------------------------:|
+   *  |               OK | The handler was assigned             |
+   *  | INVAL_FUNC_PARAM | Source id out of range               |
+   */
+  Chimera::Status_t registerSource( const SourceId source, Handler handler, const bool coalesce );
+
+  /**
+   *  Queues work for a source from thread context
+   *
+   *  @param[in]  source      Source posting the work
+   *  @param[in]  data        Data word passed to the handler
+   *  @return bool            False if the work could not be queued
+   */
+  bool post( const SourceId source, const uint32_t data = 0 );
+
+  /**
+   *  Queues work for a source from an ISR. Never blocks or takes a lock.
+   *
+   *  @param[in]  source      Source posting the work
+   *  @param[in]  data        Data word passed to the handler
+   *  @return bool            False if the work could not be queued
+   */
+  bool postFromISR( const SourceId source, const uint32_t data = 0 );
+
+  /**
+   *  Runs queued work on the calling thread. The worker threads use this
+   *  internally; it is public so that systems without them can poll.
+   *
+   *  @param[in]  limit       Most work items to run this call
+   *  @return size_t          Number of handlers invoked
+   */
+  size_t process( const size_t limit = SIZE_MAX );
+
+  /**
+   *  Approximate number of work items waiting for a worker
+   *
+   *  @return size_t
+   */
+  size_t pending();
+
+  /**
+   *  Reads the telemetry for a source
+   *
+   *  @param[in]  source      Source to query
+   *  @param[out] stats       Receives the telemetry
+   *  @return bool            False if the source id is out of range
+   */
+  bool getStats( const SourceId source, Stats &stats );
+
+  /**
+   *  Zeros the telemetry for a source
+   *
+   *  @param[in]  source      Source to reset
+   *  @return void
+   */
+  void resetStats( const SourceId source );
+
+}  // namespace Chimera::Interrupt::DPC
+
+#endif /* !CHIMERA_INTERRUPT_DPC_HPP */
@@ -17,6 +17,7 @@
 #include <Chimera/scheduler>
 #include <Chimera/system>
 #include <Chimera/thread>
+#include <Chimera/trace>
 
 
 namespace Chimera::Scheduler::LoRes
@@ -313,6 +314,7 @@ namespace Chimera::Scheduler::LoRes
         /*---------------------------------------------------------------------
         Execute the function
         ---------------------------------------------------------------------*/
+        CHIMERA_TRACE( SCHED_FIRE, timer );
         s_registry[ timer ].func();
         s_registry[ timer ].numCalls++;
 
@@ -0,0 +1,323 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_format.cpp
+ *
+ *  Description:
+ *    Cost per call of formatted serial output. snprintf into a stack buffer
+ *    followed by write() is compared against CHIMERA_SERIAL_PRINT, which
+ *    formats in place, and against the call site cost of CHIMERA_SERIAL_DEFER.
+ *    Output goes over two native channels joined by Native::connect(). Only
+ *    the calls themselves are timed, and everything that arrives is checked
+ *    against the snprintf text.
+ *
+ *    Usage: chimera_serial_format_bench [rounds]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* ETL Includes */
+#include <etl/bip_buffer_spsc_atomic.h>
+
+/* Chimera Includes */
+#include <Chimera/log>
+#include <Chimera/serial>
+#include <Chimera/thread>
+
+namespace
+{
+  using namespace Chimera::Serial;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t BIP_SIZE = 64 * 1024;
+  static constexpr size_t TIMEOUT  = 1000;
+
+  /*-------------------------------------------------------------------
+  Calls per timed batch. A batch has to fit the TX buffer, and a
+  deferred batch the log queue.
+  -------------------------------------------------------------------*/
+  static constexpr size_t BATCH = 32;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  enum Method : size_t
+  {
+    SNPRINTF,
+    PRINT,
+    DEFER,
+
+    NUM_METHODS
+  };
+
+  static constexpr const char *METHOD_NAME[] = { "snprintf+write", "print", "defer" };
+
+  struct Result
+  {
+    double nanos[ NUM_METHODS ];  /**< Mean time per call */
+    size_t errors;                /**< Batches that didn't arrive as expected */
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static etl::bip_buffer_spsc_atomic<uint8_t, BIP_SIZE> s_txBuffer[ 2 ];
+  static etl::bip_buffer_spsc_atomic<uint8_t, BIP_SIZE> s_rxBuffer[ 2 ];
+
+  /*---------------------------------------------------------------------------
+  Test Cases
+  ---------------------------------------------------------------------------*/
+  /*-------------------------------------------------------------------
+  Each case is a functor called with a method and the call's index.
+  It returns what the method returned, or -1 on failure. Passing
+  NUM_METHODS writes the expected text into ref instead.
+  -------------------------------------------------------------------*/
+  struct Telemetry
+  {
+    static constexpr const char *name = "t=%u adc=%5d v=%.3f id=%s\\r\\n";
+
+    int operator()( const Method method, Driver &driver, const uint32_t i, char *const ref, const size_t size ) const
+    {
+      const int    adc = static_cast<int>( i % 4096 ) - 2048;
+      const double v   = static_cast<double>( i % 3300 ) / 1000.0;
+
+      switch ( method )
+      {
+        case SNPRINTF: {
+          char      buffer[ 128 ];
+          const int length = snprintf( buffer, sizeof( buffer ), "t=%u adc=%5d v=%.3f id=%s\r\n", i, adc, v, "imu0" );
+          return driver.write( buffer, static_cast<size_t>( length ), Chimera::Thread::TIMEOUT_DONT_WAIT );
+        }
+
+        case PRINT:
+          return CHIMERA_SERIAL_PRINT( driver, "t=%u adc=%5d v=%.3f id=%s\r\n", i, adc, v, "imu0" );
+
+        case DEFER:
+          return CHIMERA_SERIAL_DEFER( driver, "t=%u adc=%5d v=%.3f id=%s\r\n", i, adc, v, "imu0" ) ? 0 : -1;
+
+        default:
+          return snprintf( ref, size, "t=%u adc=%5d v=%.3f id=%s\r\n", i, adc, v, "imu0" );
+      }
+    }
+  };
+
+  struct Integers
+  {
+    static constexpr const char *name = "%u,%u,%u,%d,%08x\\n";
+
+    int operator()( const Method method, Driver &driver, const uint32_t i, char *const ref, const size_t size ) const
+    {
+      const uint32_t a = i * 2654435761u;
+      const int      b = -static_cast<int>( i );
+
+      switch ( method )
+      {
+        case SNPRINTF: {
+          char      buffer[ 128 ];
+          const int length = snprintf( buffer, sizeof( buffer ), "%u,%u,%u,%d,%08x\n", i, a, a >> 7, b, a ^ i );
+          return driver.write( buffer, static_cast<size_t>( length ), Chimera::Thread::TIMEOUT_DONT_WAIT );
+        }
+
+        case PRINT:
+          return CHIMERA_SERIAL_PRINT( driver, "%u,%u,%u,%d,%08x\n", i, a, a >> 7, b, a ^ i );
+
+        case DEFER:
+          return CHIMERA_SERIAL_DEFER( driver, "%u,%u,%u,%d,%08x\n", i, a, a >> 7, b, a ^ i ) ? 0 : -1;
+
+        default:
+          return snprintf( ref, size, "%u,%u,%u,%d,%08x\n", i, a, a >> 7, b, a ^ i );
+      }
+    }
+  };
+
+  struct Text
+  {
+    static constexpr const char *name = "[%s] state %s -> %s\\r\\n";
+
+    int operator()( const Method method, Driver &driver, const uint32_t i, char *const ref, const size_t size ) const
+    {
+      const char *const from = ( i & 1u ) ? "IDLE" : "RUN";
+      const char *const to   = ( i & 1u ) ? "RUN" : "IDLE";
+
+      switch ( method )
+      {
+        case SNPRINTF: {
+          char      buffer[ 128 ];
+          const int length = snprintf( buffer, sizeof( buffer ), "[%s] state %s -> %s\r\n", "motor", from, to );
+          return driver.write( buffer, static_cast<size_t>( length ), Chimera::Thread::TIMEOUT_DONT_WAIT );
+        }
+
+        case PRINT:
+          return CHIMERA_SERIAL_PRINT( driver, "[%s] state %s -> %s\r\n", "motor", from, to );
+
+        case DEFER:
+          return CHIMERA_SERIAL_DEFER( driver, "[%s] state %s -> %s\r\n", "motor", from, to ) ? 0 : -1;
+
+        default:
+          return snprintf( ref, size, "[%s] state %s -> %s\r\n", "motor", from, to );
+      }
+    }
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Reads exactly length bytes unless the timeout expires
+   *
+   *  @return size_t          Bytes read
+   */
+  static size_t readAll( Driver &rx, uint8_t *const buffer, const size_t length )
+  {
+    const size_t start = Chimera::millis();
+    size_t       done  = 0;
+
+    while ( ( done < length ) && ( ( Chimera::millis() - start ) < TIMEOUT ) )
+    {
+      const int count = rx.read( buffer + done, length - done, 1 );
+      if ( count > 0 )
+      {
+        done += static_cast<size_t>( count );
+      }
+    }
+
+    return done;
+  }
+
+
+  /**
+   *  Times rounds of BATCH calls of one case with every method. The deferred
+   *  batch is played back by Chimera::Log::drain() outside the timed region.
+   */
+  template<typename Case>
+  static Result run( Driver &tx, Driver &rx, const size_t rounds )
+  {
+    using Clock = std::chrono::steady_clock;
+
+    const Case           call;
+    Result               result = {};
+    std::string          expect;
+    std::vector<uint8_t> incoming;
+    char                 line[ 128 ];
+
+    for ( size_t round = 0; round < rounds; round++ )
+    {
+      const uint32_t first = static_cast<uint32_t>( round * BATCH );
+
+      expect.clear();
+      for ( uint32_t x = 0; x < BATCH; x++ )
+      {
+        const int length = call( NUM_METHODS, tx, first + x, line, sizeof( line ) );
+        expect.append( line, static_cast<size_t>( length ) );
+      }
+      incoming.resize( expect.size() );
+
+      for ( size_t m = 0; m < NUM_METHODS; m++ )
+      {
+        const Method method = static_cast<Method>( m );
+        bool         ok     = true;
+
+        const auto start = Clock::now();
+        for ( uint32_t x = 0; x < BATCH; x++ )
+        {
+          ok &= ( call( method, tx, first + x, line, sizeof( line ) ) >= 0 );
+        }
+        const auto stop = Clock::now();
+
+        if ( method == DEFER )
+        {
+          Chimera::Log::drain();
+        }
+
+        result.nanos[ m ] += std::chrono::duration<double, std::nano>( stop - start ).count();
+
+        const size_t read = readAll( rx, incoming.data(), incoming.size() );
+        ok &= ( read == expect.size() ) && ( memcmp( incoming.data(), expect.data(), read ) == 0 );
+        result.errors += ok ? 0u : 1u;
+      }
+    }
+
+    for ( double &nanos : result.nanos )
+    {
+      nanos /= static_cast<double>( rounds * BATCH );
+    }
+
+    return result;
+  }
+
+
+  template<typename Case>
+  static bool report( Driver &tx, Driver &rx, const size_t rounds )
+  {
+    const Result result = run<Case>( tx, rx, rounds );
+
+    printf( "%-32s", Case::name );
+    for ( const double nanos : result.nanos )
+    {
+      printf( " %14.1f", nanos );
+    }
+    printf( "  %5.2fx  errors %zu\n", result.nanos[ SNPRINTF ] / result.nanos[ PRINT ], result.errors );
+
+    return result.errors == 0;
+  }
+
+
+  static Driver_rPtr openChannel( const Channel channel, const size_t index )
+  {
+    Config config   = {};
+    config.channel  = channel;
+    config.width    = CharWid::CW_8BIT;
+    config.parity   = Parity::PAR_NONE;
+    config.stopBits = StopBits::SBITS_ONE;
+    config.flow     = FlowControl::FCTRL_NONE;
+    config.txfrMode = TxfrMode::DMA;
+    config.rxBuffer = &s_rxBuffer[ index ];
+    config.txBuffer = &s_txBuffer[ index ];
+
+    Driver_rPtr driver = getDriver( channel );
+    return ( driver && ( driver->open( config ) == Chimera::Status::OK ) ) ? driver : nullptr;
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t rounds = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 5000;
+
+  Chimera::Serial::initialize();
+  Driver_rPtr tx = openChannel( Channel::SERIAL1, 0 );
+  Driver_rPtr rx = openChannel( Channel::SERIAL2, 1 );
+  if ( !tx || !rx || ( Native::connect( Channel::SERIAL1, Channel::SERIAL2 ) != Chimera::Status::OK ) )
+  {
+    printf( "Couldn't connect the native channels\n" );
+    return 1;
+  }
+
+  printf( "ns per call, %zu calls per case\n%-32s", rounds * BATCH, "format" );
+  for ( const char *name : METHOD_NAME )
+  {
+    printf( " %14s", name );
+  }
+  printf( "  speedup\n" );
+
+  bool ok = true;
+  ok      = report<Telemetry>( *tx, *rx, rounds ) && ok;
+  ok      = report<Integers>( *tx, *rx, rounds ) && ok;
+  ok      = report<Text>( *tx, *rx, rounds ) && ok;
+
+  printf( "deferred prints dropped: %zu\n", Chimera::Serial::Format::dropped() );
+
+  tx->close();
+  rx->close();
+  return ok ? 0 : 1;
+}
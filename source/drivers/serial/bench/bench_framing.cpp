@@ -0,0 +1,226 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_framing.cpp
+ *
+ *  Description:
+ *    Framing throughput in MB/s of payload. Every protocol and check is first
+ *    run in memory, encode and decode timed separately, then with CRC-32 over
+ *    two native channels joined by Native::connect(), where writeFrame() and
+ *    readFrame() go through the drivers' bip buffers. Every frame is checked
+ *    against what was sent.
+ *
+ *    Usage: chimera_serial_framing_bench [frame bytes] [frames]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+/* ETL Includes */
+#include <etl/bip_buffer_spsc_atomic.h>
+
+/* Chimera Includes */
+#include <Chimera/serial>
+
+namespace
+{
+  using namespace Chimera::Serial;
+  using namespace Chimera::Serial::Framing;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t BIP_SIZE = 16 * 1024;
+  static constexpr size_t TIMEOUT  = 2000;
+
+  static constexpr const char *PROTOCOL_NAME[] = { "COBS", "SLIP", "HDLC" };
+  static constexpr const char *CHECK_NAME[]    = { "none", "CRC-16", "CRC-32" };
+
+  static_assert( ( sizeof( PROTOCOL_NAME ) / sizeof( PROTOCOL_NAME[ 0 ] ) ) == static_cast<size_t>( Protocol::NUM_OPTIONS ) );
+  static_assert( ( sizeof( CHECK_NAME ) / sizeof( CHECK_NAME[ 0 ] ) ) == static_cast<size_t>( Check::NUM_OPTIONS ) );
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static etl::bip_buffer_spsc_atomic<uint8_t, BIP_SIZE> s_txBuffer[ 2 ];
+  static etl::bip_buffer_spsc_atomic<uint8_t, BIP_SIZE> s_rxBuffer[ 2 ];
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static double megabytes( const size_t bytes, const std::chrono::steady_clock::time_point start,
+                           const std::chrono::steady_clock::time_point stop )
+  {
+    return static_cast<double>( bytes ) / std::chrono::duration<double, std::micro>( stop - start ).count();
+  }
+
+
+  /**
+   *  Encodes every frame into one flat stream, then decodes the stream back
+   *
+   *  @return bool            False if a frame didn't come back intact
+   */
+  static bool runMemory( const Protocol protocol, const Check check, const std::vector<uint8_t> &payload,
+                         const size_t frames )
+  {
+    const size_t         length  = payload.size();
+    const size_t         maxSize = maxEncodedSize( protocol, check, length );
+    std::vector<uint8_t> stream( maxSize * frames );
+    std::vector<uint8_t> frame( length + sizeof( uint32_t ) );
+
+    size_t     streamLen = 0;
+    const auto encStart  = std::chrono::steady_clock::now();
+    for ( size_t x = 0; x < frames; x++ )
+    {
+      streamLen += encode( protocol, check, payload.data(), length, stream.data() + streamLen, maxSize );
+    }
+    const auto encStop = std::chrono::steady_clock::now();
+
+    Decoder    decoder( protocol, check, frame.data(), frame.size() );
+    size_t     offset   = 0;
+    size_t     intact   = 0;
+    const auto decStart = std::chrono::steady_clock::now();
+    while ( offset < streamLen )
+    {
+      size_t consumed = 0;
+      if ( decoder.decode( stream.data() + offset, streamLen - offset, consumed ) == Result::FRAME )
+      {
+        const etl::span<uint8_t> out = decoder.frame();
+        intact += ( out.size() == length ) && ( memcmp( out.data(), payload.data(), length ) == 0 );
+      }
+      offset += consumed;
+    }
+    const auto decStop = std::chrono::steady_clock::now();
+
+    printf( "%s %-6s  encode %8.1f MB/s  decode %8.1f MB/s  overhead %5.2f%%\n", PROTOCOL_NAME[ static_cast<size_t>( protocol ) ],
+            CHECK_NAME[ static_cast<size_t>( check ) ], megabytes( length * frames, encStart, encStop ),
+            megabytes( length * frames, decStart, decStop ),
+            100.0 * static_cast<double>( streamLen - ( length * frames ) ) / static_cast<double>( length * frames ) );
+
+    return intact == frames;
+  }
+
+
+  /**
+   *  Streams CRC-32 frames from one connected channel to the other, with the
+   *  receiver on its own thread
+   *
+   *  @return bool            False if a frame was lost, damaged or timed out
+   */
+  static bool runLink( const Protocol protocol, Driver &tx, Driver &rx, const std::vector<uint8_t> &payload,
+                       const size_t frames )
+  {
+    const size_t         length = payload.size();
+    std::vector<uint8_t> frame( length + sizeof( uint32_t ) );
+    Encoder              encoder( protocol, Check::CRC32 );
+    Decoder              decoder( protocol, Check::CRC32, frame.data(), frame.size() );
+
+    size_t      intact = 0;
+    size_t      failed = 0;
+    std::thread reader( [ & ]() {
+      while ( ( intact + failed ) < frames )
+      {
+        const Result result = readFrame( rx, decoder, TIMEOUT );
+        if ( result == Result::NEED_MORE )
+        {
+          break;
+        }
+
+        const etl::span<uint8_t> out = decoder.frame();
+        if ( ( result == Result::FRAME ) && ( out.size() == length ) && ( memcmp( out.data(), payload.data(), length ) == 0 ) )
+        {
+          intact++;
+        }
+        else
+        {
+          failed++;
+        }
+      }
+    } );
+
+    size_t     sent  = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while ( ( sent < frames ) && ( writeFrame( tx, encoder, payload.data(), length, TIMEOUT ) == static_cast<int>( length ) ) )
+    {
+      sent++;
+    }
+    reader.join();
+    const auto stop = std::chrono::steady_clock::now();
+
+    printf( "%s CRC-32  link   %8.1f MB/s  %zu/%zu frames intact\n", PROTOCOL_NAME[ static_cast<size_t>( protocol ) ],
+            megabytes( length * intact, start, stop ), intact, frames );
+
+    return intact == frames;
+  }
+
+
+  static Driver_rPtr openChannel( const Channel channel, const size_t index )
+  {
+    Config config   = {};
+    config.channel  = channel;
+    config.width    = CharWid::CW_8BIT;
+    config.parity   = Parity::PAR_NONE;
+    config.stopBits = StopBits::SBITS_ONE;
+    config.flow     = FlowControl::FCTRL_NONE;
+    config.txfrMode = TxfrMode::DMA;
+    config.rxBuffer = &s_rxBuffer[ index ];
+    config.txBuffer = &s_txBuffer[ index ];
+
+    Driver_rPtr driver = getDriver( channel );
+    return ( driver && ( driver->open( config ) == Chimera::Status::OK ) ) ? driver : nullptr;
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t length = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 1024;
+  const size_t frames = ( argc > 2 ) ? strtoul( argv[ 2 ], nullptr, 0 ) : 50000;
+
+  std::mt19937         rng( 1 );
+  std::vector<uint8_t> payload( length );
+  for ( uint8_t &byte : payload )
+  {
+    byte = static_cast<uint8_t>( rng() );
+  }
+
+  printf( "%zu frames of %zu random bytes\n", frames, length );
+
+  bool ok = true;
+  for ( size_t p = 0; p < static_cast<size_t>( Protocol::NUM_OPTIONS ); p++ )
+  {
+    for ( size_t c = 0; c < static_cast<size_t>( Check::NUM_OPTIONS ); c++ )
+    {
+      ok = runMemory( static_cast<Protocol>( p ), static_cast<Check>( c ), payload, frames ) && ok;
+    }
+  }
+
+  /*-------------------------------------------------------------------------
+  Over the native backend. The link has no baud rate, so this measures the
+  framing plus the driver's buffer handling and the socket.
+  -------------------------------------------------------------------------*/
+  Chimera::Serial::initialize();
+  Driver_rPtr tx = openChannel( Channel::SERIAL1, 0 );
+  Driver_rPtr rx = openChannel( Channel::SERIAL2, 1 );
+  if ( !tx || !rx || ( Native::connect( Channel::SERIAL1, Channel::SERIAL2 ) != Chimera::Status::OK ) )
+  {
+    printf( "Couldn't connect the native channels\n" );
+    return 1;
+  }
+
+  for ( size_t p = 0; p < static_cast<size_t>( Protocol::NUM_OPTIONS ); p++ )
+  {
+    ok = runLink( static_cast<Protocol>( p ), *tx, *rx, payload, frames ) && ok;
+  }
+
+  tx->close();
+  rx->close();
+  return ok ? 0 : 1;
+}
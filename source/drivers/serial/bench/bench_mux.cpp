@@ -0,0 +1,436 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_mux.cpp
+ *
+ *  Description:
+ *    Latency of short commands while a bulk stream saturates the same link.
+ *    The baseline shares one driver between the two writers with a mutex,
+ *    the way code did before the multiplexer. The mux run puts commands on a
+ *    high priority channel and the stream on a low one.
+ *
+ *    The native backend has no bit timing, so each pair of channels is PTYs
+ *    bridged by a thread that forwards at the baud rate, 10 bits per byte.
+ *    An unpaced link would leave nothing queued and make the run a measure
+ *    of thread scheduling instead.
+ *
+ *    Usage: chimera_serial_mux_bench [commands] [bulk write bytes] [baud]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Linux Includes */
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+/* ETL Includes */
+#include <etl/bip_buffer_spsc_atomic.h>
+
+/* Chimera Includes */
+#include <Chimera/serial>
+
+namespace
+{
+  using namespace Chimera::Serial;
+  using Clock = std::chrono::steady_clock;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t  COMMAND_SIZE   = 8;
+  static constexpr uint8_t COMMAND_BYTE   = 0xC5;
+  static constexpr uint8_t BULK_BYTE      = 0x11;
+  static constexpr size_t  TIMEOUT        = 1000;
+  static constexpr size_t  POLL           = 20;
+  static constexpr auto    COMMAND_PERIOD = std::chrono::milliseconds( 5 );
+  static constexpr auto    SETTLE         = std::chrono::milliseconds( 200 );
+  static constexpr auto    TICK           = std::chrono::milliseconds( 1 );
+
+  static constexpr size_t CMD_CHANNEL  = 0;
+  static constexpr size_t BULK_CHANNEL = 1;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Physical ports. The TX side is kept to a few chunks so the mux decides
+   *  the order of nearly everything on the wire.
+   */
+  struct Port
+  {
+    etl::bip_buffer_spsc_atomic<uint8_t, 256>  tx;
+    etl::bip_buffer_spsc_atomic<uint8_t, 4096> rx;
+  };
+
+  struct Channel
+  {
+    etl::bip_buffer_spsc_atomic<uint8_t, 4096> tx;
+    etl::bip_buffer_spsc_atomic<uint8_t, 1024> rx;
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static Port      s_port[ 4 ];
+  static Channel   s_channel[ 2 ][ Mux::NUM_CHANNELS ];
+  static Mux::Link s_link[ 2 ];
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Forwards bytes from one PTY to another no faster than the line rate.
+   *  Credit doesn't accumulate while the line is idle, like a real UART.
+   */
+  static void wire( const int from, const int to, const size_t bytesPerSec, const std::atomic<bool> &stop )
+  {
+    const double perTick = static_cast<double>( bytesPerSec ) * std::chrono::duration<double>( TICK ).count();
+    uint8_t      buffer[ 256 ];
+    double       budget = 0.0;
+    auto         next   = Clock::now();
+
+    while ( !stop.load() )
+    {
+      next += TICK;
+      std::this_thread::sleep_until( next );
+      budget = std::min( budget + perTick, perTick + 1.0 );
+
+      pollfd readable = { from, POLLIN, 0 };
+      if ( ( budget < 1.0 ) || ( poll( &readable, 1, 0 ) <= 0 ) )
+      {
+        continue;
+      }
+
+      const ssize_t length = ::read( from, buffer, std::min( sizeof( buffer ), static_cast<size_t>( budget ) ) );
+      ssize_t       offset = 0;
+      while ( ( offset < length ) && !stop.load() )
+      {
+        pollfd writable = { to, POLLOUT, 0 };
+        if ( poll( &writable, 1, static_cast<int>( POLL ) ) > 0 )
+        {
+          offset += std::max<ssize_t>( ::write( to, buffer + offset, length - offset ), 0 );
+        }
+      }
+
+      budget -= static_cast<double>( std::max<ssize_t>( length, 0 ) );
+    }
+  }
+
+
+  /**
+   *  Starts the two directions of a paced link between the far ends of a
+   *  pair of channels
+   */
+  static void bridge( const Chimera::Serial::Channel a, const Chimera::Serial::Channel b, const size_t bytesPerSec,
+                      const std::atomic<bool> &stop, std::vector<std::thread> &threads )
+  {
+    const int ends[ 2 ] = { Native::peerFd( a ), Native::peerFd( b ) };
+    for ( const int fd : ends )
+    {
+      fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+    }
+
+    threads.emplace_back( wire, ends[ 0 ], ends[ 1 ], bytesPerSec, std::cref( stop ) );
+    threads.emplace_back( wire, ends[ 1 ], ends[ 0 ], bytesPerSec, std::cref( stop ) );
+  }
+
+
+  static Driver_rPtr openPort( const Chimera::Serial::Channel channel, const size_t index, const size_t baud )
+  {
+    Native::setTransport( channel, Native::Transport::PTY );
+
+    Config config   = {};
+    config.channel  = channel;
+    config.baud     = baud;
+    config.width    = CharWid::CW_8BIT;
+    config.parity   = Parity::PAR_NONE;
+    config.stopBits = StopBits::SBITS_ONE;
+    config.flow     = FlowControl::FCTRL_NONE;
+    config.txfrMode = TxfrMode::DMA;
+    config.rxBuffer = &s_port[ index ].rx;
+    config.txBuffer = &s_port[ index ].tx;
+
+    Driver_rPtr driver = getDriver( channel );
+    return ( driver && ( driver->open( config ) == Chimera::Status::OK ) ) ? driver : nullptr;
+  }
+
+
+  static double elapsedUs( const Clock::time_point start, const Clock::time_point stop )
+  {
+    return std::chrono::duration<double, std::micro>( stop - start ).count();
+  }
+
+
+  /**
+   *  Sends a command every period while the caller's bulk writer runs, and
+   *  prints the percentiles of the samples the receiver recorded
+   *
+   *  @return bool            False if a command never arrived
+   */
+  template<typename Send>
+  static bool sendCommands( const char *const name, const size_t commands, std::atomic<Clock::time_point> &sent,
+                            std::vector<double> &samples, std::mutex &lock, Send &&send )
+  {
+    std::this_thread::sleep_for( SETTLE );
+
+    const uint8_t command[ COMMAND_SIZE ] = { COMMAND_BYTE, COMMAND_BYTE, COMMAND_BYTE, COMMAND_BYTE,
+                                              COMMAND_BYTE, COMMAND_BYTE, COMMAND_BYTE, COMMAND_BYTE };
+    for ( size_t x = 0; x < commands; x++ )
+    {
+      sent.store( Clock::now() );
+      if ( !send( command ) )
+      {
+        break;
+      }
+
+      std::this_thread::sleep_for( COMMAND_PERIOD );
+    }
+
+    /*-------------------------------------------------------------------------
+    Give the last command up to the timeout to arrive
+    -------------------------------------------------------------------------*/
+    const auto deadline = Clock::now() + std::chrono::milliseconds( TIMEOUT );
+    while ( Clock::now() < deadline )
+    {
+      {
+        std::lock_guard<std::mutex> guard( lock );
+        if ( samples.size() >= commands )
+        {
+          break;
+        }
+      }
+
+      std::this_thread::sleep_for( std::chrono::milliseconds( POLL ) );
+    }
+
+    std::lock_guard<std::mutex> guard( lock );
+    std::sort( samples.begin(), samples.end() );
+    if ( samples.size() != commands )
+    {
+      printf( "%-8s %zu of %zu commands arrived\n", name, samples.size(), commands );
+      return false;
+    }
+
+    printf( "%-8s median %9.1f us  p99 %9.1f us  max %9.1f us\n", name, samples[ samples.size() / 2 ],
+            samples[ ( samples.size() * 99 ) / 100 ], samples.back() );
+    return true;
+  }
+
+
+  /**
+   *  Bulk and commands share a driver through a mutex. The receiver finds
+   *  each command by its run of marker bytes.
+   */
+  static bool runBaseline( Driver &tx, Driver &rx, const size_t commands, const size_t block )
+  {
+    std::atomic<bool>              stop( false );
+    std::atomic<Clock::time_point> sent( Clock::now() );
+    std::mutex                     writeLock;
+    std::mutex                     sampleLock;
+    std::vector<double>            samples;
+
+    std::thread bulk( [ & ]() {
+      const std::vector<uint8_t> data( block, BULK_BYTE );
+      while ( !stop.load() )
+      {
+        std::lock_guard<std::mutex> guard( writeLock );
+        size_t                      written = 0;
+        while ( ( written < data.size() ) && !stop.load() )
+        {
+          written += std::max( tx.write( data.data() + written, data.size() - written, POLL ), 0 );
+        }
+      }
+    } );
+
+    std::thread sink( [ & ]() {
+      uint8_t buffer[ 1024 ];
+      size_t  run = 0;
+      while ( !stop.load() )
+      {
+        const int read = rx.read( buffer, sizeof( buffer ), POLL );
+        for ( int x = 0; x < read; x++ )
+        {
+          run = ( buffer[ x ] == COMMAND_BYTE ) ? run + 1 : 0;
+          if ( run == COMMAND_SIZE )
+          {
+            std::lock_guard<std::mutex> guard( sampleLock );
+            samples.push_back( elapsedUs( sent.load(), Clock::now() ) );
+            run = 0;
+          }
+        }
+      }
+    } );
+
+    const bool ok = sendCommands( "mutex", commands, sent, samples, sampleLock, [ & ]( const uint8_t *const command ) {
+      std::lock_guard<std::mutex> guard( writeLock );
+      return tx.write( command, COMMAND_SIZE, TIMEOUT ) == static_cast<int>( COMMAND_SIZE );
+    } );
+
+    stop.store( true );
+    bulk.join();
+    sink.join();
+    return ok;
+  }
+
+
+  /**
+   *  Commands on a high priority channel, bulk on a low one
+   */
+  static bool runMux( Driver &a, Driver &b, const size_t commands, const size_t block )
+  {
+    Driver *const drivers[ 2 ] = { &a, &b };
+    for ( size_t side = 0; side < 2; side++ )
+    {
+      if ( s_link[ side ].open( *drivers[ side ] ) != Chimera::Status::OK )
+      {
+        return false;
+      }
+
+      for ( size_t ch = 0; ch < Mux::NUM_CHANNELS; ch++ )
+      {
+        Config config   = {};
+        config.rxBuffer = &s_channel[ side ][ ch ].rx;
+        config.txBuffer = &s_channel[ side ][ ch ].tx;
+        if ( s_link[ side ].endpoint( ch )->open( config ) != Chimera::Status::OK )
+        {
+          return false;
+        }
+      }
+
+      s_link[ side ].endpoint( CMD_CHANNEL )->setScheduling( 1, 1 );
+      s_link[ side ].endpoint( BULK_CHANNEL )->setScheduling( 0, 1 );
+    }
+
+    std::atomic<bool>        stop( false );
+    std::vector<std::thread> pumps;
+    for ( Mux::Link &link : s_link )
+    {
+      pumps.emplace_back( [ &stop, &link ]() {
+        while ( !stop.load() )
+        {
+          link.processTX( POLL );
+        }
+      } );
+      pumps.emplace_back( [ &stop, &link ]() {
+        while ( !stop.load() )
+        {
+          link.processRX( POLL );
+        }
+      } );
+    }
+
+    Mux::Endpoint *const cmdTx  = s_link[ 0 ].endpoint( CMD_CHANNEL );
+    Mux::Endpoint *const cmdRx  = s_link[ 1 ].endpoint( CMD_CHANNEL );
+    Mux::Endpoint *const bulkTx = s_link[ 0 ].endpoint( BULK_CHANNEL );
+    Mux::Endpoint *const bulkRx = s_link[ 1 ].endpoint( BULK_CHANNEL );
+
+    std::atomic<bool>              done( false );
+    std::atomic<Clock::time_point> sent( Clock::now() );
+    std::mutex                     sampleLock;
+    std::vector<double>            samples;
+
+    std::thread bulk( [ & ]() {
+      const std::vector<uint8_t> data( block, BULK_BYTE );
+      while ( !done.load() )
+      {
+        bulkTx->write( data.data(), data.size(), POLL );
+      }
+    } );
+
+    std::thread sink( [ & ]() {
+      uint8_t buffer[ 1024 ];
+      while ( !done.load() )
+      {
+        bulkRx->read( buffer, sizeof( buffer ), POLL );
+      }
+    } );
+
+    std::thread receiver( [ & ]() {
+      uint8_t buffer[ COMMAND_SIZE ];
+      size_t  length = 0;
+      while ( !done.load() )
+      {
+        length += std::max( cmdRx->read( buffer + length, COMMAND_SIZE - length, POLL ), 0 );
+        if ( length == COMMAND_SIZE )
+        {
+          std::lock_guard<std::mutex> guard( sampleLock );
+          samples.push_back( elapsedUs( sent.load(), Clock::now() ) );
+          length = 0;
+        }
+      }
+    } );
+
+    const bool ok = sendCommands( "mux", commands, sent, samples, sampleLock, [ & ]( const uint8_t *const command ) {
+      return cmdTx->write( command, COMMAND_SIZE, TIMEOUT ) == static_cast<int>( COMMAND_SIZE );
+    } );
+
+    done.store( true );
+    bulk.join();
+    sink.join();
+    receiver.join();
+
+    stop.store( true );
+    for ( std::thread &pump : pumps )
+    {
+      pump.join();
+    }
+
+    return ok;
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t commands = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : 200;
+  const size_t block    = ( argc > 2 ) ? strtoul( argv[ 2 ], nullptr, 0 ) : 4096;
+  const size_t baud     = ( argc > 3 ) ? strtoul( argv[ 3 ], nullptr, 0 ) : 921600;
+
+  printf( "%zu commands of %zu bytes, one every %lld ms, bulk writes of %zu bytes, %zu baud\n", commands, COMMAND_SIZE,
+          static_cast<long long>( COMMAND_PERIOD.count() ), block, baud );
+
+  /*-------------------------------------------------------------------------
+  Each run gets its own pair of channels, so nothing is left queued from the
+  one before
+  -------------------------------------------------------------------------*/
+  using Chimera::Serial::Channel;
+
+  Chimera::Serial::initialize();
+  Driver_rPtr port[ 4 ] = { openPort( Channel::SERIAL1, 0, baud ), openPort( Channel::SERIAL2, 1, baud ),
+                            openPort( Channel::SERIAL3, 2, baud ), openPort( Channel::SERIAL4, 3, baud ) };
+  if ( !port[ 0 ] || !port[ 1 ] || !port[ 2 ] || !port[ 3 ] )
+  {
+    printf( "Couldn't open the PTY channels\n" );
+    return 1;
+  }
+
+  std::atomic<bool>        stop( false );
+  std::vector<std::thread> wires;
+  bridge( Channel::SERIAL1, Channel::SERIAL2, baud / 10, stop, wires );
+  bridge( Channel::SERIAL3, Channel::SERIAL4, baud / 10, stop, wires );
+
+  const bool ok = runBaseline( *port[ 0 ], *port[ 1 ], commands, block ) && runMux( *port[ 2 ], *port[ 3 ], commands, block );
+
+  stop.store( true );
+  for ( std::thread &thread : wires )
+  {
+    thread.join();
+  }
+
+  for ( Driver_rPtr driver : port )
+  {
+    driver->close();
+  }
+
+  return ok ? 0 : 1;
+}
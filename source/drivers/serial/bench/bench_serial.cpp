@@ -0,0 +1,428 @@
+/******************************************************************************
+ *  File Name:
+ *    bench_serial.cpp
+ *
+ *  Description:
+ *    Serial loopback throughput and latency over two native channels joined
+ *    by Native::connect(). Throughput streams a verified byte pattern and
+ *    reports MB/s and process CPU time per byte. Latency times single
+ *    message round trips. Only the public Driver API is used. Every TxfrMode
+ *    and baud rate in the sweep gets its own rows.
+ *
+ *    The native backend ignores the baud rate and TxfrMode, so on a host the
+ *    rows only differ by noise and measure the driver and buffer paths. The
+ *    sweep is there for backends that honor them.
+ *
+ *    Usage: chimera_serial_bench [bytes per throughput run] [latency samples]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* Linux Includes */
+#include <time.h>
+
+/* ETL Includes */
+#include <etl/bip_buffer_spsc_atomic.h>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/serial>
+#include <Chimera/thread>
+
+namespace
+{
+  using namespace Chimera::Serial;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t BIP_SIZE = 16 * 1024;
+  static constexpr size_t TIMEOUT  = 1000;
+
+  static constexpr size_t MESSAGE_SIZES[] = { 64, 1024, 8192 };
+
+  static constexpr TxfrMode MODES[]      = { TxfrMode::BLOCKING, TxfrMode::INTERRUPT, TxfrMode::DMA };
+  static constexpr BaudRate BAUD_RATES[] = { BaudRate::SERIAL_BAUD_115200, BaudRate::SERIAL_BAUD_921600 };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct Result
+  {
+    size_t   bytes;      /**< Bytes that arrived */
+    size_t   errors;     /**< Bytes that arrived with the wrong value */
+    size_t   messages;   /**< Latency samples taken */
+    uint64_t elapsed;    /**< Wall time of the test (uS) */
+    uint64_t cpu;        /**< Process CPU time of the test (uS) */
+    uint32_t latencyP50; /**< Write start to last byte read (uS) */
+    uint32_t latencyP99;
+    uint32_t latencyMax;
+  };
+
+  /**
+   *  Clock readings at one point in a test
+   */
+  struct Mark
+  {
+    size_t   wall; /**< Chimera::micros() */
+    uint64_t cpu;  /**< Process time, so the IO thread standing in for the hardware is counted */
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static etl::bip_buffer_spsc_atomic<uint8_t, BIP_SIZE> s_txBuffer[ 2 ];
+  static etl::bip_buffer_spsc_atomic<uint8_t, BIP_SIZE> s_rxBuffer[ 2 ];
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  The test stream repeats the first messageSize bytes of this sequence.
+   *  Its period is long enough that a dropped or repeated chunk shows up as
+   *  errors rather than lining up again.
+   */
+  static void fillPattern( uint8_t *const data, const size_t length )
+  {
+    for ( size_t x = 0; x < length; x++ )
+    {
+      data[ x ] = static_cast<uint8_t>( ( x * 31u ) + ( x >> 8 ) + 7u );
+    }
+  }
+
+
+  /**
+   *  Counts the bytes that differ from the stream
+   *
+   *  @param[in]  data        Received bytes
+   *  @param[in]  length      Number of received bytes
+   *  @param[in]  position    Stream offset of the first one
+   *  @param[in]  pattern     One period of the stream
+   *  @param[in]  period      Bytes in the period
+   *  @return size_t
+   */
+  static size_t verify( const uint8_t *data, size_t length, size_t position, const uint8_t *const pattern, const size_t period )
+  {
+    size_t errors = 0;
+
+    while ( length )
+    {
+      const size_t offset = position % period;
+      const size_t step   = std::min( length, period - offset );
+
+      if ( memcmp( data, pattern + offset, step ) != 0 )
+      {
+        for ( size_t x = 0; x < step; x++ )
+        {
+          errors += ( data[ x ] != pattern[ offset + x ] ) ? 1u : 0u;
+        }
+      }
+
+      data += step;
+      length -= step;
+      position += step;
+    }
+
+    return errors;
+  }
+
+
+  static Mark mark()
+  {
+    timespec ts;
+    clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+
+    Mark now;
+    now.cpu  = ( static_cast<uint64_t>( ts.tv_sec ) * 1000000u ) + ( static_cast<uint64_t>( ts.tv_nsec ) / 1000u );
+    now.wall = Chimera::micros();
+    return now;
+  }
+
+
+  static void end( const Mark &start, Result &result )
+  {
+    const Mark stop = mark();
+
+    result.elapsed = stop.wall - start.wall;
+    result.cpu     = stop.cpu - start.cpu;
+  }
+
+
+  /**
+   *  Throws away anything left over from an earlier test
+   */
+  static void discard( Driver &rx, uint8_t *const buffer, const size_t size )
+  {
+    while ( rx.read( buffer, size, Chimera::Thread::TIMEOUT_DONT_WAIT ) > 0 )
+    {
+      continue;
+    }
+  }
+
+
+  /**
+   *  Reads exactly length bytes unless the timeout expires
+   *
+   *  @return size_t          Bytes read
+   */
+  static size_t readAll( Driver &rx, uint8_t *const buffer, const size_t length, const size_t timeout )
+  {
+    const size_t start = Chimera::millis();
+    size_t       done  = 0;
+
+    while ( done < length )
+    {
+      const size_t elapsed = Chimera::millis() - start;
+      if ( elapsed >= timeout )
+      {
+        break;
+      }
+
+      const int count = rx.read( buffer + done, length - done, timeout - elapsed );
+      if ( count > 0 )
+      {
+        done += static_cast<size_t>( count );
+      }
+      else if ( count < 0 )
+      {
+        break;
+      }
+    }
+
+    return done;
+  }
+
+
+  /**
+   *  Streams total bytes from tx to rx as fast as the link takes them and
+   *  checks every byte. Writes and reads are interleaved on the calling
+   *  thread, which only blocks when neither side can make progress.
+   *
+   *  @return bool            False if the link stalled for the timeout
+   */
+  static bool throughput( Driver &tx, Driver &rx, const size_t size, const size_t total, Result &result )
+  {
+    std::vector<uint8_t> pattern( size );
+    std::vector<uint8_t> incoming( size );
+
+    result = {};
+    fillPattern( pattern.data(), size );
+    discard( rx, incoming.data(), size );
+
+    size_t     sent    = 0;
+    size_t     stalled = 0;
+    bool       waiting = false;
+    const Mark start   = mark();
+
+    while ( result.bytes < total )
+    {
+      bool progress = false;
+
+      if ( sent < total )
+      {
+        const size_t offset  = sent % size;
+        const int    written = tx.write( pattern.data() + offset, std::min( size - offset, total - sent ),
+                                         Chimera::Thread::TIMEOUT_DONT_WAIT );
+        if ( written > 0 )
+        {
+          sent += static_cast<size_t>( written );
+          progress = true;
+        }
+      }
+
+      const int count = rx.read( incoming.data(), std::min( size, total - result.bytes ), Chimera::Thread::TIMEOUT_DONT_WAIT );
+      if ( count > 0 )
+      {
+        result.errors += verify( incoming.data(), static_cast<size_t>( count ), result.bytes, pattern.data(), size );
+        result.bytes += static_cast<size_t>( count );
+        progress = true;
+      }
+
+      if ( progress )
+      {
+        waiting = false;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Neither side could move. Sleep in read() until a byte lands, checking
+      back now and then in case it's the TX side that has room again.
+      -----------------------------------------------------------------------*/
+      if ( !waiting )
+      {
+        stalled = Chimera::millis();
+        waiting = true;
+      }
+      else if ( ( Chimera::millis() - stalled ) >= TIMEOUT )
+      {
+        end( start, result );
+        return false;
+      }
+
+      if ( rx.read( incoming.data(), 1, 1 ) == 1 )
+      {
+        result.errors += verify( incoming.data(), 1, result.bytes, pattern.data(), size );
+        result.bytes++;
+        waiting = false;
+      }
+    }
+
+    end( start, result );
+    return true;
+  }
+
+
+  /**
+   *  Sends one message at a time and waits for it to arrive, timing each
+   *  round
+   *
+   *  @return bool            False if a message took longer than the timeout
+   */
+  static bool latency( Driver &tx, Driver &rx, const size_t size, const size_t count, Result &result )
+  {
+    std::vector<uint8_t>  pattern( size );
+    std::vector<uint8_t>  incoming( size );
+    std::vector<uint32_t> samples;
+
+    result = {};
+    samples.reserve( count );
+    fillPattern( pattern.data(), size );
+    discard( rx, incoming.data(), size );
+
+    bool       ok    = true;
+    const Mark start = mark();
+
+    for ( size_t x = 0; x < count; x++ )
+    {
+      const size_t sent    = Chimera::micros();
+      const int    written = tx.write( pattern.data(), size, TIMEOUT );
+      if ( ( written < 0 ) || ( static_cast<size_t>( written ) != size ) )
+      {
+        ok = false;
+        break;
+      }
+
+      const size_t read = readAll( rx, incoming.data(), size, TIMEOUT );
+      result.errors += verify( incoming.data(), read, 0, pattern.data(), size );
+      result.bytes += read;
+      if ( read != size )
+      {
+        ok = false;
+        break;
+      }
+
+      samples.push_back( static_cast<uint32_t>( Chimera::micros() - sent ) );
+    }
+
+    end( start, result );
+
+    /*-------------------------------------------------------------------------
+    Percentiles by nearest rank
+    -------------------------------------------------------------------------*/
+    result.messages = samples.size();
+    if ( result.messages )
+    {
+      const size_t last = result.messages - 1;
+      std::sort( samples.begin(), samples.end() );
+
+      result.latencyP50 = samples[ ( last * 50 ) / 100 ];
+      result.latencyP99 = samples[ ( last * 99 ) / 100 ];
+      result.latencyMax = samples[ last ];
+    }
+
+    return ok;
+  }
+
+
+  static const char *modeName( const TxfrMode mode )
+  {
+    switch ( mode )
+    {
+      case TxfrMode::BLOCKING:
+        return "BLOCKING";
+
+      case TxfrMode::INTERRUPT:
+        return "INTERRUPT";
+
+      case TxfrMode::DMA:
+        return "DMA";
+
+      default:
+        return "UNKNOWN";
+    }
+  }
+
+
+  static Driver_rPtr openChannel( const Channel channel, const size_t index, const TxfrMode mode, const BaudRate baud )
+  {
+    Config config   = {};
+    config.channel  = channel;
+    config.baud     = static_cast<size_t>( baud );
+    config.width    = CharWid::CW_8BIT;
+    config.parity   = Parity::PAR_NONE;
+    config.stopBits = StopBits::SBITS_ONE;
+    config.flow     = FlowControl::FCTRL_NONE;
+    config.txfrMode = mode;
+    config.rxBuffer = &s_rxBuffer[ index ];
+    config.txBuffer = &s_txBuffer[ index ];
+
+    Driver_rPtr driver = getDriver( channel );
+    return ( driver && ( driver->open( config ) == Chimera::Status::OK ) ) ? driver : nullptr;
+  }
+}  // namespace
+
+
+int main( int argc, char **argv )
+{
+  const size_t total   = ( argc > 1 ) ? strtoul( argv[ 1 ], nullptr, 0 ) : ( 64u * 1024u * 1024u );
+  const size_t samples = ( argc > 2 ) ? strtoul( argv[ 2 ], nullptr, 0 ) : 10000;
+
+  Chimera::Serial::initialize();
+  printf( "%zu bytes per throughput run, %zu latency samples\n", total, samples );
+
+  bool ok = true;
+  for ( const TxfrMode mode : MODES )
+  {
+    for ( const BaudRate baud : BAUD_RATES )
+    {
+      /*-----------------------------------------------------------------------
+      Reopen for every combination so the mode and rate go through open()
+      -----------------------------------------------------------------------*/
+      Driver_rPtr tx = openChannel( Channel::SERIAL1, 0, mode, baud );
+      Driver_rPtr rx = openChannel( Channel::SERIAL2, 1, mode, baud );
+      if ( !tx || !rx || ( Native::connect( Channel::SERIAL1, Channel::SERIAL2 ) != Chimera::Status::OK ) )
+      {
+        printf( "Couldn't connect the native channels\n" );
+        return 1;
+      }
+
+      for ( const size_t size : MESSAGE_SIZES )
+      {
+        Result stream;
+        Result rounds;
+
+        ok = throughput( *tx, *rx, size, total, stream ) && ok;
+        ok = latency( *tx, *rx, size, samples, rounds ) && ok;
+        ok = ok && !stream.errors && !rounds.errors;
+
+        printf( "%-9s %7zu bd %5zu B writes  %8.1f MB/s  cpu %5.1f ns/B  latency us p50 %4u p99 %4u max %5u  errors %zu\n",
+                modeName( mode ), static_cast<size_t>( baud ), size,
+                static_cast<double>( stream.bytes ) / static_cast<double>( std::max<uint64_t>( stream.elapsed, 1 ) ),
+                ( static_cast<double>( stream.cpu ) * 1000.0 ) / static_cast<double>( std::max<size_t>( stream.bytes, 1 ) ),
+                rounds.latencyP50, rounds.latencyP99, rounds.latencyMax, stream.errors + rounds.errors );
+      }
+
+      tx->close();
+      rx->close();
+    }
+  }
+
+  return ok ? 0 : 1;
+}
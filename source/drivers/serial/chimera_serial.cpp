@@ -13,6 +13,8 @@ Includes
 -----------------------------------------------------------------------------*/
 #include <Chimera/serial>
 #include <Chimera/common>
+#include <algorithm>
+#include <cstdint>
 
 namespace Chimera::Serial
 {
@@ -21,6 +23,13 @@ namespace Chimera::Serial
   ---------------------------------------------------------------------------*/
   static Backend::DriverConfig s_backend_driver;
 
+  static constexpr BaudRate s_standard_rates[] = {
+    BaudRate::SERIAL_BAUD_110,    BaudRate::SERIAL_BAUD_150,    BaudRate::SERIAL_BAUD_300,    BaudRate::SERIAL_BAUD_1200,
+    BaudRate::SERIAL_BAUD_2400,   BaudRate::SERIAL_BAUD_4800,   BaudRate::SERIAL_BAUD_9600,   BaudRate::SERIAL_BAUD_19200,
+    BaudRate::SERIAL_BAUD_38400,  BaudRate::SERIAL_BAUD_57600,  BaudRate::SERIAL_BAUD_115200, BaudRate::SERIAL_BAUD_230400,
+    BaudRate::SERIAL_BAUD_460800, BaudRate::SERIAL_BAUD_921600
+  };
+
   /*---------------------------------------------------------------------------
   Public Functions
   ---------------------------------------------------------------------------*/
@@ -88,4 +97,49 @@ namespace Chimera::Serial
     }
   }
 
+
+  BaudRate closestBaudRate( const size_t bps )
+  {
+    /*-------------------------------------------------------------------------
+    Compare the ratios hi / lo by cross multiplying, which stays in integers
+    -------------------------------------------------------------------------*/
+    const uint64_t measured = std::max<uint64_t>( std::min<uint64_t>( bps, UINT32_MAX ), 1u );
+
+    BaudRate best   = s_standard_rates[ 0 ];
+    uint64_t bestHi = 0;
+    uint64_t bestLo = 1;
+
+    for ( const BaudRate rate : s_standard_rates )
+    {
+      const uint64_t standard = static_cast<uint64_t>( rate );
+      const uint64_t hi       = std::max( standard, measured );
+      const uint64_t lo       = std::min( standard, measured );
+
+      if ( !bestHi || ( ( hi * bestLo ) < ( bestHi * lo ) ) )
+      {
+        best   = rate;
+        bestHi = hi;
+        bestLo = lo;
+      }
+    }
+
+    return best;
+  }
+
+
+  size_t baudFromPulse( const uint8_t sync, const size_t ticks, const size_t tickRate )
+  {
+    if ( !ticks )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Data goes out LSB first after the start bit. The stop bit is high, so it
+    bounds the pulse for a sync character of zero.
+    -------------------------------------------------------------------------*/
+    const uint64_t bits = 1u + static_cast<uint64_t>( __builtin_ctz( sync | 0x100u ) );
+    return static_cast<size_t>( ( ( static_cast<uint64_t>( tickRate ) * bits ) + ( ticks / 2 ) ) / ticks );
+  }
+
 }  // namespace Chimera::Serial
@@ -0,0 +1,659 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_serial_format.cpp
+ *
+ *  Description:
+ *    In place formatted output for the serial driver
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/log>
+#include <Chimera/serial>
+
+namespace Chimera::Serial::Format
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr char s_digit_pairs[] = "00010203040506070809"
+                                          "10111213141516171819"
+                                          "20212223242526272829"
+                                          "30313233343536373839"
+                                          "40414243444546474849"
+                                          "50515253545556575859"
+                                          "60616263646566676869"
+                                          "70717273747576777879"
+                                          "80818283848586878889"
+                                          "90919293949596979899";
+
+  static constexpr char s_lower_hex[] = "0123456789abcdef";
+  static constexpr char s_upper_hex[] = "0123456789ABCDEF";
+
+  static constexpr uint32_t s_pow10[ MAX_FLOAT_PRECISION + 1 ] = { 1,      10,      100,      1000,      10000,
+                                                                   100000, 1000000, 10000000, 100000000, 1000000000 };
+
+  /*-------------------------------------------------------------------
+  Largest whole number a double can hold that still fits in 64 bits.
+  Anything bigger is printed in exponent form.
+  -------------------------------------------------------------------*/
+  static constexpr double MAX_FIXED_FLOAT = 18446744073709549568.0;
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static std::atomic<size_t> s_dropped;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Writes the decimal digits of a value backwards, two at a time
+   *
+   *  @param[in]  value       Number to convert
+   *  @param[in]  end         One past where the last digit goes
+   *  @return char *          First digit
+   */
+  template<typename U>
+  static char *toDecimal( U value, char *end )
+  {
+    while ( value >= 100 )
+    {
+      const U      quotient = value / 100;
+      const size_t pair     = static_cast<size_t>( value - ( quotient * 100 ) ) * 2;
+
+      end -= 2;
+      end[ 0 ] = s_digit_pairs[ pair ];
+      end[ 1 ] = s_digit_pairs[ pair + 1 ];
+      value    = quotient;
+    }
+
+    if ( value >= 10 )
+    {
+      const size_t pair = static_cast<size_t>( value ) * 2;
+
+      end -= 2;
+      end[ 0 ] = s_digit_pairs[ pair ];
+      end[ 1 ] = s_digit_pairs[ pair + 1 ];
+    }
+    else
+    {
+      *--end = static_cast<char>( '0' + value );
+    }
+
+    return end;
+  }
+
+
+  /**
+   *  Writes the digits of a value in a power of two base backwards
+   */
+  template<typename U>
+  static char *toBinaryBase( U value, char *end, const unsigned shift, const char *const alphabet )
+  {
+    const U mask = static_cast<U>( ( 1u << shift ) - 1u );
+
+    do
+    {
+      *--end = alphabet[ value & mask ];
+      value >>= shift;
+    } while ( value );
+
+    return end;
+  }
+
+
+  /**
+   *  Lays out one field: padding, prefix, leading zeros, then the body
+   *
+   *  @param[in]  out         Destination
+   *  @param[in]  piece       Conversion giving the width and flags
+   *  @param[in]  prefix      Sign or radix prefix
+   *  @param[in]  prefixLen   Bytes of prefix
+   *  @param[in]  body        Digits or text
+   *  @param[in]  bodyLen     Bytes of body
+   *  @param[in]  zeros       Leading zeros required by the precision
+   *  @param[in]  zeroPad     Whether the '0' flag may pad out the width
+   *  @return void
+   */
+  static void field( Writer &out, const Piece &piece, const char *const prefix, const size_t prefixLen, const char *const body,
+                     const size_t bodyLen, size_t zeros, const bool zeroPad )
+  {
+    size_t total  = prefixLen + zeros + bodyLen;
+    size_t before = 0;
+    size_t after  = 0;
+
+    if ( piece.width > total )
+    {
+      const size_t pad = piece.width - total;
+      if ( piece.flags & FLAG_LEFT )
+      {
+        after = pad;
+      }
+      else if ( zeroPad && ( piece.flags & FLAG_ZERO ) )
+      {
+        zeros += pad;
+      }
+      else
+      {
+        before = pad;
+      }
+
+      total = piece.width;
+    }
+
+    /*-------------------------------------------------------------------------
+    Usually the whole field fits in the current reservation
+    -------------------------------------------------------------------------*/
+    char *dst = out.room( total );
+    if ( dst )
+    {
+      memset( dst, ' ', before );
+      dst += before;
+      memcpy( dst, prefix, prefixLen );
+      dst += prefixLen;
+      memset( dst, '0', zeros );
+      dst += zeros;
+      memcpy( dst, body, bodyLen );
+      dst += bodyLen;
+      memset( dst, ' ', after );
+
+      out.advance( total );
+      return;
+    }
+
+    out.fill( ' ', before );
+    out.put( prefix, prefixLen );
+    out.fill( '0', zeros );
+    out.put( body, bodyLen );
+    out.fill( ' ', after );
+  }
+
+
+  /**
+   *  Integer conversions. The magnitude and sign are split by the caller so
+   *  the same code serves signed and unsigned values.
+   */
+  template<typename U>
+  static void integer( Writer &out, const Piece &piece, const U magnitude, const bool negative )
+  {
+    char  digits[ 24 ];
+    char *end   = digits + sizeof( digits );
+    char *start = end;
+
+    /*-------------------------------------------------------------------------
+    printf prints nothing at all for a zero with a zero precision
+    -------------------------------------------------------------------------*/
+    if ( ( magnitude != 0 ) || ( piece.precision != 0 ) )
+    {
+      switch ( piece.conv )
+      {
+        case 'x':
+          start = toBinaryBase( magnitude, end, 4, s_lower_hex );
+          break;
+
+        case 'X':
+          start = toBinaryBase( magnitude, end, 4, s_upper_hex );
+          break;
+
+        case 'o':
+          start = toBinaryBase( magnitude, end, 3, s_lower_hex );
+          break;
+
+        default:
+          start = toDecimal( magnitude, end );
+          break;
+      }
+    }
+
+    const size_t length = static_cast<size_t>( end - start );
+
+    char   prefix[ 2 ];
+    size_t prefixLen = 0;
+
+    if ( negative )
+    {
+      prefix[ prefixLen++ ] = '-';
+    }
+    else if ( ( piece.conv == 'd' ) || ( piece.conv == 'i' ) )
+    {
+      if ( piece.flags & FLAG_PLUS )
+      {
+        prefix[ prefixLen++ ] = '+';
+      }
+      else if ( piece.flags & FLAG_SPACE )
+      {
+        prefix[ prefixLen++ ] = ' ';
+      }
+    }
+    else if ( ( piece.flags & FLAG_ALT ) && ( magnitude != 0 ) && ( ( piece.conv == 'x' ) || ( piece.conv == 'X' ) ) )
+    {
+      prefix[ prefixLen++ ] = '0';
+      prefix[ prefixLen++ ] = piece.conv;
+    }
+
+    size_t zeros = 0;
+    if ( ( piece.precision > 0 ) && ( static_cast<size_t>( piece.precision ) > length ) )
+    {
+      zeros = static_cast<size_t>( piece.precision ) - length;
+    }
+
+    if ( ( piece.conv == 'o' ) && ( piece.flags & FLAG_ALT ) && ( zeros == 0 ) && ( ( length == 0 ) || ( *start != '0' ) ) )
+    {
+      zeros = 1;
+    }
+
+    field( out, piece, prefix, prefixLen, start, length, zeros, piece.precision < 0 );
+  }
+
+
+  /**
+   *  Fixed point digits of a non-negative value below MAX_FIXED_FLOAT, written
+   *  backwards. Exact ties round to even, as printf does.
+   */
+  static char *fixedDigits( const double value, const size_t precision, const bool point, char *end )
+  {
+    uint64_t     whole    = static_cast<uint64_t>( value );
+    const double fraction = value - static_cast<double>( whole );
+    const double scale    = static_cast<double>( s_pow10[ precision ] );
+
+    /*-------------------------------------------------------------------------
+    The product rounds, which can land it on a digit boundary the real value
+    doesn't reach, e.g. 0.1234567895 is stored a little below ...895. The fma
+    recovers what the rounding lost so the boundary cases round like printf.
+    -------------------------------------------------------------------------*/
+    const double product = fraction * scale;
+    const double error   = std::fma( fraction, scale, -product );
+    uint32_t     scaled  = static_cast<uint32_t>( product );
+    const double rest    = product - static_cast<double>( scaled );
+    const bool   odd     = precision ? ( scaled & 1u ) : ( whole & 1u );
+
+    if ( ( rest > 0.5 ) || ( ( rest == 0.5 ) && ( ( error > 0.0 ) || ( ( error == 0.0 ) && odd ) ) ) )
+    {
+      scaled++;
+    }
+
+    if ( scaled >= s_pow10[ precision ] )
+    {
+      scaled -= s_pow10[ precision ];
+      whole++;
+    }
+
+    if ( precision )
+    {
+      char *const stop = end - precision;
+      while ( end != stop )
+      {
+        *--end = static_cast<char>( '0' + ( scaled % 10 ) );
+        scaled /= 10;
+      }
+    }
+
+    if ( point )
+    {
+      *--end = '.';
+    }
+
+    /*-------------------------------------------------------------------------
+    64-bit division is a library call on most MCUs, so avoid it when it can be
+    -------------------------------------------------------------------------*/
+    if ( whole <= UINT32_MAX )
+    {
+      return toDecimal( static_cast<uint32_t>( whole ), end );
+    }
+
+    return toDecimal( whole, end );
+  }
+
+  /*---------------------------------------------------------------------------
+  Writer
+  ---------------------------------------------------------------------------*/
+  Writer::Writer( Driver &driver, const size_t timeout, const size_t hint ) :
+      mDriver( &driver ), mBase( nullptr ), mPos( nullptr ), mEnd( nullptr ), mHint( hint ), mTimeout( timeout ), mStart( 0 ),
+      mWritten( 0 ), mWaited( false ), mFailed( false )
+  {
+    auto span = driver.writeReserve( hint );
+
+    mBase = reinterpret_cast<char *>( span.data() );
+    mPos  = mBase;
+    mEnd  = mBase + span.size();
+  }
+
+
+  void Writer::fill( const char c, const size_t count )
+  {
+    char *dst = room( count );
+    if ( dst )
+    {
+      memset( dst, c, count );
+      mPos += count;
+      return;
+    }
+
+    char   run[ 16 ];
+    size_t left = count;
+
+    memset( run, c, sizeof( run ) );
+    while ( left && !mFailed )
+    {
+      const size_t step = std::min( left, sizeof( run ) );
+      put( run, step );
+      left -= step;
+    }
+  }
+
+
+  int Writer::finish()
+  {
+    commit();
+    return mFailed ? -1 : static_cast<int>( mWritten );
+  }
+
+
+  char *Writer::refill( const size_t length )
+  {
+    commit();
+    if ( mFailed )
+    {
+      mEnd = mPos;
+      return nullptr;
+    }
+
+    auto span = mDriver->writeReserve( std::max( length, mHint ) );
+
+    mBase = reinterpret_cast<char *>( span.data() );
+    mPos  = mBase;
+    mEnd  = mBase + span.size();
+
+    return ( span.size() >= length ) ? mPos : nullptr;
+  }
+
+
+  void Writer::commit()
+  {
+    if ( mPos != mBase )
+    {
+      const size_t length = static_cast<size_t>( mPos - mBase );
+
+      mDriver->writeCommit( etl::span<uint8_t>( reinterpret_cast<uint8_t *>( mBase ), length ) );
+      mWritten += length;
+    }
+
+    mBase = mPos;
+  }
+
+
+  void Writer::putSlow( const char *data, size_t length )
+  {
+    while ( length && !mFailed )
+    {
+      /*-----------------------------------------------------------------------
+      Use up the reservation, then try for another
+      -----------------------------------------------------------------------*/
+      size_t avail = static_cast<size_t>( mEnd - mPos );
+      if ( !avail )
+      {
+        refill( length );
+        avail = static_cast<size_t>( mEnd - mPos );
+      }
+
+      if ( avail )
+      {
+        const size_t step = std::min( avail, length );
+
+        memcpy( mPos, data, step );
+        mPos += step;
+        data += step;
+        length -= step;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      The TX buffer is full. Let the driver's blocking write() do the waiting
+      so its timeout semantics apply unchanged.
+      -----------------------------------------------------------------------*/
+      const size_t now = Chimera::millis();
+      if ( !mWaited )
+      {
+        mStart  = now;
+        mWaited = true;
+      }
+
+      const size_t elapsed = now - mStart;
+      if ( ( mTimeout == Chimera::Thread::TIMEOUT_DONT_WAIT ) || ( elapsed >= mTimeout ) )
+      {
+        mFailed = true;
+        break;
+      }
+
+      const size_t remaining = ( mTimeout == Chimera::Thread::TIMEOUT_BLOCK ) ? mTimeout : ( mTimeout - elapsed );
+      const int    written   = mDriver->write( data, length, remaining );
+
+      if ( ( written < 0 ) || ( static_cast<size_t>( written ) != length ) )
+      {
+        mWritten += ( written > 0 ) ? static_cast<size_t>( written ) : 0;
+        mFailed = true;
+        break;
+      }
+
+      mWritten += length;
+      length = 0;
+    }
+
+    if ( mFailed )
+    {
+      mEnd = mPos;
+    }
+  }
+
+  /*---------------------------------------------------------------------------
+  Internal Functions
+  ---------------------------------------------------------------------------*/
+  namespace Internal
+  {
+    void putSigned( Writer &out, const Piece &piece, const int32_t value )
+    {
+      const uint32_t magnitude = ( value < 0 ) ? ( 0u - static_cast<uint32_t>( value ) ) : static_cast<uint32_t>( value );
+      integer( out, piece, magnitude, value < 0 );
+    }
+
+
+    void putSigned( Writer &out, const Piece &piece, const int64_t value )
+    {
+      const uint64_t magnitude = ( value < 0 ) ? ( 0u - static_cast<uint64_t>( value ) ) : static_cast<uint64_t>( value );
+      if ( magnitude <= UINT32_MAX )
+      {
+        integer( out, piece, static_cast<uint32_t>( magnitude ), value < 0 );
+      }
+      else
+      {
+        integer( out, piece, magnitude, value < 0 );
+      }
+    }
+
+
+    void putUnsigned( Writer &out, const Piece &piece, const uint32_t value )
+    {
+      integer( out, piece, value, false );
+    }
+
+
+    void putUnsigned( Writer &out, const Piece &piece, const uint64_t value )
+    {
+      if ( value <= UINT32_MAX )
+      {
+        integer( out, piece, static_cast<uint32_t>( value ), false );
+      }
+      else
+      {
+        integer( out, piece, value, false );
+      }
+    }
+
+
+    void putFloat( Writer &out, const Piece &piece, const double value )
+    {
+      const bool   negative  = std::signbit( value );
+      const size_t precision = static_cast<size_t>( ( piece.precision < 0 ) ? 6 : piece.precision );
+      const bool   point     = ( precision != 0 ) || ( piece.flags & FLAG_ALT );
+
+      char   prefix[ 1 ];
+      size_t prefixLen = 0;
+
+      if ( negative )
+      {
+        prefix[ prefixLen++ ] = '-';
+      }
+      else if ( piece.flags & FLAG_PLUS )
+      {
+        prefix[ prefixLen++ ] = '+';
+      }
+      else if ( piece.flags & FLAG_SPACE )
+      {
+        prefix[ prefixLen++ ] = ' ';
+      }
+
+      if ( std::isnan( value ) )
+      {
+        field( out, piece, prefix, prefixLen, "nan", 3, 0, false );
+        return;
+      }
+
+      if ( std::isinf( value ) )
+      {
+        field( out, piece, prefix, prefixLen, "inf", 3, 0, false );
+        return;
+      }
+
+      char         digits[ 40 ];
+      char *const  end       = digits + sizeof( digits );
+      char        *start     = end;
+      const double magnitude = std::fabs( value );
+
+      if ( magnitude < MAX_FIXED_FLOAT )
+      {
+        start = fixedDigits( magnitude, precision, point, end );
+      }
+      else
+      {
+        /*---------------------------------------------------------------------
+        Too big for fixed point without a bignum. Print d.ddde+NN instead.
+        ---------------------------------------------------------------------*/
+        int    exponent = static_cast<int>( std::floor( std::log10( magnitude ) ) );
+        double mantissa = magnitude / std::pow( 10.0, exponent );
+
+        if ( mantissa >= 10.0 )
+        {
+          mantissa /= 10.0;
+          exponent++;
+        }
+
+        char *cursor = toDecimal( static_cast<uint32_t>( exponent ), end );
+        if ( ( end - cursor ) < 2 )
+        {
+          *--cursor = '0';
+        }
+        *--cursor = '+';
+        *--cursor = 'e';
+
+        start = fixedDigits( mantissa, precision, point, cursor );
+        if ( ( start[ 0 ] == '1' ) && ( start[ 1 ] == '0' ) )
+        {
+          /*-------------------------------------------------------------------
+          Rounding carried into a second digit, e.g. 9.9999 -> 10.000
+          -------------------------------------------------------------------*/
+          cursor = toDecimal( static_cast<uint32_t>( exponent + 1 ), end );
+          if ( ( end - cursor ) < 2 )
+          {
+            *--cursor = '0';
+          }
+          *--cursor = '+';
+          *--cursor = 'e';
+
+          start = fixedDigits( mantissa / 10.0, precision, point, cursor );
+        }
+      }
+
+      field( out, piece, prefix, prefixLen, start, static_cast<size_t>( end - start ), 0, true );
+    }
+
+
+    void putChar( Writer &out, const Piece &piece, const char value )
+    {
+      field( out, piece, nullptr, 0, &value, 1, 0, false );
+    }
+
+
+    void putString( Writer &out, const Piece &piece, const char *const value )
+    {
+      const char  *text   = value ? value : "(null)";
+      const size_t length = ( piece.precision >= 0 ) ? strnlen( text, static_cast<size_t>( piece.precision ) ) : strlen( text );
+
+      field( out, piece, nullptr, 0, text, length, 0, false );
+    }
+
+
+    void putPointer( Writer &out, const Piece &piece, const void *const value )
+    {
+      char  digits[ 2 * sizeof( uintptr_t ) ];
+      char *end   = digits + sizeof( digits );
+      char *start = toBinaryBase( reinterpret_cast<uintptr_t>( value ), end, 4, s_lower_hex );
+
+      field( out, piece, "0x", 2, start, static_cast<size_t>( end - start ), 0, false );
+    }
+
+
+    void playback( const Chimera::Log::Record &record, int ( *render )( Driver &, const size_t, const uint8_t *const ) )
+    {
+      const uint8_t *const data   = reinterpret_cast<const uint8_t *>( record.words );
+      Driver *const        driver = load<Driver *>( data );
+
+      /*-----------------------------------------------------------------------
+      Never wait on the port. Whoever holds the lock may be the one draining,
+      and a busy port mustn't hold up the records queued behind this one.
+      -----------------------------------------------------------------------*/
+      if ( !driver->try_lock_for( Chimera::Thread::TIMEOUT_DONT_WAIT ) )
+      {
+        s_dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+      }
+
+      const int result = render( *driver, CHIMERA_SERIAL_FORMAT_DRAIN_TIMEOUT, data + sizeof( Driver * ) );
+      driver->unlock();
+
+      if ( result < 0 )
+      {
+        s_dropped.fetch_add( 1, std::memory_order_relaxed );
+      }
+    }
+
+
+    bool enqueue( const Chimera::Log::Record &record )
+    {
+      if ( Chimera::Log::Internal::enqueue( record ) )
+      {
+        return true;
+      }
+
+      s_dropped.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+  }  // namespace Internal
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  size_t dropped()
+  {
+    return s_dropped.load( std::memory_order_relaxed );
+  }
+
+}  // namespace Chimera::Serial::Format
@@ -0,0 +1,869 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_serial_framing.cpp
+ *
+ *  Description:
+ *    COBS, SLIP and HDLC-style framing with optional CRC trailers
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/serial>
+#include <Chimera/source/drivers/serial/serial_framing.hpp>
+
+namespace Chimera::Serial::Framing
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint8_t COBS_DELIMITER = 0x00;
+  static constexpr size_t  COBS_MAX_RUN   = 254;
+
+  static constexpr uint8_t SLIP_END     = 0xC0;
+  static constexpr uint8_t SLIP_ESC     = 0xDB;
+  static constexpr uint8_t SLIP_ESC_END = 0xDC;
+  static constexpr uint8_t SLIP_ESC_ESC = 0xDD;
+
+  static constexpr uint8_t HDLC_FLAG = 0x7E;
+  static constexpr uint8_t HDLC_ESC  = 0x7D;
+  static constexpr uint8_t HDLC_XOR  = 0x20;
+
+  static constexpr uint32_t CRC16_POLY = 0x8408;     /**< 0x1021 reflected */
+  static constexpr uint32_t CRC32_POLY = 0xEDB88320; /**< 0x04C11DB7 reflected */
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Slice-by-4 lookup for a reflected CRC, so the bulk of a buffer is folded
+   *  in a 32-bit word at a time
+   */
+  template<typename T>
+  struct CRCTable
+  {
+    T slice[ 4 ][ 256 ];
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  template<typename T>
+  static constexpr CRCTable<T> makeTable( const uint32_t poly )
+  {
+    CRCTable<T> table = {};
+
+    for ( uint32_t x = 0; x < 256; x++ )
+    {
+      uint32_t crc = x;
+      for ( size_t bit = 0; bit < 8; bit++ )
+      {
+        crc = ( crc & 1u ) ? ( ( crc >> 1 ) ^ poly ) : ( crc >> 1 );
+      }
+      table.slice[ 0 ][ x ] = static_cast<T>( crc );
+    }
+
+    for ( size_t s = 1; s < 4; s++ )
+    {
+      for ( size_t x = 0; x < 256; x++ )
+      {
+        const T prev          = table.slice[ s - 1 ][ x ];
+        table.slice[ s ][ x ] = static_cast<T>( ( prev >> 8 ) ^ table.slice[ 0 ][ prev & 0xFFu ] );
+      }
+    }
+
+    return table;
+  }
+
+  static constexpr CRCTable<uint16_t> s_crc16 = makeTable<uint16_t>( CRC16_POLY );
+  static constexpr CRCTable<uint32_t> s_crc32 = makeTable<uint32_t>( CRC32_POLY );
+
+
+  template<typename T>
+  static uint32_t crcUpdate( const CRCTable<T> &table, uint32_t crc, const uint8_t *data, size_t length )
+  {
+#if defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ )
+    while ( length >= sizeof( uint32_t ) )
+    {
+      uint32_t word;
+      memcpy( &word, data, sizeof( word ) );
+
+      crc ^= word;
+      crc = table.slice[ 3 ][ crc & 0xFFu ] ^ table.slice[ 2 ][ ( crc >> 8 ) & 0xFFu ] ^
+            table.slice[ 1 ][ ( crc >> 16 ) & 0xFFu ] ^ table.slice[ 0 ][ crc >> 24 ];
+
+      data += sizeof( uint32_t );
+      length -= sizeof( uint32_t );
+    }
+#endif
+
+    while ( length-- )
+    {
+      crc = ( crc >> 8 ) ^ table.slice[ 0 ][ ( crc ^ *data++ ) & 0xFFu ];
+    }
+
+    return crc;
+  }
+
+
+  static size_t trailerSize( const Check check )
+  {
+    switch ( check )
+    {
+      case Check::CRC16:
+        return sizeof( uint16_t );
+
+      case Check::CRC32:
+        return sizeof( uint32_t );
+
+      default:
+        return 0;
+    }
+  }
+
+
+  /**
+   *  Computes the check and stores it LSB first
+   *
+   *  @return size_t          Trailer bytes written
+   */
+  static size_t makeTrailer( const Check check, const uint8_t *const data, const size_t length, uint8_t *const out )
+  {
+    uint32_t crc = 0;
+
+    switch ( check )
+    {
+      case Check::CRC16:
+        crc = crc16( data, length );
+        break;
+
+      case Check::CRC32:
+        crc = crc32( data, length );
+        break;
+
+      default:
+        return 0;
+    }
+
+    const size_t size = trailerSize( check );
+    for ( size_t x = 0; x < size; x++ )
+    {
+      out[ x ] = static_cast<uint8_t>( crc >> ( 8u * x ) );
+    }
+
+    return size;
+  }
+
+
+  static uint8_t delimiterOf( const Protocol protocol )
+  {
+    switch ( protocol )
+    {
+      case Protocol::SLIP:
+        return SLIP_END;
+
+      case Protocol::HDLC:
+        return HDLC_FLAG;
+
+      case Protocol::COBS:
+      default:
+        return COBS_DELIMITER;
+    }
+  }
+
+
+  static uint8_t escapeOf( const Protocol protocol )
+  {
+    return ( protocol == Protocol::SLIP ) ? SLIP_ESC : HDLC_ESC;
+  }
+
+  /*---------------------------------------------------------------------------
+  Encoder
+  ---------------------------------------------------------------------------*/
+  Encoder::Encoder( const Protocol protocol, const Check check ) :
+      mProtocol( protocol ), mCheck( check ), mPhase( Phase::DONE ), mPayload( nullptr ), mLength( 0 ), mTotal( 0 ),
+      mPos( 0 ), mRun( 0 ), mTrailer{}, mPending( 0 ), mHasPending( false ), mBlockOpen( false ), mSkipZero( false ),
+      mLastBlock( false )
+  {
+  }
+
+
+  void Encoder::begin( const void *const payload, const size_t length )
+  {
+    mPayload = static_cast<const uint8_t *>( payload );
+    mLength  = mPayload ? length : 0;
+    mTotal   = mLength + makeTrailer( mCheck, mPayload, mLength, mTrailer );
+
+    mPhase      = Phase::OPEN;
+    mPos        = 0;
+    mRun        = 0;
+    mHasPending = false;
+    mBlockOpen  = false;
+    mSkipZero   = false;
+    mLastBlock  = false;
+  }
+
+
+  size_t Encoder::encode( uint8_t *const out, const size_t size )
+  {
+    size_t produced = 0;
+
+    while ( out && ( produced < size ) && ( mPhase != Phase::DONE ) )
+    {
+      switch ( mPhase )
+      {
+        case Phase::OPEN:
+          /*-------------------------------------------------------------------
+          SLIP and HDLC open with a delimiter too, flushing any line noise
+          -------------------------------------------------------------------*/
+          if ( mProtocol != Protocol::COBS )
+          {
+            out[ produced++ ] = delimiterOf( mProtocol );
+          }
+          mPhase = Phase::BODY;
+          break;
+
+        case Phase::BODY:
+          if ( mProtocol == Protocol::COBS )
+          {
+            produced += encodeCOBS( out + produced, size - produced );
+          }
+          else
+          {
+            produced += encodeStuffed( out + produced, size - produced );
+          }
+          break;
+
+        case Phase::CLOSE:
+          out[ produced++ ] = delimiterOf( mProtocol );
+          mPhase            = Phase::DONE;
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    return produced;
+  }
+
+
+  bool Encoder::done() const
+  {
+    return mPhase == Phase::DONE;
+  }
+
+
+  size_t Encoder::remaining() const
+  {
+    if ( mPhase == Phase::DONE )
+    {
+      return 0;
+    }
+
+    return maxEncodedSize( mProtocol, Check::NONE, mTotal - mPos ) + ( mHasPending ? 1 : 0 );
+  }
+
+
+  const uint8_t *Encoder::at( const size_t pos, size_t &contiguous ) const
+  {
+    if ( pos < mLength )
+    {
+      contiguous = mLength - pos;
+      return mPayload + pos;
+    }
+
+    contiguous = mTotal - pos;
+    return mTrailer + ( pos - mLength );
+  }
+
+
+  size_t Encoder::nonZeroRun( const size_t limit ) const
+  {
+    size_t run = 0;
+    size_t pos = mPos;
+
+    while ( ( run < limit ) && ( pos < mTotal ) )
+    {
+      size_t         contiguous = 0;
+      const uint8_t *data       = at( pos, contiguous );
+
+      contiguous       = std::min( contiguous, limit - run );
+      const size_t hit = findAny( data, contiguous, COBS_DELIMITER, COBS_DELIMITER );
+
+      run += hit;
+      pos += hit;
+      if ( hit < contiguous )
+      {
+        break;
+      }
+    }
+
+    return run;
+  }
+
+
+  size_t Encoder::encodeCOBS( uint8_t *const out, const size_t size )
+  {
+    size_t produced = 0;
+
+    while ( produced < size )
+    {
+      if ( mHasPending )
+      {
+        out[ produced++ ] = mPending;
+        mHasPending       = false;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Copy the current block
+      -----------------------------------------------------------------------*/
+      if ( mRun )
+      {
+        size_t         contiguous = 0;
+        const uint8_t *data       = at( mPos, contiguous );
+        const size_t   count      = std::min( { mRun, contiguous, size - produced } );
+
+        memcpy( out + produced, data, count );
+        produced += count;
+        mPos += count;
+        mRun -= count;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Close it out, swallowing the zero it replaced
+      -----------------------------------------------------------------------*/
+      if ( mBlockOpen )
+      {
+        mBlockOpen = false;
+        mPos += mSkipZero ? 1 : 0;
+
+        if ( mLastBlock )
+        {
+          mPhase = Phase::CLOSE;
+          break;
+        }
+      }
+
+      /*-----------------------------------------------------------------------
+      Look ahead for the next block. The input ends in an implied zero, so a
+      short block at the end needs no real one, and a full block at the end
+      needs no empty block after it.
+      -----------------------------------------------------------------------*/
+      const size_t run    = nonZeroRun( COBS_MAX_RUN );
+      const bool   at_end = ( mPos + run ) >= mTotal;
+
+      mRun        = run;
+      mBlockOpen  = true;
+      mSkipZero   = ( run < COBS_MAX_RUN ) && !at_end;
+      mLastBlock  = at_end;
+      mPending    = static_cast<uint8_t>( run + 1 );
+      mHasPending = true;
+    }
+
+    return produced;
+  }
+
+
+  size_t Encoder::encodeStuffed( uint8_t *const out, const size_t size )
+  {
+    const uint8_t flag     = delimiterOf( mProtocol );
+    const uint8_t escape   = escapeOf( mProtocol );
+    size_t        produced = 0;
+
+    while ( produced < size )
+    {
+      if ( mHasPending )
+      {
+        out[ produced++ ] = mPending;
+        mHasPending       = false;
+        continue;
+      }
+
+      if ( mPos >= mTotal )
+      {
+        mPhase = Phase::CLOSE;
+        break;
+      }
+
+      /*-----------------------------------------------------------------------
+      Bulk copy up to the next byte that needs escaping
+      -----------------------------------------------------------------------*/
+      size_t         contiguous = 0;
+      const uint8_t *data       = at( mPos, contiguous );
+      const size_t   count      = std::min( contiguous, size - produced );
+      const size_t   hit        = findAny( data, count, flag, escape );
+
+      memcpy( out + produced, data, hit );
+      produced += hit;
+      mPos += hit;
+
+      if ( hit < count )
+      {
+        const uint8_t value = data[ hit ];
+
+        if ( mProtocol == Protocol::SLIP )
+        {
+          mPending = ( value == SLIP_END ) ? SLIP_ESC_END : SLIP_ESC_ESC;
+        }
+        else
+        {
+          mPending = value ^ HDLC_XOR;
+        }
+
+        out[ produced++ ] = escape;
+        mHasPending       = true;
+        mPos++;
+      }
+    }
+
+    return produced;
+  }
+
+  /*---------------------------------------------------------------------------
+  Decoder
+  ---------------------------------------------------------------------------*/
+  Decoder::Decoder( const Protocol protocol, const Check check, uint8_t *const buffer, const size_t size ) :
+      mProtocol( protocol ), mCheck( check ), mBuffer( buffer ), mSize( buffer ? size : 0 ), mLength( 0 ), mReady( 0 ),
+      mBlock( 0 ), mError( Result::FRAME ), mStarted( false ), mPendingZero( false ), mEscape( false )
+  {
+  }
+
+
+  Result Decoder::decode( const uint8_t *const data, const size_t length, size_t &consumed )
+  {
+    mReady   = 0;
+    consumed = 0;
+
+    if ( !data || !length )
+    {
+      return Result::NEED_MORE;
+    }
+
+    if ( mProtocol == Protocol::COBS )
+    {
+      return decodeCOBS( data, length, consumed );
+    }
+    else
+    {
+      return decodeStuffed( data, length, consumed );
+    }
+  }
+
+
+  etl::span<uint8_t> Decoder::frame() const
+  {
+    return etl::span<uint8_t>( mBuffer, mReady );
+  }
+
+
+  void Decoder::reset()
+  {
+    mLength      = 0;
+    mReady       = 0;
+    mBlock       = 0;
+    mError       = Result::FRAME;
+    mStarted     = false;
+    mPendingZero = false;
+    mEscape      = false;
+  }
+
+
+  void Decoder::append( const uint8_t *const data, const size_t length )
+  {
+    if ( mError != Result::FRAME )
+    {
+      return;
+    }
+
+    if ( length > ( mSize - mLength ) )
+    {
+      mError = Result::OVERFLOW;
+      return;
+    }
+
+    memcpy( mBuffer + mLength, data, length );
+    mLength += length;
+  }
+
+
+  Result Decoder::finish()
+  {
+    Result       result  = mError;
+    const size_t trailer = trailerSize( mCheck );
+
+    if ( result == Result::FRAME )
+    {
+      uint8_t expect[ 4 ];
+
+      if ( mLength < trailer )
+      {
+        result = Result::CHECK_FAILED;
+      }
+      else if ( makeTrailer( mCheck, mBuffer, mLength - trailer, expect ) &&
+                memcmp( expect, mBuffer + mLength - trailer, trailer ) )
+      {
+        result = Result::CHECK_FAILED;
+      }
+      else
+      {
+        mReady = mLength - trailer;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    The payload stays in the buffer until the next frame starts
+    -------------------------------------------------------------------------*/
+    mLength      = 0;
+    mBlock       = 0;
+    mError       = Result::FRAME;
+    mStarted     = false;
+    mPendingZero = false;
+    mEscape      = false;
+
+    return result;
+  }
+
+
+  Result Decoder::decodeCOBS( const uint8_t *const data, const size_t length, size_t &consumed )
+  {
+    static constexpr uint8_t zero = 0;
+    size_t                   idx  = 0;
+
+    while ( idx < length )
+    {
+      /*-----------------------------------------------------------------------
+      Code byte, or the delimiter
+      -----------------------------------------------------------------------*/
+      if ( !mBlock )
+      {
+        const uint8_t code = data[ idx++ ];
+        if ( code == COBS_DELIMITER )
+        {
+          if ( !mStarted )
+          {
+            continue;
+          }
+
+          consumed = idx;
+          return finish();
+        }
+
+        if ( mPendingZero )
+        {
+          append( &zero, 1 );
+        }
+
+        mStarted     = true;
+        mBlock       = code - 1u;
+        mPendingZero = ( code != ( COBS_MAX_RUN + 1 ) );
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Block contents. A delimiter inside one means the frame was cut short.
+      -----------------------------------------------------------------------*/
+      const size_t run = std::min( mBlock, length - idx );
+      const size_t hit = findAny( data + idx, run, COBS_DELIMITER, COBS_DELIMITER );
+
+      append( data + idx, hit );
+      idx += hit;
+      mBlock -= hit;
+
+      if ( hit < run )
+      {
+        mError   = ( mError == Result::FRAME ) ? Result::INVALID : mError;
+        consumed = idx + 1;
+        return finish();
+      }
+    }
+
+    consumed = idx;
+    return Result::NEED_MORE;
+  }
+
+
+  Result Decoder::decodeStuffed( const uint8_t *const data, const size_t length, size_t &consumed )
+  {
+    const uint8_t flag   = delimiterOf( mProtocol );
+    const uint8_t escape = escapeOf( mProtocol );
+    size_t        idx    = 0;
+
+    while ( idx < length )
+    {
+      if ( mEscape )
+      {
+        const uint8_t value = data[ idx ];
+        mEscape             = false;
+
+        /*---------------------------------------------------------------------
+        An escaped delimiter is the HDLC abort sequence. Let the delimiter
+        end the frame below.
+        ---------------------------------------------------------------------*/
+        if ( value == flag )
+        {
+          mError = ( mError == Result::FRAME ) ? Result::INVALID : mError;
+        }
+        else if ( mProtocol == Protocol::HDLC )
+        {
+          const uint8_t decoded = value ^ HDLC_XOR;
+          append( &decoded, 1 );
+          idx++;
+          continue;
+        }
+        else
+        {
+          const uint8_t decoded = ( value == SLIP_ESC_END ) ? SLIP_END : SLIP_ESC;
+          if ( ( value == SLIP_ESC_END ) || ( value == SLIP_ESC_ESC ) )
+          {
+            append( &decoded, 1 );
+          }
+          else
+          {
+            mError = ( mError == Result::FRAME ) ? Result::INVALID : mError;
+          }
+
+          idx++;
+          continue;
+        }
+      }
+
+      /*-----------------------------------------------------------------------
+      Bulk copy up to the next delimiter or escape
+      -----------------------------------------------------------------------*/
+      const size_t hit = findAny( data + idx, length - idx, flag, escape );
+      if ( hit )
+      {
+        append( data + idx, hit );
+        mStarted = true;
+        idx += hit;
+      }
+
+      if ( idx >= length )
+      {
+        break;
+      }
+
+      if ( data[ idx++ ] == escape )
+      {
+        mEscape  = true;
+        mStarted = true;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Delimiter. Back to back ones carry no frame.
+      -----------------------------------------------------------------------*/
+      if ( mStarted )
+      {
+        consumed = idx;
+        return finish();
+      }
+    }
+
+    consumed = idx;
+    return Result::NEED_MORE;
+  }
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  size_t maxEncodedSize( const Protocol protocol, const Check check, const size_t length )
+  {
+    const size_t size = length + trailerSize( check );
+
+    if ( protocol == Protocol::COBS )
+    {
+      return size + ( size / COBS_MAX_RUN ) + 2u;
+    }
+    else
+    {
+      return ( 2u * size ) + 2u;
+    }
+  }
+
+
+  size_t encode( const Protocol protocol, const Check check, const void *const payload, const size_t length,
+                 uint8_t *const out, const size_t size )
+  {
+    Encoder encoder( protocol, check );
+    encoder.begin( payload, length );
+
+    const size_t produced = encoder.encode( out, size );
+    return encoder.done() ? produced : 0;
+  }
+
+
+  int writeFrame( Driver &driver, Encoder &encoder, const void *const payload, const size_t length,
+                  const size_t timeout )
+  {
+    const size_t start = Chimera::millis();
+    encoder.begin( payload, length );
+
+    while ( !encoder.done() )
+    {
+      auto span = driver.writeReserve( encoder.remaining() );
+      if ( !span.empty() )
+      {
+        const size_t produced = encoder.encode( span.data(), span.size() );
+        driver.writeCommit( span.first( produced ) );
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      No room. Let the driver's blocking write() do the waiting, with a small
+      piece of the frame, so its timeout semantics apply unchanged.
+      -----------------------------------------------------------------------*/
+      const size_t elapsed = Chimera::millis() - start;
+      if ( elapsed >= timeout )
+      {
+        return -1;
+      }
+
+      uint8_t      chunk[ 32 ];
+      const size_t produced = encoder.encode( chunk, sizeof( chunk ) );
+      const int    written  = driver.write( chunk, produced, timeout - elapsed );
+
+      if ( ( written < 0 ) || ( static_cast<size_t>( written ) != produced ) )
+      {
+        return -1;
+      }
+    }
+
+    return static_cast<int>( length );
+  }
+
+
+  Result readFrame( Driver &driver, Decoder &decoder, const size_t timeout )
+  {
+    const size_t start = Chimera::millis();
+
+    while ( true )
+    {
+      auto span = driver.readPeek();
+      if ( !span.empty() )
+      {
+        size_t       consumed = 0;
+        const Result result   = decoder.decode( span.data(), span.size(), consumed );
+
+        driver.readConsume( span.first( consumed ) );
+        if ( result != Result::NEED_MORE )
+        {
+          return result;
+        }
+
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Nothing buffered. Block in the driver's read() for a single byte.
+      -----------------------------------------------------------------------*/
+      const size_t elapsed = Chimera::millis() - start;
+      if ( elapsed >= timeout )
+      {
+        return Result::NEED_MORE;
+      }
+
+      uint8_t byte = 0;
+      if ( driver.read( &byte, 1, timeout - elapsed ) != 1 )
+      {
+        return Result::NEED_MORE;
+      }
+
+      size_t       consumed = 0;
+      const Result result   = decoder.decode( &byte, 1, consumed );
+      if ( result != Result::NEED_MORE )
+      {
+        return result;
+      }
+    }
+  }
+
+
+  uint16_t crc16( const void *const data, const size_t length )
+  {
+    const uint32_t crc = crcUpdate( s_crc16, 0xFFFFu, static_cast<const uint8_t *>( data ), data ? length : 0 );
+    return static_cast<uint16_t>( crc ^ 0xFFFFu );
+  }
+
+
+  uint32_t crc32( const void *const data, const size_t length )
+  {
+    const uint32_t crc = crcUpdate( s_crc32, 0xFFFFFFFFu, static_cast<const uint8_t *>( data ), data ? length : 0 );
+    return crc ^ 0xFFFFFFFFu;
+  }
+
+
+  size_t findAny( const uint8_t *const data, const size_t length, const uint8_t a, const uint8_t b )
+  {
+    size_t idx = 0;
+
+#if defined( __SSE2__ )
+    /*-------------------------------------------------------------------------
+    Sixteen bytes per compare on x86 hosts
+    -------------------------------------------------------------------------*/
+    const __m128i va = _mm_set1_epi8( static_cast<char>( a ) );
+    const __m128i vb = _mm_set1_epi8( static_cast<char>( b ) );
+
+    for ( ; ( idx + sizeof( __m128i ) ) <= length; idx += sizeof( __m128i ) )
+    {
+      const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i *>( data + idx ) );
+      const int     mask  = _mm_movemask_epi8( _mm_or_si128( _mm_cmpeq_epi8( chunk, va ), _mm_cmpeq_epi8( chunk, vb ) ) );
+
+      if ( mask )
+      {
+        return idx + static_cast<size_t>( __builtin_ctz( static_cast<unsigned>( mask ) ) );
+      }
+    }
+#elif defined( __BYTE_ORDER__ ) && ( __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ )
+    /*-------------------------------------------------------------------------
+    A machine word per compare everywhere else. A byte matches when it XORs
+    to zero, and the classic has-zero test flags it. Borrows only ripple
+    upwards, so the lowest flag is always a real match.
+    -------------------------------------------------------------------------*/
+    using Word = size_t;
+
+    constexpr Word ONES  = ~static_cast<Word>( 0 ) / 0xFFu;
+    constexpr Word HIGHS = ONES * 0x80u;
+    const Word     wa    = ONES * a;
+    const Word     wb    = ONES * b;
+
+    for ( ; ( idx + sizeof( Word ) ) <= length; idx += sizeof( Word ) )
+    {
+      Word word;
+      memcpy( &word, data + idx, sizeof( word ) );
+
+      const Word xa  = word ^ wa;
+      const Word xb  = word ^ wb;
+      const Word hit = ( ( ( xa - ONES ) & ~xa ) | ( ( xb - ONES ) & ~xb ) ) & HIGHS;
+
+      if ( hit )
+      {
+        return idx + ( static_cast<size_t>( __builtin_ctzll( hit ) ) / 8u );
+      }
+    }
+#endif
+
+    for ( ; idx < length; idx++ )
+    {
+      if ( ( data[ idx ] == a ) || ( data[ idx ] == b ) )
+      {
+        return idx;
+      }
+    }
+
+    return length;
+  }
+
+}  // namespace Chimera::Serial::Framing
@@ -0,0 +1,754 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_serial_mux.cpp
+ *
+ *  Description:
+ *    Virtual channel multiplexer. Every frame on the wire carries a kind, a
+ *    channel number and a 32-bit byte counter:
+ *
+ *      DATA    counter is the sender's byte offset, followed by the payload
+ *      CREDIT  counter is how far the receiver will let the sender go
+ *
+ *    Both counters are cumulative, so a lost frame costs some bytes on one
+ *    channel but never the flow control state.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* STL Includes */
+#include <algorithm>
+#include <cstring>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/serial>
+#include <Chimera/thread>
+#include <Chimera/source/drivers/serial/serial_mux.hpp>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+How often every open channel re-sends its credit, in milliseconds.
+This recovers from lost CREDIT frames and from a far end that came
+up after the announcement went out.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_SERIAL_MUX_REFRESH
+#define CHIMERA_SERIAL_MUX_REFRESH ( 100 )
+#endif
+
+namespace Chimera::Serial::Mux
+{
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  enum Kind : uint8_t
+  {
+    KIND_DATA   = 0x01,
+    KIND_CREDIT = 0x02,
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static void putU32( uint8_t *const dst, const uint32_t value )
+  {
+    dst[ 0 ] = static_cast<uint8_t>( value );
+    dst[ 1 ] = static_cast<uint8_t>( value >> 8 );
+    dst[ 2 ] = static_cast<uint8_t>( value >> 16 );
+    dst[ 3 ] = static_cast<uint8_t>( value >> 24 );
+  }
+
+
+  static uint32_t getU32( const uint8_t *const src )
+  {
+    return static_cast<uint32_t>( src[ 0 ] ) | ( static_cast<uint32_t>( src[ 1 ] ) << 8 ) |
+           ( static_cast<uint32_t>( src[ 2 ] ) << 16 ) | ( static_cast<uint32_t>( src[ 3 ] ) << 24 );
+  }
+
+
+  /**
+   *  Signed distance between two wrapping byte counters
+   */
+  static int32_t distance( const uint32_t to, const uint32_t from )
+  {
+    return static_cast<int32_t>( to - from );
+  }
+
+
+  /**
+   *  Waits on a signal for whatever is left of a timeout started at start
+   *
+   *  @return bool            False once the timeout has expired
+   */
+  static bool waitFor( Chimera::Thread::BinarySemaphore &signal, const size_t start, const size_t timeout )
+  {
+    if ( timeout == Chimera::Thread::TIMEOUT_BLOCK )
+    {
+      signal.acquire();
+      return true;
+    }
+
+    const size_t elapsed = Chimera::millis() - start;
+    if ( elapsed >= timeout )
+    {
+      return false;
+    }
+
+    signal.try_acquire_for( timeout - elapsed );
+    return true;
+  }
+
+
+  template<typename Vec>
+  static bool validSegments( const etl::span<const Vec> &segments )
+  {
+    for ( const Vec &segment : segments )
+    {
+      if ( segment.length && !segment.data )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /*---------------------------------------------------------------------------
+  Endpoint Implementation
+  ---------------------------------------------------------------------------*/
+  Endpoint::Endpoint() :
+      mLink( nullptr ), mId( 0 ), mPriority( 0 ), mWeight( 1 ), mOpen( false ), mAnnounce( false ), mRx( nullptr ),
+      mTx( nullptr ), mWindow( 0 ), mLimit( 0 ), mSent( 0 ), mDeficit( 0 ), mReceived( 0 ), mSkipped( 0 ), mConsumed( 0 ),
+      mAdvertised( 0 )
+  {
+  }
+
+
+  Endpoint::~Endpoint()
+  {
+  }
+
+
+  Chimera::Status_t Endpoint::open( const Chimera::Serial::Config &config )
+  {
+    if ( !mLink )
+    {
+      return Status::NOT_READY;
+    }
+
+    if ( !config.rxBuffer || !config.txBuffer || ( config.rxBuffer->capacity() <= ( 2 * CHUNK_SIZE + 1 ) ) ||
+         !config.txBuffer->capacity() )
+    {
+      return Status::INVALID_BUFFER;
+    }
+
+    if ( config.rxMode != RxMode::RX_LENGTH )
+    {
+      return Chimera::Status::NOT_SUPPORTED;
+    }
+
+    /*-------------------------------------------------------------------------
+    The byte counters carry on from any earlier session so both ends stay in
+    step. Whatever was left unread counts as consumed, and the window leaves
+    room for the bip buffer wasting up to a chunk at its wrap point.
+    -------------------------------------------------------------------------*/
+    mOpen = false;
+    if ( mRx )
+    {
+      mConsumed += static_cast<uint32_t>( mRx->size() );
+    }
+
+    mRx     = config.rxBuffer;
+    mTx     = config.txBuffer;
+    mWindow = static_cast<uint32_t>( mRx->capacity() - 1 - CHUNK_SIZE );
+    mRx->clear();
+    mTx->clear();
+
+    mAnnounce = true;
+    mOpen     = true;
+    mLink->mWake.release();
+    return Chimera::Status::OK;
+  }
+
+
+  Chimera::Status_t Endpoint::close()
+  {
+    mOpen = false;
+    mRxSignal.release();
+    mTxSignal.release();
+    return Chimera::Status::OK;
+  }
+
+
+  int Endpoint::write( const void *const buffer, const size_t length, const size_t timeout )
+  {
+    if ( !buffer )
+    {
+      return -1;
+    }
+
+    const ConstIOVec segment = { buffer, length };
+    return writev( etl::span<const ConstIOVec>( &segment, 1 ), timeout );
+  }
+
+
+  int Endpoint::read( void *const buffer, const size_t length, const size_t timeout )
+  {
+    if ( !buffer )
+    {
+      return -1;
+    }
+
+    const IOVec segment = { buffer, length };
+    return readv( etl::span<const IOVec>( &segment, 1 ), timeout );
+  }
+
+
+  int Endpoint::writev( const etl::span<const ConstIOVec> &segments, const size_t timeout )
+  {
+    if ( !mOpen || !validSegments( segments ) )
+    {
+      return -1;
+    }
+
+    const size_t start = Chimera::millis();
+    size_t       done  = 0;
+
+    for ( const ConstIOVec &segment : segments )
+    {
+      const uint8_t *src    = static_cast<const uint8_t *>( segment.data );
+      size_t         offset = 0;
+
+      while ( offset < segment.length )
+      {
+        auto span = mTx->write_reserve( segment.length - offset );
+        if ( span.empty() )
+        {
+          queued( done );
+          if ( !waitFor( mTxSignal, start, timeout ) || !mOpen )
+          {
+            return static_cast<int>( done );
+          }
+
+          continue;
+        }
+
+        memcpy( span.data(), src + offset, span.size() );
+        mTx->write_commit( span );
+        offset += span.size();
+        done += span.size();
+      }
+    }
+
+    queued( done );
+    return static_cast<int>( done );
+  }
+
+
+  int Endpoint::readv( const etl::span<const IOVec> &segments, const size_t timeout )
+  {
+    if ( !mOpen || !validSegments( segments ) )
+    {
+      return -1;
+    }
+
+    const size_t start = Chimera::millis();
+    size_t       done  = 0;
+
+    for ( const IOVec &segment : segments )
+    {
+      uint8_t *dst    = static_cast<uint8_t *>( segment.data );
+      size_t   offset = 0;
+
+      while ( offset < segment.length )
+      {
+        auto span = mRx->read_reserve( segment.length - offset );
+        if ( span.empty() )
+        {
+          if ( !waitFor( mRxSignal, start, timeout ) || !mOpen )
+          {
+            return static_cast<int>( done );
+          }
+
+          continue;
+        }
+
+        memcpy( dst + offset, span.data(), span.size() );
+        mRx->read_commit( span );
+        consumed( span.size() );
+        offset += span.size();
+        done += span.size();
+      }
+    }
+
+    return static_cast<int>( done );
+  }
+
+
+  etl::span<uint8_t> Endpoint::writeReserve( const size_t length )
+  {
+    return mOpen ? mTx->write_reserve( length ) : etl::span<uint8_t>();
+  }
+
+
+  int Endpoint::writeCommit( const etl::span<uint8_t> &data )
+  {
+    if ( !mOpen )
+    {
+      return -1;
+    }
+
+    mTx->write_commit( data );
+    queued( data.size() );
+    return static_cast<int>( data.size() );
+  }
+
+
+  etl::span<uint8_t> Endpoint::readPeek( const size_t length )
+  {
+    return mOpen ? mRx->read_reserve( length ) : etl::span<uint8_t>();
+  }
+
+
+  int Endpoint::readConsume( const etl::span<uint8_t> &data )
+  {
+    if ( !mOpen )
+    {
+      return -1;
+    }
+
+    mRx->read_commit( data );
+    consumed( data.size() );
+    return static_cast<int>( data.size() );
+  }
+
+
+  size_t Endpoint::rxLength()
+  {
+    return mOpen ? mRx->size() : 0;
+  }
+
+
+  void Endpoint::getStats( Stats &stats )
+  {
+    mStats.snapshot( stats );
+  }
+
+
+  void Endpoint::resetStats()
+  {
+    mStats.reset();
+  }
+
+
+  Chimera::Status_t Endpoint::setBaud( const size_t baud )
+  {
+    ( void )baud;
+    return Chimera::Status::NOT_SUPPORTED;
+  }
+
+
+  Chimera::Status_t Endpoint::autoBaud( const uint8_t sync )
+  {
+    ( void )sync;
+    return Chimera::Status::NOT_SUPPORTED;
+  }
+
+
+  size_t Endpoint::getBaud()
+  {
+    return ( mLink && mLink->mDriver ) ? mLink->mDriver->getBaud() : 0;
+  }
+
+
+  Chimera::Status_t Endpoint::setScheduling( const uint8_t priority, const uint8_t weight )
+  {
+    if ( !weight )
+    {
+      return Chimera::Status::INVAL_FUNC_PARAM;
+    }
+
+    mPriority = priority;
+    mWeight   = weight;
+    return Chimera::Status::OK;
+  }
+
+
+  size_t Endpoint::lost() const
+  {
+    return mSkipped.load();
+  }
+
+
+  /**
+   *  How far the far end may send: everything that has left mRx, plus the
+   *  window
+   */
+  uint32_t Endpoint::credit() const
+  {
+    return mConsumed.load() + mSkipped.load() + mWindow;
+  }
+
+
+  /**
+   *  Wakes the link once enough of mRx has freed up to be worth a CREDIT frame
+   */
+  void Endpoint::consumed( const size_t count )
+  {
+    mConsumed += static_cast<uint32_t>( count );
+    if ( ( credit() - mAdvertised ) >= ( mWindow / 4 ) )
+    {
+      mLink->mWake.release();
+    }
+  }
+
+
+  void Endpoint::queued( const size_t count )
+  {
+    if ( count )
+    {
+      mLink->mWake.release();
+    }
+  }
+
+  /*---------------------------------------------------------------------------
+  Link Implementation
+  ---------------------------------------------------------------------------*/
+  Link::Link() :
+      mDriver( nullptr ), mProtocol( Framing::Protocol::COBS ), mCheck( Framing::Check::CRC16 ),
+      mDecoder( mProtocol, mCheck, mRxFrame, sizeof( mRxFrame ) ), mCursor( 0 ), mCharged( false ), mLastRefresh( 0 ),
+      mTxLength( 0 ), mTxDone( 0 )
+  {
+  }
+
+
+  Link::~Link()
+  {
+  }
+
+
+  Chimera::Status_t Link::open( Driver &driver, const Framing::Protocol protocol, const Framing::Check check )
+  {
+    if ( ( protocol >= Framing::Protocol::NUM_OPTIONS ) || ( check >= Framing::Check::NUM_OPTIONS ) )
+    {
+      return Chimera::Status::INVAL_FUNC_PARAM;
+    }
+
+    mDriver      = &driver;
+    mProtocol    = protocol;
+    mCheck       = check;
+    mDecoder     = Framing::Decoder( protocol, check, mRxFrame, sizeof( mRxFrame ) );
+    mCursor      = 0;
+    mCharged     = false;
+    mLastRefresh = Chimera::millis();
+    mTxLength    = 0;
+    mTxDone      = 0;
+
+    for ( size_t x = 0; x < NUM_CHANNELS; x++ )
+    {
+      Endpoint &ep  = mEndpoints[ x ];
+      ep.mLink       = this;
+      ep.mId         = static_cast<uint8_t>( x );
+      ep.mOpen       = false;
+      ep.mAnnounce   = false;
+      ep.mRx         = nullptr;
+      ep.mTx         = nullptr;
+      ep.mLimit      = 0;
+      ep.mSent       = 0;
+      ep.mDeficit    = 0;
+      ep.mReceived   = 0;
+      ep.mSkipped    = 0;
+      ep.mConsumed   = 0;
+      ep.mAdvertised = 0;
+    }
+
+    return Chimera::Status::OK;
+  }
+
+
+  Endpoint *Link::endpoint( const size_t channel )
+  {
+    return ( channel < NUM_CHANNELS ) ? &mEndpoints[ channel ] : nullptr;
+  }
+
+
+  size_t Link::processTX( const size_t timeout )
+  {
+    if ( !mDriver || !flush( timeout ) )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Credit first. It gates the far end's traffic on every channel.
+    -------------------------------------------------------------------------*/
+    const size_t now = Chimera::millis();
+    if ( ( now - mLastRefresh ) >= CHIMERA_SERIAL_MUX_REFRESH )
+    {
+      mLastRefresh = now;
+      for ( Endpoint &ep : mEndpoints )
+      {
+        ep.mAnnounce = true;
+      }
+    }
+
+    for ( Endpoint &ep : mEndpoints )
+    {
+      if ( !ep.mOpen )
+      {
+        continue;
+      }
+
+      const uint32_t limit = ep.credit();
+      if ( ep.mAnnounce.exchange( false ) || ( ( limit - ep.mAdvertised ) >= ( ep.mWindow / 4 ) ) )
+      {
+        ep.mAdvertised = limit;
+        send( KIND_CREDIT, ep.mId, limit, nullptr, 0 );
+        flush( timeout );
+        return 0;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    Then one chunk of data, or wait for some
+    -------------------------------------------------------------------------*/
+    size_t    length = 0;
+    Endpoint *ep     = schedule( length );
+    if ( !ep )
+    {
+      waitFor( mWake, now, std::min<size_t>( timeout, CHIMERA_SERIAL_MUX_REFRESH ) );
+      return 0;
+    }
+
+    uint8_t payload[ CHUNK_SIZE ];
+    size_t  copied = 0;
+    while ( copied < length )
+    {
+      auto span = ep->mTx->read_reserve( length - copied );
+      memcpy( payload + copied, span.data(), span.size() );
+      ep->mTx->read_commit( span );
+      copied += span.size();
+    }
+
+    send( KIND_DATA, ep->mId, ep->mSent, payload, length );
+    ep->mSent += static_cast<uint32_t>( length );
+    StatsBlock::add( ep->mStats.bytesOut, length );
+    ep->mTxSignal.release();
+
+    flush( timeout );
+    return length;
+  }
+
+
+  bool Link::processRX( const size_t timeout )
+  {
+    if ( !mDriver || ( Framing::readFrame( *mDriver, mDecoder, timeout ) != Framing::Result::FRAME ) )
+    {
+      return false;
+    }
+
+    const auto frame = mDecoder.frame();
+    if ( ( frame.size() < HEADER_SIZE ) || ( frame[ 1 ] >= NUM_CHANNELS ) )
+    {
+      return true;
+    }
+
+    Endpoint      &ep    = mEndpoints[ frame[ 1 ] ];
+    const uint32_t value = getU32( &frame[ 2 ] );
+
+    switch ( frame[ 0 ] )
+    {
+      case KIND_CREDIT:
+        if ( distance( value, ep.mLimit ) > 0 )
+        {
+          ep.mLimit = value;
+          mWake.release();
+        }
+        break;
+
+      case KIND_DATA:
+        deliver( ep, value, frame.data() + HEADER_SIZE, frame.size() - HEADER_SIZE );
+        break;
+
+      default:
+        break;
+    }
+
+    return true;
+  }
+
+
+  /**
+   *  Picks the channel that sends next and how much. The highest priority
+   *  with anything sendable wins outright; within it, deficit round robin
+   *  hands each channel weight chunks' worth of bytes per turn.
+   */
+  Endpoint *Link::schedule( size_t &length )
+  {
+    size_t  ready[ NUM_CHANNELS ];
+    bool    found = false;
+    uint8_t level = 0;
+
+    for ( size_t x = 0; x < NUM_CHANNELS; x++ )
+    {
+      Endpoint &ep = mEndpoints[ x ];
+      ready[ x ]   = 0;
+
+      if ( !ep.mOpen )
+      {
+        continue;
+      }
+
+      const int32_t room = distance( ep.mLimit, ep.mSent );
+      if ( room > 0 )
+      {
+        ready[ x ] = std::min( { CHUNK_SIZE, ep.mTx->size(), static_cast<size_t>( room ) } );
+      }
+
+      /*-----------------------------------------------------------------------
+      Idle channels don't bank allowance
+      -----------------------------------------------------------------------*/
+      if ( !ready[ x ] )
+      {
+        ep.mDeficit = 0;
+        continue;
+      }
+
+      if ( !found || ( ep.mPriority > level ) )
+      {
+        level = ep.mPriority;
+        found = true;
+      }
+    }
+
+    if ( !found )
+    {
+      return nullptr;
+    }
+
+    /*-------------------------------------------------------------------------
+    A channel's quantum always covers a chunk, so this finds one within a
+    single lap
+    -------------------------------------------------------------------------*/
+    while ( true )
+    {
+      Endpoint &ep = mEndpoints[ mCursor ];
+
+      if ( ready[ mCursor ] && ( ep.mPriority == level ) )
+      {
+        if ( !mCharged )
+        {
+          ep.mDeficit += ep.mWeight * CHUNK_SIZE;
+          mCharged = true;
+        }
+
+        if ( ep.mDeficit >= ready[ mCursor ] )
+        {
+          ep.mDeficit -= ready[ mCursor ];
+          length = ready[ mCursor ];
+          return &ep;
+        }
+      }
+
+      mCursor  = ( mCursor + 1 ) % NUM_CHANNELS;
+      mCharged = false;
+    }
+  }
+
+
+  /**
+   *  Writes out the rest of the pending frame
+   *
+   *  @return bool            True once nothing is pending
+   */
+  bool Link::flush( const size_t timeout )
+  {
+    if ( mTxDone < mTxLength )
+    {
+      const int written = mDriver->write( mTxFrame + mTxDone, mTxLength - mTxDone, timeout );
+      if ( written > 0 )
+      {
+        mTxDone += static_cast<size_t>( written );
+      }
+    }
+
+    return mTxDone >= mTxLength;
+  }
+
+
+  /**
+   *  Encodes a frame into mTxFrame. Nothing may be pending.
+   */
+  void Link::send( const uint8_t kind, const uint8_t channel, const uint32_t value, const uint8_t *const payload,
+                   const size_t length )
+  {
+    uint8_t frame[ FRAME_SIZE ];
+    frame[ 0 ] = kind;
+    frame[ 1 ] = channel;
+    putU32( &frame[ 2 ], value );
+
+    if ( length )
+    {
+      memcpy( &frame[ HEADER_SIZE ], payload, length );
+    }
+
+    mTxLength = Framing::encode( mProtocol, mCheck, frame, HEADER_SIZE + length, mTxFrame, sizeof( mTxFrame ) );
+    mTxDone   = 0;
+  }
+
+
+  /**
+   *  Puts a DATA payload in its channel's rxBuffer. Bytes that can't be
+   *  delivered, whether lost on the way, sent to a closed channel or beyond
+   *  the credit, are skipped so the window stays intact.
+   */
+  void Link::deliver( Endpoint &ep, const uint32_t offset, const uint8_t *const payload, const size_t length )
+  {
+    const int32_t gap = distance( offset, ep.mReceived );
+    if ( gap < 0 )
+    {
+      return;
+    }
+
+    size_t done = 0;
+    if ( ep.mOpen )
+    {
+      while ( done < length )
+      {
+        auto span = ep.mRx->write_reserve( length - done );
+        if ( span.empty() )
+        {
+          break;
+        }
+
+        memcpy( span.data(), payload + done, span.size() );
+        ep.mRx->write_commit( span );
+        done += span.size();
+      }
+    }
+
+    const uint32_t skipped = static_cast<uint32_t>( gap ) + static_cast<uint32_t>( length - done );
+    ep.mReceived           = offset + static_cast<uint32_t>( length );
+
+    if ( done )
+    {
+      StatsBlock::add( ep.mStats.bytesIn, done );
+      ep.mStats.rxLevel( ep.mRx->size() );
+      ep.mRxSignal.release();
+    }
+
+    if ( ep.mOpen && ( done < length ) )
+    {
+      StatsBlock::add( ep.mStats.rxFull );
+    }
+
+    if ( skipped )
+    {
+      StatsBlock::add( ep.mStats.rxDropped, skipped );
+      ep.mSkipped += skipped;
+      mWake.release();
+    }
+  }
+
+}  // namespace Chimera::Serial::Mux
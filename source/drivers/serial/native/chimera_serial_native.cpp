@@ -0,0 +1,1504 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_serial_native.cpp
+ *
+ *  Description:
+ *    Serial, USART and UART backend for Linux hosts. A single epoll thread
+ *    plays the part of the hardware, moving bytes between each channel's bip
+ *    buffers and its socketpair or PTY.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#if defined( USING_NATIVE_THREADS ) && defined( __linux__ )
+
+/* STL Includes */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+/* Linux Includes */
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/serial>
+#include <Chimera/uart>
+#include <Chimera/usart>
+#include <Chimera/source/drivers/serial/native/serial_native.hpp>
+
+namespace Chimera::Serial
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t NUM_PORTS = static_cast<size_t>( Channel::NUM_OPTIONS );
+
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Driver objects opened on a port, which get the AsyncIO signals
+   */
+  enum View : uint8_t
+  {
+    VIEW_SERIAL = ( 1u << 0 ),
+    VIEW_USART  = ( 1u << 1 ),
+    VIEW_UART   = ( 1u << 2 ),
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  State of one channel. The IO thread is the only producer into rx and the
+   *  only consumer of tx, so the buffers need no locking. The lock guards the
+   *  descriptors and epoll interest, and backs the condition variable that
+   *  read() and write() wait on.
+   *
+   *  Packet boundaries are tracked as running byte counts: rxTotal is what the
+   *  IO thread has received, rxMark where the last packet ended and rxTaken
+   *  what the consumer has removed. rxMark - rxTaken is ready to be read.
+   *
+   *  A socket carries no bit timing, so the baud rate is bookkeeping. On a
+   *  PTY it is mirrored into the terminal settings, where the far end can
+   *  see and change it.
+   */
+  struct Port
+  {
+    size_t                  index;      /**< Position in s_ports */
+    Native::Transport       transport;  /**< Transport in use while open */
+    int                     fd;         /**< Non-blocking end serviced by the IO thread */
+    int                     peer;       /**< Far end handed out by peerFd() */
+    uint32_t                interest;   /**< epoll events currently armed */
+    uint8_t                 views;      /**< See View */
+    RxMode                  rxMode;     /**< What ends a packet */
+    uint8_t                 rxMatch;    /**< Terminator for RX_CHAR_MATCH */
+    char                    path[ 64 ]; /**< PTY slave path */
+    BipBuffer              *rx;         /**< User's receive buffer */
+    BipBuffer              *tx;         /**< User's transmit buffer */
+    size_t                  rxTotal;    /**< Bytes received, IO thread only */
+    size_t                  rxTaken;    /**< Bytes consumed, reader only */
+    std::atomic<size_t>     rxMark;     /**< rxTotal at the last packet boundary */
+    std::atomic<bool>       opened;     /**< Descriptors are valid */
+    std::atomic<bool>       hangup;     /**< The link failed, nothing more will move */
+    std::atomic<bool>       rxStalled;  /**< rx filled up and EPOLLIN was dropped */
+    std::atomic<bool>       txIdle;     /**< tx ran dry and EPOLLOUT was dropped */
+    StatsBlock              stats;      /**< Written by the IO thread only */
+    std::atomic<size_t>     baud;       /**< Line speed (bps) */
+    std::atomic<bool>       detecting;  /**< autoBaud() waits for the next byte */
+    std::atomic<Port *>     link;       /**< Channel joined by Native::connect() */
+    std::mutex              lock;
+    std::condition_variable cv;
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static size_t            s_driver_initialized;
+  static std::mutex        s_init_lock;
+  static int               s_epoll = -1;
+  static Native::Transport s_transport[ NUM_PORTS ];
+
+  /*-------------------------------------------------------------------
+  The IO thread is never joined, so everything it touches is left out
+  of static destruction
+  -------------------------------------------------------------------*/
+  static Port *const          s_ports  = new Port[ NUM_PORTS ];
+  static Driver *const        s_serial = new Driver[ NUM_PORTS ];
+  static USART::Driver *const s_usart  = new USART::Driver[ NUM_PORTS ];
+  static UART::Driver *const  s_uart   = new UART::Driver[ NUM_PORTS ];
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static size_t toIndex( const Channel channel )
+  {
+    return static_cast<size_t>( channel );
+  }
+
+
+  /**
+   *  Brings epoll interest in line with the buffer state. Port lock held.
+   */
+  static void rearm( Port &port )
+  {
+    if ( !port.opened || port.hangup )
+    {
+      return;
+    }
+
+    const uint32_t interest = ( port.rxStalled ? 0u : EPOLLIN ) | ( port.txIdle ? 0u : EPOLLOUT );
+    if ( interest != port.interest )
+    {
+      epoll_event event;
+      event.events   = interest;
+      event.data.ptr = &port;
+
+      epoll_ctl( s_epoll, EPOLL_CTL_MOD, port.fd, &event );
+      port.interest = interest;
+    }
+  }
+
+
+  /**
+   *  Terminal speed codes for the standard rates
+   */
+  static constexpr struct
+  {
+    BaudRate rate;
+    speed_t  speed;
+  } s_speeds[] = {
+    { BaudRate::SERIAL_BAUD_110, B110 },       { BaudRate::SERIAL_BAUD_150, B150 },
+    { BaudRate::SERIAL_BAUD_300, B300 },       { BaudRate::SERIAL_BAUD_1200, B1200 },
+    { BaudRate::SERIAL_BAUD_2400, B2400 },     { BaudRate::SERIAL_BAUD_4800, B4800 },
+    { BaudRate::SERIAL_BAUD_9600, B9600 },     { BaudRate::SERIAL_BAUD_19200, B19200 },
+    { BaudRate::SERIAL_BAUD_38400, B38400 },   { BaudRate::SERIAL_BAUD_57600, B57600 },
+    { BaudRate::SERIAL_BAUD_115200, B115200 }, { BaudRate::SERIAL_BAUD_230400, B230400 },
+    { BaudRate::SERIAL_BAUD_460800, B460800 }, { BaudRate::SERIAL_BAUD_921600, B921600 },
+  };
+
+
+  /**
+   *  Mirrors the baud rate into a PTY's terminal settings. They only take
+   *  the standard rates, so anything else is rounded. Port lock held.
+   */
+  static void applySpeed( Port &port )
+  {
+    if ( port.transport != Native::Transport::PTY )
+    {
+      return;
+    }
+
+    termios tio;
+    if ( tcgetattr( port.fd, &tio ) != 0 )
+    {
+      return;
+    }
+
+    const BaudRate rate = closestBaudRate( port.baud.load( std::memory_order_relaxed ) );
+    for ( const auto &entry : s_speeds )
+    {
+      if ( entry.rate == rate )
+      {
+        cfsetspeed( &tio, entry.speed );
+        tcsetattr( port.fd, TCSANOW, &tio );
+        break;
+      }
+    }
+  }
+
+
+  /**
+   *  Completes an autoBaud() once a byte has arrived. Lacking edges to time,
+   *  the "measurement" is the rate the far end is set to: the PTY's terminal
+   *  speed, or the baud of the channel joined by Native::connect(). A plain
+   *  socketpair peer has none, so the rate stays. Port lock held.
+   */
+  static void detectBaud( Port &port )
+  {
+    size_t measured = port.baud.load( std::memory_order_relaxed );
+
+    if ( port.transport == Native::Transport::PTY )
+    {
+      termios tio;
+      if ( tcgetattr( port.fd, &tio ) == 0 )
+      {
+        const speed_t speed = cfgetospeed( &tio );
+        for ( const auto &entry : s_speeds )
+        {
+          if ( entry.speed == speed )
+          {
+            measured = static_cast<size_t>( entry.rate );
+            break;
+          }
+        }
+      }
+    }
+    else
+    {
+      const Port *const link = port.link.load();
+      if ( link && ( link->link.load() == &port ) && link->opened )
+      {
+        measured = link->baud.load( std::memory_order_relaxed );
+      }
+    }
+
+    port.baud.store( static_cast<size_t>( closestBaudRate( measured ) ), std::memory_order_relaxed );
+    port.detecting.store( false, std::memory_order_release );
+  }
+
+
+  /**
+   *  Stops servicing a port whose link is gone. epoll reports EPOLLHUP even
+   *  with no interest armed, so it has to come out of the set entirely.
+   */
+  static void disconnect( Port &port )
+  {
+    port.hangup = true;
+    epoll_ctl( s_epoll, EPOLL_CTL_DEL, port.fd, nullptr );
+  }
+
+
+  /**
+   *  Moves everything the kernel has into rx and advances the packet
+   *  boundary. Port lock held.
+   *
+   *  The kernel running dry is the idle line here: whatever the peer wrote in
+   *  one go has all arrived. A full buffer or a dead link also ends a packet,
+   *  as a DMA transfer running out of room would, so a reader can't wait
+   *  forever on data that has nowhere to go.
+   *
+   *  @return bool            True if a receive completed
+   */
+  static bool receive( Port &port )
+  {
+    size_t boundary = port.rxMark.load( std::memory_order_relaxed );
+    bool   flush    = false;
+
+    while ( true )
+    {
+      auto span = port.rx->write_reserve( CHIMERA_SERIAL_NATIVE_CHUNK );
+      if ( span.empty() )
+      {
+        /*---------------------------------------------------------------------
+        Full. Leave the rest in the kernel, which back-pressures the sender
+        like a deasserted RTS would. The consumer re-arms once it has read
+        something, so check again after publishing the flag in case it
+        already did.
+        ---------------------------------------------------------------------*/
+        port.rxStalled.store( true, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if ( port.rx->write_reserve( 1 ).empty() )
+        {
+          StatsBlock::add( port.stats.rxFull );
+          flush = true;
+          break;
+        }
+
+        port.rxStalled.store( false, std::memory_order_relaxed );
+        continue;
+      }
+
+      const ssize_t count = ::read( port.fd, span.data(), span.size() );
+      if ( count > 0 )
+      {
+        if ( port.detecting.load( std::memory_order_relaxed ) )
+        {
+          detectBaud( port );
+        }
+
+        port.rx->write_commit( span.first( static_cast<size_t>( count ) ) );
+        StatsBlock::add( port.stats.bytesIn, static_cast<size_t>( count ) );
+        port.stats.rxLevel( port.rx->size() );
+
+        if ( port.rxMode == RxMode::RX_CHAR_MATCH )
+        {
+          const void *match = memrchr( span.data(), port.rxMatch, static_cast<size_t>( count ) );
+          if ( match )
+          {
+            boundary = port.rxTotal + ( static_cast<const uint8_t *>( match ) - span.data() ) + 1;
+          }
+        }
+
+        port.rxTotal += static_cast<size_t>( count );
+        if ( static_cast<size_t>( count ) < span.size() )
+        {
+          flush = ( port.rxMode == RxMode::RX_IDLE_LINE );
+          break;
+        }
+      }
+      else if ( ( count < 0 ) && ( errno == EINTR ) )
+      {
+        continue;
+      }
+      else
+      {
+        if ( ( count == 0 ) || ( ( errno != EAGAIN ) && ( errno != EWOULDBLOCK ) ) )
+        {
+          disconnect( port );
+          flush = true;
+        }
+        else
+        {
+          flush = ( port.rxMode == RxMode::RX_IDLE_LINE );
+        }
+        break;
+      }
+    }
+
+    if ( flush || ( port.rxMode == RxMode::RX_LENGTH ) )
+    {
+      boundary = port.rxTotal;
+    }
+
+    if ( boundary == port.rxMark.load( std::memory_order_relaxed ) )
+    {
+      return false;
+    }
+
+    port.rxMark.store( boundary, std::memory_order_release );
+    return true;
+  }
+
+
+  /**
+   *  Pushes as much of tx into the kernel as it will take. Port lock held.
+   *
+   *  @return bool            True if any bytes went out
+   */
+  static bool transmit( Port &port )
+  {
+    bool sent = false;
+
+    while ( true )
+    {
+      auto span = port.tx->read_reserve( CHIMERA_SERIAL_NATIVE_CHUNK );
+      if ( span.empty() )
+      {
+        /*---------------------------------------------------------------------
+        Drained. Same handshake as the RX side, but with the producer.
+        ---------------------------------------------------------------------*/
+        port.txIdle.store( true, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if ( port.tx->empty() )
+        {
+          break;
+        }
+
+        port.txIdle.store( false, std::memory_order_relaxed );
+        continue;
+      }
+
+      ssize_t count;
+      if ( port.transport == Native::Transport::SOCKETPAIR )
+      {
+        count = ::send( port.fd, span.data(), span.size(), MSG_NOSIGNAL );
+      }
+      else
+      {
+        count = ::write( port.fd, span.data(), span.size() );
+      }
+
+      if ( count > 0 )
+      {
+        port.tx->read_commit( span.first( static_cast<size_t>( count ) ) );
+        StatsBlock::add( port.stats.bytesOut, static_cast<size_t>( count ) );
+        sent = true;
+      }
+      else if ( ( count < 0 ) && ( errno == EINTR ) )
+      {
+        continue;
+      }
+      else
+      {
+        if ( ( count == 0 ) || ( ( errno != EAGAIN ) && ( errno != EWOULDBLOCK ) ) )
+        {
+          disconnect( port );
+        }
+        break;
+      }
+    }
+
+    return sent;
+  }
+
+
+  static void signal( const size_t index, const uint8_t views, const Chimera::Event::Trigger trigger )
+  {
+    if ( views & VIEW_SERIAL )
+    {
+      s_serial[ index ].signalAIO( trigger );
+    }
+
+    if ( views & VIEW_USART )
+    {
+      s_usart[ index ].signalAIO( trigger );
+    }
+
+    if ( views & VIEW_UART )
+    {
+      s_uart[ index ].signalAIO( trigger );
+    }
+  }
+
+
+  static void service( Port &port, const uint32_t events )
+  {
+    bool    received = false;
+    bool    drained  = false;
+    bool    failed   = false;
+    uint8_t views    = 0;
+
+    {
+      std::lock_guard<std::mutex> lck( port.lock );
+
+      /*-----------------------------------------------------------------------
+      Events can still be queued for a port that was closed in the meantime
+      -----------------------------------------------------------------------*/
+      if ( !port.opened || port.hangup )
+      {
+        return;
+      }
+
+      if ( events & ( EPOLLIN | EPOLLHUP | EPOLLERR ) )
+      {
+        received = receive( port );
+      }
+
+      if ( ( events & EPOLLOUT ) && !port.hangup )
+      {
+        drained = transmit( port ) && port.txIdle;
+      }
+
+      failed = port.hangup;
+      views  = port.views;
+      rearm( port );
+    }
+
+    port.cv.notify_all();
+
+    if ( received )
+    {
+      signal( port.index, views, Chimera::Event::Trigger::TRIGGER_READ_COMPLETE );
+    }
+
+    if ( drained )
+    {
+      signal( port.index, views, Chimera::Event::Trigger::TRIGGER_WRITE_COMPLETE );
+    }
+
+    if ( failed )
+    {
+      signal( port.index, views, Chimera::Event::Trigger::TRIGGER_SYSTEM_ERROR );
+    }
+  }
+
+
+  static void IOThread()
+  {
+    epoll_event events[ 16 ];
+
+    while ( true )
+    {
+      const int count = epoll_wait( s_epoll, events, ARRAY_COUNT( events ), -1 );
+
+      for ( int x = 0; x < count; x++ )
+      {
+        service( *static_cast<Port *>( events[ x ].data.ptr ), events[ x ].events );
+      }
+    }
+  }
+
+
+  /**
+   *  Starts the IO thread. It stands in for the UART hardware and its
+   *  interrupts, so it is a plain std::thread rather than a Chimera task and
+   *  runs for the life of the process.
+   */
+  static Chimera::Status_t startIO()
+  {
+    std::lock_guard<std::mutex> lck( s_init_lock );
+
+    if ( s_driver_initialized == Chimera::DRIVER_INITIALIZED_KEY )
+    {
+      return Chimera::Status::OK;
+    }
+
+    s_epoll = epoll_create1( EPOLL_CLOEXEC );
+    if ( s_epoll < 0 )
+    {
+      return Chimera::Status::FAIL;
+    }
+
+    for ( size_t x = 0; x < NUM_PORTS; x++ )
+    {
+      s_ports[ x ].index = x;
+      s_ports[ x ].fd    = -1;
+      s_ports[ x ].peer  = -1;
+      s_transport[ x ]   = CHIMERA_SERIAL_NATIVE_TRANSPORT;
+    }
+
+    std::thread( IOThread ).detach();
+
+    s_driver_initialized = Chimera::DRIVER_INITIALIZED_KEY;
+    return Chimera::Status::OK;
+  }
+
+
+  static bool openSocketPair( Port &port )
+  {
+    int fds[ 2 ];
+    if ( socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds ) != 0 )
+    {
+      return false;
+    }
+
+    port.fd        = fds[ 0 ];
+    port.peer      = fds[ 1 ];
+    port.path[ 0 ] = '\0';
+    return true;
+  }
+
+
+  static bool openPTY( Port &port )
+  {
+    const int master = posix_openpt( O_RDWR | O_NOCTTY | O_CLOEXEC );
+    if ( master < 0 )
+    {
+      return false;
+    }
+
+    if ( ( grantpt( master ) != 0 ) || ( unlockpt( master ) != 0 ) ||
+         ( ptsname_r( master, port.path, sizeof( port.path ) ) != 0 ) )
+    {
+      ::close( master );
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Hold the slave open so the master never sees EIO while no one else has it
+    attached, and make it raw so bytes pass through untouched
+    -------------------------------------------------------------------------*/
+    const int slave = ::open( port.path, O_RDWR | O_NOCTTY | O_CLOEXEC );
+    if ( slave < 0 )
+    {
+      ::close( master );
+      return false;
+    }
+
+    termios tio;
+    if ( tcgetattr( slave, &tio ) == 0 )
+    {
+      cfmakeraw( &tio );
+      tcsetattr( slave, TCSANOW, &tio );
+    }
+
+    port.fd   = master;
+    port.peer = slave;
+    return true;
+  }
+
+
+  static Chimera::Status_t closePort( Port &port )
+  {
+    {
+      std::lock_guard<std::mutex> lck( port.lock );
+
+      if ( !port.opened )
+      {
+        return Chimera::Status::OK;
+      }
+
+      if ( !port.hangup )
+      {
+        epoll_ctl( s_epoll, EPOLL_CTL_DEL, port.fd, nullptr );
+      }
+
+      ::close( port.fd );
+      ::close( port.peer );
+
+      port.opened    = false;
+      port.fd        = -1;
+      port.peer      = -1;
+      port.views     = 0;
+      port.path[ 0 ] = '\0';
+    }
+
+    port.cv.notify_all();
+    return Chimera::Status::OK;
+  }
+
+
+  static Chimera::Status_t openPort( const Config &config, const uint8_t view )
+  {
+    const size_t index = toIndex( config.channel );
+    if ( index >= NUM_PORTS )
+    {
+      return Chimera::Status::INVAL_FUNC_PARAM;
+    }
+
+    if ( !config.rxBuffer || !config.txBuffer || !config.rxBuffer->capacity() || !config.txBuffer->capacity() )
+    {
+      return Status::INVALID_BUFFER;
+    }
+
+    if ( config.rxMode >= RxMode::NUM_OPTIONS )
+    {
+      return Chimera::Status::INVAL_FUNC_PARAM;
+    }
+
+    if ( startIO() != Chimera::Status::OK )
+    {
+      return Status::FAILED_OPEN;
+    }
+
+    /*-------------------------------------------------------------------------
+    Re-opening with the same buffers just adds another view of the channel.
+    Anything else starts the link over.
+    -------------------------------------------------------------------------*/
+    Port &port = s_ports[ index ];
+    {
+      std::lock_guard<std::mutex> lck( port.lock );
+      if ( port.opened && !port.hangup && ( port.rx == config.rxBuffer ) && ( port.tx == config.txBuffer ) )
+      {
+        port.views |= view;
+        port.rxMode  = config.rxMode;
+        port.rxMatch = config.rxMatch;
+        port.baud    = config.baud;
+        applySpeed( port );
+        return Chimera::Status::OK;
+      }
+    }
+
+    closePort( port );
+
+    std::lock_guard<std::mutex> lck( port.lock );
+
+    port.transport = s_transport[ index ];
+    const bool ready = ( port.transport == Native::Transport::PTY ) ? openPTY( port ) : openSocketPair( port );
+    if ( !ready )
+    {
+      return Status::FAILED_OPEN;
+    }
+
+    fcntl( port.fd, F_SETFL, fcntl( port.fd, F_GETFL ) | O_NONBLOCK );
+
+    port.rx = config.rxBuffer;
+    port.tx = config.txBuffer;
+    port.rx->clear();
+    port.tx->clear();
+    port.rxMode  = config.rxMode;
+    port.rxMatch = config.rxMatch;
+    port.baud    = config.baud;
+    port.rxTotal = 0;
+    port.rxTaken = 0;
+    port.rxMark  = 0;
+
+    port.interest  = EPOLLIN;
+    port.views     = view;
+    port.hangup    = false;
+    port.rxStalled = false;
+    port.txIdle    = true;
+    port.detecting = false;
+    port.link      = nullptr;
+    applySpeed( port );
+
+    epoll_event event;
+    event.events   = port.interest;
+    event.data.ptr = &port;
+
+    if ( epoll_ctl( s_epoll, EPOLL_CTL_ADD, port.fd, &event ) != 0 )
+    {
+      ::close( port.fd );
+      ::close( port.peer );
+      port.fd   = -1;
+      port.peer = -1;
+      return Status::FAILED_OPEN;
+    }
+
+    port.opened = true;
+    return Chimera::Status::OK;
+  }
+
+
+  /**
+   *  Lets the IO thread know tx has data, if it stopped watching for it
+   */
+  static void kickTX( Port &port )
+  {
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( port.txIdle.load( std::memory_order_relaxed ) )
+    {
+      std::lock_guard<std::mutex> lck( port.lock );
+      port.txIdle = false;
+      rearm( port );
+    }
+  }
+
+
+  /**
+   *  Lets the IO thread know rx has room, if it stopped reading for lack of it
+   */
+  static void resumeRX( Port &port )
+  {
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( port.rxStalled.load( std::memory_order_relaxed ) )
+    {
+      std::lock_guard<std::mutex> lck( port.lock );
+      port.rxStalled = false;
+      rearm( port );
+    }
+  }
+
+
+  /**
+   *  Blocks until ready() or the deadline passes
+   *
+   *  @return bool            False on timeout
+   */
+  template<typename Predicate>
+  static bool waitUntil( Port &port, const std::chrono::steady_clock::time_point deadline, const size_t timeout,
+                         Predicate ready )
+  {
+    std::unique_lock<std::mutex> lck( port.lock );
+
+    if ( timeout == Chimera::Thread::TIMEOUT_BLOCK )
+    {
+      port.cv.wait( lck, ready );
+      return true;
+    }
+
+    return port.cv.wait_until( lck, deadline, ready );
+  }
+
+
+  static std::chrono::steady_clock::time_point deadlineOf( const size_t timeout )
+  {
+    const size_t limit = std::min<size_t>( timeout, std::numeric_limits<int32_t>::max() );
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds( limit );
+  }
+
+
+  /**
+   *  Position in a segment list that is walked as one flat range of bytes
+   */
+  template<typename Vec>
+  struct Cursor
+  {
+    const Vec *vec;    /**< Segment list */
+    size_t     index;  /**< Current segment */
+    size_t     offset; /**< Bytes of it already used */
+  };
+
+
+  /**
+   *  Adds up the segment lengths, rejecting any with no buffer behind it
+   */
+  template<typename Vec>
+  static bool totalLength( const etl::span<const Vec> &segments, size_t &total )
+  {
+    total = 0;
+    for ( const Vec &segment : segments )
+    {
+      if ( segment.length && !segment.data )
+      {
+        return false;
+      }
+
+      total += segment.length;
+    }
+
+    return true;
+  }
+
+
+  /**
+   *  Gathers from ConstIOVec segments into region, or scatters region out to
+   *  IOVec segments, and advances the cursor past the bytes moved
+   */
+  template<typename Vec>
+  static void transfer( Cursor<Vec> &cursor, uint8_t *const region, const size_t length )
+  {
+    size_t done = 0;
+    while ( done < length )
+    {
+      const Vec   &segment = cursor.vec[ cursor.index ];
+      const size_t count   = std::min( length - done, segment.length - cursor.offset );
+
+      if constexpr ( std::is_same_v<Vec, ConstIOVec> )
+      {
+        memcpy( region + done, static_cast<const uint8_t *>( segment.data ) + cursor.offset, count );
+      }
+      else
+      {
+        memcpy( static_cast<uint8_t *>( segment.data ) + cursor.offset, region + done, count );
+      }
+
+      done += count;
+      cursor.offset += count;
+      if ( cursor.offset == segment.length )
+      {
+        cursor.index++;
+        cursor.offset = 0;
+      }
+    }
+  }
+
+
+  /**
+   *  Queues as much of the segments as fits, waiting up to timeout for room.
+   *  Everything that fits goes in before the IO thread is kicked.
+   */
+  static int portWritev( Port &port, const etl::span<const ConstIOVec> &segments, const size_t timeout )
+  {
+    size_t length = 0;
+    if ( !port.opened || !totalLength( segments, length ) )
+    {
+      return -1;
+    }
+
+    const auto         deadline = deadlineOf( timeout );
+    Cursor<ConstIOVec> src      = { segments.data(), 0, 0 };
+    size_t             done     = 0;
+
+    while ( true )
+    {
+      const size_t start = done;
+      while ( done < length )
+      {
+        auto span = port.tx->write_reserve( length - done );
+        if ( span.empty() )
+        {
+          break;
+        }
+
+        transfer( src, span.data(), span.size() );
+        port.tx->write_commit( span );
+        done += span.size();
+      }
+
+      if ( done != start )
+      {
+        kickTX( port );
+      }
+
+      if ( ( done >= length ) || ( timeout == Chimera::Thread::TIMEOUT_DONT_WAIT ) )
+      {
+        break;
+      }
+
+      const bool ready = waitUntil( port, deadline, timeout, [ &port ] {
+        return ( port.tx->available() != 0 ) || !port.opened || port.hangup;
+      } );
+
+      if ( !ready || !port.opened || port.hangup )
+      {
+        break;
+      }
+    }
+
+    return static_cast<int>( done );
+  }
+
+
+  static int portWrite( Port &port, const void *const buffer, const size_t length, const size_t timeout )
+  {
+    if ( !buffer )
+    {
+      return -1;
+    }
+
+    const ConstIOVec segment = { buffer, length };
+    return portWritev( port, etl::span<const ConstIOVec>( &segment, 1 ), timeout );
+  }
+
+
+  /**
+   *  Received bytes up to the last packet boundary that haven't been read
+   */
+  static size_t completed( const Port &port )
+  {
+    const size_t ready = port.rxMark.load( std::memory_order_acquire ) - port.rxTaken;
+    return ( static_cast<ptrdiff_t>( ready ) > 0 ) ? ready : 0;
+  }
+
+
+  /**
+   *  Copies out one completed packet, or as much of it as fits, waiting up to
+   *  timeout for a packet boundary. Partial packets are left in rx.
+   */
+  static int readPacket( Port &port, Cursor<IOVec> &dst, const size_t length, const size_t timeout )
+  {
+    if ( !completed( port ) && ( timeout != Chimera::Thread::TIMEOUT_DONT_WAIT ) )
+    {
+      waitUntil( port, deadlineOf( timeout ), timeout, [ &port ] {
+        return completed( port ) || !port.opened || port.hangup;
+      } );
+    }
+
+    const size_t limit = std::min( length, completed( port ) );
+    size_t       done  = 0;
+    bool         found = false;
+
+    while ( ( done < limit ) && !found )
+    {
+      auto span = port.rx->read_reserve( limit - done );
+      if ( span.empty() )
+      {
+        break;
+      }
+
+      size_t count = span.size();
+      if ( port.rxMode == RxMode::RX_CHAR_MATCH )
+      {
+        const void *match = memchr( span.data(), port.rxMatch, count );
+        if ( match )
+        {
+          count = ( static_cast<const uint8_t *>( match ) - span.data() ) + 1;
+          found = true;
+        }
+      }
+
+      transfer( dst, span.data(), count );
+      port.rx->read_commit( span.first( count ) );
+      done += count;
+    }
+
+    if ( done )
+    {
+      port.rxTaken += done;
+      resumeRX( port );
+    }
+
+    return static_cast<int>( done );
+  }
+
+
+  /**
+   *  Copies out received data, waiting up to timeout for enough to fill the
+   *  segments, or for the end of a packet in the packet modes
+   */
+  static int portReadv( Port &port, const etl::span<const IOVec> &segments, const size_t timeout )
+  {
+    size_t length = 0;
+    if ( !port.opened || !totalLength( segments, length ) )
+    {
+      return -1;
+    }
+
+    Cursor<IOVec> dst = { segments.data(), 0, 0 };
+    if ( port.rxMode != RxMode::RX_LENGTH )
+    {
+      return readPacket( port, dst, length, timeout );
+    }
+
+    const auto deadline = deadlineOf( timeout );
+    size_t     done     = 0;
+
+    while ( true )
+    {
+      const size_t start = done;
+      while ( done < length )
+      {
+        auto span = port.rx->read_reserve( length - done );
+        if ( span.empty() )
+        {
+          break;
+        }
+
+        transfer( dst, span.data(), span.size() );
+        port.rx->read_commit( span );
+        done += span.size();
+      }
+
+      if ( done != start )
+      {
+        port.rxTaken += done - start;
+        resumeRX( port );
+      }
+
+      if ( ( done >= length ) || ( timeout == Chimera::Thread::TIMEOUT_DONT_WAIT ) )
+      {
+        break;
+      }
+
+      const bool ready = waitUntil( port, deadline, timeout, [ &port ] {
+        return !port.rx->empty() || !port.opened || port.hangup;
+      } );
+
+      if ( !ready || !port.opened || ( port.hangup && port.rx->empty() ) )
+      {
+        break;
+      }
+    }
+
+    return static_cast<int>( done );
+  }
+
+
+  static int portRead( Port &port, void *const buffer, const size_t length, const size_t timeout )
+  {
+    if ( !buffer )
+    {
+      return -1;
+    }
+
+    const IOVec segment = { buffer, length };
+    return portReadv( port, etl::span<const IOVec>( &segment, 1 ), timeout );
+  }
+
+
+  static Chimera::Status_t portSetBaud( Port &port, const size_t baud )
+  {
+    if ( !baud )
+    {
+      return Chimera::Status::INVAL_FUNC_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lck( port.lock );
+    if ( !port.opened )
+    {
+      return Status::NOT_READY;
+    }
+
+    port.baud      = baud;
+    port.detecting = false;
+    applySpeed( port );
+    return Chimera::Status::OK;
+  }
+
+
+  static Chimera::Status_t portAutoBaud( Port &port )
+  {
+    std::lock_guard<std::mutex> lck( port.lock );
+    if ( !port.opened || port.hangup )
+    {
+      return Status::NOT_READY;
+    }
+
+    port.detecting = true;
+    return Chimera::Status::OK;
+  }
+
+
+  static Chimera::Status_t backendInitialize()
+  {
+    return startIO();
+  }
+
+
+  static Chimera::Status_t backendReset()
+  {
+    for ( size_t x = 0; x < NUM_PORTS; x++ )
+    {
+      closePort( s_ports[ x ] );
+    }
+
+    return Chimera::Status::OK;
+  }
+
+
+  static bool isNativeChannel( const Channel channel )
+  {
+    return toIndex( channel ) < NUM_PORTS;
+  }
+
+
+  static Driver_rPtr getSerialDriver( const Channel channel )
+  {
+    return isNativeChannel( channel ) ? &s_serial[ toIndex( channel ) ] : nullptr;
+  }
+
+
+  static USART::Driver_rPtr getUSARTDriver( const Channel channel )
+  {
+    return isNativeChannel( channel ) ? &s_usart[ toIndex( channel ) ] : nullptr;
+  }
+
+
+  static UART::Driver_rPtr getUARTDriver( const Channel channel )
+  {
+    return isNativeChannel( channel ) ? &s_uart[ toIndex( channel ) ] : nullptr;
+  }
+
+  /*---------------------------------------------------------------------------
+  Backend Registration
+  ---------------------------------------------------------------------------*/
+  namespace Backend
+  {
+    Chimera::Status_t registerDriver( Chimera::Serial::Backend::DriverConfig &registry )
+    {
+      registry.isSupported = true;
+      registry.initialize  = backendInitialize;
+      registry.reset       = backendReset;
+      registry.getDriver   = getSerialDriver;
+      return Chimera::Status::OK;
+    }
+  }  // namespace Backend
+
+  /*---------------------------------------------------------------------------
+  Driver Implementation
+  ---------------------------------------------------------------------------*/
+  Driver::Driver() : mImpl( nullptr )
+  {
+  }
+
+
+  Driver::~Driver()
+  {
+  }
+
+
+  Chimera::Status_t Driver::open( const Chimera::Serial::Config &config )
+  {
+    const auto result = openPort( config, VIEW_SERIAL );
+    if ( result == Chimera::Status::OK )
+    {
+      this->initAIO();
+      mImpl = &s_ports[ toIndex( config.channel ) ];
+    }
+
+    return result;
+  }
+
+
+  Chimera::Status_t Driver::close()
+  {
+    return mImpl ? closePort( *static_cast<Port *>( mImpl ) ) : Chimera::Status::OK;
+  }
+
+
+  int Driver::write( const void *const buffer, const size_t length, const size_t timeout )
+  {
+    return mImpl ? portWrite( *static_cast<Port *>( mImpl ), buffer, length, timeout ) : -1;
+  }
+
+
+  int Driver::read( void *const buffer, const size_t length, const size_t timeout )
+  {
+    return mImpl ? portRead( *static_cast<Port *>( mImpl ), buffer, length, timeout ) : -1;
+  }
+
+
+  int Driver::writev( const etl::span<const ConstIOVec> &segments, const size_t timeout )
+  {
+    return mImpl ? portWritev( *static_cast<Port *>( mImpl ), segments, timeout ) : -1;
+  }
+
+
+  int Driver::readv( const etl::span<const IOVec> &segments, const size_t timeout )
+  {
+    return mImpl ? portReadv( *static_cast<Port *>( mImpl ), segments, timeout ) : -1;
+  }
+
+
+  etl::span<uint8_t> Driver::writeReserve( const size_t length )
+  {
+    auto port = static_cast<Port *>( mImpl );
+    return ( port && port->opened ) ? port->tx->write_reserve( length ) : etl::span<uint8_t>();
+  }
+
+
+  int Driver::writeCommit( const etl::span<uint8_t> &data )
+  {
+    auto port = static_cast<Port *>( mImpl );
+    if ( !port || !port->opened )
+    {
+      return -1;
+    }
+
+    port->tx->write_commit( data );
+    kickTX( *port );
+    return static_cast<int>( data.size() );
+  }
+
+
+  etl::span<uint8_t> Driver::readPeek( const size_t length )
+  {
+    auto port = static_cast<Port *>( mImpl );
+    return ( port && port->opened ) ? port->rx->read_reserve( length ) : etl::span<uint8_t>();
+  }
+
+
+  int Driver::readConsume( const etl::span<uint8_t> &data )
+  {
+    auto port = static_cast<Port *>( mImpl );
+    if ( !port || !port->opened )
+    {
+      return -1;
+    }
+
+    port->rx->read_commit( data );
+    port->rxTaken += data.size();
+    resumeRX( *port );
+    return static_cast<int>( data.size() );
+  }
+
+
+  size_t Driver::rxLength()
+  {
+    auto port = static_cast<Port *>( mImpl );
+    return ( port && port->opened ) ? completed( *port ) : 0;
+  }
+
+
+  void Driver::getStats( Stats &stats )
+  {
+    auto port = static_cast<Port *>( mImpl );
+    if ( port )
+    {
+      port->stats.snapshot( stats );
+    }
+    else
+    {
+      memset( &stats, 0, sizeof( stats ) );
+    }
+  }
+
+
+  void Driver::resetStats()
+  {
+    if ( mImpl )
+    {
+      static_cast<Port *>( mImpl )->stats.reset();
+    }
+  }
+
+
+  Chimera::Status_t Driver::setBaud( const size_t baud )
+  {
+    return mImpl ? portSetBaud( *static_cast<Port *>( mImpl ), baud ) : Status::NOT_READY;
+  }
+
+
+  Chimera::Status_t Driver::autoBaud( const uint8_t sync )
+  {
+    ( void )sync;
+    return mImpl ? portAutoBaud( *static_cast<Port *>( mImpl ) ) : Status::NOT_READY;
+  }
+
+
+  size_t Driver::getBaud()
+  {
+    auto port = static_cast<Port *>( mImpl );
+    return ( port && port->opened ) ? port->baud.load() : 0;
+  }
+
+  /*---------------------------------------------------------------------------
+  Native Functions
+  ---------------------------------------------------------------------------*/
+  namespace Native
+  {
+    Chimera::Status_t setTransport( const Channel channel, const Transport transport )
+    {
+      if ( !isNativeChannel( channel ) || ( transport >= Transport::NUM_OPTIONS ) )
+      {
+        return Chimera::Status::INVAL_FUNC_PARAM;
+      }
+
+      if ( startIO() != Chimera::Status::OK )
+      {
+        return Chimera::Status::FAIL;
+      }
+
+      s_transport[ toIndex( channel ) ] = transport;
+      return Chimera::Status::OK;
+    }
+
+
+    Chimera::Status_t connect( const Channel a, const Channel b )
+    {
+      if ( !isNativeChannel( a ) || !isNativeChannel( b ) || ( a == b ) )
+      {
+        return Chimera::Status::INVAL_FUNC_PARAM;
+      }
+
+      Port *ports[ 2 ] = { &s_ports[ toIndex( a ) ], &s_ports[ toIndex( b ) ] };
+      std::scoped_lock lck( ports[ 0 ]->lock, ports[ 1 ]->lock );
+
+      if ( !ports[ 0 ]->opened || !ports[ 1 ]->opened || ports[ 0 ]->hangup || ports[ 1 ]->hangup )
+      {
+        return Status::NOT_READY;
+      }
+
+      int fds[ 2 ];
+      if ( socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds ) != 0 )
+      {
+        return Chimera::Status::FAIL;
+      }
+
+      /*-----------------------------------------------------------------------
+      Swap each channel over to its end of the new pair. The old links and
+      anything still in them are dropped. Buffered TX data carries on to the
+      other channel since the epoll interest is kept.
+      -----------------------------------------------------------------------*/
+      for ( size_t x = 0; x < ARRAY_COUNT( ports ); x++ )
+      {
+        Port &port = *ports[ x ];
+
+        fcntl( fds[ x ], F_SETFL, fcntl( fds[ x ], F_GETFL ) | O_NONBLOCK );
+        epoll_ctl( s_epoll, EPOLL_CTL_DEL, port.fd, nullptr );
+        ::close( port.fd );
+        ::close( port.peer );
+
+        port.fd        = fds[ x ];
+        port.peer      = -1;
+        port.transport = Transport::SOCKETPAIR;
+        port.link      = ports[ x ^ 1 ];
+        port.path[ 0 ] = '\0';
+
+        epoll_event event;
+        event.events   = port.interest;
+        event.data.ptr = &port;
+        epoll_ctl( s_epoll, EPOLL_CTL_ADD, port.fd, &event );
+      }
+
+      return Chimera::Status::OK;
+    }
+
+
+    int peerFd( const Channel channel )
+    {
+      if ( !isNativeChannel( channel ) )
+      {
+        return -1;
+      }
+
+      Port                       &port = s_ports[ toIndex( channel ) ];
+      std::lock_guard<std::mutex> lck( port.lock );
+      return port.opened ? port.peer : -1;
+    }
+
+
+    const char *devicePath( const Channel channel )
+    {
+      return isNativeChannel( channel ) ? s_ports[ toIndex( channel ) ].path : "";
+    }
+  }  // namespace Native
+}  // namespace Chimera::Serial
+
+
+namespace Chimera::USART
+{
+  using namespace Chimera::Serial;
+
+  /*---------------------------------------------------------------------------
+  Backend Registration
+  ---------------------------------------------------------------------------*/
+  namespace Backend
+  {
+    Chimera::Status_t registerDriver( Chimera::USART::Backend::DriverConfig &registry )
+    {
+      registry.isSupported    = true;
+      registry.initialize     = backendInitialize;
+      registry.reset          = backendReset;
+      registry.isChannelUSART = isNativeChannel;
+      registry.getDriver      = getUSARTDriver;
+      return Chimera::Status::OK;
+    }
+  }  // namespace Backend
+
+  /*---------------------------------------------------------------------------
+  Driver Implementation
+  ---------------------------------------------------------------------------*/
+  Driver::Driver() : mImpl( nullptr )
+  {
+  }
+
+
+  Driver::~Driver()
+  {
+  }
+
+
+  Chimera::Status_t Driver::open( const Chimera::Serial::Config &config )
+  {
+    const auto result = openPort( config, VIEW_USART );
+    if ( result == Chimera::Status::OK )
+    {
+      this->initAIO();
+      mImpl = &s_ports[ toIndex( config.channel ) ];
+    }
+
+    return result;
+  }
+
+
+  Chimera::Status_t Driver::close()
+  {
+    return mImpl ? closePort( *static_cast<Port *>( mImpl ) ) : Chimera::Status::OK;
+  }
+
+
+  int Driver::write( const void *const buffer, const size_t length )
+  {
+    return mImpl ? portWrite( *static_cast<Port *>( mImpl ), buffer, length, Chimera::Thread::TIMEOUT_DONT_WAIT ) : -1;
+  }
+
+
+  int Driver::read( void *const buffer, const size_t length )
+  {
+    return mImpl ? portRead( *static_cast<Port *>( mImpl ), buffer, length, Chimera::Thread::TIMEOUT_DONT_WAIT ) : -1;
+  }
+}  // namespace Chimera::USART
+
+
+namespace Chimera::UART
+{
+  using namespace Chimera::Serial;
+
+  /*---------------------------------------------------------------------------
+  Backend Registration
+  ---------------------------------------------------------------------------*/
+  namespace Backend
+  {
+    Chimera::Status_t registerDriver( Chimera::UART::Backend::DriverConfig &registry )
+    {
+      registry.isSupported   = true;
+      registry.initialize    = backendInitialize;
+      registry.reset         = backendReset;
+      registry.isChannelUART = isNativeChannel;
+      registry.getDriver     = getUARTDriver;
+      return Chimera::Status::OK;
+    }
+  }  // namespace Backend
+
+  /*---------------------------------------------------------------------------
+  Driver Implementation
+  ---------------------------------------------------------------------------*/
+  Driver::Driver() : mImpl( nullptr )
+  {
+  }
+
+
+  Driver::~Driver()
+  {
+  }
+
+
+  Chimera::Status_t Driver::open( const Chimera::Serial::Config &config )
+  {
+    const auto result = openPort( config, VIEW_UART );
+    if ( result == Chimera::Status::OK )
+    {
+      this->initAIO();
+      mImpl = &s_ports[ toIndex( config.channel ) ];
+    }
+
+    return result;
+  }
+
+
+  Chimera::Status_t Driver::close()
+  {
+    return mImpl ? closePort( *static_cast<Port *>( mImpl ) ) : Chimera::Status::OK;
+  }
+
+
+  int Driver::write( const void *const buffer, const size_t length )
+  {
+    return mImpl ? portWrite( *static_cast<Port *>( mImpl ), buffer, length, Chimera::Thread::TIMEOUT_DONT_WAIT ) : -1;
+  }
+
+
+  int Driver::read( void *const buffer, const size_t length )
+  {
+    return mImpl ? portRead( *static_cast<Port *>( mImpl ), buffer, length, Chimera::Thread::TIMEOUT_DONT_WAIT ) : -1;
+  }
+}  // namespace Chimera::UART
+
+#endif /* USING_NATIVE_THREADS && __linux__ */
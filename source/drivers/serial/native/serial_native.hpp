@@ -0,0 +1,115 @@
+/******************************************************************************
+ *  File Name:
+ *    serial_native.hpp
+ *
+ *  Description:
+ *    Host serial backend. Each channel is one end of a socketpair or the
+ *    master side of a pseudo-terminal.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_SERIAL_NATIVE_HPP
+#define CHIMERA_SERIAL_NATIVE_HPP
+
+#if defined( USING_NATIVE_THREADS ) && defined( __linux__ )
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/serial/serial_types.hpp>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Transport used by channels that weren't given one with setTransport()
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_SERIAL_NATIVE_TRANSPORT
+#define CHIMERA_SERIAL_NATIVE_TRANSPORT ( Chimera::Serial::Native::Transport::SOCKETPAIR )
+#endif
+
+/*-------------------------------------------------------------------
+Largest single read() or write() the IO thread issues on a channel
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_SERIAL_NATIVE_CHUNK
+#define CHIMERA_SERIAL_NATIVE_CHUNK ( 64 * 1024 )
+#endif
+
+namespace Chimera::Serial::Native
+{
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  enum class Transport : uint8_t
+  {
+    SOCKETPAIR, /**< AF_UNIX stream pair, fastest, peer is only reachable in process */
+    PTY,        /**< Pseudo-terminal, the slave path can be opened by other tools */
+
+    NUM_OPTIONS
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Selects the transport a channel uses the next time it is opened
+   *
+   *  @param[in]  channel     Channel to configure
+   *  @param[in]  transport   Transport to use
+   *  @return Chimera::Status_t
+   *
+   *  |   Return Value   |         Explanation         |
+   *  |:----------------:|:---------------------------:|
+   *  |               OK | Takes effect on next open() |
+   *  | INVAL_FUNC_PARAM | Bad channel or transport    |
+   */
+  Chimera::Status_t setTransport( const Channel channel, const Transport transport );
+
+  /**
+   *  Wires two open channels to each other, like crossing the TX and RX
+   *  lines of two UARTs. What one channel writes arrives in the other's
+   *  rxBuffer. Neither has a peerFd() afterwards. Re-opening either channel
+   *  breaks the connection.
+   *
+   *  @param[in]  a           First channel
+   *  @param[in]  b           Second channel
+   *  @return Chimera::Status_t
+   *
+   *  |   Return Value   |           Explanation           |
+   *  |:----------------:|:-------------------------------:|
+   *  |               OK | The channels are connected      |
+   *  |        NOT_READY | A channel isn't open            |
+   *  | INVAL_FUNC_PARAM | Bad channel, or the same one    |
+   *  |             FAIL | The socketpair couldn't be made |
+   */
+  Chimera::Status_t connect( const Channel a, const Channel b );
+
+  /**
+   *  File descriptor of the far end of an open channel. Whatever is written
+   *  to it arrives in the channel's rxBuffer, and whatever the driver writes
+   *  can be read from it. For a PTY this is the slave side. The descriptor is
+   *  blocking and owned by the backend; don't close it.
+   *
+   *  @param[in]  channel     Channel to query
+   *  @return int             -1 if the channel isn't open
+   */
+  int peerFd( const Channel channel );
+
+  /**
+   *  Path of the PTY slave, e.g. "/dev/pts/3", for attaching a terminal or
+   *  another process to the channel
+   *
+   *  @param[in]  channel     Channel to query
+   *  @return const char *    Empty if the channel isn't an open PTY
+   */
+  const char *devicePath( const Channel channel );
+
+}  // namespace Chimera::Serial::Native
+
+#endif /* USING_NATIVE_THREADS && __linux__ */
+#endif /* !CHIMERA_SERIAL_NATIVE_HPP */
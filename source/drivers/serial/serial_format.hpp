@@ -0,0 +1,786 @@
+/******************************************************************************
+ *  File Name:
+ *    serial_format.hpp
+ *
+ *  Description:
+ *    printf style output that formats straight into a serial port's TX
+ *    buffer. Format strings are parsed and type checked at compile time.
+ *    Formatting can also be deferred to the logger's drain task.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_SERIAL_FORMAT_HPP
+#define CHIMERA_SERIAL_FORMAT_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/log/log.hpp>
+#include <Chimera/source/drivers/serial/serial_types.hpp>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Most time the log drain task waits for TX room per deferred print
+(mS). Every record queued behind it waits too, other sinks included,
+so the default drops the print instead.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_SERIAL_FORMAT_DRAIN_TIMEOUT
+#define CHIMERA_SERIAL_FORMAT_DRAIN_TIMEOUT ( 0 )
+#endif
+
+/*-----------------------------------------------------------------------------
+Macros
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Formats directly into the driver's TX buffer. Evaluates to the number
+of bytes queued, or -1 if the output didn't fit before the timeout.
+
+  CHIMERA_SERIAL_PRINT( driver, "adc %u: %5d mV\r\n", channel, mv );
+
+Supported conversions are %d %i %u %x %X %o %c %s %p %f and %%, with
+the usual flags, width and precision. Length modifiers are accepted
+and ignored; the argument's type decides. '*' widths aren't
+supported. Mismatched arguments fail to compile.
+
+%f switches to exponent form once the whole part no longer fits in
+64 bits (about 1.8e19), so 1e300 prints as 1.000000e+300. Those
+digits can differ from printf's in the last place. Smaller values
+match printf exactly.
+
+Only one task may hold a TX reservation at a time, so lock the driver
+if several tasks transmit.
+-------------------------------------------------------------------*/
+#define CHIMERA_SERIAL_PRINT( driver, fmt, ... )                                                                                \
+  CHIMERA_SERIAL_PRINT_WAIT( driver, ::Chimera::Thread::TIMEOUT_DONT_WAIT, fmt, ##__VA_ARGS__ )
+
+#define CHIMERA_SERIAL_PRINT_WAIT( driver, timeout, fmt, ... )                                                                  \
+  ( [ & ]() -> int {                                                                                                           \
+    static constexpr auto chimera_serial_fmt__ =                                                                               \
+        ::Chimera::Serial::Format::compile<::Chimera::Serial::Format::Internal::countPieces( fmt )>( fmt );                    \
+    return ::Chimera::Serial::Format::print<chimera_serial_fmt__>( driver, timeout, ##__VA_ARGS__ );                           \
+  }() )
+
+/*-------------------------------------------------------------------
+Queues the raw arguments as a record in the deferred logger's queue.
+Its drain task, started by Chimera::Log::initialize(), formats them
+later and Chimera::Log::drain() flushes them along with the log
+statements. Evaluates to false if the queue was full. Safe from ISRs.
+
+The drain never waits for the driver. If another task holds its lock,
+the print is dropped and counted by Format::dropped(). The assert
+path's Chimera::Log::flush() discards deferred prints.
+
+%s arguments are recorded as pointers, so they must outlive the
+record. String literals are fine, stack buffers are not. The driver
+pointer and the arguments must fit in a record's words, see
+CHIMERA_LOG_MAX_WORDS.
+-------------------------------------------------------------------*/
+#define CHIMERA_SERIAL_DEFER( driver, fmt, ... )                                                                                \
+  ( [ & ]() -> bool {                                                                                                          \
+    static constexpr auto chimera_serial_fmt__ =                                                                               \
+        ::Chimera::Serial::Format::compile<::Chimera::Serial::Format::Internal::countPieces( fmt )>( fmt );                    \
+    static constexpr ::Chimera::Log::Descriptor chimera_serial_desc__{                                                         \
+      fmt, __SHORTFILE__, __LINE__, ::Chimera::Log::Level::LVL_INFO,                                                           \
+      decltype( ::Chimera::Serial::Format::Internal::consumerOf<chimera_serial_fmt__>( __VA_ARGS__ ) )::value                  \
+    };                                                                                                                         \
+    return ::Chimera::Serial::Format::defer<chimera_serial_fmt__, chimera_serial_desc__>( driver, ##__VA_ARGS__ );             \
+  }() )
+
+namespace Chimera::Serial::Format
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint8_t FLAG_LEFT  = 0x01; /**< '-' */
+  static constexpr uint8_t FLAG_ZERO  = 0x02; /**< '0' */
+  static constexpr uint8_t FLAG_PLUS  = 0x04; /**< '+' */
+  static constexpr uint8_t FLAG_SPACE = 0x08; /**< ' ' */
+  static constexpr uint8_t FLAG_ALT   = 0x10; /**< '#' */
+
+  static constexpr int8_t MAX_FLOAT_PRECISION = 9;
+
+  /*-------------------------------------------------------------------
+  Argument bytes a deferred print can carry. The driver pointer takes
+  the front of the log record.
+  -------------------------------------------------------------------*/
+  static constexpr size_t DEFER_ARG_BYTES = sizeof( Chimera::Log::Record::words ) - sizeof( Driver * );
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  A run of literal text followed by at most one conversion
+   */
+  struct Piece
+  {
+    const char *text;      /**< Literal text, pointing into the format string */
+    size_t      length;    /**< Bytes of literal text */
+    char        conv;      /**< Conversion character, or 0 for text only */
+    uint8_t     flags;     /**< FLAG_* bits */
+    uint8_t     width;     /**< Minimum field width */
+    int8_t      precision; /**< -1 if not given */
+  };
+
+  /**
+   *  A parsed format string. Built at compile time by compile().
+   *
+   *  @tparam N   Number of pieces, from Internal::countPieces()
+   */
+  template<size_t N>
+  struct Compiled
+  {
+    Piece  pieces[ N ];
+    size_t args;  /**< Conversions that take an argument */
+    size_t fixed; /**< Bytes of literal text */
+    bool   valid; /**< Every conversion was understood */
+  };
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Output cursor over a driver's TX buffer. Text lands in a writeReserve()
+   *  region and is committed in one go by finish(). When the region runs out
+   *  the part written so far is committed and another is reserved. With no
+   *  room at all, the driver's write() does the waiting.
+   */
+  class Writer
+  {
+  public:
+    /**
+     *  @param[in]  driver      Open serial driver
+     *  @param[in]  timeout     Most time to wait for TX room in milliseconds
+     *  @param[in]  hint        Expected output length, the size of the first reservation
+     */
+    Writer( Driver &driver, const size_t timeout, const size_t hint );
+
+    /**
+     *  Contiguous space for length bytes, to be followed by advance()
+     *
+     *  @param[in]  length      Bytes needed
+     *  @return char *          nullptr if that much isn't available without waiting
+     */
+    inline char *room( const size_t length )
+    {
+      return ( static_cast<size_t>( mEnd - mPos ) >= length ) ? mPos : refill( length );
+    }
+
+    /**
+     *  Marks bytes written through room() as used
+     *
+     *  @param[in]  length      Bytes written
+     *  @return void
+     */
+    inline void advance( const size_t length )
+    {
+      mPos += length;
+    }
+
+    /**
+     *  Appends bytes, waiting for room if allowed
+     *
+     *  @param[in]  data        Bytes to append
+     *  @param[in]  length      Number of bytes
+     *  @return void
+     */
+    inline void put( const char *const data, const size_t length )
+    {
+      if ( static_cast<size_t>( mEnd - mPos ) >= length )
+      {
+        memcpy( mPos, data, length );
+        mPos += length;
+      }
+      else
+      {
+        putSlow( data, length );
+      }
+    }
+
+    /**
+     *  Appends count copies of a character
+     *
+     *  @param[in]  c           Character to repeat
+     *  @param[in]  count       Number of copies
+     *  @return void
+     */
+    void fill( const char c, const size_t count );
+
+    /**
+     *  Commits whatever is still reserved
+     *
+     *  @return int             Bytes output in total, -1 if some didn't fit before the timeout
+     */
+    int finish();
+
+  private:
+    Driver *mDriver;
+    char   *mBase;    /**< Start of the uncommitted part of the reservation */
+    char   *mPos;     /**< Next byte to write */
+    char   *mEnd;     /**< End of the reservation */
+    size_t  mHint;
+    size_t  mTimeout;
+    size_t  mStart;   /**< When the first wait for room began */
+    size_t  mWritten; /**< Bytes committed or written so far */
+    bool    mWaited;
+    bool    mFailed;
+
+    char *refill( const size_t length );
+    void  commit();
+    void  putSlow( const char *data, size_t length );
+  };
+
+  /*---------------------------------------------------------------------------
+  Internal Helpers
+  ---------------------------------------------------------------------------*/
+  namespace Internal
+  {
+    /**
+     *  Pieces a format string parses into. "%%" ends a piece without a
+     *  conversion, and the text after the last conversion is a piece too.
+     */
+    constexpr size_t countPieces( const char *fmt )
+    {
+      size_t count = 1;
+      while ( *fmt )
+      {
+        if ( *fmt == '%' )
+        {
+          count++;
+          fmt++;
+          if ( !*fmt )
+          {
+            break;
+          }
+        }
+
+        fmt++;
+      }
+
+      return count;
+    }
+
+    constexpr bool isFlag( const char c )
+    {
+      return ( c == '-' ) || ( c == '0' ) || ( c == '+' ) || ( c == ' ' ) || ( c == '#' );
+    }
+
+    constexpr bool isLengthModifier( const char c )
+    {
+      return ( c == 'h' ) || ( c == 'l' ) || ( c == 'j' ) || ( c == 'z' ) || ( c == 't' ) || ( c == 'L' );
+    }
+
+    constexpr bool isInteger( const char conv )
+    {
+      return ( conv == 'd' ) || ( conv == 'i' ) || ( conv == 'u' ) || ( conv == 'x' ) || ( conv == 'X' ) || ( conv == 'o' );
+    }
+
+    constexpr bool isSupported( const char conv )
+    {
+      return isInteger( conv ) || ( conv == 'c' ) || ( conv == 's' ) || ( conv == 'p' ) || ( conv == 'f' );
+    }
+
+    /**
+     *  Whether an argument of type T can be printed by a conversion
+     */
+    template<typename T>
+    constexpr bool accepts( const char conv )
+    {
+      using D = std::decay_t<T>;
+
+      if ( isInteger( conv ) || ( conv == 'c' ) )
+      {
+        return std::is_integral_v<D> || std::is_enum_v<D>;
+      }
+      else if ( conv == 'f' )
+      {
+        return std::is_arithmetic_v<D>;
+      }
+      else if ( conv == 's' )
+      {
+        return std::is_pointer_v<D> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<D>>, char>;
+      }
+      else if ( conv == 'p' )
+      {
+        return std::is_pointer_v<D> || std::is_null_pointer_v<D>;
+      }
+
+      return false;
+    }
+
+    /**
+     *  Conversion character of the arg'th argument
+     */
+    template<size_t N>
+    constexpr char argConv( const Compiled<N> &format, const size_t arg )
+    {
+      size_t count = 0;
+      for ( size_t x = 0; x < N; x++ )
+      {
+        if ( format.pieces[ x ].conv && ( count++ == arg ) )
+        {
+          return format.pieces[ x ].conv;
+        }
+      }
+
+      return 0;
+    }
+
+    template<const auto &F, typename... Args, size_t... I>
+    constexpr bool matches( std::index_sequence<I...> )
+    {
+      return ( accepts<Args>( argConv( F, I ) ) && ... && true );
+    }
+
+    /**
+     *  Upper bound on the text from one argument. Strings are unknown until
+     *  runtime, so they count for their field width plus a guess.
+     */
+    template<typename T>
+    constexpr size_t argBound( const char conv, const Piece &piece )
+    {
+      using D = std::decay_t<T>;
+
+      size_t bound = 1;
+      if ( isInteger( conv ) )
+      {
+        bound = ( sizeof( D ) > sizeof( uint32_t ) ) ? 24 : 13;
+        if ( piece.precision > 0 )
+        {
+          bound += static_cast<size_t>( piece.precision );
+        }
+      }
+      else if ( conv == 'f' )
+      {
+        bound = 24 + static_cast<size_t>( ( piece.precision < 0 ) ? 6 : piece.precision );
+      }
+      else if ( conv == 's' )
+      {
+        bound = 16;
+      }
+      else if ( conv == 'p' )
+      {
+        bound = 2 + 2 * sizeof( uintptr_t );
+      }
+
+      return ( bound > piece.width ) ? bound : piece.width;
+    }
+
+    template<size_t N>
+    constexpr const Piece &argPiece( const Compiled<N> &format, const size_t arg )
+    {
+      size_t count = 0;
+      for ( size_t x = 0; x < N; x++ )
+      {
+        if ( format.pieces[ x ].conv && ( count++ == arg ) )
+        {
+          return format.pieces[ x ];
+        }
+      }
+
+      return format.pieces[ N - 1 ];
+    }
+
+    template<const auto &F, typename... Args, size_t... I>
+    constexpr size_t bound( std::index_sequence<I...> )
+    {
+      return F.fixed + ( argBound<Args>( argConv( F, I ), argPiece( F, I ) ) + ... + 0 );
+    }
+
+    /*-------------------------------------------------------------------------
+    Conversions, implemented in the source file so each call site only pays
+    for a call
+    -------------------------------------------------------------------------*/
+    void putSigned( Writer &out, const Piece &piece, const int32_t value );
+    void putSigned( Writer &out, const Piece &piece, const int64_t value );
+    void putUnsigned( Writer &out, const Piece &piece, const uint32_t value );
+    void putUnsigned( Writer &out, const Piece &piece, const uint64_t value );
+    void putFloat( Writer &out, const Piece &piece, const double value );
+    void putChar( Writer &out, const Piece &piece, const char value );
+    void putString( Writer &out, const Piece &piece, const char *const value );
+    void putPointer( Writer &out, const Piece &piece, const void *const value );
+
+    /**
+     *  Integer type an argument is read as
+     */
+    template<typename T, typename = void>
+    struct IntegerOf
+    {
+      using type = T;
+    };
+
+    template<typename T>
+    struct IntegerOf<T, std::enable_if_t<std::is_enum_v<T>>>
+    {
+      using type = std::underlying_type_t<T>;
+    };
+
+    /**
+     *  Formats one argument with a conversion known at compile time
+     */
+    template<char C, typename T>
+    inline void convert( Writer &out, const Piece &piece, const T &arg )
+    {
+      using D = std::decay_t<T>;
+
+      if constexpr ( C == 'c' )
+      {
+        putChar( out, piece, static_cast<char>( arg ) );
+      }
+      else if constexpr ( C == 's' )
+      {
+        putString( out, piece, static_cast<const char *>( arg ) );
+      }
+      else if constexpr ( C == 'p' )
+      {
+        putPointer( out, piece, static_cast<const void *>( arg ) );
+      }
+      else if constexpr ( C == 'f' )
+      {
+        putFloat( out, piece, static_cast<double>( arg ) );
+      }
+      else if constexpr ( sizeof( D ) > sizeof( uint32_t ) )
+      {
+        if constexpr ( ( C == 'd' ) || ( C == 'i' ) )
+        {
+          putSigned( out, piece, static_cast<int64_t>( arg ) );
+        }
+        else
+        {
+          putUnsigned( out, piece, static_cast<uint64_t>( arg ) );
+        }
+      }
+      else
+      {
+        /*---------------------------------------------------------------------
+        Like printf, small types are promoted to int and then the conversion
+        decides how the bits are read. A negative int printed with %u shows
+        as its unsigned value.
+        ---------------------------------------------------------------------*/
+        using B = decltype( +std::declval<typename IntegerOf<D>::type>() );
+
+        if constexpr ( ( C == 'd' ) || ( C == 'i' ) )
+        {
+          putSigned( out, piece, static_cast<int32_t>( static_cast<std::make_signed_t<B>>( arg ) ) );
+        }
+        else
+        {
+          putUnsigned( out, piece, static_cast<uint32_t>( static_cast<std::make_unsigned_t<B>>( arg ) ) );
+        }
+      }
+    }
+
+    /**
+     *  Walks the pieces at compile time, pairing each conversion with the
+     *  next argument
+     */
+    template<const auto &F, size_t I>
+    inline void emit( Writer &out )
+    {
+      constexpr size_t N = sizeof( F.pieces ) / sizeof( F.pieces[ 0 ] );
+
+      if constexpr ( F.pieces[ I ].length != 0 )
+      {
+        out.put( F.pieces[ I ].text, F.pieces[ I ].length );
+      }
+
+      if constexpr ( ( I + 1 ) < N )
+      {
+        emit<F, I + 1>( out );
+      }
+    }
+
+    template<const auto &F, size_t I, typename T, typename... Rest>
+    inline void emit( Writer &out, const T &arg, const Rest &...rest )
+    {
+      if constexpr ( F.pieces[ I ].length != 0 )
+      {
+        out.put( F.pieces[ I ].text, F.pieces[ I ].length );
+      }
+
+      if constexpr ( F.pieces[ I ].conv == 0 )
+      {
+        emit<F, I + 1>( out, arg, rest... );
+      }
+      else
+      {
+        convert<F.pieces[ I ].conv>( out, F.pieces[ I ], arg );
+        emit<F, I + 1>( out, rest... );
+      }
+    }
+
+    /**
+     *  Where each deferred argument lives after the driver pointer
+     */
+    template<typename... D>
+    constexpr size_t offsetOf( const size_t arg )
+    {
+      constexpr size_t sizes[] = { 0, sizeof( D )... };
+
+      size_t offset = 0;
+      for ( size_t x = 0; x < arg; x++ )
+      {
+        offset += sizes[ x + 1 ];
+      }
+
+      return offset;
+    }
+
+    /**
+     *  How a deferred argument is kept. Arrays, i.e. string literals, become
+     *  pointers to const.
+     */
+    template<typename T>
+    using Stored = std::decay_t<const T>;
+
+    template<typename T>
+    inline void store( uint8_t *const data, size_t &offset, const T value )
+    {
+      memcpy( data + offset, &value, sizeof( T ) );
+      offset += sizeof( T );
+    }
+
+    template<typename T>
+    inline T load( const uint8_t *const data )
+    {
+      T value;
+      memcpy( &value, data, sizeof( T ) );
+      return value;
+    }
+
+    /**
+     *  Rebuilds a deferred print's arguments and formats them
+     */
+    template<const auto &F, typename... D, size_t... I>
+    inline int replay( Driver &driver, const size_t timeout, const uint8_t *const args, std::index_sequence<I...> )
+    {
+      const std::tuple<D...> values{ load<D>( args + offsetOf<D...>( I ) )... };
+      ( void )args;
+
+      Writer out( driver, timeout, bound<F, D...>( std::index_sequence<I...>{} ) );
+      emit<F, 0>( out, std::get<I>( values )... );
+      return out.finish();
+    }
+
+    template<const auto &F, typename... D>
+    int render( Driver &driver, const size_t timeout, const uint8_t *const args )
+    {
+      return replay<F, D...>( driver, timeout, args, std::index_sequence_for<D...>{} );
+    }
+
+    /**
+     *  Writes out a deferred print on the log drain task if its driver's
+     *  lock is free
+     *
+     *  @param[in]  record      Record queued by defer()
+     *  @param[in]  render      Formats the arguments with the call site's format
+     *  @return void
+     */
+    void playback( const Chimera::Log::Record &record, int ( *render )( Driver &, const size_t, const uint8_t *const ) );
+
+    template<const auto &F, typename... D>
+    void consume( const Chimera::Log::Record &record )
+    {
+      playback( record, render<F, D...> );
+    }
+
+    /**
+     *  Only ever used inside decltype() to name a call site's consumer
+     */
+    template<const auto &F, typename... Args>
+    std::integral_constant<Chimera::Log::Consumer, &consume<F, Stored<Args>...>> consumerOf( const Args &... );
+
+    /**
+     *  Queues a deferred print in the log queue
+     */
+    bool enqueue( const Chimera::Log::Record &record );
+  }  // namespace Internal
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Parses a format string. Use the CHIMERA_SERIAL_* macros, which do this
+   *  at compile time.
+   *
+   *  @param[in]  fmt         printf style format string
+   *  @return Compiled<N>
+   */
+  template<size_t N>
+  constexpr Compiled<N> compile( const char *fmt )
+  {
+    Compiled<N> out{};
+    out.valid = true;
+
+    for ( size_t x = 0; x < N; x++ )
+    {
+      Piece &piece = out.pieces[ x ];
+
+      piece.text      = fmt;
+      piece.precision = -1;
+      while ( *fmt && ( *fmt != '%' ) )
+      {
+        fmt++;
+      }
+
+      piece.length = static_cast<size_t>( fmt - piece.text );
+      if ( !*fmt )
+      {
+        out.fixed += piece.length;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      "%%" keeps the first percent as text and skips the second
+      -----------------------------------------------------------------------*/
+      fmt++;
+      if ( *fmt == '%' )
+      {
+        piece.length++;
+        out.fixed += piece.length;
+        fmt++;
+        continue;
+      }
+
+      out.fixed += piece.length;
+
+      /*-----------------------------------------------------------------------
+      Flags, width, precision and ignored length modifiers
+      -----------------------------------------------------------------------*/
+      while ( Internal::isFlag( *fmt ) )
+      {
+        piece.flags |= ( *fmt == '-' )   ? FLAG_LEFT
+                       : ( *fmt == '0' ) ? FLAG_ZERO
+                       : ( *fmt == '+' ) ? FLAG_PLUS
+                       : ( *fmt == ' ' ) ? FLAG_SPACE
+                                         : FLAG_ALT;
+        fmt++;
+      }
+
+      size_t width = 0;
+      while ( ( *fmt >= '0' ) && ( *fmt <= '9' ) )
+      {
+        width = ( width * 10 ) + static_cast<size_t>( *fmt++ - '0' );
+        out.valid &= ( width <= UINT8_MAX );
+      }
+      piece.width = static_cast<uint8_t>( width );
+
+      if ( *fmt == '.' )
+      {
+        size_t precision = 0;
+        fmt++;
+        while ( ( *fmt >= '0' ) && ( *fmt <= '9' ) )
+        {
+          precision = ( precision * 10 ) + static_cast<size_t>( *fmt++ - '0' );
+          out.valid &= ( precision <= INT8_MAX );
+        }
+        piece.precision = static_cast<int8_t>( precision );
+      }
+
+      while ( Internal::isLengthModifier( *fmt ) )
+      {
+        fmt++;
+      }
+
+      /*-----------------------------------------------------------------------
+      The conversion itself
+      -----------------------------------------------------------------------*/
+      piece.conv = *fmt;
+      out.valid &= Internal::isSupported( piece.conv );
+      if ( piece.conv == 'f' )
+      {
+        out.valid &= ( piece.precision <= MAX_FLOAT_PRECISION );
+      }
+
+      if ( *fmt )
+      {
+        fmt++;
+        out.args++;
+      }
+    }
+
+    return out;
+  }
+
+
+  /**
+   *  Formats straight into a driver's TX buffer. Use CHIMERA_SERIAL_PRINT,
+   *  which supplies the compiled format.
+   *
+   *  @param[in]  driver      Open serial driver
+   *  @param[in]  timeout     Most time to wait for TX room in milliseconds
+   *  @param[in]  args        Arguments matching the format string
+   *  @return int             Bytes queued, -1 if some didn't fit before the timeout
+   */
+  template<const auto &F, typename... Args>
+  inline int print( Driver &driver, const size_t timeout, const Args &...args )
+  {
+    static_assert( F.valid, "Unsupported conversion in serial format string" );
+    static_assert( F.args == sizeof...( Args ), "Serial format specifiers don't match the argument count" );
+    static_assert( Internal::matches<F, Args...>( std::index_sequence_for<Args...>{} ),
+                   "Serial format argument doesn't suit its conversion" );
+
+    Writer out( driver, timeout, Internal::bound<F, Args...>( std::index_sequence_for<Args...>{} ) );
+    Internal::emit<F, 0>( out, args... );
+    return out.finish();
+  }
+
+
+  /**
+   *  Records the arguments of a print for the log drain task. Use
+   *  CHIMERA_SERIAL_DEFER, which supplies the compiled format and the
+   *  descriptor naming its consumer.
+   *
+   *  @param[in]  driver      Open serial driver
+   *  @param[in]  args        Arguments matching the format string
+   *  @return bool            False if the queue was full and the print dropped
+   */
+  template<const auto &F, const Chimera::Log::Descriptor &Desc, typename... Args>
+  inline bool defer( Driver &driver, const Args &...args )
+  {
+    static_assert( F.valid, "Unsupported conversion in serial format string" );
+    static_assert( F.args == sizeof...( Args ), "Serial format specifiers don't match the argument count" );
+    static_assert( Internal::matches<F, Args...>( std::index_sequence_for<Args...>{} ),
+                   "Serial format argument doesn't suit its conversion" );
+    static_assert( ( sizeof( Internal::Stored<Args> ) + ... + 0 ) <= DEFER_ARG_BYTES,
+                   "Deferred arguments don't fit a log record, see CHIMERA_LOG_MAX_WORDS" );
+    static_assert( ( std::is_trivially_copyable_v<Internal::Stored<Args>> && ... && true ),
+                   "Deferred arguments must be trivially copyable" );
+    static_assert( Desc.consumer == &Internal::consume<F, Internal::Stored<Args>...>,
+                   "Descriptor doesn't belong to this print" );
+
+    Chimera::Log::Record record;
+    record.desc      = &Desc;
+    record.timestamp = static_cast<uint32_t>( Chimera::micros() );
+    record.types     = 0;
+
+    uint8_t *const data   = reinterpret_cast<uint8_t *>( record.words );
+    size_t         offset = 0;
+    Internal::store<Driver *>( data, offset, &driver );
+    ( Internal::store<Internal::Stored<Args>>( data, offset, args ), ... );
+
+    return Internal::enqueue( record );
+  }
+
+  /**
+   *  Deferred prints lost because the queue was full, the driver was
+   *  locked, or the port stayed busy past CHIMERA_SERIAL_FORMAT_DRAIN_TIMEOUT.
+   *  A full queue counts toward Chimera::Log::dropped() too.
+   *
+   *  @return size_t
+   */
+  size_t dropped();
+
+}  // namespace Chimera::Serial::Format
+
+#endif /* !CHIMERA_SERIAL_FORMAT_HPP */
@@ -0,0 +1,278 @@
+/******************************************************************************
+ *  File Name:
+ *    serial_framing.hpp
+ *
+ *  Description:
+ *    Packet framing on top of a serial byte stream. COBS, SLIP and HDLC-style
+ *    byte stuffing, each with an optional CRC trailer.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_SERIAL_FRAMING_HPP
+#define CHIMERA_SERIAL_FRAMING_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+/* ETL Includes */
+#include <etl/span.h>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/serial/serial_types.hpp>
+
+namespace Chimera::Serial::Framing
+{
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  enum class Protocol : uint8_t
+  {
+    COBS, /**< Consistent overhead byte stuffing, 0x00 terminates each frame */
+    SLIP, /**< RFC 1055, 0xC0 before and after each frame */
+    HDLC, /**< RFC 1662 async framing, 0x7E before and after each frame */
+
+    NUM_OPTIONS
+  };
+
+  enum class Check : uint8_t
+  {
+    NONE,
+    CRC16, /**< CRC-16/X.25, the HDLC FCS. Appended LSB first. */
+    CRC32, /**< CRC-32 as used by Ethernet and zlib. Appended LSB first. */
+
+    NUM_OPTIONS
+  };
+
+  enum class Result : uint8_t
+  {
+    NEED_MORE,    /**< Input ran out before the end of a frame */
+    FRAME,        /**< A frame passed its check and is in frame() */
+    OVERFLOW,     /**< A frame was larger than the buffer and was dropped */
+    CHECK_FAILED, /**< A frame failed its CRC and was dropped */
+    INVALID,      /**< A frame had bad stuffing or was aborted and was dropped */
+  };
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Incremental encoder. The output can be supplied in pieces of any size,
+   *  so frames go straight into bip buffer reservations that wrap. Runs of
+   *  bytes that need no stuffing are located a word (or vector) at a time
+   *  and copied in bulk.
+   */
+  class Encoder
+  {
+  public:
+    Encoder( const Protocol protocol, const Check check );
+
+    /**
+     *  Starts a new frame, abandoning any unfinished one
+     *
+     *  @param[in]  payload     Frame contents, which must stay valid until done()
+     *  @param[in]  length      Bytes in the payload
+     *  @return void
+     */
+    void begin( const void *const payload, const size_t length );
+
+    /**
+     *  Produces as much of the encoded frame as fits
+     *
+     *  @param[out] out         Where to put the encoded bytes
+     *  @param[in]  size        Room in out
+     *  @return size_t          Bytes written to out
+     */
+    size_t encode( uint8_t *const out, const size_t size );
+
+    /**
+     *  @return bool            True once the whole frame, delimiters included, was produced
+     */
+    bool done() const;
+
+    /**
+     *  @return size_t          Upper bound on the encoded bytes still to come
+     */
+    size_t remaining() const;
+
+  private:
+    enum class Phase : uint8_t
+    {
+      OPEN,
+      BODY,
+      CLOSE,
+      DONE
+    };
+
+    Protocol       mProtocol;
+    Check          mCheck;
+    Phase          mPhase;
+    const uint8_t *mPayload;
+    size_t         mLength;
+    size_t         mTotal;       /**< Payload plus trailer */
+    size_t         mPos;         /**< Next input byte */
+    size_t         mRun;         /**< COBS bytes left in the current block */
+    uint8_t        mTrailer[ 4 ];
+    uint8_t        mPending;     /**< Byte owed to the output */
+    bool           mHasPending;
+    bool           mBlockOpen;   /**< COBS code byte went out, block bytes may follow */
+    bool           mSkipZero;    /**< COBS block ends on a real zero */
+    bool           mLastBlock;   /**< COBS block is the end of the input */
+
+    const uint8_t *at( const size_t pos, size_t &contiguous ) const;
+    size_t         nonZeroRun( const size_t limit ) const;
+    size_t         encodeCOBS( uint8_t *const out, const size_t size );
+    size_t         encodeStuffed( uint8_t *const out, const size_t size );
+  };
+
+
+  /**
+   *  Incremental decoder. Feed it whatever arrived; it stops at the end of
+   *  each frame so the caller can consume exactly what was used. Frames that
+   *  fail are dropped whole and decoding resynchronizes on the next delimiter.
+   */
+  class Decoder
+  {
+  public:
+    /**
+     *  @param[in]  protocol    Framing in use
+     *  @param[in]  check       Trailer to verify and strip
+     *  @param[in]  buffer      Storage for one decoded frame, trailer included
+     *  @param[in]  size        Bytes in the storage
+     */
+    Decoder( const Protocol protocol, const Check check, uint8_t *const buffer, const size_t size );
+
+    /**
+     *  Decodes until a frame ends or the input runs out
+     *
+     *  @param[in]  data        Received bytes
+     *  @param[in]  length      Number of received bytes
+     *  @param[out] consumed    How many of them were used
+     *  @return Result
+     */
+    Result decode( const uint8_t *const data, const size_t length, size_t &consumed );
+
+    /**
+     *  Payload of the last FRAME result, valid until the next decode()
+     *
+     *  @return etl::span<uint8_t>
+     */
+    etl::span<uint8_t> frame() const;
+
+    /**
+     *  Drops any partial frame
+     *
+     *  @return void
+     */
+    void reset();
+
+  private:
+    Protocol mProtocol;
+    Check    mCheck;
+    uint8_t *mBuffer;
+    size_t   mSize;
+    size_t   mLength;
+    size_t   mReady;       /**< Payload bytes of the completed frame */
+    size_t   mBlock;       /**< COBS bytes left in the current block */
+    Result   mError;       /**< Failure to report when the frame ends */
+    bool     mStarted;     /**< Something other than a delimiter arrived */
+    bool     mPendingZero; /**< COBS zero owed if another block follows */
+    bool     mEscape;      /**< Previous byte was an escape */
+
+    void   append( const uint8_t *const data, const size_t length );
+    Result finish();
+    Result decodeCOBS( const uint8_t *const data, const size_t length, size_t &consumed );
+    Result decodeStuffed( const uint8_t *const data, const size_t length, size_t &consumed );
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Worst case encoded size of a frame, delimiters and trailer included
+   *
+   *  @param[in]  protocol    Framing in use
+   *  @param[in]  check       Trailer in use
+   *  @param[in]  length      Payload bytes
+   *  @return size_t
+   */
+  size_t maxEncodedSize( const Protocol protocol, const Check check, const size_t length );
+
+  /**
+   *  Encodes a whole frame into a flat buffer
+   *
+   *  @param[in]  protocol    Framing to use
+   *  @param[in]  check       Trailer to append
+   *  @param[in]  payload     Frame contents
+   *  @param[in]  length      Bytes in the payload
+   *  @param[out] out         Where to put the frame
+   *  @param[in]  size        Room in out
+   *  @return size_t          Encoded length, or 0 if it didn't fit
+   */
+  size_t encode( const Protocol protocol, const Check check, const void *const payload, const size_t length,
+                 uint8_t *const out, const size_t size );
+
+  /**
+   *  Encodes a frame directly into the driver's TX buffer. When it is full,
+   *  the driver's write() does the waiting. A frame cut short by the timeout
+   *  is discarded by the receiver at the next delimiter. Hold the driver lock
+   *  if several tasks transmit.
+   *
+   *  @param[in]  driver      Open serial driver
+   *  @param[in]  encoder     Encoder configured for the link
+   *  @param[in]  payload     Frame contents
+   *  @param[in]  length      Bytes in the payload
+   *  @param[in]  timeout     Most time to wait for TX room in milliseconds
+   *  @return int             Payload bytes sent, negative on timeout
+   */
+  int writeFrame( Driver &driver, Encoder &encoder, const void *const payload, const size_t length,
+                  const size_t timeout );
+
+  /**
+   *  Decodes directly out of the driver's RX buffer until a frame ends or the
+   *  timeout expires. Raw bytes are only copied out, one at a time, while
+   *  waiting in the driver's read() for more to arrive.
+   *
+   *  @param[in]  driver      Open serial driver
+   *  @param[in]  decoder     Decoder configured for the link
+   *  @param[in]  timeout     Most time to wait for data in milliseconds
+   *  @return Result          NEED_MORE if the timeout expired mid-frame
+   */
+  Result readFrame( Driver &driver, Decoder &decoder, const size_t timeout );
+
+  /**
+   *  CRC-16/X.25 of a buffer: reflected 0x1021, init and final XOR 0xFFFF
+   *
+   *  @param[in]  data        Bytes to check
+   *  @param[in]  length      Number of bytes
+   *  @return uint16_t
+   */
+  uint16_t crc16( const void *const data, const size_t length );
+
+  /**
+   *  CRC-32 of a buffer: reflected 0x04C11DB7, init and final XOR 0xFFFFFFFF
+   *
+   *  @param[in]  data        Bytes to check
+   *  @param[in]  length      Number of bytes
+   *  @return uint32_t
+   */
+  uint32_t crc32( const void *const data, const size_t length );
+
+  /**
+   *  Offset of the first byte equal to a or b, compared a vector or machine
+   *  word at a time
+   *
+   *  @param[in]  data        Bytes to search
+   *  @param[in]  length      Number of bytes
+   *  @param[in]  a           First value to find
+   *  @param[in]  b           Second value to find, pass a again for one
+   *  @return size_t          length if neither was found
+   */
+  size_t findAny( const uint8_t *const data, const size_t length, const uint8_t a, const uint8_t b );
+
+}  // namespace Chimera::Serial::Framing
+
+#endif /* !CHIMERA_SERIAL_FRAMING_HPP */
@@ -18,8 +18,10 @@ Includes
 #include <Chimera/callback>
 #include <Chimera/common>
 #include <Chimera/event>
+#include <Chimera/source/drivers/serial/serial_stats.hpp>
 #include <Chimera/source/drivers/serial/serial_types.hpp>
 #include <cstdint>
+#include <etl/span.h>
 
 namespace Chimera::Serial
 {
@@ -75,7 +77,11 @@ namespace Chimera::Serial
     /**
      * @brief Read a number of bytes from the wire
      *
-     * This will read from internal IO buffers.
+     * This will read from internal IO buffers. In RX_IDLE_LINE mode the read
+     * completes at the end of a packet, and in RX_CHAR_MATCH mode at the first
+     * match character, which is included. A packet longer than the buffer is
+     * returned over several reads. If no packet completes before the timeout,
+     * nothing is returned and the partial packet stays buffered.
      *
      * @param buffer  Buffer to read into
      * @param length  Number of bytes to read
@@ -83,6 +89,131 @@ namespace Chimera::Serial
      * @return int    Number of bytes actually read, negative on error
      */
     virtual int read( void *const buffer, const size_t length, const size_t timeout ) = 0;
+
+    /**
+     * @brief Writes several buffers onto the wire as one transfer
+     *
+     * Useful for a header, payload and CRC that live apart. The segments go
+     * out back to back with a single lock and a single kick of the hardware,
+     * instead of one per write() or a staging copy by the caller.
+     *
+     * @param segments  Buffers to send, in order. Empty ones are skipped.
+     * @param timeout   Total time the transaction may take to occur in milliseconds
+     * @return int      Number of bytes actually written, negative on error
+     */
+    virtual int writev( const etl::span<const ConstIOVec> &segments, const size_t timeout ) = 0;
+
+    /**
+     * @brief Reads from the wire into several buffers as one transfer
+     *
+     * Completes the same way read() would for the combined length, filling
+     * the segments in order.
+     *
+     * @param segments  Buffers to fill, in order. Empty ones are skipped.
+     * @param timeout   Total time the transaction may take to occur in milliseconds
+     * @return int      Number of bytes actually read, negative on error
+     */
+    virtual int readv( const etl::span<const IOVec> &segments, const size_t timeout ) = 0;
+
+    /**
+     * @brief Reserves space in the TX bip buffer to serialize into directly
+     *
+     * The region is always contiguous, so it may be smaller than requested
+     * when the free space wraps around the end of the buffer. Nothing goes
+     * out on the wire until writeCommit(). Only one reservation may be
+     * outstanding at a time; hold the driver lock if several tasks transmit.
+     *
+     * @param length  Most bytes wanted
+     * @return etl::span<uint8_t>  Writable region, empty if the buffer is full
+     */
+    virtual etl::span<uint8_t> writeReserve( const size_t length ) = 0;
+
+    /**
+     * @brief Queues a reserved region for transmission
+     *
+     * @param data    Span from writeReserve(), or a prefix of it if fewer bytes were used
+     * @return int    Number of bytes committed, negative on error
+     */
+    virtual int writeCommit( const etl::span<uint8_t> &data ) = 0;
+
+    /**
+     * @brief Exposes received data in place, without copying it out
+     *
+     * Like writeReserve(), only the contiguous part of the data is returned.
+     * Call again after readConsume() to get the remainder once it wraps.
+     *
+     * @param length  Most bytes wanted
+     * @return etl::span<uint8_t>  Received bytes, empty if there are none
+     */
+    virtual etl::span<uint8_t> readPeek( const size_t length ) = 0;
+
+    /**
+     * @brief Releases bytes returned by readPeek() back to the RX buffer
+     *
+     * @param data    Span from readPeek(), or a prefix of it if fewer bytes were parsed
+     * @return int    Number of bytes released, negative on error
+     */
+    virtual int readConsume( const etl::span<uint8_t> &data ) = 0;
+
+    /**
+     * @brief Number of received bytes ready to be read
+     *
+     * In RX_IDLE_LINE and RX_CHAR_MATCH modes this only counts bytes up to the
+     * most recent packet boundary, so after TRIGGER_READ_COMPLETE it gives the
+     * length of the packet(s) that completed. A partial packet still arriving
+     * is not included. In RX_LENGTH mode it is everything in the rxBuffer.
+     *
+     * @return size_t
+     */
+    virtual size_t rxLength() = 0;
+
+    /**
+     * @brief Copies out the channel's traffic and error counters
+     *
+     * Safe to call from any task while the port runs. The counters survive
+     * close() and open(), and only resetStats() clears them. Fields the
+     * hardware can't detect stay at zero.
+     *
+     * @param stats   Receives the snapshot
+     */
+    virtual void getStats( Stats &stats ) = 0;
+
+    /**
+     * @brief Zeroes the channel's counters, including the RX high water mark
+     */
+    virtual void resetStats() = 0;
+
+    /**
+     * @brief Changes the line speed of an open port
+     *
+     * Only the clock divider is retuned. Both buffers and everything in them
+     * are kept. A character already on the wire finishes at the old rate and
+     * the rest of the txBuffer goes out at the new one. Both ends have to
+     * switch, so agree on the change over the link first.
+     *
+     * @param baud    New rate in bps. Need not be one of BaudRate.
+     * @return Chimera::Status_t
+     */
+    virtual Chimera::Status_t setBaud( const size_t baud ) = 0;
+
+    /**
+     * @brief Detects the line speed from the next character received
+     *
+     * Returns straight away. The far end then sends the sync character, the
+     * port times it and switches to the closestBaudRate() of what it
+     * measured. The sync character is delivered like any other, so discard
+     * it. getBaud() shows the result once it has arrived.
+     *
+     * @param sync    Character the far end will send, e.g. 0x55 or 0x7F
+     * @return Chimera::Status_t
+     */
+    virtual Chimera::Status_t autoBaud( const uint8_t sync ) = 0;
+
+    /**
+     * @brief Current line speed
+     * @return size_t   Rate in bps, zero if the port isn't open
+     */
+    virtual size_t getBaud() = 0;
   };
 
   /**
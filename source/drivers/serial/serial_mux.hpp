@@ -0,0 +1,232 @@
+/******************************************************************************
+ *  File Name:
+ *    serial_mux.hpp
+ *
+ *  Description:
+ *    Virtual serial channels multiplexed over one physical link. Each channel
+ *    is a full HWInterface with its own buffers, priority and share of the
+ *    bandwidth, and credit based flow control towards the far end.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_SERIAL_MUX_HPP
+#define CHIMERA_SERIAL_MUX_HPP
+
+/* STL Includes */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/* ETL Includes */
+#include <etl/span.h>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/thread>
+#include <Chimera/source/drivers/serial/serial_framing.hpp>
+#include <Chimera/source/drivers/serial/serial_intf.hpp>
+#include <Chimera/source/drivers/serial/serial_stats.hpp>
+#include <Chimera/source/drivers/serial/serial_types.hpp>
+#include <Chimera/source/drivers/serial/serial_user.hpp>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Virtual channels carried by one link
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_SERIAL_MUX_CHANNELS
+#define CHIMERA_SERIAL_MUX_CHANNELS ( 4 )
+#endif
+
+/*-------------------------------------------------------------------
+Most payload bytes in one frame on the wire. This is the scheduling
+granularity: a high priority channel waits for at most one chunk of
+another channel once its data reaches the link.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_SERIAL_MUX_CHUNK
+#define CHIMERA_SERIAL_MUX_CHUNK ( 64 )
+#endif
+
+namespace Chimera::Serial::Mux
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t NUM_CHANNELS = CHIMERA_SERIAL_MUX_CHANNELS;
+  static constexpr size_t CHUNK_SIZE   = CHIMERA_SERIAL_MUX_CHUNK;
+  static constexpr size_t HEADER_SIZE  = 6; /**< Kind, channel and a 32-bit counter */
+  static constexpr size_t FRAME_SIZE   = HEADER_SIZE + CHUNK_SIZE;
+
+  static_assert( NUM_CHANNELS <= 256, "Channel id is a single byte" );
+
+  /*---------------------------------------------------------------------------
+  Forward Declarations
+  ---------------------------------------------------------------------------*/
+  class Link;
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  One virtual channel. Opened like any serial port; Config::channel is
+   *  ignored and only RX_LENGTH reception is supported. The rxBuffer must
+   *  hold more than two chunks. Its free space is what the far end is allowed
+   *  to send, so a slow reader throttles only its own channel. The line
+   *  speed belongs to the physical driver, so setBaud() and autoBaud() are
+   *  not supported here.
+   */
+  class Endpoint : public HWInterface
+  {
+  public:
+    Endpoint();
+    ~Endpoint();
+
+    Chimera::Status_t  open( const Chimera::Serial::Config &config ) override;
+    Chimera::Status_t  close() override;
+    int                write( const void *const buffer, const size_t length, const size_t timeout ) override;
+    int                read( void *const buffer, const size_t length, const size_t timeout ) override;
+    int                writev( const etl::span<const ConstIOVec> &segments, const size_t timeout ) override;
+    int                readv( const etl::span<const IOVec> &segments, const size_t timeout ) override;
+    etl::span<uint8_t> writeReserve( const size_t length ) override;
+    int                writeCommit( const etl::span<uint8_t> &data ) override;
+    etl::span<uint8_t> readPeek( const size_t length ) override;
+    int                readConsume( const etl::span<uint8_t> &data ) override;
+    size_t             rxLength() override;
+    void               getStats( Stats &stats ) override;
+    void               resetStats() override;
+    Chimera::Status_t  setBaud( const size_t baud ) override;
+    Chimera::Status_t  autoBaud( const uint8_t sync ) override;
+    size_t             getBaud() override;
+
+    /**
+     *  Sets how the channel competes for the link. Channels with a higher
+     *  priority always go first. Channels of equal priority share the link in
+     *  proportion to their weight, a chunk at a time.
+     *
+     *  @param[in]  priority    Strict priority level, higher wins
+     *  @param[in]  weight      Relative share within the level, at least 1
+     *  @return Chimera::Status_t
+     */
+    Chimera::Status_t setScheduling( const uint8_t priority, const uint8_t weight );
+
+    /**
+     *  Bytes the far end sent that never arrived, e.g. frames that failed
+     *  their CRC. They are skipped rather than stalling the channel.
+     *
+     *  @return size_t
+     */
+    size_t lost() const;
+
+  private:
+    friend class Link;
+
+    Link                            *mLink;
+    uint8_t                          mId;
+    uint8_t                          mPriority;
+    uint8_t                          mWeight;
+    std::atomic<bool>                mOpen;
+    std::atomic<bool>                mAnnounce;   /**< Credit must be sent even if unchanged */
+    BipBuffer                       *mRx;
+    BipBuffer                       *mTx;
+    uint32_t                         mWindow;     /**< Bytes the far end may have in flight */
+    std::atomic<uint32_t>            mLimit;      /**< Far end's credit: send while mSent is below */
+    uint32_t                         mSent;       /**< Payload bytes sent */
+    size_t                           mDeficit;    /**< Deficit round robin allowance in bytes */
+    uint32_t                         mReceived;   /**< Far end's mSent as of the last frame */
+    std::atomic<uint32_t>            mSkipped;    /**< Received counter advanced past lost frames */
+    std::atomic<uint32_t>            mConsumed;   /**< Bytes taken out of mRx by the user */
+    std::atomic<uint32_t>            mAdvertised; /**< Last credit sent */
+    StatsBlock                       mStats;      /**< rxDropped counts the same bytes as lost() */
+    Chimera::Thread::BinarySemaphore mRxSignal;
+    Chimera::Thread::BinarySemaphore mTxSignal;
+
+    uint32_t credit() const;
+    void     consumed( const size_t count );
+    void     queued( const size_t count );
+  };
+
+
+  /**
+   *  The multiplexer. Each end of the link runs one, with matching channel
+   *  numbers, framing and chunk size. Two tasks drive it, or one task that
+   *  alternates between the calls with short timeouts:
+   *
+   *    while ( true ) { link.processTX( 100 ); }
+   *    while ( true ) { link.processRX( 100 ); }
+   *
+   *  Anything already in the physical driver's txBuffer is ahead of every
+   *  channel, so keep that buffer to a few chunks. The priorities can only
+   *  reorder what hasn't reached it yet.
+   */
+  class Link
+  {
+  public:
+    Link();
+    ~Link();
+
+    /**
+     *  Attaches the multiplexer to an open serial driver
+     *
+     *  @param[in]  driver      Physical link
+     *  @param[in]  protocol    Framing used on the wire
+     *  @param[in]  check       Integrity check on each frame
+     *  @return Chimera::Status_t
+     */
+    Chimera::Status_t open( Driver &driver, const Framing::Protocol protocol = Framing::Protocol::COBS,
+                            const Framing::Check check = Framing::Check::CRC16 );
+
+    /**
+     *  @param[in]  channel     Virtual channel number
+     *  @return Endpoint *      nullptr if out of range
+     */
+    Endpoint *endpoint( const size_t channel );
+
+    /**
+     *  Sends one frame: a credit update if one is due, otherwise the next
+     *  chunk picked by the scheduler. With nothing to send it waits up to
+     *  timeout for a channel to have data. Every channel's credit is also
+     *  re-sent periodically in case a CREDIT frame was lost.
+     *
+     *  @param[in]  timeout     Most time to block in milliseconds
+     *  @return size_t          Payload bytes sent
+     */
+    size_t processTX( const size_t timeout );
+
+    /**
+     *  Receives one frame and hands it to its channel
+     *
+     *  @param[in]  timeout     Most time to block in milliseconds
+     *  @return bool            True if a frame was received
+     */
+    bool processRX( const size_t timeout );
+
+  private:
+    friend class Endpoint;
+
+    Driver                          *mDriver;
+    Framing::Protocol                mProtocol;
+    Framing::Check                   mCheck;
+    Framing::Decoder                 mDecoder;
+    size_t                           mCursor;      /**< Channel the round robin is on */
+    bool                             mCharged;     /**< Cursor channel got its quantum */
+    size_t                           mLastRefresh; /**< When every credit was last re-sent */
+    size_t                           mTxLength;    /**< Encoded frame waiting in mTxFrame */
+    size_t                           mTxDone;      /**< Part of it already written */
+    Chimera::Thread::BinarySemaphore mWake;
+    Endpoint                         mEndpoints[ NUM_CHANNELS ];
+    uint8_t                          mRxFrame[ FRAME_SIZE + sizeof( uint32_t ) ];
+    uint8_t                          mTxFrame[ 2 * ( FRAME_SIZE + sizeof( uint32_t ) ) + 2 ];
+
+    Endpoint *schedule( size_t &length );
+    bool      flush( const size_t timeout );
+    void      send( const uint8_t kind, const uint8_t channel, const uint32_t value, const uint8_t *const payload,
+                    const size_t length );
+    void      deliver( Endpoint &endpoint, const uint32_t offset, const uint8_t *const payload, const size_t length );
+  };
+
+}  // namespace Chimera::Serial::Mux
+
+#endif /* !CHIMERA_SERIAL_MUX_HPP */
@@ -0,0 +1,130 @@
+/******************************************************************************
+ *  File Name:
+ *    serial_stats.hpp
+ *
+ *  Description:
+ *    Per-channel serial counters. Backends bump them from the ISR or IO
+ *    thread without locking, and users read them through Driver::getStats()
+ *    to tell line errors and overruns apart from a slow application.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_SERIAL_STATS_HPP
+#define CHIMERA_SERIAL_STATS_HPP
+
+/* STL Includes */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Chimera::Serial
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Snapshot of one channel's counters. They count from the last
+   *  resetStats() and wrap at 2^32, so take the difference of two snapshots
+   *  with unsigned arithmetic to get a rate.
+   */
+  struct Stats
+  {
+    uint32_t bytesIn;       /**< Bytes placed in the rxBuffer */
+    uint32_t bytesOut;      /**< Bytes taken from the txBuffer onto the wire */
+    uint32_t framingErrors; /**< Characters with a bad stop bit */
+    uint32_t parityErrors;  /**< Characters that failed the parity check */
+    uint32_t overrunErrors; /**< Characters lost in the hardware before they could be read out */
+    uint32_t noiseErrors;   /**< Characters sampled with noise on the line */
+    uint32_t rxFull;        /**< Times the rxBuffer filled up */
+    uint32_t rxDropped;     /**< Received bytes thrown away for lack of room */
+    uint32_t dmaRestarts;   /**< DMA transfers restarted after an error or abort */
+    uint32_t rxHighWater;   /**< Most bytes ever waiting in the rxBuffer */
+  };
+
+  /**
+   *  The live counters behind Stats. Each field has one writer, the ISR or
+   *  IO thread of the channel, and relaxed atomics keep that cheap while any
+   *  task takes a snapshot. A snapshot is consistent per field, not across
+   *  fields.
+   */
+  struct StatsBlock
+  {
+    std::atomic<uint32_t> bytesIn;
+    std::atomic<uint32_t> bytesOut;
+    std::atomic<uint32_t> framingErrors;
+    std::atomic<uint32_t> parityErrors;
+    std::atomic<uint32_t> overrunErrors;
+    std::atomic<uint32_t> noiseErrors;
+    std::atomic<uint32_t> rxFull;
+    std::atomic<uint32_t> rxDropped;
+    std::atomic<uint32_t> dmaRestarts;
+    std::atomic<uint32_t> rxHighWater;
+
+    StatsBlock()
+    {
+      reset();
+    }
+
+    /**
+     *  Adds to a counter
+     *
+     *  @param[in]  counter     Field of this block
+     *  @param[in]  count       Amount to add
+     */
+    static void add( std::atomic<uint32_t> &counter, const size_t count = 1 )
+    {
+      counter.fetch_add( static_cast<uint32_t>( count ), std::memory_order_relaxed );
+    }
+
+    /**
+     *  Records the rxBuffer fill level, keeping the highest
+     *
+     *  @param[in]  level       Bytes currently in the rxBuffer
+     */
+    void rxLevel( const size_t level )
+    {
+      const uint32_t value = static_cast<uint32_t>( level );
+      if ( value > rxHighWater.load( std::memory_order_relaxed ) )
+      {
+        rxHighWater.store( value, std::memory_order_relaxed );
+      }
+    }
+
+    void snapshot( Stats &stats ) const
+    {
+      stats.bytesIn       = bytesIn.load( std::memory_order_relaxed );
+      stats.bytesOut      = bytesOut.load( std::memory_order_relaxed );
+      stats.framingErrors = framingErrors.load( std::memory_order_relaxed );
+      stats.parityErrors  = parityErrors.load( std::memory_order_relaxed );
+      stats.overrunErrors = overrunErrors.load( std::memory_order_relaxed );
+      stats.noiseErrors   = noiseErrors.load( std::memory_order_relaxed );
+      stats.rxFull        = rxFull.load( std::memory_order_relaxed );
+      stats.rxDropped     = rxDropped.load( std::memory_order_relaxed );
+      stats.dmaRestarts   = dmaRestarts.load( std::memory_order_relaxed );
+      stats.rxHighWater   = rxHighWater.load( std::memory_order_relaxed );
+    }
+
+    /**
+     *  Zeroes every counter. An increment racing with this is counted
+     *  either before or after the reset, never half of each.
+     */
+    void reset()
+    {
+      bytesIn.store( 0, std::memory_order_relaxed );
+      bytesOut.store( 0, std::memory_order_relaxed );
+      framingErrors.store( 0, std::memory_order_relaxed );
+      parityErrors.store( 0, std::memory_order_relaxed );
+      overrunErrors.store( 0, std::memory_order_relaxed );
+      noiseErrors.store( 0, std::memory_order_relaxed );
+      rxFull.store( 0, std::memory_order_relaxed );
+      rxDropped.store( 0, std::memory_order_relaxed );
+      dmaRestarts.store( 0, std::memory_order_relaxed );
+      rxHighWater.store( 0, std::memory_order_relaxed );
+    }
+  };
+
+}  // namespace Chimera::Serial
+
+#endif /* !CHIMERA_SERIAL_STATS_HPP */
@@ -137,6 +137,23 @@ namespace Chimera::Serial
     NUM_OPTIONS
   };
 
+  /**
+   * @brief What completes a receive
+   *
+   * In the packet modes reception runs continuously into the rxBuffer and
+   * each boundary raises TRIGGER_READ_COMPLETE, so variable length messages
+   * are picked up about one character time after they end instead of when a
+   * read times out.
+   */
+  enum class RxMode : uint8_t
+  {
+    RX_LENGTH = 0, /**< read() waits for the requested length or the timeout */
+    RX_IDLE_LINE,  /**< A packet ends when the line goes idle */
+    RX_CHAR_MATCH, /**< A packet ends with Config::rxMatch */
+
+    NUM_OPTIONS
+  };
+
   enum class Channel : uint8_t
   {
     SERIAL1,
@@ -164,6 +181,24 @@ namespace Chimera::Serial
   /*---------------------------------------------------------------------------
   Structures
   ---------------------------------------------------------------------------*/
+  /**
+   * @brief One segment of a gathered write
+   */
+  struct ConstIOVec
+  {
+    const void *data;   /**< Start of the segment */
+    size_t      length; /**< Bytes in the segment */
+  };
+
+  /**
+   * @brief One segment of a scattered read
+   */
+  struct IOVec
+  {
+    void  *data;   /**< Start of the segment */
+    size_t length; /**< Bytes in the segment */
+  };
+
   struct Config
   {
     Channel     channel;  /**< Serial channel to use */
@@ -175,6 +210,8 @@ namespace Chimera::Serial
     TxfrMode    txfrMode; /**< Hardware transfer mode in TX/RX */
     BipBuffer  *rxBuffer; /**< IO ring buffer for reception */
     BipBuffer  *txBuffer; /**< IO ring buffer for transmission */
+    RxMode      rxMode;   /**< What completes a receive */
+    uint8_t     rxMatch;  /**< Packet terminator for RX_CHAR_MATCH */
   };
 
 
@@ -17,8 +17,11 @@ Includes
 -----------------------------------------------------------------------------*/
 #include <Chimera/common>
 #include <Chimera/source/drivers/peripherals/peripheral_types.hpp>
+#include <Chimera/source/drivers/serial/serial_stats.hpp>
 #include <Chimera/source/drivers/serial/serial_types.hpp>
 #include <Chimera/source/drivers/threading/threading_extensions.hpp>
+#include <etl/span.h>
+#include <limits>
 
 namespace Chimera::Serial
 {
@@ -29,6 +32,29 @@ namespace Chimera::Serial
   Chimera::Status_t reset();
   Driver_rPtr       getDriver( const Channel channel );
 
+  /**
+   *  Snaps a measured line speed to the nearest standard rate. Nearest is
+   *  by ratio, which is how UART timing error is judged, so 100000 bps
+   *  gives SERIAL_BAUD_115200 rather than SERIAL_BAUD_57600.
+   *
+   *  @param[in]  bps         Measured rate
+   *  @return BaudRate
+   */
+  BaudRate closestBaudRate( const size_t bps );
+
+  /**
+   *  Line speed from the timing of an auto-baud sync character. The pulse
+   *  runs from the falling edge of the start bit to the first rising edge,
+   *  so it spans the start bit plus the low bits that lead the character.
+   *  That is one bit for 0x55 and 0x7F, two for 0xFE.
+   *
+   *  @param[in]  sync        Sync character that was sent
+   *  @param[in]  ticks       Measured width of the low pulse
+   *  @param[in]  tickRate    Frequency of the timer that measured it (Hz)
+   *  @return size_t          Rate in bps, zero if ticks is zero
+   */
+  size_t baudFromPulse( const uint8_t sync, const size_t ticks, const size_t tickRate );
+
   /*---------------------------------------------------------------------------
   Classes
   ---------------------------------------------------------------------------*/
@@ -38,10 +64,22 @@ namespace Chimera::Serial
     Driver();
     ~Driver();
 
-    Chimera::Status_t open( const Chimera::Serial::Config &config );
-    Chimera::Status_t close();
-    int               write( const void *const buffer, const size_t length, const size_t timeout = Chimera::Thread::TIMEOUT_DONT_WAIT );
-    int               read( void *const buffer, const size_t length, const size_t timeout = Chimera::Thread::TIMEOUT_DONT_WAIT );
+    Chimera::Status_t  open( const Chimera::Serial::Config &config );
+    Chimera::Status_t  close();
+    int                write( const void *const buffer, const size_t length, const size_t timeout = Chimera::Thread::TIMEOUT_DONT_WAIT );
+    int                read( void *const buffer, const size_t length, const size_t timeout = Chimera::Thread::TIMEOUT_DONT_WAIT );
+    int                writev( const etl::span<const ConstIOVec> &segments, const size_t timeout = Chimera::Thread::TIMEOUT_DONT_WAIT );
+    int                readv( const etl::span<const IOVec> &segments, const size_t timeout = Chimera::Thread::TIMEOUT_DONT_WAIT );
+    etl::span<uint8_t> writeReserve( const size_t length );
+    int                writeCommit( const etl::span<uint8_t> &data );
+    etl::span<uint8_t> readPeek( const size_t length = std::numeric_limits<size_t>::max() );
+    int                readConsume( const etl::span<uint8_t> &data );
+    size_t             rxLength();
+    void               getStats( Stats &stats );
+    void               resetStats();
+    Chimera::Status_t  setBaud( const size_t baud );
+    Chimera::Status_t  autoBaud( const uint8_t sync );
+    size_t             getBaud();
 
   protected:
     friend Chimera::Thread::Lockable<Driver>;
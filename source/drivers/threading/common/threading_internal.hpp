@@ -52,6 +52,16 @@ namespace Chimera::Thread
    */
   TaskId getIdFromNativeId( const detail::native_thread_id id );
 
+  /**
+   *  Walks the registry without taking its lock. Only meant for post-mortem
+   *  capture, where blocking on a lock held by the failing thread would keep
+   *  the system from ever resetting.
+   *
+   *  @param[in]  index       Position in the registry
+   *  @return Task*           Thread at that position, nullptr past the end
+   */
+  Task *peekThread( const size_t index );
+
 }  // namespace Chimera::Thread
 
 #endif /* !CHIMERA_THREADING_INTERNAL_HPP */
@@ -14,6 +14,7 @@
 
 /* STL Includes */
 #include <cstdlib>
+#include <iterator>
 
 /* ETL Includes */
 #include <etl/flat_map.h>
@@ -187,6 +188,19 @@ namespace Chimera::Thread
   }
 
 
+  Task *peekThread( const size_t index )
+  {
+    if ( index >= s_thread_registry.size() )
+    {
+      return nullptr;
+    }
+
+    auto iter = s_thread_registry.begin();
+    std::advance( iter, index );
+    return &iter->second;
+  }
+
+
   /*---------------------------------------------------------------------------
   Public Functions
   ---------------------------------------------------------------------------*/
@@ -258,6 +272,12 @@ namespace Chimera::Thread
     return std::string_view( mTaskConfig.name.cbegin() );
   }
 
+
+  TaskPriority ITask::priority() const
+  {
+    return mTaskConfig.priority;
+  }
+
 }  // namespace Chimera::Thread
 
 
@@ -23,6 +23,7 @@
 #include <Chimera/common>
 #include <Chimera/system>
 #include <Chimera/thread>
+#include <Chimera/trace>
 
 #if defined( USING_FREERTOS ) || defined( USING_FREERTOS_THREADS )
 
@@ -52,7 +53,15 @@ namespace Chimera::Thread
   {
     if ( !Chimera::System::inISR() && ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING ) )
     {
+#if CHIMERA_TRACE_ENABLED
+      if ( xSemaphoreTake( _mtx, 0 ) != pdPASS )
+      {
+        CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+        xSemaphoreTake( _mtx, portMAX_DELAY );
+      }
+#else
       xSemaphoreTake( _mtx, portMAX_DELAY );
+#endif /* CHIMERA_TRACE_ENABLED */
     }
   }
 
@@ -98,7 +107,15 @@ namespace Chimera::Thread
   {
     if ( !Chimera::System::inISR() && ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING ) )
     {
+#if CHIMERA_TRACE_ENABLED
+      if ( xSemaphoreTakeRecursive( _mtx, 0 ) != pdPASS )
+      {
+        CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+        xSemaphoreTakeRecursive( _mtx, portMAX_DELAY );
+      }
+#else
       xSemaphoreTakeRecursive( _mtx, portMAX_DELAY );
+#endif /* CHIMERA_TRACE_ENABLED */
     }
   }
 
@@ -144,7 +161,15 @@ namespace Chimera::Thread
   {
     if ( !Chimera::System::inISR() && ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING ) )
     {
+#if CHIMERA_TRACE_ENABLED
+      if ( xSemaphoreTake( _mtx, 0 ) != pdPASS )
+      {
+        CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+        xSemaphoreTake( _mtx, portMAX_DELAY );
+      }
+#else
       xSemaphoreTake( _mtx, portMAX_DELAY );
+#endif /* CHIMERA_TRACE_ENABLED */
     }
   }
 
@@ -217,7 +242,15 @@ namespace Chimera::Thread
   {
     if ( !Chimera::System::inISR() && ( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING ) )
     {
+#if CHIMERA_TRACE_ENABLED
+      if ( xSemaphoreTakeRecursive( _mtx, 0 ) != pdPASS )
+      {
+        CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+        xSemaphoreTakeRecursive( _mtx, portMAX_DELAY );
+      }
+#else
       xSemaphoreTakeRecursive( _mtx, portMAX_DELAY );
+#endif /* CHIMERA_TRACE_ENABLED */
     }
   }
 
@@ -11,6 +11,7 @@
 /* Chimera Includes */
 #include <Chimera/common>
 #include <Chimera/thread>
+#include <Chimera/trace>
 
 #if defined( USING_NATIVE_THREADS )
 
@@ -29,7 +30,15 @@ namespace Chimera::Thread
 
   void Mutex::lock()
   {
+#if CHIMERA_TRACE_ENABLED
+    if ( !_mtx.try_lock() )
+    {
+      CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+      _mtx.lock();
+    }
+#else
     _mtx.lock();
+#endif /* CHIMERA_TRACE_ENABLED */
   }
 
   bool Mutex::try_lock()
@@ -56,7 +65,15 @@ namespace Chimera::Thread
 
   void RecursiveMutex::lock()
   {
+#if CHIMERA_TRACE_ENABLED
+    if ( !_mtx.try_lock() )
+    {
+      CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+      _mtx.lock();
+    }
+#else
     _mtx.lock();
+#endif /* CHIMERA_TRACE_ENABLED */
   }
 
   bool RecursiveMutex::try_lock()
@@ -83,7 +100,15 @@ namespace Chimera::Thread
 
   void TimedMutex::lock()
   {
+#if CHIMERA_TRACE_ENABLED
+    if ( !_mtx.try_lock() )
+    {
+      CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+      _mtx.lock();
+    }
+#else
     _mtx.lock();
+#endif /* CHIMERA_TRACE_ENABLED */
   }
 
   bool TimedMutex::try_lock()
@@ -121,7 +146,15 @@ namespace Chimera::Thread
 
   void RecursiveTimedMutex::lock()
   {
+#if CHIMERA_TRACE_ENABLED
+    if ( !_mtx.try_lock() )
+    {
+      CHIMERA_TRACE( MUTEX_CONTEND, reinterpret_cast<uintptr_t>( this ) );
+      _mtx.lock();
+    }
+#else
     _mtx.lock();
+#endif /* CHIMERA_TRACE_ENABLED */
   }
 
   bool RecursiveTimedMutex::try_lock()
@@ -154,6 +154,12 @@ namespace Chimera::Thread
      */
     std::string_view name() const;
 
+    /**
+     *  Returns the priority the thread was configured with
+     *  @return TaskPriority
+     */
+    TaskPriority priority() const;
+
     /**
      *  Returns the ID associated with the thread
      *  @return TaskId
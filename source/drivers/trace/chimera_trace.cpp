@@ -0,0 +1,127 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_trace.cpp
+ *
+ *  Description:
+ *    Trace recorder implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/* Chimera Includes */
+#include <Chimera/trace>
+
+namespace Chimera::Trace
+{
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  namespace Internal
+  {
+    Ring              rings[ CHIMERA_TRACE_CORES ];
+    std::atomic<bool> enabled{ true };
+  }  // namespace Internal
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  void enable( const bool state )
+  {
+    Internal::enabled.store( state, std::memory_order_relaxed );
+  }
+
+
+  void clear()
+  {
+    for ( auto &ring : Internal::rings )
+    {
+      for ( auto &slot : ring.slots )
+      {
+        slot.sequence.store( 0, std::memory_order_relaxed );
+      }
+
+      ring.head.store( 0, std::memory_order_release );
+    }
+  }
+
+
+  size_t collect( const size_t core, Entry *const entries, const size_t max )
+  {
+    if ( ( core >= CHIMERA_TRACE_CORES ) || !entries )
+    {
+      return 0;
+    }
+
+    const Internal::Ring &ring  = Internal::rings[ core ];
+    const uint32_t        head  = ring.head.load( std::memory_order_acquire );
+    const uint32_t        keep  = static_cast<uint32_t>( ( max < CHIMERA_TRACE_DEPTH ) ? max : CHIMERA_TRACE_DEPTH );
+    const uint32_t        first = ( head > keep ) ? ( head - keep ) : 0;
+    size_t                count = 0;
+
+    for ( uint32_t pos = first; ( pos != head ) && ( count < max ); pos++ )
+    {
+      const Internal::Slot &slot = ring.slots[ pos & ( CHIMERA_TRACE_DEPTH - 1 ) ];
+
+      /*-----------------------------------------------------------------------
+      Only keep the copy if the slot held this position before and after it
+      -----------------------------------------------------------------------*/
+      const uint32_t before = slot.sequence.load( std::memory_order_acquire );
+      if ( before != ( pos + 1 ) )
+      {
+        continue;
+      }
+
+      const uint32_t timestamp = slot.timestamp.load( std::memory_order_relaxed );
+      const uint32_t info      = slot.info.load( std::memory_order_relaxed );
+      const uint32_t arg       = slot.arg.load( std::memory_order_relaxed );
+
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( slot.sequence.load( std::memory_order_relaxed ) != before )
+      {
+        continue;
+      }
+
+      entries[ count ].timestamp = timestamp;
+      entries[ count ].event     = static_cast<uint16_t>( info & 0xFFFF );
+      entries[ count ].core      = static_cast<uint16_t>( info >> 16 );
+      entries[ count ].arg       = arg;
+      count++;
+    }
+
+    return count;
+  }
+
+
+  size_t dump( void *const buffer, const size_t size )
+  {
+    if ( !buffer || ( size < sizeof( DumpHeader ) ) || ( reinterpret_cast<uintptr_t>( buffer ) % alignof( DumpHeader ) ) )
+    {
+      return 0;
+    }
+
+    const bool was_enabled = Internal::enabled.exchange( false, std::memory_order_relaxed );
+
+    auto *const  header = static_cast<DumpHeader *>( buffer );
+    auto *const  body   = reinterpret_cast<Entry *>( header + 1 );
+    const size_t room   = ( size - sizeof( DumpHeader ) ) / sizeof( Entry );
+
+    header->magic   = DUMP_MAGIC;
+    header->version = DUMP_VERSION;
+    header->cores   = CHIMERA_TRACE_CORES;
+    header->count   = 0;
+    header->lost    = 0;
+
+    for ( size_t core = 0; core < CHIMERA_TRACE_CORES; core++ )
+    {
+      const uint32_t recorded = Internal::rings[ core ].head.load( std::memory_order_acquire );
+      const size_t   copied   = collect( core, body + header->count, room - header->count );
+
+      header->count += static_cast<uint32_t>( copied );
+      header->lost += static_cast<uint32_t>( ( recorded > copied ) ? ( recorded - copied ) : 0 );
+    }
+
+    Internal::enabled.store( was_enabled, std::memory_order_relaxed );
+    return sizeof( DumpHeader ) + ( header->count * sizeof( Entry ) );
+  }
+
+}  // namespace Chimera::Trace
@@ -0,0 +1,195 @@
+/******************************************************************************
+ *  File Name:
+ *    chimera_trace_export.cpp
+ *
+ *  Description:
+ *    Trace dump exporters. Only built for the host.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#if defined( USING_NATIVE_THREADS )
+
+/* STL Includes */
+#include <cstdarg>
+#include <cstring>
+
+/* Chimera Includes */
+#include <Chimera/source/drivers/trace/trace_export.hpp>
+
+namespace Chimera::Trace
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr int TRACK_TASKS  = 1;
+  static constexpr int TRACK_ISR    = 2;
+  static constexpr int TRACK_EVENTS = 3;
+
+  static constexpr const char *s_event_names[] = {
+    "task_switch", "isr_enter", "isr_exit", "event_notify", "dma_start", "dma_complete", "sched_fire", "mutex_contend",
+  };
+  static_assert( ( sizeof( s_event_names ) / sizeof( s_event_names[ 0 ] ) ) == NUM_SYSTEM_EVENTS );
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static void writeEvent( std::FILE *const file, bool &first, const char *const fmt, ... )
+      __attribute__( ( format( printf, 3, 4 ) ) );
+
+  static void writeEvent( std::FILE *const file, bool &first, const char *const fmt, ... )
+  {
+    va_list args;
+    va_start( args, fmt );
+
+    std::fputs( first ? "\n    " : ",\n    ", file );
+    std::vfprintf( file, fmt, args );
+    first = false;
+
+    va_end( args );
+  }
+
+
+  static void eventName( const uint16_t event, char *const name, const size_t size )
+  {
+    if ( event < NUM_SYSTEM_EVENTS )
+    {
+      std::snprintf( name, size, "%s", s_event_names[ event ] );
+    }
+    else if ( event >= USER_EVENT )
+    {
+      std::snprintf( name, size, "user_%u", static_cast<unsigned>( event - USER_EVENT ) );
+    }
+    else
+    {
+      std::snprintf( name, size, "unknown_%u", static_cast<unsigned>( event ) );
+    }
+  }
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  bool exportPerfetto( const void *const dump, const size_t size, std::FILE *const file )
+  {
+    /*-------------------------------------------------------------------------
+    Validate the dump
+    -------------------------------------------------------------------------*/
+    DumpHeader header;
+    if ( !dump || !file || ( size < sizeof( header ) ) )
+    {
+      return false;
+    }
+
+    memcpy( &header, dump, sizeof( header ) );
+    if ( ( header.magic != DUMP_MAGIC ) || ( header.version != DUMP_VERSION ) ||
+         ( size < ( sizeof( header ) + ( header.count * sizeof( Entry ) ) ) ) )
+    {
+      return false;
+    }
+
+    const auto *const raw = static_cast<const uint8_t *>( dump ) + sizeof( header );
+
+    /*-------------------------------------------------------------------------
+    Name the tracks
+    -------------------------------------------------------------------------*/
+    bool first = true;
+    std::fputs( "{\n  \"traceEvents\": [", file );
+
+    static constexpr const char *TRACK_NAME_FMT = R"({"ph":"M","name":"thread_name","pid":%u,"tid":%d,"args":{"name":"%s"}})";
+
+    for ( unsigned core = 0; core < header.cores; core++ )
+    {
+      writeEvent( file, first, R"({"ph":"M","name":"process_name","pid":%u,"args":{"name":"Core %u"}})", core, core );
+      writeEvent( file, first, TRACK_NAME_FMT, core, TRACK_TASKS, "Tasks" );
+      writeEvent( file, first, TRACK_NAME_FMT, core, TRACK_ISR, "ISR" );
+      writeEvent( file, first, TRACK_NAME_FMT, core, TRACK_EVENTS, "Events" );
+    }
+
+    /*-------------------------------------------------------------------------
+    Entries are grouped by core, oldest first
+    -------------------------------------------------------------------------*/
+    unsigned long long last_stamp  = 0;
+    unsigned long long epoch       = 0;
+    unsigned           last_core   = UINT32_MAX;
+    bool               task_active = false;
+
+    for ( uint32_t x = 0; x < header.count; x++ )
+    {
+      Entry entry;
+      memcpy( &entry, raw + ( x * sizeof( Entry ) ), sizeof( entry ) );
+      const unsigned core = entry.core;
+
+      /*-----------------------------------------------------------------------
+      Close out the previous core and restart timestamp unwrapping
+      -----------------------------------------------------------------------*/
+      if ( core != last_core )
+      {
+        if ( task_active )
+        {
+          writeEvent( file, first, R"({"ph":"E","pid":%u,"tid":%d,"ts":%llu})", last_core, TRACK_TASKS, last_stamp );
+        }
+
+        last_core   = core;
+        last_stamp  = 0;
+        epoch       = 0;
+        task_active = false;
+      }
+
+      unsigned long long stamp = epoch + entry.timestamp;
+      if ( stamp < last_stamp )
+      {
+        epoch += ( 1ull << 32 );
+        stamp += ( 1ull << 32 );
+      }
+      last_stamp = stamp;
+
+      char name[ 24 ];
+      eventName( entry.event, name, sizeof( name ) );
+
+      switch ( entry.event )
+      {
+        case TASK_SWITCH:
+          if ( task_active )
+          {
+            writeEvent( file, first, R"({"ph":"E","pid":%u,"tid":%d,"ts":%llu})", core, TRACK_TASKS, stamp );
+          }
+
+          writeEvent( file, first, R"({"ph":"B","name":"task %u","pid":%u,"tid":%d,"ts":%llu})", entry.arg, core, TRACK_TASKS,
+                      stamp );
+          task_active = true;
+          break;
+
+        case ISR_ENTER:
+          writeEvent( file, first, R"({"ph":"B","name":"isr %u","pid":%u,"tid":%d,"ts":%llu})", entry.arg, core, TRACK_ISR,
+                      stamp );
+          break;
+
+        case ISR_EXIT:
+          writeEvent( file, first, R"({"ph":"E","pid":%u,"tid":%d,"ts":%llu})", core, TRACK_ISR, stamp );
+          break;
+
+        case DMA_START:
+        case DMA_COMPLETE:
+          writeEvent( file, first, R"({"ph":"%s","cat":"dma","name":"dma","id":%u,"pid":%u,"tid":%d,"ts":%llu})",
+                      ( entry.event == DMA_START ) ? "b" : "e", entry.arg, core, TRACK_EVENTS, stamp );
+          break;
+
+        default:
+          writeEvent( file, first, R"({"ph":"i","s":"t","name":"%s","pid":%u,"tid":%d,"ts":%llu,"args":{"arg":%u}})",
+                      name, core, TRACK_EVENTS, stamp, entry.arg );
+          break;
+      }
+    }
+
+    if ( task_active )
+    {
+      writeEvent( file, first, R"({"ph":"E","pid":%u,"tid":%d,"ts":%llu})", last_core, TRACK_TASKS, last_stamp );
+    }
+
+    std::fprintf( file, "\n  ],\n  \"otherData\": {\"lost\": %u}\n}\n", header.lost );
+    return std::ferror( file ) == 0;
+  }
+
+}  // namespace Chimera::Trace
+
+#endif /* USING_NATIVE_THREADS */
@@ -0,0 +1,193 @@
+/******************************************************************************
+ *  File Name:
+ *    trace.hpp
+ *
+ *  Description:
+ *    Low overhead binary event trace recorder
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_TRACE_HPP
+#define CHIMERA_TRACE_HPP
+
+/* STL Includes */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/source/drivers/container/container_mpmc_queue.hpp>
+#include <Chimera/source/drivers/trace/trace_types.hpp>
+
+/*-----------------------------------------------------------------------------
+Literals
+-----------------------------------------------------------------------------*/
+/*-------------------------------------------------------------------
+Compiles the trace points in. When zero, CHIMERA_TRACE() expands to
+nothing and its argument isn't evaluated. Must be set the same way
+for every library in the build.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_TRACE_ENABLED
+#define CHIMERA_TRACE_ENABLED ( 0 )
+#endif
+
+/*-------------------------------------------------------------------
+Records held per core. Must be a power of two.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_TRACE_DEPTH
+#define CHIMERA_TRACE_DEPTH ( 256 )
+#endif
+
+/*-------------------------------------------------------------------
+Number of cores recording, and how to tell which one is running.
+Multi-core ports override both.
+-------------------------------------------------------------------*/
+#ifndef CHIMERA_TRACE_CORES
+#define CHIMERA_TRACE_CORES ( 1 )
+#endif
+
+#ifndef CHIMERA_TRACE_CORE_ID
+#define CHIMERA_TRACE_CORE_ID() ( 0u )
+#endif
+
+/*-------------------------------------------------------------------
+Records an event at the call site:
+
+  CHIMERA_TRACE( ISR_ENTER, signal );
+  CHIMERA_TRACE( USER_EVENT + 3, length );
+
+FreeRTOS task switches can be captured by defining traceTASK_SWITCHED_IN()
+in FreeRTOSConfig.h to record TASK_SWITCH with the task number.
+-------------------------------------------------------------------*/
+#if CHIMERA_TRACE_ENABLED
+#define CHIMERA_TRACE( event, arg ) \
+  ::Chimera::Trace::record( static_cast<uint16_t>( ::Chimera::Trace::event ), static_cast<uint32_t>( arg ) )
+#else
+#define CHIMERA_TRACE( event, arg ) ( ( void )0 )
+#endif
+
+namespace Chimera::Trace
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  namespace Internal
+  {
+    /**
+     *  Ring slot. Every field is an atomic word so that a reader copying a
+     *  slot while it is rewritten is well defined; relaxed accesses compile
+     *  to plain loads and stores. The sequence number is cleared before the
+     *  slot is rewritten and set to its position + 1 afterwards, so a reader
+     *  can tell a torn copy from a good one.
+     */
+    struct Slot
+    {
+      std::atomic<uint32_t> sequence;
+      std::atomic<uint32_t> timestamp;
+      std::atomic<uint32_t> info; /**< Event in the low half, core in the high */
+      std::atomic<uint32_t> arg;
+    };
+
+    /**
+     *  Flight recorder ring for one core. The newest records overwrite the
+     *  oldest. Writers claim a position with a single fetch_add, so nested
+     *  ISRs on the same core can record without masking interrupts.
+     */
+    struct Ring
+    {
+      alignas( CHIMERA_CACHE_LINE_SIZE ) std::atomic<uint32_t> head;
+      Slot slots[ CHIMERA_TRACE_DEPTH ];
+    };
+
+    static_assert( ( CHIMERA_TRACE_DEPTH & ( CHIMERA_TRACE_DEPTH - 1 ) ) == 0, "CHIMERA_TRACE_DEPTH must be a power of two" );
+
+    extern Ring              rings[ CHIMERA_TRACE_CORES ];
+    extern std::atomic<bool> enabled;
+  }  // namespace Internal
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Records an event on the current core. Safe from any context. Prefer the
+   *  CHIMERA_TRACE() macro, which compiles away when tracing is disabled.
+   *
+   *  @param[in]  event       Trace::Event or an application defined id
+   *  @param[in]  arg         Event specific argument
+   *  @return void
+   */
+  inline void record( const uint16_t event, const uint32_t arg )
+  {
+    using namespace Internal;
+
+    if ( !enabled.load( std::memory_order_relaxed ) )
+    {
+      return;
+    }
+
+    const uint32_t core = CHIMERA_TRACE_CORE_ID();
+    Ring          &ring = rings[ core ];
+    const uint32_t pos  = ring.head.fetch_add( 1, std::memory_order_relaxed );
+    Slot          &slot = ring.slots[ pos & ( CHIMERA_TRACE_DEPTH - 1 ) ];
+
+    slot.sequence.store( 0, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    slot.timestamp.store( static_cast<uint32_t>( Chimera::micros() ), std::memory_order_relaxed );
+    slot.info.store( event | ( core << 16 ), std::memory_order_relaxed );
+    slot.arg.store( arg, std::memory_order_relaxed );
+    slot.sequence.store( pos + 1, std::memory_order_release );
+  }
+
+  /**
+   *  Starts or stops recording. Recording starts enabled.
+   *
+   *  @param[in]  state       True to record
+   *  @return void
+   */
+  void enable( const bool state );
+
+  /**
+   *  Discards everything recorded so far
+   *
+   *  @return void
+   */
+  void clear();
+
+  /**
+   *  Copies the most recent records of one core out of its ring, oldest
+   *  first. Records being written during the copy are skipped.
+   *
+   *  @param[in]  core        Core to collect from
+   *  @param[out] entries     Receives the records
+   *  @param[in]  max         Capacity of entries
+   *  @return size_t          Number of records copied
+   */
+  size_t collect( const size_t core, Entry *const entries, const size_t max );
+
+  /**
+   *  Serializes every core's records into a buffer for transfer to a host,
+   *  where it can be converted with one of the exporters. Recording is paused
+   *  for the duration so the snapshot is consistent.
+   *
+   *  @param[out] buffer      Destination for the DumpHeader and entries, 4 byte aligned
+   *  @param[in]  size        Size of the buffer in bytes
+   *  @return size_t          Bytes written, or zero if the buffer can't hold the header
+   */
+  size_t dump( void *const buffer, const size_t size );
+
+  /**
+   *  Worst case size of a dump
+   *
+   *  @return size_t
+   */
+  constexpr size_t dumpSize()
+  {
+    return sizeof( DumpHeader ) + ( sizeof( Entry ) * CHIMERA_TRACE_DEPTH * CHIMERA_TRACE_CORES );
+  }
+
+}  // namespace Chimera::Trace
+
+#endif /* !CHIMERA_TRACE_HPP */
@@ -0,0 +1,52 @@
+/******************************************************************************
+ *  File Name:
+ *    trace_export.hpp
+ *
+ *  Description:
+ *    Host side conversion of trace dumps into viewer formats
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_TRACE_EXPORT_HPP
+#define CHIMERA_TRACE_EXPORT_HPP
+
+#if defined( USING_NATIVE_THREADS )
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdio>
+
+/* Chimera Includes */
+#include <Chimera/source/drivers/trace/trace_types.hpp>
+
+namespace Chimera::Trace
+{
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Converts a buffer produced by Trace::dump() into the Chrome trace event
+   *  JSON format, which Perfetto (ui.perfetto.dev) and chrome://tracing open
+   *  directly. Each core becomes a process with three tracks:
+   *
+   *    - Tasks:  a slice per task, from one TASK_SWITCH to the next
+   *    - ISR:    a slice per ISR_ENTER/ISR_EXIT pair, nested as they occur
+   *    - Events: an instant for everything else
+   *
+   *  DMA_START/DMA_COMPLETE pairs become async slices keyed by transfer id.
+   *  The 32-bit timestamps are unwrapped, so dumps longer than ~71 minutes
+   *  remain ordered.
+   *
+   *  @param[in]  dump        Buffer from Trace::dump()
+   *  @param[in]  size        Size of the dump in bytes
+   *  @param[in]  file        Where to write the JSON
+   *  @return bool            False if the dump is malformed or the write failed
+   */
+  bool exportPerfetto( const void *const dump, const size_t size, std::FILE *const file );
+
+}  // namespace Chimera::Trace
+
+#endif /* USING_NATIVE_THREADS */
+#endif /* !CHIMERA_TRACE_EXPORT_HPP */
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *  File Name:
+ *    trace_types.hpp
+ *
+ *  Description:
+ *    Types shared by the trace recorder and its exporters
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef CHIMERA_TRACE_TYPES_HPP
+#define CHIMERA_TRACE_TYPES_HPP
+
+/* STL Includes */
+#include <cstddef>
+#include <cstdint>
+
+namespace Chimera::Trace
+{
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  /**
+   *  What a trace record describes. The meaning of the record's argument
+   *  depends on the event and is noted next to each one.
+   */
+  enum Event : uint16_t
+  {
+    TASK_SWITCH,   /**< A task was switched in. Arg: task id */
+    ISR_ENTER,     /**< An ISR started. Arg: interrupt signal */
+    ISR_EXIT,      /**< An ISR finished. Arg: interrupt signal */
+    EVENT_NOTIFY,  /**< Event::notifyListener() ran. Arg: trigger */
+    DMA_START,     /**< A DMA transfer started. Arg: transfer id */
+    DMA_COMPLETE,  /**< A DMA transfer finished. Arg: transfer id */
+    SCHED_FIRE,    /**< A scheduled function was invoked. Arg: timer slot */
+    MUTEX_CONTEND, /**< A mutex lock had to wait. Arg: low bits of the mutex address */
+
+    NUM_SYSTEM_EVENTS,
+    USER_EVENT = 0x100 /**< First id available to applications */
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  A single decoded trace record
+   */
+  struct Entry
+  {
+    uint32_t timestamp; /**< Chimera::micros() when recorded, truncated to 32 bits */
+    uint16_t event;     /**< Trace::Event or an application defined id */
+    uint16_t core;      /**< Core that recorded it */
+    uint32_t arg;       /**< Event specific argument */
+  };
+  static_assert( sizeof( Entry ) == 12 );
+
+  /**
+   *  Start of a buffer produced by Trace::dump(). It is followed directly by
+   *  `count` Entry structures, grouped by core and oldest first within each.
+   */
+  struct DumpHeader
+  {
+    uint32_t magic;   /**< Always DUMP_MAGIC */
+    uint16_t version; /**< Always DUMP_VERSION */
+    uint16_t cores;   /**< Number of cores the recorder was built for */
+    uint32_t count;   /**< Number of entries following the header */
+    uint32_t lost;    /**< Records overwritten before they were dumped */
+  };
+  static_assert( sizeof( DumpHeader ) == 16 );
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint32_t DUMP_MAGIC   = 0x43545243; /**< "CRTC" */
+  static constexpr uint16_t DUMP_VERSION = 1;
+
+}  // namespace Chimera::Trace
+
+#endif /* !CHIMERA_TRACE_TYPES_HPP */